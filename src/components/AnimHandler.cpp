@@ -4,6 +4,7 @@
 #include <algorithm>
 #include <zenload/zCModelPrototype.h>
 #include <engine/World.h>
+#include <content/VDFSLock.h>
 
 using namespace Components;
 
@@ -15,6 +16,7 @@ AnimHandler::AnimHandler()
     m_LastProcessedFrame = static_cast<size_t>(-1);
     m_AnimationStateHash = 0;
     m_pWorld = nullptr;
+    m_Owner.invalidate();
 }
 
 /**
@@ -64,7 +66,7 @@ bool AnimHandler::addAnimation(const std::string &name)
 	}
 
     m_Animations.push_back(h);
-    m_AnimationsByName[getAnimation(h).animation.getModelAniHeader().aniName] = h;
+    m_AnimationsByName[Utils::Name(getAnimation(h).animation.getModelAniHeader().aniName)] = h;
 
     return true;
 }
@@ -72,7 +74,7 @@ bool AnimHandler::addAnimation(const std::string &name)
 /**
 * @brief Sets the currently playing animation
 */
-void AnimHandler::playAnimation(const std::string &animName)
+void AnimHandler::playAnimation(const Utils::Name &animName)
 {
     //if(m_MeshLibName == "CHESTSMALL_OCCRATESMALL")
     //    LogInfo() << "Playing animation '" << animName << "' on Model: " << m_MeshLibName;
@@ -83,6 +85,7 @@ void AnimHandler::playAnimation(const std::string &animName)
     if (animName.empty())
     {
         m_ActiveAnimation.invalidate();
+        m_ActiveAnimationName = Utils::Name();
 
         // Restore matrices from the bind-pose
         // because the animation won't modify all of the nodes
@@ -96,7 +99,7 @@ void AnimHandler::playAnimation(const std::string &animName)
 
     // If we currently don't have this animation, try to load it
     if(!hasAnimation(animName))
-        addAnimation(animName);
+        addAnimation(animName.str());
 
     // find and apply given animation name
     auto it = m_AnimationsByName.find(animName);
@@ -104,10 +107,12 @@ void AnimHandler::playAnimation(const std::string &animName)
     {
         //LogError() << "Failed to find animation: " << animName;
         m_ActiveAnimation.invalidate();
+        m_ActiveAnimationName = Utils::Name();
     }
     else
     {
         m_ActiveAnimation = (*it).second;
+        m_ActiveAnimationName = animName;
         m_AnimationFrame = 0.0f;
         m_LoopActiveAnimation = false;
         m_LastProcessedFrame = (size_t)-1;
@@ -124,9 +129,9 @@ void AnimHandler::playAnimation(const std::string &animName)
     }
 }
 
-void AnimHandler::setAnimation(const std::string &animName)
+void AnimHandler::setAnimation(const Utils::Name &animName)
 {
-    if (getActiveAnimationPtr() && getActiveAnimationPtr()->getModelAniHeader().aniName == animName)
+    if (getActiveAnimationPtr() && m_ActiveAnimationName == animName)
         return;
 
     playAnimation(animName);
@@ -157,7 +162,7 @@ void AnimHandler::updateAnimations(double deltaTime)
             //    LogInfo() << "Setting next Ani: " << next;
 
             bool oldLoop = m_LoopActiveAnimation;
-            playAnimation(next);
+            playAnimation(Utils::Name(next));
 
             // Make sure we loop that one if we wanted to loop the starting animation
             m_LoopActiveAnimation = oldLoop;
@@ -334,12 +339,14 @@ bool AnimHandler::loadMeshLibFromVDF(const std::string &file, VDFS::FileIndex &i
     ZenLoad::zCModelMeshLib lib;
 
     // Load heirachy
+    std::unique_lock<std::mutex> lock = Content::lockVDFS();
     if(idx.hasFile(file + ".MDH"))
         lib = ZenLoad::zCModelMeshLib(file + ".MDH", idx, 1.0f / 100.0f);
     else if(idx.hasFile(file + ".MDL")) // Some mobs have .MDL
         lib = ZenLoad::zCModelMeshLib(file + ".MDL", idx, 1.0f / 100.0f);
     else if(idx.hasFile(file + ".MDM")) // Some mobs have .MDL
         lib = ZenLoad::zCModelMeshLib(file + ".MDM", idx, 1.0f / 100.0f);
+    lock.unlock();
 
     if(!lib.isValid())
         LogWarn() << "Could not load MeshLib for Visual: " << file;
@@ -4,6 +4,7 @@
 #include <unordered_map>
 #include <math/mathlib.h>
 #include <handle/HandleDef.h>
+#include <utils/Name.h>
 
 namespace World
 {
@@ -17,7 +18,7 @@ namespace Animations
 
 namespace Components
 {
-	class AnimHandler
+	class AnimHandler : public Handle::HandleTypeDescriptor<Handle::AnimHandlerHandle>
 	{
 	public:
 
@@ -28,6 +29,12 @@ namespace Components
 		 */
 		void setWorld(World::WorldInstance& world){ m_pWorld = &world; }
 
+		/**
+		 * Entity this handler animates
+		 */
+		void setOwner(Handle::EntityHandle e){ m_Owner = e; }
+		Handle::EntityHandle getOwner(){ return m_Owner; }
+
 		/**
 		 * @brief Sets the mesh-lib this operates on. Does a copy inside, so the given object can be deleted.
 		 */
@@ -48,12 +55,12 @@ namespace Components
 		/**
 		 * @brief Sets the currently playing animation. Restarts it, if this is currently running. Doesn't loop.
 		 */
-		void playAnimation(const std::string& animName);
+		void playAnimation(const Utils::Name& animName);
 
 		/**
 		 * @brief Sets the currently playing animation without restarting it, if it is currently running. Loops.
 		 */
-		void setAnimation(const std::string& animName);
+		void setAnimation(const Utils::Name& animName);
 
 		/**
 		 * @brief Sets the overlay for this animation manager
@@ -134,11 +141,18 @@ namespace Components
 		 * @param name Animation to check
 		 * @return whether the given animation is available
 		 */
-		bool hasAnimation(const std::string& name)
+		bool hasAnimation(const Utils::Name& name)
 		{
 			return m_AnimationsByName.find(name) != m_AnimationsByName.end();
 		}
 
+		bool hasAnimation(const std::string& name)
+		{
+			// Never interned, so it can't have been loaded
+			Utils::Name n = Utils::Name::find(name);
+			return (!n.empty() || name.empty()) && hasAnimation(n);
+		}
+
 		/**
 		 * @return Value useful to check if there was an actual change. This value is modified every time
 		 * 		  the animation was updated
@@ -168,7 +182,7 @@ namespace Components
 		 * @brief Animations by their name
 		 */
 		std::vector<Handle::AnimationHandle> m_Animations;
-		std::unordered_map<std::string, Handle::AnimationHandle> m_AnimationsByName;
+		std::unordered_map<Utils::Name, Handle::AnimationHandle> m_AnimationsByName;
 
 		/**
 		 * @brief Meshlib this operates on
@@ -180,6 +194,7 @@ namespace Components
 		 * @brief Active animation
 		 */
 		Handle::AnimationHandle m_ActiveAnimation;
+		Utils::Name m_ActiveAnimationName;
 		float m_AnimationFrame;
 		size_t m_LastProcessedFrame;
 		bool m_LoopActiveAnimation;
@@ -217,6 +232,11 @@ namespace Components
 		 */
 		World::WorldInstance* m_pWorld;
 
+		/**
+		 * @brief Entity this handler animates
+		 */
+		Handle::EntityHandle m_Owner;
+
 		/**
 		 * @brief Speed multiplier for all animations
 		 */
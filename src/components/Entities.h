@@ -1,13 +1,16 @@
 #pragma once
 #include <utils/Utils.h>
+#include <utils/Name.h>
 #include <math/mathlib.h>
 #include <handle/Handle.h>
 #include <handle/HandleDef.h>
 #include <content/StaticLevelMesh.h>
 #include <content/VertexTypes.h>
 #include <memory/AllocatorBundle.h>
+#include <memory/SparseAllocatorBundle.h>
 #include <memory/Config.h>
 #include <engine/WorldTypes.h>
+#include "EntityQueries.h"
 #include "AnimHandler.h"
 
 /**
@@ -34,8 +37,6 @@ namespace Logic
 
 namespace Components
 {
-    typedef uint32_t ComponentMask;
-
 	struct Component : public Handle::HandleTypeDescriptor<Handle::EntityHandle>
 	{
         ~Component(){};
@@ -44,10 +45,9 @@ namespace Components
     /**
      * Component which can be expected to be valid on all entities.
      * This stores, which components are valid for that entity.
-     * Since every entity creates all components in the background, a component being "valid"
-     * only means, that it's flag was registered inside m_ComponentMask. The memory would be there in all cases,
-     * however accessing a component without it being registered is not supported and could lead to undefined behavior
-     * (or just 'nothing', in most cases really)
+     * All other components are only stored for entities which access them, see SparseAllocatorBundle.
+     * A component being "valid" means, that it's flag was registered inside m_ComponentMask. Accessing a component
+     * without it being registered will create an initialized one, but is not supported otherwise.
      */
     struct EntityComponent : public Component
     {
@@ -223,7 +223,7 @@ namespace Components
         /**
          * Name of this object
          */
-        std::string m_Name;
+        Utils::Name m_Name;
 
         /**
          * Object-type
@@ -251,9 +251,10 @@ namespace Components
         enum { MASK = 1 << 9 };
 
         /**
-         * Storage for animations of this model
+         * Storage for animations of this model, inside the worlds AnimHandler-pool.
+         * Taken from the pool on first access through WorldInstance::getAnimHandler().
          */
-        AnimHandler* m_AnimHandler;
+        Handle::AnimHandlerHandle m_AnimHandler;
 
         /**
          * If this is set to something valid, the anim-handler of this will be ignored and the one of the
@@ -261,11 +262,9 @@ namespace Components
          */
         Handle::EntityHandle m_ParentAnimHandler;
 
-        AnimHandler& getAnimHandler(){ return *m_AnimHandler; }
-
         static void init(AnimationComponent& c)
         {
-            c.m_AnimHandler = new AnimHandler;
+            c.m_AnimHandler.invalidate();
         }
     };
 
@@ -313,45 +312,235 @@ namespace Components
     };
 
     /**
-     * Adds a component to the given Entity-Component
+     * Checks if the given component is present in the entity
      */
     template<typename T>
-    void addComponent(EntityComponent& e)
+    bool hasComponent(const EntityComponent& e)
     {
         // See "EntityComponent" for further information
-        e.m_ComponentMask |= T::MASK;
+        return (e.m_ComponentMask & T::MASK) != 0;
     }
 
     /**
-     * Removes a component from the given Entity-Component
+     * Creates a ComponentMask from uint32_t, for cleaner access
      */
-    template<typename T>
-    void removeComponent(EntityComponent& e)
+    static ComponentMask makeEntityMask(uint32_t mask)
     {
-        // See "EntityComponent" for further information
-        e.m_ComponentMask &= ~T::MASK;
+        return static_cast<ComponentMask>(mask);
     }
 
     /**
-     * Checks if the given component is present in the entity
+     * The components a vob is made of, resolved once per entity. Components whose flag isn't set are nullptr.
+     * Components never move as long as no entity is removed (their arrays are reserved up front), so the pointers
+     * stay good until the allocator changes its layout. See ComponentAllocator::getView().
+     */
+    struct ComponentView
+    {
+        LogicComponent* logic;
+        VisualComponent* visual;
+        ObjectComponent* object;
+        PositionComponent* position;
+
+        /** Entity this was resolved for */
+        Handle::EntityHandle entity;
+
+        /** Layout-generation of the allocator at the time this was resolved. 0 if it never was. */
+        uint32_t generation;
+    };
+
+    /**
+     * Default allocator-type. Only stores the components an entity uses.
+     * All changes to the component-masks must go through here, so the entity-queries stay up to date.
+     */
+    class ComponentAllocator : public Memory::SparseAllocatorBundle<Config::MAX_NUM_LEVEL_ENTITIES, EntityComponent::HandleType, ALL_COMPONENTS>
+    {
+    public:
+
+        /**
+         * Counts how often views were asked for and how often they had to be resolved again
+         */
+        struct ViewStats
+        {
+            size_t numLookups;
+            size_t numResolves;
+            size_t numFrames;
+        };
+
+        ComponentAllocator() :
+                m_LayoutGeneration(1),
+                m_ViewStats()
+        {
+        }
+
+        /**
+         * Removes the given entity and all of its components
+         */
+        void removeObject(const Handle& h)
+        {
+            m_Queries.onEntityRemoved(h, getElement<EntityComponent>(h).m_ComponentMask);
+
+            SparseAllocatorBundle::removeObject(h);
+
+            // Removing moves the last component of every set into the hole, as well as the last entity
+            m_LayoutGeneration++;
+        }
+
+        /**
+         * Sets the component-mask of the given entity
+         */
+        void setComponentMask(const Handle& h, ComponentMask mask)
+        {
+            EntityComponent& e = getElement<EntityComponent>(h);
+            ComponentMask old = e.m_ComponentMask;
+
+            e.m_ComponentMask = mask;
+            m_Queries.onMaskChanged(h, old, mask);
+
+            m_LayoutGeneration++;
+        }
+
+        /**
+         * @return The cached component-view of the given entity. Only resolved again, if components were added or
+         *         removed since the last call.
+         *         Note: Only valid until the next change to the layout, don't keep it around.
+         */
+        const ComponentView& getView(const Handle& h)
+        {
+            m_ViewStats.numLookups++;
+
+            // Freshly committed memory is zeroed and generations start at 1, so unused views never match
+            m_Views.growTo(h.index + 1);
+            ComponentView& v = m_Views.data()[h.index];
+
+            if(v.generation != m_LayoutGeneration || v.entity != h)
+                resolveView(h, v);
+
+            return v;
+        }
+
+        /**
+         * @return Number of layout-changes so far. Views resolved at an older generation are outdated.
+         */
+        uint32_t getLayoutGeneration()
+        {
+            return m_LayoutGeneration;
+        }
+
+        /**
+         * @return View-usage since the last call to resetViewStats()
+         */
+        const ViewStats& getViewStats()
+        {
+            return m_ViewStats;
+        }
+
+        void resetViewStats()
+        {
+            m_ViewStats = ViewStats();
+        }
+
+        /**
+         * To be called once per frame, so the view-stats can be put into relation
+         */
+        void countViewFrame()
+        {
+            m_ViewStats.numFrames++;
+        }
+
+        /**
+         * @return Memory committed for the cached views
+         */
+        size_t getNumViewBytes()
+        {
+            return m_Views.getNumCommittedBytes();
+        }
+
+        /**
+         * @return All entities having at least the components set in the given mask. The list is registered on the
+         *         first call and kept up to date from then on.
+         *         Note: Adding or removing entities or components changes the list! Loops which may do that must
+         *         use indices and check against the current size.
+         */
+        const EntityList& query(ComponentMask mask)
+        {
+            int q = m_Queries.findQuery(mask);
+
+            if(q == -1)
+            {
+                q = m_Queries.registerQuery(mask);
+
+                EntityComponent* ents = getElements<EntityComponent>();
+                for(size_t i = 0, num = getNumObtainedElements(); i < num; i++)
+                {
+                    if((ents[i].m_ComponentMask & mask) == mask)
+                        m_Queries.addToQuery(q, ents[i].m_ThisEntity);
+                }
+            }
+
+            return m_Queries.getEntities(q);
+        }
+
+        /**
+         * @return Number of registered queries
+         */
+        size_t getNumQueries()
+        {
+            return m_Queries.getNumQueries();
+        }
+
+    private:
+
+        /**
+         * Looks up all components of the given entity and stores them in the given view
+         */
+        void resolveView(const Handle& h, ComponentView& v)
+        {
+            m_ViewStats.numResolves++;
+
+            ComponentMask mask = getElement<EntityComponent>(h).m_ComponentMask;
+
+            v.logic = (mask & LogicComponent::MASK) ? &getElement<LogicComponent>(h) : nullptr;
+            v.visual = (mask & VisualComponent::MASK) ? &getElement<VisualComponent>(h) : nullptr;
+            v.object = (mask & ObjectComponent::MASK) ? &getElement<ObjectComponent>(h) : nullptr;
+            v.position = (mask & PositionComponent::MASK) ? &getElement<PositionComponent>(h) : nullptr;
+            v.entity = h;
+            v.generation = m_LayoutGeneration;
+        }
+
+        /** Cached entity-lists for the masks queried so far */
+        EntityQueryCache m_Queries;
+
+        /** Entity-index -> Cached view */
+        Memory::LazyCommittedArray<ComponentView, Config::MAX_NUM_LEVEL_ENTITIES> m_Views;
+
+        /** Bumped whenever components are added, removed or moved */
+        uint32_t m_LayoutGeneration;
+
+        ViewStats m_ViewStats;
+    };
+
+    /**
+     * Adds a component to the given entity
      */
     template<typename T>
-    bool hasComponent(const EntityComponent& e)
+    void addComponent(ComponentAllocator& alloc, Handle::EntityHandle e)
     {
         // See "EntityComponent" for further information
-        return (e.m_ComponentMask & T::MASK) != 0;
+        alloc.setComponentMask(e, alloc.getElement<EntityComponent>(e).m_ComponentMask | T::MASK);
     }
 
     /**
-     * Creates a ComponentMask from uint32_t, for cleaner access
+     * Removes a component from the given entity
      */
-    static ComponentMask makeEntityMask(uint32_t mask)
+    template<typename T>
+    void removeComponent(ComponentAllocator& alloc, Handle::EntityHandle e)
     {
-        return static_cast<ComponentMask>(mask);
+        // See "EntityComponent" for further information
+        alloc.setComponentMask(e, alloc.getElement<EntityComponent>(e).m_ComponentMask & ~T::MASK);
     }
 
     /**
-     * Default allocator-type
+     * Old layout, storing every component for every entity. Only kept for comparison.
      */
-    typedef Memory::AllocatorBundle<Config::MAX_NUM_LEVEL_ENTITIES, EntityComponent::HandleType, ALL_COMPONENTS> ComponentAllocator;
+    typedef Memory::AllocatorBundle<Config::MAX_NUM_LEVEL_ENTITIES, EntityComponent::HandleType, ALL_COMPONENTS> BundledComponentAllocator;
 }
\ No newline at end of file
@@ -19,9 +19,11 @@ namespace Components
         {
 			auto& c = alloc.getElement<Components::EntityComponent>(h);
 			if((c.m_ComponentMask & T::MASK) == 0)
+			{
 				T::init(alloc.getElement<T>(h));
+				alloc.setComponentMask(h, c.m_ComponentMask | T::MASK);
+			}
 
-            c.m_ComponentMask |= T::MASK;
             return alloc.getElement<T>(h);
         }
 
@@ -113,11 +115,6 @@ namespace Components
             void destroyVisualComponent(VisualComponent& c);
         }
 
-        namespace Animation
-        {
-            void destroyAnimationComponent(AnimationComponent& c);
-        }
-
         namespace Physics
         {
             /**
@@ -170,21 +167,15 @@ namespace Components
             Logic::destroyVisualComponent(c);
         }
 
-        template<>
-        inline void destroyComponent<AnimationComponent>(AnimationComponent& c)
-        {
-            Animation::destroyAnimationComponent(c);
-        }
-
+        /**
+         * Calls f for every component the given entity has storage for
+         */
         template<typename F>
         inline void forAllComponents(Components::ComponentAllocator& alloc,
                                      Handle::EntityHandle e,
                                      F f)
         {
-            std::tuple<ALL_COMPONENTS> t;
-            Utils::for_each_in_tuple(t, [&](auto& v){
-               f(alloc.getElement<typename std::remove_reference<decltype(v)>::type>(e));
-            });
+            alloc.forEachComponentOf(e, f);
         }
 
     }
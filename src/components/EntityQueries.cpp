@@ -0,0 +1,81 @@
+#include "EntityQueries.h"
+#include <assert.h>
+
+using namespace Components;
+
+int EntityQueryCache::findQuery(ComponentMask mask) const
+{
+    for(size_t i = 0; i < m_Queries.size(); i++)
+    {
+        if(m_Queries[i].mask == mask)
+            return static_cast<int>(i);
+    }
+
+    return -1;
+}
+
+int EntityQueryCache::registerQuery(ComponentMask mask)
+{
+    assert(findQuery(mask) == -1);
+
+    m_Queries.emplace_back();
+    m_Queries.back().mask = mask;
+
+    return static_cast<int>(m_Queries.size() - 1);
+}
+
+void EntityQueryCache::addToQuery(int query, Handle::EntityHandle h)
+{
+    addEntity(m_Queries[query], h);
+}
+
+void EntityQueryCache::onMaskChanged(Handle::EntityHandle h, ComponentMask oldMask, ComponentMask newMask)
+{
+    if(oldMask == newMask)
+        return;
+
+    for(Query& q : m_Queries)
+    {
+        bool wasMatching = (oldMask & q.mask) == q.mask;
+        bool isMatching = (newMask & q.mask) == q.mask;
+
+        if(wasMatching == isMatching)
+            continue;
+
+        if(isMatching)
+            addEntity(q, h);
+        else
+            removeEntity(q, h);
+    }
+}
+
+void EntityQueryCache::addEntity(Query& q, Handle::EntityHandle h)
+{
+    uint32_t idx = h.index;
+
+    if(q.positions.size() <= idx)
+        q.positions.resize(idx + 1, 0);
+
+    assert(q.positions[idx] == 0);
+
+    q.entities.push_back(h);
+    q.positions[idx] = static_cast<uint32_t>(q.entities.size());
+}
+
+void EntityQueryCache::removeEntity(Query& q, Handle::EntityHandle h)
+{
+    uint32_t idx = h.index;
+
+    if(idx >= q.positions.size() || q.positions[idx] == 0)
+        return;
+
+    // Move the last entity into the hole
+    uint32_t pos = q.positions[idx] - 1;
+    Handle::EntityHandle last = q.entities.back();
+
+    q.entities[pos] = last;
+    q.positions[static_cast<uint32_t>(last.index)] = pos + 1;
+
+    q.entities.pop_back();
+    q.positions[idx] = 0;
+}
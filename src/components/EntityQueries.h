@@ -0,0 +1,94 @@
+#pragma once
+#include <cstdint>
+#include <vector>
+#include <handle/HandleDef.h>
+
+namespace Components
+{
+    typedef uint32_t ComponentMask;
+
+    /**
+     * List of entities matching a query
+     */
+    typedef std::vector<Handle::EntityHandle> EntityList;
+
+    /**
+     * Keeps lists of all entities matching a set of component-masks, so systems don't have to go through
+     * every entity and test its mask to find the few they care about.
+     * An entity matches a query, if all bits of the queries mask are set inside its component-mask.
+     * The lists are updated incrementally on every mask-change reported here, in no particular order.
+     */
+    class EntityQueryCache
+    {
+    public:
+
+        /**
+         * @return Index of the query with the given mask, or -1 if it wasn't registered yet
+         */
+        int findQuery(ComponentMask mask) const;
+
+        /**
+         * Registers a new query. The caller must fill it with the currently matching entities using addToQuery().
+         * @return Index of the new query
+         */
+        int registerQuery(ComponentMask mask);
+
+        /**
+         * Adds the given entity to the query, without checking its mask. Used for the initial fill.
+         */
+        void addToQuery(int query, Handle::EntityHandle h);
+
+        /**
+         * @return Entities matching the query at the given index
+         */
+        const EntityList& getEntities(int query) const
+        {
+            return m_Queries[query].entities;
+        }
+
+        /**
+         * Updates all queries the entity starts or stops matching
+         * @param oldMask Mask of the entity before the change
+         * @param newMask Mask of the entity after the change
+         */
+        void onMaskChanged(Handle::EntityHandle h, ComponentMask oldMask, ComponentMask newMask);
+
+        /**
+         * Takes the given entity out of all queries it matches
+         * @param mask Current mask of the entity
+         */
+        void onEntityRemoved(Handle::EntityHandle h, ComponentMask mask)
+        {
+            onMaskChanged(h, mask, 0);
+        }
+
+        /**
+         * @return Number of registered queries
+         */
+        size_t getNumQueries() const
+        {
+            return m_Queries.size();
+        }
+
+    private:
+
+        struct Query
+        {
+            ComponentMask mask;
+
+            /** Matching entities */
+            EntityList entities;
+
+            /** Entity-handle index -> Position inside "entities" + 1. 0 if not inside. */
+            std::vector<uint32_t> positions;
+        };
+
+        void addEntity(Query& q, Handle::EntityHandle h);
+        void removeEntity(Query& q, Handle::EntityHandle h);
+
+        /**
+         * Registered queries. There are only a handful of them, so these are simply searched linearly.
+         */
+        std::vector<Query> m_Queries;
+    };
+}
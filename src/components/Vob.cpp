@@ -15,26 +15,25 @@ Handle::EntityHandle Vob::constructVob(World::WorldInstance& world)
 {
     // Create main entity
     Handle::EntityHandle e = world.addEntity();
-    Components::EntityComponent& entity = world.getEntity<Components::EntityComponent>(e);
 
     // Add components
-    Components::addComponent<Components::LogicComponent>(entity);
+    Components::addComponent<Components::LogicComponent>(world.getComponentAllocator(), e);
     Components::Actions::initComponent<Components::LogicComponent>(world.getComponentAllocator(), e);
 
-    Components::addComponent<Components::VisualComponent>(entity);
+    Components::addComponent<Components::VisualComponent>(world.getComponentAllocator(), e);
     Components::Actions::initComponent<Components::VisualComponent>(world.getComponentAllocator(), e);
 
-    Components::addComponent<Components::BBoxComponent>(entity);
+    Components::addComponent<Components::BBoxComponent>(world.getComponentAllocator(), e);
     Components::Actions::initComponent<Components::BBoxComponent>(world.getComponentAllocator(), e);
 
-    Components::addComponent<Components::ObjectComponent>(entity);
+    Components::addComponent<Components::ObjectComponent>(world.getComponentAllocator(), e);
     Components::ObjectComponent& obj = Components::Actions::initComponent<Components::ObjectComponent>(world.getComponentAllocator(), e);
     obj.m_Type = Components::ObjectComponent::Other;
 
-    Components::addComponent<Components::PositionComponent>(entity);
+    Components::addComponent<Components::PositionComponent>(world.getComponentAllocator(), e);
     Components::Actions::initComponent<Components::PositionComponent>(world.getComponentAllocator(), e);
 
-    //Components::addComponent<Components::PhysicsComponent>(entity);
+    //Components::addComponent<Components::PhysicsComponent>(world.getComponentAllocator(), e);
     //Components::Actions::initComponent<Components::PhysicsComponent>(world.getComponentAllocator(), e);
 
     return e;
@@ -43,33 +42,14 @@ Handle::EntityHandle Vob::constructVob(World::WorldInstance& world)
 Vob::VobInformation Vob::asVob(World::WorldInstance& world, Handle::EntityHandle e)
 {
     VobInformation info;
-    Components::ComponentAllocator& alloc = world.getComponentAllocator();
-    Components::EntityComponent entity = alloc.getElement<Components::EntityComponent>(e);
+    const Components::ComponentView& view = world.getComponentAllocator().getView(e);
 
     info.entity = e;
     info.world = &world;
-
-    if(Components::hasComponent<Components::LogicComponent>(entity))
-        info.logic = alloc.getElement<Components::LogicComponent>(e).m_pLogicController;
-    else
-        info.logic = nullptr;
-
-    if(Components::hasComponent<Components::VisualComponent>(entity))
-        info.visual = alloc.getElement<Components::VisualComponent>(e).m_pVisualController;
-    else
-        info.visual = nullptr;
-
-    if(Components::hasComponent<Components::ObjectComponent>(entity))
-        info.object = &alloc.getElement<Components::ObjectComponent>(e);
-    else
-        info.object = nullptr;
-
-    if(Components::hasComponent<Components::PositionComponent>(entity))
-        info.position = &alloc.getElement<Components::PositionComponent>(e);
-    else
-        info.position = nullptr;
-
-
+    info.logic = view.logic ? view.logic->m_pLogicController : nullptr;
+    info.visual = view.visual ? view.visual->m_pVisualController : nullptr;
+    info.object = view.object;
+    info.position = view.position;
 
     return info;
 }
@@ -152,7 +132,7 @@ void ::Vob::setVisual(VobInformation& vob, const std::string& _visual)
     vob.visual = (*ppVisual);
 }
 
-void ::Vob::setName(VobInformation& vob, const std::string& name)
+void ::Vob::setName(VobInformation& vob, const Utils::Name& name)
 {
     if(vob.object)
         vob.object->m_Name = name;
@@ -183,7 +163,7 @@ Logic::VisualController *::Vob::getVisual(Vob::VobInformation &vob)
 std::string Vob::getName(Vob::VobInformation& vob)
 {
     if(vob.object)
-        return vob.object->m_Name;
+        return vob.object->m_Name.str();
 
     return "";
 }
@@ -80,7 +80,7 @@ namespace Vob
     /**
      * Sets the name of the given vob
      */
-    void setName(VobInformation& vob, const std::string& name);
+    void setName(VobInformation& vob, const Utils::Name& name);
 
     /**
      * Sets the BBox of the given vob
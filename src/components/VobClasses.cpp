@@ -185,13 +185,13 @@ void ::VobTypes::NPC_SetModelVisual(VobTypes::NpcVobInformation& vob, const std:
     Handle::EntityHandle e = vob.entity;
 
     // Initialize animations
-    Components::AnimationComponent& anim = Components::Actions::initComponent<Components::AnimationComponent>(vob.world->getComponentAllocator(), e);
+    Components::Actions::initComponent<Components::AnimationComponent>(vob.world->getComponentAllocator(), e);
+    Components::AnimHandler& animHandler = vob.world->getAnimHandler(e);
 
     // Strip extension
     std::string libName = visual.substr(0, visual.find_last_of('.'));
 
-    anim.getAnimHandler().setWorld(*vob.world);
-    anim.getAnimHandler().loadMeshLibFromVDF(libName, vob.world->getEngine()->getVDFSIndex());
+    animHandler.loadMeshLibFromVDF(libName, vob.world->getEngine()->getVDFSIndex());
 
     // TODO: Move to other place (MDS)
 	// Load all default animations
@@ -199,7 +199,7 @@ void ::VobTypes::NPC_SetModelVisual(VobTypes::NpcVobInformation& vob, const std:
 	{
 		const char* name = Logic::ModelVisual::getAnimationName(static_cast<Logic::ModelVisual::EModelAnimType>(i));
 
-		anim.getAnimHandler().addAnimation(name);
+		animHandler.addAnimation(name);
 	}
 
     for(int i=0;i<20;i++)
@@ -208,30 +208,30 @@ void ::VobTypes::NPC_SetModelVisual(VobTypes::NpcVobInformation& vob, const std:
         if(ns.size() == 1)
             ns = "0" + ns;
 
-        anim.getAnimHandler().addAnimation("T_DIALOGGESTURE_" + ns);
+        animHandler.addAnimation("T_DIALOGGESTURE_" + ns);
     }
 
-    anim.getAnimHandler().addAnimation(libName + "-S_RUNL.MAN");
-    anim.getAnimHandler().addAnimation(libName + "-S_WALKL.MAN");
-    anim.getAnimHandler().addAnimation(libName + "-S_FISTRUNL.MAN");
-    anim.getAnimHandler().addAnimation(libName + "-S_FISTWALKL.MAN");
+    animHandler.addAnimation(libName + "-S_RUNL.MAN");
+    animHandler.addAnimation(libName + "-S_WALKL.MAN");
+    animHandler.addAnimation(libName + "-S_FISTRUNL.MAN");
+    animHandler.addAnimation(libName + "-S_FISTWALKL.MAN");
 
-    anim.getAnimHandler().addAnimation(libName + "-S_RUN.MAN");
-    anim.getAnimHandler().addAnimation(libName + "-S_WALK.MAN");
-    anim.getAnimHandler().addAnimation(libName + "-S_FISTRUN.MAN");
-    anim.getAnimHandler().addAnimation(libName + "-S_FISTWALK.MAN");
+    animHandler.addAnimation(libName + "-S_RUN.MAN");
+    animHandler.addAnimation(libName + "-S_WALK.MAN");
+    animHandler.addAnimation(libName + "-S_FISTRUN.MAN");
+    animHandler.addAnimation(libName + "-S_FISTWALK.MAN");
 
-    anim.getAnimHandler().addAnimation(libName + "-T_JUMPB.MAN");
-    anim.getAnimHandler().addAnimation(libName + "-T_RUNSTRAFEL.MAN");
-    anim.getAnimHandler().addAnimation(libName + "-T_RUNSTRAFER.MAN");
+    animHandler.addAnimation(libName + "-T_JUMPB.MAN");
+    animHandler.addAnimation(libName + "-T_RUNSTRAFEL.MAN");
+    animHandler.addAnimation(libName + "-T_RUNSTRAFER.MAN");
 
     // Fist
-    anim.getAnimHandler().addAnimation(libName + "-S_FISTATTACK.MAN");
+    animHandler.addAnimation(libName + "-S_FISTATTACK.MAN");
 
     // 1H
-    anim.getAnimHandler().addAnimation(libName + "-S_1HATTACK.MAN");
+    animHandler.addAnimation(libName + "-S_1HATTACK.MAN");
 
-    anim.getAnimHandler().playAnimation("S_RUNL");
+    animHandler.playAnimation(Utils::Name("S_RUNL"));
 }
 
 void ::VobTypes::NPC_SetHeadMesh(VobTypes::NpcVobInformation &vob, const std::string &visual, size_t headTextureIdx,
@@ -4,6 +4,7 @@
 
 #include "AnimationAllocator.h"
 #include <utils/logger.h>
+#include "VDFSLock.h"
 
 Animations::AnimationAllocator::AnimationAllocator(const VDFS::FileIndex *vdfidx)
 {
@@ -18,13 +19,15 @@ Animations::AnimationAllocator::~AnimationAllocator()
 Handle::AnimationHandle Animations::AnimationAllocator::loadAnimationVDF(const VDFS::FileIndex& idx, const std::string& name)
 {
     // Check if this was already loaded
-    auto it = m_AnimationsByName.find(name);
+    auto it = m_AnimationsByName.find(Utils::Name::find(name));
     if (it != m_AnimationsByName.end())
         return (*it).second;
 
 	//LogInfo() << "New animation: " << name;
 
+    std::unique_lock<std::mutex> lock = Content::lockVDFS();
     ZenLoad::zCModelAni zani(name, idx, 1.0f / 100.0f);
+    lock.unlock();
 
 	if(!zani.isValid())
 		return Handle::AnimationHandle::makeInvalidHandle();
@@ -33,7 +36,7 @@ Handle::AnimationHandle Animations::AnimationAllocator::loadAnimationVDF(const V
     Animation& aniObject = m_Allocator.getElement(h);
     aniObject.animation = zani;
 
-    m_AnimationsByName[name] = h;
+    m_AnimationsByName[Utils::Name(name)] = h;
 
     return h;
 }
@@ -45,3 +48,18 @@ Handle::AnimationHandle Animations::AnimationAllocator::loadAnimationVDF(const s
 
     return loadAnimationVDF(*m_pVDFSIndex, name);
 }
+
+Memory::AllocatorStats Animations::AnimationAllocator::getStats()
+{
+    Memory::AllocatorStats s = m_Allocator.getStats();
+
+    for (size_t i = 0; i < m_Allocator.getNumObtainedElements(); i++)
+    {
+        const ZenLoad::zCModelAni& ani = m_Allocator.getElements()[i].animation;
+
+        s.numBytesPayload += ani.getAniSamples().capacity() * sizeof(ani.getAniSamples()[0])
+                             + ani.getNodeIndexList().capacity() * sizeof(ani.getNodeIndexList()[0]);
+    }
+
+    return s;
+}
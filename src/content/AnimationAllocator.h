@@ -2,10 +2,12 @@
 
 #include <handle/HandleDef.h>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include <memory/Config.h>
 #include <handle/Handle.h>
+#include <utils/Name.h>
 #include "zenload/zCModelAni.h"
 #include "zenload/zCModelMeshLib.h"
 
@@ -49,12 +51,17 @@ namespace Animations
 		 * @brief Returns the animation of the given handle
 		 */
         Animation& getAnimation(Handle::AnimationHandle h) { return m_Allocator.getElement(h); }
+
+        /**
+         * @return Usage of the allocator. The payload is the sample-data of all animations.
+         */
+        Memory::AllocatorStats getStats();
     protected:
         /**
          * @brief Textures by their set names. Note: If names are doubled, only the last loaded texture
          *		  can be found here
          */
-        std::map<std::string, Handle::AnimationHandle> m_AnimationsByName;
+        std::unordered_map<Utils::Name, Handle::AnimationHandle> m_AnimationsByName;
 
         /**
 		 * Data allocator
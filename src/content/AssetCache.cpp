@@ -0,0 +1,210 @@
+#include "AssetCache.h"
+#include <vdfs/fileIndex.h>
+#include "GenericMeshAllocator.h"
+
+using namespace Content;
+
+namespace
+{
+    size_t getNumBytes(const Textures::TextureAllocator::DecodedTexture& tex)
+    {
+        return tex.data.size();
+    }
+
+    size_t getNumBytes(const ZenLoad::PackedMesh& mesh)
+    {
+        size_t n = mesh.vertices.size() * sizeof(mesh.vertices[0])
+                   + mesh.triangles.size() * sizeof(mesh.triangles[0]);
+
+        for(const auto& sm : mesh.subMeshes)
+            n += sm.indices.size() * sizeof(sm.indices[0])
+                 + sm.triangleLightmapIndices.size() * sizeof(sm.triangleLightmapIndices[0]);
+
+        return n;
+    }
+}
+
+AssetCache::AssetCache(size_t budget) :
+        m_Budget(budget),
+        m_NumBytes(0),
+        m_NumHits(0),
+        m_NumMisses(0),
+        m_NumEvicted(0)
+{
+}
+
+void AssetCache::setBudget(size_t numBytes)
+{
+    std::lock_guard<std::mutex> guard(m_Mutex);
+
+    m_Budget = numBytes;
+    evict();
+}
+
+template<typename T, typename LoadFn, typename SizeFn>
+std::vector<std::shared_ptr<const T>> AssetCache::lookup(std::unordered_map<Utils::Name, Entry<T>>& map, EKind kind,
+                                                         const std::vector<std::string>& names, LoadFn load, SizeFn size)
+{
+    std::vector<std::shared_ptr<const T>> result(names.size());
+    std::vector<Utils::Name> keys(names.size());
+    std::vector<size_t> missing;
+
+    // Only look the names up, so requests for missing files don't grow the name-table. That takes a lock of its
+    // own, so do it before taking the cache's.
+    for(size_t i = 0; i < names.size(); i++)
+        keys[i] = Utils::Name::find(names[i]);
+
+    {
+        std::lock_guard<std::mutex> guard(m_Mutex);
+
+        for(size_t i = 0; i < names.size(); i++)
+        {
+            // Never interned means never cached
+            auto it = keys[i].empty() ? map.end() : map.find(keys[i]);
+            if(it != map.end())
+            {
+                m_UseOrder.splice(m_UseOrder.begin(), m_UseOrder, it->second.use);
+                result[i] = it->second.data;
+                m_NumHits++;
+            }
+            else
+            {
+                missing.push_back(i);
+            }
+        }
+    }
+
+    if(missing.empty())
+        return result;
+
+    // Load without holding the lock, so other threads can still use the cache meanwhile
+    std::vector<std::shared_ptr<T>> loaded(missing.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for(int i = 0; i < static_cast<int>(missing.size()); i++)
+    {
+        std::shared_ptr<T> data = std::make_shared<T>();
+        if(load(names[missing[i]], *data))
+            loaded[i] = data;
+    }
+
+    // Only what could be loaded gets a name
+    for(size_t i = 0; i < missing.size(); i++)
+    {
+        if(loaded[i] && keys[missing[i]].empty())
+            keys[missing[i]] = Utils::Name(names[missing[i]]);
+    }
+
+    std::lock_guard<std::mutex> guard(m_Mutex);
+
+    for(size_t i = 0; i < missing.size(); i++)
+    {
+        const Utils::Name& key = keys[missing[i]];
+        m_NumMisses++;
+
+        if(!loaded[i])
+            continue;
+
+        // An other thread could have been faster, keep the data everyone else already got
+        auto it = map.find(key);
+        if(it == map.end())
+        {
+            m_UseOrder.emplace_front(kind, key);
+
+            Entry<T> e;
+            e.data = loaded[i];
+            e.numBytes = size(*loaded[i]);
+            e.use = m_UseOrder.begin();
+
+            m_NumBytes += e.numBytes;
+            it = map.emplace(key, e).first;
+        }
+        else
+        {
+            m_UseOrder.splice(m_UseOrder.begin(), m_UseOrder, it->second.use);
+        }
+
+        result[missing[i]] = it->second.data;
+    }
+
+    evict();
+
+    return result;
+}
+
+AssetCache::TexturePtr AssetCache::getTexture(const VDFS::FileIndex& idx, const std::string& name)
+{
+    return getTextures(idx, {name}).front();
+}
+
+std::vector<AssetCache::TexturePtr> AssetCache::getTextures(const VDFS::FileIndex& idx, const std::vector<std::string>& names)
+{
+    return lookup(m_Textures, K_Texture, names, [&](const std::string& name, Textures::TextureAllocator::DecodedTexture& out){
+        return Textures::TextureAllocator::decodeTextureVDF(idx, name, out);
+    }, [](const Textures::TextureAllocator::DecodedTexture& tex){
+        return getNumBytes(tex);
+    });
+}
+
+AssetCache::MeshPtr AssetCache::getMesh(const VDFS::FileIndex& idx, const std::string& name)
+{
+    return getMeshes(idx, {name}).front();
+}
+
+std::vector<AssetCache::MeshPtr> AssetCache::getMeshes(const VDFS::FileIndex& idx, const std::vector<std::string>& names)
+{
+    return lookup(m_Meshes, K_Mesh, names, [&](const std::string& name, ZenLoad::PackedMesh& out){
+        return Meshes::GenericMeshAllocator::packMeshVDF(idx, name, out);
+    }, [](const ZenLoad::PackedMesh& mesh){
+        return getNumBytes(mesh);
+    });
+}
+
+void AssetCache::evict()
+{
+    while(m_NumBytes > m_Budget && !m_UseOrder.empty())
+    {
+        const std::pair<EKind, Utils::Name>& oldest = m_UseOrder.back();
+
+        if(oldest.first == K_Texture)
+        {
+            auto it = m_Textures.find(oldest.second);
+            m_NumBytes -= it->second.numBytes;
+            m_Textures.erase(it);
+        }
+        else
+        {
+            auto it = m_Meshes.find(oldest.second);
+            m_NumBytes -= it->second.numBytes;
+            m_Meshes.erase(it);
+        }
+
+        m_UseOrder.pop_back();
+        m_NumEvicted++;
+    }
+}
+
+void AssetCache::clear()
+{
+    std::lock_guard<std::mutex> guard(m_Mutex);
+
+    m_Textures.clear();
+    m_Meshes.clear();
+    m_UseOrder.clear();
+    m_NumBytes = 0;
+}
+
+AssetCache::Stats AssetCache::getStats()
+{
+    std::lock_guard<std::mutex> guard(m_Mutex);
+
+    Stats s;
+    s.numTextures = m_Textures.size();
+    s.numMeshes = m_Meshes.size();
+    s.numBytes = m_NumBytes;
+    s.numHits = m_NumHits;
+    s.numMisses = m_NumMisses;
+    s.numEvicted = m_NumEvicted;
+
+    return s;
+}
@@ -0,0 +1,130 @@
+#pragma once
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <zenload/zTypes.h>
+#include <utils/Name.h>
+#include "Texture.h"
+
+namespace VDFS
+{
+    class FileIndex;
+}
+
+namespace Content
+{
+    /**
+     * Engine-wide store of decoded textures and packed meshes, so the CPU-side work of loading them is only done once
+     * for all worlds. Only the upload to the GPU is still done per world, by the world's own allocators.
+     *
+     * Thread-safe: Worlds can be prepared on a background thread while the current world keeps using the cache.
+     * Entries are dropped least-recently-used first once the cache grows over its budget. Data handed out stays
+     * valid for as long as the caller holds on to it. Names are case-insensitive, like the VDFS itself.
+     */
+    class AssetCache
+    {
+    public:
+        typedef std::shared_ptr<const Textures::TextureAllocator::DecodedTexture> TexturePtr;
+        typedef std::shared_ptr<const ZenLoad::PackedMesh> MeshPtr;
+
+        /**
+         * Default size of all decoded data kept around
+         */
+        static const size_t DEFAULT_BUDGET = 512 * 1024 * 1024;
+
+        struct Stats
+        {
+            size_t numTextures;
+            size_t numMeshes;
+            size_t numBytes;
+            size_t numHits;
+            size_t numMisses;
+            size_t numEvicted;
+        };
+
+        AssetCache(size_t budget = DEFAULT_BUDGET);
+
+        /**
+         * Sets the size the cache may grow to. Evicts right away, if needed.
+         */
+        void setBudget(size_t numBytes);
+
+        /**
+         * @return The decoded texture of the given name, decoding it if it isn't cached yet. nullptr, if it could not be found.
+         */
+        TexturePtr getTexture(const VDFS::FileIndex& idx, const std::string& name);
+
+        /**
+         * Same as getTexture() for a whole list. Textures missing from the cache are decoded in parallel.
+         * @return One entry per name, in the same order
+         */
+        std::vector<TexturePtr> getTextures(const VDFS::FileIndex& idx, const std::vector<std::string>& names);
+
+        /**
+         * @return The packed mesh of the given name, packing it if it isn't cached yet. nullptr, if it could not be loaded.
+         */
+        MeshPtr getMesh(const VDFS::FileIndex& idx, const std::string& name);
+
+        /**
+         * Same as getMesh() for a whole list. Meshes missing from the cache are packed in parallel.
+         * @return One entry per name, in the same order
+         */
+        std::vector<MeshPtr> getMeshes(const VDFS::FileIndex& idx, const std::vector<std::string>& names);
+
+        /**
+         * Drops everything
+         */
+        void clear();
+
+        Stats getStats();
+
+    private:
+
+        enum EKind
+        {
+            K_Texture,
+            K_Mesh
+        };
+
+        /**
+         * All entries of both kinds, most recently used first
+         */
+        typedef std::list<std::pair<EKind, Utils::Name>> UseList;
+
+        template<typename T>
+        struct Entry
+        {
+            std::shared_ptr<const T> data;
+            size_t numBytes;
+            UseList::iterator use; // Position inside m_UseOrder
+        };
+
+        /**
+         * Drops the least recently used entries until the cache fits its budget. Mutex must be held.
+         */
+        void evict();
+
+        /**
+         * Looks up the given names, loading the missing ones in parallel without holding the mutex
+         * @param load Loads a single asset, returns false on failure. Must be safe to be called from multiple threads.
+         * @param size Number of bytes an asset takes
+         */
+        template<typename T, typename LoadFn, typename SizeFn>
+        std::vector<std::shared_ptr<const T>> lookup(std::unordered_map<Utils::Name, Entry<T>>& map, EKind kind,
+                                                     const std::vector<std::string>& names, LoadFn load, SizeFn size);
+
+        std::mutex m_Mutex;
+        std::unordered_map<Utils::Name, Entry<Textures::TextureAllocator::DecodedTexture>> m_Textures;
+        std::unordered_map<Utils::Name, Entry<ZenLoad::PackedMesh>> m_Meshes;
+        UseList m_UseOrder;
+
+        size_t m_Budget;
+        size_t m_NumBytes;
+        size_t m_NumHits;
+        size_t m_NumMisses;
+        size_t m_NumEvicted;
+    };
+}
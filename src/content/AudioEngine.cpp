@@ -4,6 +4,7 @@
 
 #include <utils/logger.h>
 #include "AudioEngine.h"
+#include "VDFSLock.h"
 #include <adpcm/adpcm-lib.h>
 
 using namespace Content;
@@ -63,13 +64,17 @@ Handle::AudioHandle AudioEngine::loadAudioVDF(const VDFS::FileIndex& idx, const
     std::vector<uint8_t> data;
 	std::vector<uint8_t> outData;
     // Check cache first
-    if(m_SoundMap.find(name) != m_SoundMap.end())
-        return m_SoundMap[name];
+    auto it = m_SoundMap.find(Utils::Name::find(name));
+    if(it != m_SoundMap.end())
+        return (*it).second;
 
     LogInfo() << "Loading sound: " << name;
 
     // Load the audio-file from the VDF-archive
-    idx.getFileData(name, data);
+    {
+        std::unique_lock<std::mutex> lock = Content::lockVDFS();
+        idx.getFileData(name, data);
+    }
 
     if(data.empty())
         return Handle::AudioHandle::makeInvalidHandle();
@@ -90,7 +95,7 @@ Handle::AudioHandle AudioEngine::loadAudioVDF(const VDFS::FileIndex& idx, const
         return Handle::AudioHandle::makeInvalidHandle();
     }
 
-    m_SoundMap[name] = h;
+    m_SoundMap[Utils::Name(name)] = h;
 
     return h;
 #else
@@ -122,7 +127,7 @@ void AudioEngine::playSound(Handle::AudioHandle h)
 
 void AudioEngine::playSound(const std::string& name)
 {
-    auto it = m_SoundMap.find(name);
+    auto it = m_SoundMap.find(Utils::Name::find(name));
     if(it == m_SoundMap.end())
     {
         // Did not find that, try to load it...
@@ -140,6 +145,20 @@ void AudioEngine::playSound(const std::string& name)
     }
 }
 
+Memory::AllocatorStats AudioEngine::getStats()
+{
+#ifdef RE_USE_SFML
+    Memory::AllocatorStats s = m_Allocator.getStats();
+
+    for(size_t i = 0; i < m_Allocator.getNumObtainedElements(); i++)
+        s.numBytesPayload += m_Allocator.getElements()[i].buffer.getSampleCount() * sizeof(sf::Int16);
+
+    return s;
+#else
+    return Memory::AllocatorStats();
+#endif
+}
+
 #ifdef RE_USE_SFML 
 sf::Sound& AudioEngine::getFreeSoundObject()
 {
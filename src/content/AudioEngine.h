@@ -6,6 +6,8 @@
 #include <handle/HandleDef.h>
 #include <handle/Handle.h>
 #include <map>
+#include <unordered_map>
+#include <utils/Name.h>
 #include <list>
 
 #ifdef RE_USE_SFML 
@@ -39,6 +41,12 @@ namespace Content
         * @brief Sets the VDFS-Index to use
         */
         void setVDFSIndex(const VDFS::FileIndex* vdfidx) { m_pVDFSIndex = vdfidx; }
+
+        /**
+         * @return Usage of the sound-allocator. The payload is the decoded sample-data of all sounds.
+         *         Empty when built without sound-support.
+         */
+        Memory::AllocatorStats getStats();
     private:
 
         /**
@@ -81,6 +89,6 @@ namespace Content
         /**
          * Contains all loaded sounds by name
          */
-        std::map<std::string, Handle::AudioHandle> m_SoundMap;
+        std::unordered_map<Utils::Name, Handle::AudioHandle> m_SoundMap;
     };
 }
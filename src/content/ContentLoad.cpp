@@ -20,7 +20,7 @@ Components::CompoundComponent& Content::Wrap::getCompoundComponent(World::WorldI
                                                                    Handle::EntityHandle e)
 {
     // Make sure the component is enabled
-    Components::addComponent<Components::CompoundComponent>(world.getEntity<Components::EntityComponent>(e));
+    Components::addComponent<Components::CompoundComponent>(world.getComponentAllocator(), e);
 
     return world.getEntity<Components::CompoundComponent>(e);
 }
@@ -7,11 +7,14 @@
 #include <zenload/zCProgMeshProto.h>
 #include <zenload/zCModelMeshLib.h>
 #include <zenload/zCMorphMesh.h>
+#include "AssetCache.h"
+#include "VDFSLock.h"
 
 using namespace Meshes;
 
 GenericMeshAllocator::GenericMeshAllocator(const VDFS::FileIndex* vdfidx)
-        : m_pVDFSIndex(vdfidx)
+        : m_pVDFSIndex(vdfidx),
+          m_pAssetCache(nullptr)
 {
 }
 
@@ -23,10 +26,28 @@ GenericMeshAllocator::~GenericMeshAllocator()
 Handle::MeshHandle GenericMeshAllocator::loadMeshVDF(const VDFS::FileIndex& idx, const std::string& name)
 {
     // Check if this was already loaded
-    auto it = m_MeshesByName.find(name);
+    auto it = m_MeshesByName.find(Utils::Name::find(name));
     if (it != m_MeshesByName.end())
         return (*it).second;
 
+    if(m_pAssetCache)
+    {
+        Content::AssetCache::MeshPtr packed = m_pAssetCache->getMesh(idx, name);
+        if(!packed)
+            return Handle::MeshHandle::makeInvalidHandle();
+
+        return loadFromPacked(*packed, name);
+    }
+
+    ZenLoad::PackedMesh packed;
+    if(!packMeshVDF(idx, name, packed))
+        return Handle::MeshHandle::makeInvalidHandle();
+
+    return loadFromPacked(packed, name);
+}
+
+bool GenericMeshAllocator::packMeshVDF(const VDFS::FileIndex& idx, const std::string& name, ZenLoad::PackedMesh& packed)
+{
     std::string vname = name;
     std::vector<uint8_t> data;
     std::vector<uint8_t> dds;
@@ -51,37 +72,41 @@ Handle::MeshHandle GenericMeshAllocator::loadMeshVDF(const VDFS::FileIndex& idx,
 		}
     }
 
-    ZenLoad::PackedMesh packed;
-
     if(vname.find(".MRM") != std::string::npos)
     {
-        // Try to load the mesh
-        ZenLoad::zCProgMeshProto zmsh(vname, *m_pVDFSIndex);
+        // Try to load the mesh. Packing is what takes long, so that's done without holding the VDFS.
+        std::unique_lock<std::mutex> lock = Content::lockVDFS();
+        ZenLoad::zCProgMeshProto zmsh(vname, idx);
+        lock.unlock();
 
         // Failed?
         if (zmsh.getNumSubmeshes() == 0)
-            return Handle::MeshHandle::makeInvalidHandle();
+            return false;
 
         // Pack the mesh
         zmsh.packMesh(packed, 1.0f / 100.0f);
     }else if(vname.find(".MMB") != std::string::npos)
 	{
-		ZenLoad::zCMorphMesh zmm(vname, *m_pVDFSIndex);
+		std::unique_lock<std::mutex> lock = Content::lockVDFS();
+		ZenLoad::zCMorphMesh zmm(vname, idx);
+		lock.unlock();
 
 		// Failed?
 		if (zmm.getMesh().getNumSubmeshes() == 0)
-			return Handle::MeshHandle::makeInvalidHandle();
+			return false;
 
 		// Pack the mesh
 		zmm.getMesh().packMesh(packed, 1.0f / 100.0f);
 	}if(vname.find(".MDMS") != std::string::npos)
 	{
 		vname = vname.substr(0, vname.size()-1);
-		ZenLoad::zCModelMeshLib zlib(vname, *m_pVDFSIndex, 1.0f / 100.0f);
+		std::unique_lock<std::mutex> lock = Content::lockVDFS();
+		ZenLoad::zCModelMeshLib zlib(vname, idx, 1.0f / 100.0f);
+		lock.unlock();
 
 		// Failed?
 		if (!zlib.isValid())
-			return Handle::MeshHandle::makeInvalidHandle();
+			return false;
 
 		ZenLoad::PackedSkeletalMesh sp;
 		zlib.packMesh(sp, 1.0f / 100.0f);
@@ -93,7 +118,7 @@ Handle::MeshHandle GenericMeshAllocator::loadMeshVDF(const VDFS::FileIndex& idx,
 	}
 
 
-    return loadFromPacked(packed, name);
+    return true;
 }
 
 Handle::MeshHandle GenericMeshAllocator::loadMeshVDF(const std::string & name)
@@ -103,3 +128,65 @@ Handle::MeshHandle GenericMeshAllocator::loadMeshVDF(const std::string & name)
 
     return loadMeshVDF(*m_pVDFSIndex, name);
 }
+
+size_t GenericMeshAllocator::preloadMeshesVDF(const std::vector<std::string>& names, std::vector<std::string>* outTextures)
+{
+    if (!m_pVDFSIndex)
+        return 0;
+
+    // Only care about meshes we don't have yet
+    std::vector<std::string> toLoad;
+    for(const std::string& n : names)
+    {
+        if(m_MeshesByName.find(Utils::Name::find(n)) == m_MeshesByName.end())
+            toLoad.push_back(n);
+    }
+
+    const VDFS::FileIndex& idx = *m_pVDFSIndex;
+    std::vector<Content::AssetCache::MeshPtr> cached;
+    std::vector<ZenLoad::PackedMesh> packed;
+    std::vector<char> loaded(toLoad.size(), 0);
+
+    if(m_pAssetCache)
+    {
+        // Let the cache pack whatever it doesn't have yet
+        cached = m_pAssetCache->getMeshes(idx, toLoad);
+
+        for(size_t i = 0; i < toLoad.size(); i++)
+            loaded[i] = cached[i] ? 1 : 0;
+    }
+    else
+    {
+        packed.resize(toLoad.size());
+
+        // Read and pack. Reading is serialized by packMeshVDF, packing is where most of the time goes.
+        #pragma omp parallel for schedule(dynamic)
+        for(int i = 0; i < static_cast<int>(toLoad.size()); i++)
+        {
+            loaded[i] = packMeshVDF(idx, toLoad[i], packed[i]) ? 1 : 0;
+        }
+    }
+
+    // Upload
+    size_t num = 0;
+    for(size_t i = 0; i < toLoad.size(); i++)
+    {
+        if(!loaded[i])
+            continue;
+
+        const ZenLoad::PackedMesh& mesh = m_pAssetCache ? *cached[i] : packed[i];
+
+        if(!loadFromPacked(mesh, toLoad[i]).isValid())
+            continue;
+
+        num++;
+
+        if(outTextures)
+        {
+            for(const auto& sm : mesh.subMeshes)
+                outTextures->push_back(sm.material.texture);
+        }
+    }
+
+    return num;
+}
@@ -2,8 +2,10 @@
 
 #include <handle/HandleDef.h>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <string>
+#include <utils/Name.h>
 
 namespace VDFS
 {
@@ -15,6 +17,11 @@ namespace ZenLoad
     struct PackedMesh;
 }
 
+namespace Content
+{
+    class AssetCache;
+}
+
 namespace Meshes
 {
     class GenericMeshAllocator
@@ -29,12 +36,26 @@ namespace Meshes
         */
         void setVDFSIndex(const VDFS::FileIndex* vdfidx) { m_pVDFSIndex = vdfidx; }
 
+        /**
+         * Sets the engine-wide cache to take packed meshes from, instead of packing them again (can be nullptr)
+         */
+        void setAssetCache(Content::AssetCache* cache) { m_pAssetCache = cache; }
+
         /**
          * @brief Loads a ZTEX-texture from the given or stored VDFS-FileIndex
          */
         Handle::MeshHandle loadMeshVDF(const VDFS::FileIndex& idx, const std::string& name);
         Handle::MeshHandle loadMeshVDF(const std::string& name);
 
+        /**
+         * Loads all of the given meshes which aren't loaded yet. Packing is done in parallel, reading from the VDFS
+         * and the final upload are serial. Later calls to loadMeshVDF() will then hit the cache.
+         * @param names Names of the meshes to load
+         * @param outTextures Optional. Textures referenced by the newly loaded meshes.
+         * @return Number of meshes which were newly loaded
+         */
+        size_t preloadMeshesVDF(const std::vector<std::string>& names, std::vector<std::string>* outTextures = nullptr);
+
         /**
          * Puts all the loaded data into the target mesh
          * @param packed Packed mesh data from
@@ -42,16 +63,30 @@ namespace Meshes
          * @return Handle to the mesh from this allocator
          */
         virtual Handle::MeshHandle loadFromPacked(const ZenLoad::PackedMesh& packed, const std::string& name = "") = 0;
+
+        /**
+         * Reads the given mesh from the VDFS and packs it. Doesn't touch the allocator, so this is safe to be called
+         * from multiple threads at once. Only the reading is serialized, using the VDFS-lock.
+         * @param packed Packed mesh to write into
+         * @return False, if the mesh could not be loaded
+         */
+        static bool packMeshVDF(const VDFS::FileIndex& idx, const std::string& name, ZenLoad::PackedMesh& packed);
     protected:
+
         /**
          * @brief Textures by their set names. Note: If names are doubled, only the last loaded texture
          *		  can be found here
          */
-        std::map<std::string, Handle::MeshHandle> m_MeshesByName;
+        std::unordered_map<Utils::Name, Handle::MeshHandle> m_MeshesByName;
 
         /**
          * Pointer to a vdfs-index to work on (can be nullptr)
          */
         const VDFS::FileIndex* m_pVDFSIndex;
+
+        /**
+         * Cache of packed meshes shared between worlds (can be nullptr)
+         */
+        Content::AssetCache* m_pAssetCache;
     };
 }
\ No newline at end of file
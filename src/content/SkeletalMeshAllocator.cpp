@@ -5,6 +5,7 @@
 #include <zenload/zCModelMeshLib.h>
 #include <utils/logger.h>
 #include "VertexTypes.h"
+#include "VDFSLock.h"
 
 using namespace Meshes;
 
@@ -29,7 +30,7 @@ SkeletalMeshAllocator::~SkeletalMeshAllocator()
 Handle::MeshHandle SkeletalMeshAllocator::loadMeshVDF(const VDFS::FileIndex& idx, const std::string& name)
 {
     // Check if this was already loaded
-    auto it = m_MeshesByName.find(name);
+    auto it = m_MeshesByName.find(Utils::Name::find(name));
     if (it != m_MeshesByName.end())
         return (*it).second;
 
@@ -67,7 +68,9 @@ Handle::MeshHandle SkeletalMeshAllocator::loadMeshVDF(const VDFS::FileIndex& idx
        || vname.find(".MDL") != std::string::npos
        || vname.find(".MDS") != std::string::npos)
     {
+        std::unique_lock<std::mutex> lock = Content::lockVDFS();
         ZenLoad::zCModelMeshLib zlib(vname, *m_pVDFSIndex, 1.0f / 100.0f);
+        lock.unlock();
 
         // Failed?
         if (!zlib.isValid())
@@ -172,9 +175,18 @@ Handle::MeshHandle SkeletalMeshAllocator::loadFromPacked(const ZenLoad::PackedSk
     //bgfx::frame();
 
     if(!name.empty())
-        m_MeshesByName[name] = h;
+        m_MeshesByName[Utils::Name(name)] = h;
 
     return h;
 }
 
+Memory::AllocatorStats SkeletalMeshAllocator::getStats()
+{
+    Memory::AllocatorStats s = m_Allocator.getStats();
+
+    // Note: Only counts the mesh, not what's inside the mesh-lib
+    for (size_t i = 0; i < m_Allocator.getNumObtainedElements(); i++)
+        s.numBytesPayload += getStaticMeshDynSizeBytes(m_Allocator.getElements()[i].mesh);
 
+    return s;
+}
@@ -36,6 +36,11 @@ namespace Meshes
          */
         WorldSkeletalMesh& getMesh(Handle::MeshHandle h) { return m_Allocator.getElement(h).mesh; }
         const ZenLoad::zCModelMeshLib& getMeshLib(Handle::MeshHandle h){ return m_Allocator.getElement(h).lib; }
+
+        /**
+         * @return Usage of the allocator. The payload is the vertex- and index-data of all meshes.
+         */
+        Memory::AllocatorStats getStats();
     protected:
 
         /**
@@ -54,7 +59,7 @@ namespace Meshes
          * @brief Textures by their set names. Note: If names are doubled, only the last loaded texture
          *		  can be found here
          */
-        std::map<std::string, Handle::MeshHandle> m_MeshesByName;
+        std::unordered_map<Utils::Name, Handle::MeshHandle> m_MeshesByName;
 
         /**
          * Pointer to a vdfs-index to work on (can be nullptr)
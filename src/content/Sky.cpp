@@ -359,4 +359,22 @@ void Sky::getTimeOfDay(int& hours, int& minutes)
     float fh = fmod(24.0f * getTimeOfDay() + 12.0f, 24);
     hours = (int)fh;
     minutes = (int)((fh - hours) * 60.0f);
+}
+
+int64_t Sky::getTimeInMinutes()
+{
+    // The master-time starts at 12:00
+    return static_cast<int64_t>(m_MasterTime / 60.0) + 12 * 60;
+}
+
+void Sky::setTimeOfDay(int hours, int minutes)
+{
+    int64_t now = getTimeInMinutes();
+    int64_t target = (now / (24 * 60)) * 24 * 60 + hours * 60 + minutes;
+
+    if(target < now)
+        target += 24 * 60;
+
+    m_MasterTime = static_cast<double>(target - 12 * 60) * 60.0;
+    m_MasterState.time = fmod(static_cast<float>(m_MasterTime / (60.0 * 60.0 * 24.0)), 1.0f);
 }
\ No newline at end of file
@@ -108,6 +108,18 @@ namespace Content
          */
         void getTimeOfDay(int& hours, int& minutes);
 
+        /**
+         * @return Game-time in minutes since 00:00 of the first day. Only ever goes forward.
+         */
+        int64_t getTimeInMinutes();
+
+        /**
+         * Moves the time forward to the next time the clock shows the given hours/minutes, like sleeping does
+         * @param hours
+         * @param minutes
+         */
+        void setTimeOfDay(int hours, int minutes);
+
         /**
          * @return current interpolated sky-state
          */
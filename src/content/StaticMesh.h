@@ -78,4 +78,18 @@ namespace Meshes
         target.m_Indices.clear();
         target.m_Vertices.clear();
     }
+
+    /**
+     * @return Estimate of the heap-memory held by a StaticMeshDynSize-Instance. Vertex- and index-data
+     *         are counted once, even though the GPU holds a copy of them as well.
+     */
+    template<typename V, typename I, typename MHDL, typename VHDL, typename IHDL>
+    size_t getStaticMeshDynSizeBytes(const StaticMeshDynSize<V,I,MHDL,VHDL,IHDL>& target)
+    {
+        return target.m_Vertices.capacity() * sizeof(V)
+               + target.m_Indices.capacity() * sizeof(I)
+               + target.m_SubmeshStarts.capacity() * sizeof(SubmeshVxInfo)
+               + target.m_SubmeshMaterials.capacity() * sizeof(Materials::TexturedMaterial)
+               + target.m_SubmeshMaterialNames.capacity() * sizeof(std::string);
+    }
 }
\ No newline at end of file
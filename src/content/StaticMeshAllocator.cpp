@@ -100,9 +100,18 @@ Handle::MeshHandle StaticMeshAllocator::loadFromPacked(const ZenLoad::PackedMesh
 		return Handle::MeshHandle::makeInvalidHandle();
 	}
 
-	m_MeshesByName[name] = h;
+	if(!name.empty())
+		m_MeshesByName[Utils::Name(name)] = h;
 
     return h;
 }
 
+Memory::AllocatorStats StaticMeshAllocator::getStats()
+{
+    Memory::AllocatorStats s = m_Allocator.getStats();
+
+    for (size_t i = 0; i < m_Allocator.getNumObtainedElements(); i++)
+        s.numBytesPayload += getStaticMeshDynSizeBytes(m_Allocator.getElements()[i].mesh);
 
+    return s;
+}
@@ -51,6 +51,11 @@ namespace Meshes
          * @brief Returns the texture of the given handle
          */
         WorldStaticMesh& getMesh(Handle::MeshHandle h) { return m_Allocator.getElement(h); }
+
+        /**
+         * @return Usage of the allocator. The payload is the vertex- and index-data of all meshes.
+         */
+        Memory::AllocatorStats getStats();
     protected:
 
         /**
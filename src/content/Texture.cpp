@@ -3,6 +3,8 @@
 #include <vdfs/fileIndex.h>
 #include <zenload/ztex2dds.h>
 #include <utils/logger.h>
+#include "AssetCache.h"
+#include "VDFSLock.h"
 
 using namespace Textures;
 
@@ -12,7 +14,9 @@ extern "C" stbi_uc* stbi_load_from_memory(stbi_uc const* _buffer, int _len, int*
 extern "C" void stbi_image_free(void* _ptr);
 
 TextureAllocator::TextureAllocator(const VDFS::FileIndex* vdfidx)
-	: m_pVDFSIndex(vdfidx)
+	: m_pVDFSIndex(vdfidx),
+	  m_pAssetCache(nullptr),
+	  m_NumTextureBytes(0)
 {
 }
 
@@ -29,7 +33,7 @@ TextureAllocator::~TextureAllocator()
 Handle::TextureHandle TextureAllocator::loadTextureDDS(const std::vector<uint8_t>& data, const std::string & name)
 {
 	// Check if this was already loaded
-	auto it = m_TexturesByName.find(name);
+	auto it = m_TexturesByName.find(Utils::Name::find(name));
 	if (it != m_TexturesByName.end())
 		return (*it).second;
 
@@ -49,9 +53,11 @@ Handle::TextureHandle TextureAllocator::loadTextureDDS(const std::vector<uint8_t
 	m_Allocator.getElement(h).m_TextureHandle = bth;
 	m_Allocator.getElement(h).m_TextureName = name;
 
+	m_NumTextureBytes += data.size();
+
 	// Add handle to name-map, if it got one
 	if(!name.empty())
-		m_TexturesByName[name] = h;
+		m_TexturesByName[Utils::Name(name)] = h;
 
 	// Flush the pipeline
 	// TODO: There must be something better than "frame"?
@@ -64,7 +70,7 @@ Handle::TextureHandle TextureAllocator::loadTextureDDS(const std::vector<uint8_t
 Handle::TextureHandle TextureAllocator::loadTextureRGBA8(const std::vector<uint8_t>& data, uint16_t width, uint16_t height, const std::string & name)
 {
 	// Check if this was already loaded
-	auto it = m_TexturesByName.find(name);
+	auto it = m_TexturesByName.find(Utils::Name::find(name));
 	if (it != m_TexturesByName.end())
 		return (*it).second;
 
@@ -91,9 +97,11 @@ Handle::TextureHandle TextureAllocator::loadTextureRGBA8(const std::vector<uint8
 	m_Allocator.getElement(h).m_TextureHandle = bth;
 	m_Allocator.getElement(h).m_TextureName = name;
 
+	m_NumTextureBytes += data.size();
+
 	// Add handle to name-map, if it got one
 	if(!name.empty())
-		m_TexturesByName[name] = h;
+		m_TexturesByName[Utils::Name(name)] = h;
 
 	// Flush the pipeline
 	// TODO: There must be something better than "frame"?
@@ -103,16 +111,40 @@ Handle::TextureHandle TextureAllocator::loadTextureRGBA8(const std::vector<uint8
 	return h;
 }
 
+Memory::AllocatorStats TextureAllocator::getStats()
+{
+	Memory::AllocatorStats s = m_Allocator.getStats();
+	s.numBytesPayload = m_NumTextureBytes;
+
+	return s;
+}
+
 Handle::TextureHandle TextureAllocator::loadTextureVDF(const VDFS::FileIndex & idx, const std::string & name)
 {
 	// Check if this was already loaded
-	auto it = m_TexturesByName.find(name);
+	auto it = m_TexturesByName.find(Utils::Name::find(name));
 	if (it != m_TexturesByName.end())
 		return (*it).second;
 
+	if(m_pAssetCache)
+	{
+		Content::AssetCache::TexturePtr tex = m_pAssetCache->getTexture(idx, name);
+		if(!tex)
+			return Handle::TextureHandle::makeInvalidHandle();
+
+		return loadDecodedTexture(*tex, name);
+	}
+
+	DecodedTexture tex;
+	if(!decodeTextureVDF(idx, name, tex))
+		return Handle::TextureHandle::makeInvalidHandle();
+
+	return loadDecodedTexture(tex, name);
+}
+
+bool TextureAllocator::readTextureVDF(const VDFS::FileIndex & idx, const std::string & name, RawTexture & out)
+{
 	std::string vname = name;
-	std::vector<uint8_t> ztex;
-	std::vector<uint8_t> dds;
 
 	// Check if this isn't the compiled version
 	if (vname.find("-C") == std::string::npos)
@@ -124,21 +156,29 @@ Handle::TextureHandle TextureAllocator::loadTextureVDF(const VDFS::FileIndex & i
 		vname += "-C.TEX";
 	}
 
+	std::unique_lock<std::mutex> lock = Content::lockVDFS();
+
 	// Load from archive
-	bool asDDS = true;
-	idx.getFileData(vname, ztex);
+	out.data.clear();
+	out.compiled = true;
+	idx.getFileData(vname, out.data);
 
 	// No compiled version? Try again as TGA
-	if(ztex.empty())
+	if(out.data.empty())
 	{
-		vname = name;
-		idx.getFileData(vname, ztex);
-		asDDS = false;
+		idx.getFileData(name, out.data);
+		out.compiled = false;
 	}
 
 	// Failed?
-	if (ztex.empty())
-		return Handle::TextureHandle::makeInvalidHandle();
+	return !out.data.empty();
+}
+
+void TextureAllocator::decodeTexture(RawTexture & raw, DecodedTexture & out)
+{
+	std::vector<uint8_t> ztex = std::move(raw.data);
+	std::vector<uint8_t> dds;
+	bool asDDS = raw.compiled;
 
     if(asDDS)
     {
@@ -156,14 +196,42 @@ Handle::TextureHandle TextureAllocator::loadTextureVDF(const VDFS::FileIndex & i
     }
 #endif
 
+	out.asDDS = asDDS;
+	out.width = 0;
+	out.height = 0;
+
 	if(asDDS)
 	{
-		// Proceed to load as usual dds-file and the input-name
-		return loadTextureDDS(dds, name);
+		out.data = std::move(dds);
 	} else
 	{
 		ZenLoad::DDSURFACEDESC2 desc = ZenLoad::getSurfaceDesc(dds);
-		return loadTextureRGBA8(ztex, (uint16_t)desc.dwWidth, (uint16_t)desc.dwHeight, name);
+		out.width = (uint16_t)desc.dwWidth;
+		out.height = (uint16_t)desc.dwHeight;
+		out.data = std::move(ztex);
+	}
+}
+
+bool TextureAllocator::decodeTextureVDF(const VDFS::FileIndex & idx, const std::string & name, DecodedTexture & out)
+{
+	RawTexture raw;
+	if(!readTextureVDF(idx, name, raw))
+		return false;
+
+	decodeTexture(raw, out);
+
+	return true;
+}
+
+Handle::TextureHandle TextureAllocator::loadDecodedTexture(const DecodedTexture & tex, const std::string & name)
+{
+	if(tex.asDDS)
+	{
+		// Proceed to load as usual dds-file and the input-name
+		return loadTextureDDS(tex.data, name);
+	} else
+	{
+		return loadTextureRGBA8(tex.data, tex.width, tex.height, name);
 	}
 }
 
@@ -174,3 +242,60 @@ Handle::TextureHandle TextureAllocator::loadTextureVDF(const std::string & name)
 
 	return loadTextureVDF(*m_pVDFSIndex, name);
 }
+
+size_t TextureAllocator::preloadTexturesVDF(const std::vector<std::string>& names)
+{
+	if (!m_pVDFSIndex)
+		return 0;
+
+	// Only care about textures we don't have yet
+	std::vector<std::string> toLoad;
+	for(const std::string& n : names)
+	{
+		if(m_TexturesByName.find(Utils::Name::find(n)) == m_TexturesByName.end())
+			toLoad.push_back(n);
+	}
+
+	// Let the cache decode whatever it doesn't have yet
+	if(m_pAssetCache)
+	{
+		std::vector<Content::AssetCache::TexturePtr> cached = m_pAssetCache->getTextures(*m_pVDFSIndex, toLoad);
+
+		size_t num = 0;
+		for(size_t i = 0; i < toLoad.size(); i++)
+		{
+			if(cached[i] && loadDecodedTexture(*cached[i], toLoad[i]).isValid())
+				num++;
+		}
+
+		return num;
+	}
+
+	std::vector<RawTexture> raw(toLoad.size());
+	std::vector<DecodedTexture> decoded(toLoad.size());
+	std::vector<char> loaded(toLoad.size(), 0);
+
+	// Read serially, the VDFS can't be read from multiple threads anyways
+	for(size_t i = 0; i < toLoad.size(); i++)
+	{
+		loaded[i] = readTextureVDF(*m_pVDFSIndex, toLoad[i], raw[i]) ? 1 : 0;
+	}
+
+	// Convert in parallel
+	#pragma omp parallel for schedule(dynamic)
+	for(int i = 0; i < static_cast<int>(toLoad.size()); i++)
+	{
+		if(loaded[i])
+			decodeTexture(raw[i], decoded[i]);
+	}
+
+	// Upload
+	size_t num = 0;
+	for(size_t i = 0; i < toLoad.size(); i++)
+	{
+		if(loaded[i] && loadDecodedTexture(decoded[i], toLoad[i]).isValid())
+			num++;
+	}
+
+	return num;
+}
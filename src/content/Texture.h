@@ -2,15 +2,22 @@
 #include <handle/Handle.h>
 #include <handle/HandleDef.h>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <string>
 #include "memory/Config.h"
+#include <utils/Name.h>
 
 namespace VDFS
 {
 	class FileIndex;
 }
 
+namespace Content
+{
+	class AssetCache;
+}
+
 namespace Textures
 {
     template<typename THDL>
@@ -34,6 +41,11 @@ namespace Textures
 		 */
 		void setVDFSIndex(const VDFS::FileIndex* vdfidx) { m_pVDFSIndex = vdfidx; }
 
+		/**
+		 * @brief Sets the engine-wide cache to take decoded textures from, instead of decoding them again (can be nullptr)
+		 */
+		void setAssetCache(Content::AssetCache* cache) { m_pAssetCache = cache; }
+
 		/**
 		 * @brief Loads a texture from the given DDS-Data
 		 */
@@ -46,16 +58,74 @@ namespace Textures
 		Handle::TextureHandle loadTextureVDF(const VDFS::FileIndex& idx, const std::string& name);
 		Handle::TextureHandle loadTextureVDF(const std::string& name);
 
+		/**
+		 * @brief Loads all of the given textures which aren't loaded yet. Converting is done in parallel,
+		 *		  reading and the upload are serial.
+		 * @return Number of textures which were newly loaded
+		 */
+		size_t preloadTexturesVDF(const std::vector<std::string>& names);
+
 		/**
 		 * @brief Returns the texture of the given handle
 		 */
 		Texture& getTexture(Handle::TextureHandle h) { return m_Allocator.getElement(h); }
+
+		/**
+		 * @brief Returns the usage of the allocator. The payload is the size of the uploaded texture-data,
+		 *		  which mostly lives on the GPU.
+		 */
+		Memory::AllocatorStats getStats();
+
+		/**
+		 * Texture-data read from the VDFS, ready to be uploaded
+		 */
+		struct DecodedTexture
+		{
+			std::vector<uint8_t> data;
+			bool asDDS;
+			uint16_t width;
+			uint16_t height;
+		};
+
+		/**
+		 * Texture-file as stored inside the VDFS
+		 */
+		struct RawTexture
+		{
+			std::vector<uint8_t> data;
+			bool compiled; // ZTEX, otherwise TGA
+		};
+
+		/**
+		 * @brief Reads the given texture from the VDFS, without converting it. Takes the VDFS-lock.
+		 * @return False, if the texture could not be found
+		 */
+		static bool readTextureVDF(const VDFS::FileIndex& idx, const std::string& name, RawTexture& out);
+
+		/**
+		 * @brief Converts a texture read by readTextureVDF. Doesn't touch the allocator or the VDFS, so this is
+		 *		  safe to be called from multiple threads at once. The raw data is consumed.
+		 */
+		static void decodeTexture(RawTexture& raw, DecodedTexture& out);
+
+		/**
+		 * @brief Reads and converts the given texture. Doesn't touch the allocator, so this is safe to be called
+		 *		  from multiple threads at once. Only the reading is serialized.
+		 * @return False, if the texture could not be found
+		 */
+		static bool decodeTextureVDF(const VDFS::FileIndex& idx, const std::string& name, DecodedTexture& out);
 	protected:
+
+		/**
+		 * @brief Uploads a texture created by decodeTextureVDF
+		 */
+		Handle::TextureHandle loadDecodedTexture(const DecodedTexture& tex, const std::string& name);
+
 		/**
 		 * @brief Textures by their set names. Note: If names are doubled, only the last loaded texture
 		 *		  can be found here
 		 */
-		std::map<std::string, Handle::TextureHandle> m_TexturesByName;
+		std::unordered_map<Utils::Name, Handle::TextureHandle> m_TexturesByName;
 
 		/**
 		 * Data allocator
@@ -66,6 +136,16 @@ namespace Textures
 		 * Pointer to a vdfs-index to work on (can be nullptr)
 		 */
 		const VDFS::FileIndex* m_pVDFSIndex;
+
+		/**
+		 * Cache of decoded textures shared between worlds (can be nullptr)
+		 */
+		Content::AssetCache* m_pAssetCache;
+
+		/**
+		 * Size of all texture-data uploaded so far
+		 */
+		size_t m_NumTextureBytes;
 	};
 
 }
\ No newline at end of file
@@ -0,0 +1,8 @@
+#include "VDFSLock.h"
+
+std::unique_lock<std::mutex> Content::lockVDFS()
+{
+    static std::mutex s_Mutex;
+
+    return std::unique_lock<std::mutex>(s_Mutex);
+}
@@ -0,0 +1,18 @@
+#pragma once
+#include <mutex>
+
+namespace Content
+{
+    /**
+     * The VDFS-index is not safe to be read from multiple threads at once, but worlds and assets are loaded from
+     * background-threads while the main-thread keeps reading from it as well. Everything reading from the index
+     * (getFileData(), hasFile() and the ZenLib-loaders taking an index) has to hold this lock while doing so.
+     *
+     * Only the reading itself should be done under the lock. Decoding and packing should happen after releasing it,
+     * so that part can still run in parallel.
+     *
+     * Not recursive: Don't call anything taking the lock while holding it.
+     * @return Held lock on the engine-wide VDFS-mutex
+     */
+    std::unique_lock<std::mutex> lockVDFS();
+}
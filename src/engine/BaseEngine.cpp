@@ -11,16 +11,28 @@
 #include <zenload/zCModelPrototype.h>
 #include <components/Vob.h>
 #include <fstream>
+#include "Savegame.h"
+#include <memory/VirtualMemory.h>
+#include <memory/SizeClassPool.h>
+#include <logic/messages/EventMessage.h>
+#include <utils/Name.h>
+#include <utils/Profiler.h>
+#include <content/VDFSLock.h>
+#include <bx/timer.h>
 
 using namespace Engine;
 
-BaseEngine::BaseEngine()
+BaseEngine::BaseEngine() :
+        m_WorldLoadBudget(DEFAULT_WORLD_LOAD_BUDGET)
 {
 
 }
 
 BaseEngine::~BaseEngine()
 {
+    // Join the background-threads while the worlds they write to are still there
+    finishPreload();
+    m_WorldLoads.clear();
 }
 
 void BaseEngine::initEngine(int argc, char** argv)
@@ -82,6 +94,7 @@ void BaseEngine::initEngine(int argc, char** argv)
 
     loadArchives();
 
+    std::unique_lock<std::mutex> lock = Content::lockVDFS();
     if(m_Args.startupZEN.empty() || !m_FileIndex.hasFile(m_Args.startupZEN))
     {
         // Try Gothic 1
@@ -95,6 +108,22 @@ void BaseEngine::initEngine(int argc, char** argv)
 }
 
 Handle::WorldHandle  BaseEngine::addWorld(const std::string & worldFile, const std::string& savegame)
+{
+    Handle::WorldHandle world = addWorldAsync(worldFile, savegame);
+
+    World::WorldLoader* loader = getWorldLoader(world);
+    if(loader)
+    {
+        loader->finish();
+
+        m_WorldLoads.remove_if([&](WorldLoad& load){ return load.world == world; });
+        onWorldLoaded(world.get());
+    }
+
+    return world;
+}
+
+Handle::WorldHandle BaseEngine::addWorldAsync(const std::string& worldFile, const std::string& savegame)
 {
     m_WorldInstances.emplace_back();
 
@@ -104,7 +133,10 @@ Handle::WorldHandle  BaseEngine::addWorld(const std::string & worldFile, const s
     if(!worldFile.empty())
     {
         std::vector<uint8_t> zenData;
-        m_FileIndex.getFileData(worldFile, zenData);
+        {
+            std::unique_lock<std::mutex> lock = Content::lockVDFS();
+            m_FileIndex.getFileData(worldFile, zenData);
+        }
 
         if (zenData.empty())
         {
@@ -113,19 +145,68 @@ Handle::WorldHandle  BaseEngine::addWorld(const std::string & worldFile, const s
         }
     }
 
+    m_WorldLoads.emplace_back();
+    WorldLoad& load = m_WorldLoads.back();
+    load.world = world.getMyHandle();
+
     // Try to load a savegame
-    json savegameData;
     if(!savegame.empty())
     {
-        std::ifstream f(savegame);
-        std::stringstream saveData;
-        saveData << f.rdbuf();
+        if(!Savegame::loadFromFile(savegame, load.savegame))
+        {
+            LogError() << "Failed to read savegame: " << savegame;
+            load.savegame = json();
+        }
+    }
+
+    // Take what was read in the background, if this world was preloaded
+    World::PreparedZen* prepared = nullptr;
+    if(m_Preload && m_Preload->zen == worldFile)
+    {
+        finishPreload();
 
-        savegameData = json::parse(saveData);
+        if(m_Preload->valid)
+            prepared = &m_Preload->prepared;
     }
 
-    world.init(*this, worldFile, savegameData);
+    load.loader.reset(new World::WorldLoader(world, *this, worldFile, load.savegame, prepared));
+
+    if(prepared)
+        m_Preload.reset();
 
+	return world.getMyHandle();
+}
+
+World::WorldLoader* BaseEngine::getWorldLoader(Handle::WorldHandle world)
+{
+    for(WorldLoad& load : m_WorldLoads)
+    {
+        if(load.world == world)
+            return load.loader.get();
+    }
+
+    return nullptr;
+}
+
+void BaseEngine::updateWorldLoads(double budget)
+{
+    for(auto it = m_WorldLoads.begin(); it != m_WorldLoads.end();)
+    {
+        if(!it->loader->update(budget))
+        {
+            it++;
+            continue;
+        }
+
+        World::WorldInstance& world = it->world.get();
+        it = m_WorldLoads.erase(it);
+
+        onWorldLoaded(world);
+    }
+}
+
+void BaseEngine::onWorldLoaded(World::WorldInstance& world)
+{
     if(!m_Args.testVisual.empty())
     {
         LogInfo() << "Testing visual: " << m_Args.testVisual;
@@ -136,12 +217,65 @@ Handle::WorldHandle  BaseEngine::addWorld(const std::string & worldFile, const s
     }
 
 	m_Worlds.push_back(world.getMyHandle());
+}
 
-	return world.getMyHandle();
+bool BaseEngine::preloadWorld(const std::string& worldFile)
+{
+    {
+        std::unique_lock<std::mutex> lock = Content::lockVDFS();
+        if(!m_FileIndex.hasFile(worldFile))
+            return false;
+    }
+
+    if(m_Preload && m_Preload->zen == worldFile)
+        return true;
+
+    finishPreload();
+
+    m_Preload.reset(new WorldPreload);
+    m_Preload->zen = worldFile;
+    m_Preload->done = false;
+    m_Preload->valid = false;
+    m_Preload->time = 0.0;
+
+    WorldPreload* preload = m_Preload.get();
+    preload->thread = std::thread([this, preload, worldFile]()
+    {
+        Utils::Profiler::setThreadName("Preload");
+
+        int64_t start = bx::getHPCounter();
+        preload->valid = World::prepareZen(m_FileIndex, worldFile, preload->prepared, &m_AssetCache);
+        preload->time = double(bx::getHPCounter() - start) / double(bx::getHPFrequency());
+
+        preload->done = true;
+    });
+
+    return true;
+}
+
+bool BaseEngine::isWorldPreloaded(const std::string& worldFile)
+{
+    return m_Preload && m_Preload->zen == worldFile && m_Preload->done;
+}
+
+void BaseEngine::finishPreload()
+{
+    if(!m_Preload || !m_Preload->thread.joinable())
+        return;
+
+    m_Preload->thread.join();
+
+    if(m_Preload->valid)
+        LogInfo() << "Preloaded world " << m_Preload->zen << " in the background in " << m_Preload->time * 1000.0 << "ms";
+    else
+        LogWarn() << "Failed to preload world " << m_Preload->zen;
 }
 
 void BaseEngine::removeWorld(Handle::WorldHandle world)
 {
+    // Stop loading it, if it wasn't done yet
+    m_WorldLoads.remove_if([&](WorldLoad& load){ return load.world == world; });
+
     std::remove(m_Worlds.begin(), m_Worlds.end(), world);
 
     for(auto it = m_WorldInstances.begin(); it != m_WorldInstances.end(); it++)
@@ -156,6 +290,8 @@ void BaseEngine::removeWorld(Handle::WorldHandle world)
 
 void BaseEngine::frameUpdate(double dt, uint16_t width, uint16_t height)
 {
+    updateWorldLoads(m_WorldLoadBudget);
+
 	onFrameUpdate(dt, width, height);
 
 }
@@ -236,6 +372,44 @@ BaseEngine::EngineArgs BaseEngine::getEngineArgs()
     return m_Args;
 }
 
+void BaseEngine::collectMemoryStats(Memory::MemoryReport& report)
+{
+    report.setScope("engine");
+
+    Physics::CollisionShapeLibrary::Stats shapes = m_CollisionShapeLibrary.getStats();
+    Memory::AllocatorStats shapeStats;
+    shapeStats.numLive = shapes.numShapes;
+    shapeStats.numBytesPayload = shapes.numBytesEstimated;
+    report.add("Physics", "Shape library", shapeStats);
+
+    // Messages come in different sizes, so there is no element-size nor capacity
+    Memory::SizeClassPool::Stats pool = Logic::EventMessages::getMessagePool().getStats();
+    Memory::AllocatorStats poolStats;
+    poolStats.numLive = pool.numLive;
+    poolStats.highWater = pool.numPeakLive;
+    poolStats.numBytesAllocated = pool.numBytesReserved;
+    report.add("Messages", "Event-message pool", poolStats);
+
+    Content::AssetCache::Stats assets = m_AssetCache.getStats();
+    Memory::AllocatorStats assetStats;
+    assetStats.numLive = assets.numTextures + assets.numMeshes;
+    assetStats.numBytesPayload = assets.numBytes;
+    report.add("Assets", "Decoded asset cache", assetStats);
+
+    Memory::AllocatorStats nameStats;
+    nameStats.numLive = Utils::Name::getNumNames();
+    nameStats.numBytesAllocated = Utils::Name::getNumBytes();
+    report.add("Names", "Interned names", nameStats);
+
+    for(World::WorldInstance& w : m_WorldInstances)
+    {
+        report.setScope("world:" + w.getZenFile());
+        w.collectMemoryStats(report);
+    }
+
+    report.setProcessStats(Memory::VirtualMemory::getResidentSetSize(), Memory::VirtualMemory::getNumCommittedBytes());
+}
+
 
 
 
@@ -1,14 +1,25 @@
 #pragma once
 #include <memory/StaticReferencedAllocator.h>
 #include "World.h"
+#include "WorldLoader.h"
 #include <vdfs/fileIndex.h>
 #include <ui/View.h>
 #include <bx/commandline.h>
+#include <physics/CollisionShapeLibrary.h>
+#include <content/AssetCache.h>
+#include <thread>
+#include <atomic>
+#include <memory>
 
 namespace Engine
 {
 	const int MAX_NUM_WORLDS = 4;
 
+	/**
+	 * Seconds per frame spent on loading worlds added by addWorldAsync()
+	 */
+	const double DEFAULT_WORLD_LOAD_BUDGET = 0.008;
+
 	class BaseEngine
 	{
 	public:
@@ -39,6 +50,37 @@ namespace Engine
 		 */
 		Handle::WorldHandle  addWorld(const std::string& worldFile, const std::string& savegame = "");
 
+		/**
+		 * Same as addWorld(), but only starts loading the world. It is built during the next frameUpdate()-calls,
+		 * within the load-budget of each frame. See getWorldLoader() for how far it got.
+		 */
+		Handle::WorldHandle addWorldAsync(const std::string& worldFile, const std::string& savegame = "");
+
+		/**
+		 * @return Loader of the given world while it is still being loaded, nullptr once it is done
+		 */
+		World::WorldLoader* getWorldLoader(Handle::WorldHandle world);
+
+		/**
+		 * Sets the time per frame spent on loading worlds added by addWorldAsync()
+		 * @param seconds Time per frame
+		 */
+		void setWorldLoadBudget(double seconds){ m_WorldLoadBudget = seconds; }
+
+		/**
+		 * Starts reading the given world on a background thread: The ZEN is parsed, the worldmesh packed and the
+		 * static visuals and textures are decoded into the asset-cache. A later addWorld() of the same file
+		 * picks that up and only has to do the work which needs the world itself.
+		 * Only one world is preloaded at a time. Starting a different one waits for the current one to finish.
+		 * @return False, if the world-file doesn't exist
+		 */
+		bool preloadWorld(const std::string& worldFile);
+
+		/**
+		 * @return Whether the given world was preloaded and is ready to be added without waiting
+		 */
+		bool isWorldPreloaded(const std::string& worldFile);
+
 		/**
 		 * Removes a world and everything inside
 		 * @param world World to remove
@@ -84,6 +126,21 @@ namespace Engine
          */
 		const std::string& getContentBasePath(){ return m_ContentBasePath; }
 
+		/**
+		 * @return Collision-shapes shared between all worlds
+		 */
+		Physics::CollisionShapeLibrary& getCollisionShapeLibrary(){ return m_CollisionShapeLibrary; }
+
+		/**
+		 * @return Decoded textures and packed meshes shared between all worlds
+		 */
+		Content::AssetCache& getAssetCache(){ return m_AssetCache; }
+
+		/**
+		 * Puts the memory-usage of the engine and all worlds into the given report
+		 */
+		void collectMemoryStats(Memory::MemoryReport& report);
+
 	protected:
 
 		/**
@@ -92,6 +149,17 @@ namespace Engine
 		virtual void onWorldCreated(Handle::WorldHandle world);
 		virtual void onWorldRemoved(Handle::WorldHandle world){};
 
+		/**
+		 * Called when a world finished loading
+		 */
+		virtual void onWorldLoaded(World::WorldInstance& world);
+
+		/**
+		 * Continues loading the worlds added by addWorldAsync()
+		 * @param budget Seconds to spend on each of them
+		 */
+		void updateWorldLoads(double budget);
+
 		/**
 		 * Update-method for subclasses
 		 */
@@ -103,15 +171,69 @@ namespace Engine
 		 */
 		virtual void loadArchives();
 
+		/**
+		 * Main VDFS-Index. Declared before everything reading from it, so it outlives the worlds and loader-threads.
+		 * Access has to be guarded by Content::lockVDFS().
+		 */
+		VDFS::FileIndex m_FileIndex;
+
+		/**
+		 * Collision-shapes shared between all worlds. Needs to outlive the world instances.
+		 */
+		Physics::CollisionShapeLibrary m_CollisionShapeLibrary;
+
+		/**
+		 * Decoded assets shared between all worlds. Needs to outlive the world instances.
+		 */
+		Content::AssetCache m_AssetCache;
+
+		/**
+		 * A world being read in the background
+		 */
+		struct WorldPreload
+		{
+			std::string zen; // Only touched by the main-thread
+			World::PreparedZen prepared;
+			std::thread thread;
+			std::atomic<bool> done;
+			bool valid;
+			double time; // Seconds the background thread took
+		};
+
+		/**
+		 * Waits for the running preload to finish
+		 */
+		void finishPreload();
+
+		/**
+		 * Last started preload, if any
+		 */
+		std::unique_ptr<WorldPreload> m_Preload;
+
 		/**
 		 * Currently active world instances
 		 */
 		std::list<World::WorldInstance> m_WorldInstances;
 
 		/**
-		 * Main VDFS-Index
+		 * A world still being loaded
 		 */
-		VDFS::FileIndex m_FileIndex;
+		struct WorldLoad
+		{
+			Handle::WorldHandle world;
+			json savegame; // Referenced by the loader
+			std::unique_ptr<World::WorldLoader> loader;
+		};
+
+		/**
+		 * Worlds still being loaded. Declared after the world instances, so the loaders are gone before the worlds.
+		 */
+		std::list<WorldLoad> m_WorldLoads;
+
+		/**
+		 * Seconds per frame spent on loading worlds
+		 */
+		double m_WorldLoadBudget;
 
 		/**
 		 * Registered worlds
@@ -12,6 +12,8 @@
 #include <bx/commandline.h>
 #include <utils/logger.h>
 #include <components/Vob.h>
+#include <bx/timer.h>
+#include <utils/Profiler.h>
 
 using namespace Engine;
 
@@ -20,6 +22,7 @@ const float DRAW_DISTANCE = 100.0f;
 GameEngine::GameEngine() : m_DefaultRenderSystem(*this)
 {
     m_disableLogic = false;
+    m_LastDrawTime = 0.0;
 }
 
 GameEngine::~GameEngine()
@@ -72,13 +75,28 @@ void GameEngine::onFrameUpdate(double dt, uint16_t width, uint16_t height)
 //        lastLogicDisableKeyState = inputGetKeyState(entry::Key::Key2);
 //    }
 
-    if(m_disableLogic)
+    World::WorldLoader* mainLoader = getWorldLoader(getMainWorld());
+
+    if(mainLoader)
+    {
+        // There is nothing to update yet, but the camera can already look around once there is ground to stand on
+        if(mainLoader->isWorldMeshReady())
+        {
+            getMainCamera<Components::LogicComponent>().m_pLogicController->onUpdate(dt);
+            getMainCameraController()->onUpdateExplicit(dt);
+        }
+    }
+    else if(m_disableLogic)
     {
         getMainCamera<Components::LogicComponent>().m_pLogicController->onUpdate(dt);
     } else
     {
         for (auto& s : m_WorldInstances)
         {
+            // Worlds still being loaded don't have their scripts yet
+            if(getWorldLoader(s.getMyHandle()))
+                continue;
+
             // Update main-world after every other world, since the camera is in there
             s.onFrameUpdate(dt, DRAW_DISTANCE * DRAW_DISTANCE,
                                 getMainCamera<Components::PositionComponent>().m_WorldMatrix);
@@ -88,11 +106,17 @@ void GameEngine::onFrameUpdate(double dt, uint16_t width, uint16_t height)
         getMainCameraController()->onUpdateExplicit(dt);
     }
 
+    int64_t drawStart = bx::getHPCounter();
+
     drawFrame(width, height);
+
+    m_LastDrawTime = (bx::getHPCounter() - drawStart) / double(bx::getHPFrequency());
 }
 
 void GameEngine::drawFrame(uint16_t width, uint16_t height)
 {
+    PROFILE_SCOPE("GameEngine::drawFrame");
+
     Math::Matrix view = Components::Actions::Position::makeViewMatrixFrom(getMainWorld().get().getComponentAllocator(), m_MainCamera);
 
     // Set view and projection matrix for view 0.
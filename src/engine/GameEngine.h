@@ -61,6 +61,15 @@ namespace Engine
         {
             return m_DefaultRenderSystem;
         }
+
+        /**
+         * @return Time drawing the worlds took in the last frame, in seconds. Only covers submitting to bgfx, not
+         *         the actual rendering.
+         */
+        double getLastDrawTime()
+        {
+            return m_LastDrawTime;
+        }
     protected:
 
         /**
@@ -94,6 +103,11 @@ namespace Engine
          */
         Render::RenderSystem m_DefaultRenderSystem;
 
+        /**
+         * Time drawFrame took last frame
+         */
+        double m_LastDrawTime;
+
         /**
          * Debug only
          */
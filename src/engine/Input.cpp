@@ -60,6 +60,7 @@ float Input::mouseSensitivity = 50.0f;
 Math::float2 Input::mousePosition = {0.0f, 0.0f};
 bool Input::isMouseLocked = false;
 std::function<void(bool /* lock */)> Input::mouseLockCallback;
+Input::DispatchListener Input::dispatchListener;
 float Input::windowHalfHeight;
 float Input::windowHalfWidth;
 
@@ -209,12 +210,7 @@ void Input::fireBindings()
         // Invert intensity if isInverted is true
         intensity = itBindingToKey.first.isInverted ? -intensity : intensity;
 
-        auto rangeIterators = actionTypeToActionMap.equal_range(itBindingToKey.first.actionType);
-        for(auto itAction = rangeIterators.first; itAction != rangeIterators.second; ++itAction)
-            if(itAction->second.isEnabled)
-            {
-                itAction->second.function(triggerAction, intensity);
-            }
+        fireAction(itBindingToKey.first.actionType, triggerAction, intensity);
     }
 
     clearTriggered();
@@ -227,10 +223,7 @@ void Input::fireBindings()
         // Invert intensity if isInverted is true
         intensity = itBindingToButton.first.isInverted ? -intensity : intensity;
 
-        auto rangeIterators = actionTypeToActionMap.equal_range(itBindingToButton.first.actionType);
-        for(auto itAction = rangeIterators.first; itAction != rangeIterators.second; ++itAction)
-            if(itAction->second.isEnabled)
-                itAction->second.function(triggerAction, intensity);
+        fireAction(itBindingToButton.first.actionType, triggerAction, intensity);
 
         mouseButtonTriggered[itBindingToButton.second] = false;
     }
@@ -263,20 +256,36 @@ void Input::fireBindings()
         // Pass the axis position as intensity, caring for invertion
         intensity = itBindingToAxis.first.isInverted ? -intensity : intensity;
 
-        auto rangeIterators = actionTypeToActionMap.equal_range(itBindingToAxis.first.actionType);
-        for(auto itAction = rangeIterators.first; itAction != rangeIterators.second; ++itAction)
-            if(itAction->second.isEnabled)
-                itAction->second.function(triggerAction, intensity);
+        fireAction(itBindingToAxis.first.actionType, triggerAction, intensity);
 
         mouseAxisTriggered[mouseAxisIndex] = false;
     }
 }
 
+void Input::fireAction(ActionType actionType, bool triggered, float intensity)
+{
+    if(dispatchListener)
+        dispatchListener(actionType, triggered, intensity);
+
+    auto rangeIterators = actionTypeToActionMap.equal_range(actionType);
+    for(auto itAction = rangeIterators.first; itAction != rangeIterators.second; ++itAction)
+        if(itAction->second.isEnabled)
+            itAction->second.function(triggered, intensity);
+}
+
+void Input::setDispatchListener(DispatchListener listener)
+{
+    dispatchListener = listener;
+}
+
 void Input::setMouseLock(bool mouseLock)
 {
     if(mouseLock != isMouseLocked)
     {
-        mouseLockCallback(mouseLock);
+        // There is no window to lock the mouse to when running headless
+        if(mouseLockCallback)
+            mouseLockCallback(mouseLock);
+
         isMouseLocked = mouseLock;
     }
 }
@@ -86,6 +86,10 @@ namespace Engine
 	class Input
 	{
 	public:
+		/**
+		 * Called for every action fired by fireBindings() or fireAction()
+		 */
+		typedef std::function<void(ActionType /*actionType*/, bool /*triggered*/, float /*intensity*/)> DispatchListener;
 
         static const int NUM_KEYS = 349;
         static const int NUM_MOUSEBUTTONS = 8;
@@ -115,6 +119,16 @@ namespace Engine
 		static bool RemoveAction(ActionType actionType, Action* action);
 		static void clearActions();
 		static void fireBindings();
+
+		/**
+		 * Calls all enabled actions of the given type, just like a bound key would. Used to replay recorded input.
+		 */
+		static void fireAction(ActionType actionType, bool triggered, float intensity);
+
+		/**
+		 * Sets a function to be notified of every fired action, or clears it when passing an empty function
+		 */
+		static void setDispatchListener(DispatchListener listener);
 		static void setMouseLock(bool mouseLock);
 		static Math::float2 getMouseCoordinates();
 		static void getMouseState(MouseState& ms);
@@ -157,6 +171,7 @@ namespace Engine
 		static Math::float2 mousePosition;
 		static bool isMouseLocked;
 		static std::function<void(bool /* lock */)> mouseLockCallback;
+		static DispatchListener dispatchListener;
 		static float windowHalfWidth;
 		static float windowHalfHeight;
 	};
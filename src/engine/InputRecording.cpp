@@ -0,0 +1,385 @@
+#include "InputRecording.h"
+#include <fstream>
+#include <cstring>
+#include <algorithm>
+#include <limits>
+#include <engine/GameEngine.h>
+#include <engine/World.h>
+#include <engine/Savegame.h>
+#include <utils/logger.h>
+
+using namespace Engine;
+
+namespace
+{
+    const uint8_t MAGIC[4] = {'R', 'G', 'I', 'R'};
+    const uint16_t REPEAT_ACTIONS = 0xFFFF;
+    const uint8_t TRIGGERED_BIT = 0x80;
+
+    class Writer
+    {
+    public:
+        Writer(std::vector<uint8_t>& out) : m_Out(out){}
+
+        void u8(uint8_t v){ m_Out.push_back(v); }
+
+        void u16(uint16_t v)
+        {
+            m_Out.push_back(static_cast<uint8_t>(v));
+            m_Out.push_back(static_cast<uint8_t>(v >> 8));
+        }
+
+        void u32(uint32_t v)
+        {
+            for(int i=0;i<4;i++)
+                m_Out.push_back(static_cast<uint8_t>(v >> (i * 8)));
+        }
+
+        void f32(float v)
+        {
+            uint32_t u;
+            memcpy(&u, &v, sizeof(u));
+            u32(u);
+        }
+
+        void str(const std::string& s)
+        {
+            u32(static_cast<uint32_t>(s.size()));
+            m_Out.insert(m_Out.end(), s.begin(), s.end());
+        }
+
+    private:
+        std::vector<uint8_t>& m_Out;
+    };
+
+    class Reader
+    {
+    public:
+        Reader(const std::vector<uint8_t>& data) : m_Data(data), m_Pos(0), m_Failed(false){}
+
+        bool failed() const { return m_Failed; }
+
+        uint8_t u8()
+        {
+            if(!require(1))
+                return 0;
+
+            return m_Data[m_Pos++];
+        }
+
+        uint16_t u16()
+        {
+            if(!require(2))
+                return 0;
+
+            uint16_t v = static_cast<uint16_t>(m_Data[m_Pos] | (m_Data[m_Pos + 1] << 8));
+            m_Pos += 2;
+            return v;
+        }
+
+        uint32_t u32()
+        {
+            if(!require(4))
+                return 0;
+
+            uint32_t v = 0;
+            for(int i=0;i<4;i++)
+                v |= static_cast<uint32_t>(m_Data[m_Pos++]) << (i * 8);
+
+            return v;
+        }
+
+        float f32()
+        {
+            uint32_t u = u32();
+            float v;
+            memcpy(&v, &u, sizeof(v));
+            return v;
+        }
+
+        std::string str()
+        {
+            uint32_t size = u32();
+            if(!require(size))
+                return std::string();
+
+            std::string s(m_Data.begin() + m_Pos, m_Data.begin() + m_Pos + size);
+            m_Pos += size;
+            return s;
+        }
+
+    private:
+        bool require(size_t size)
+        {
+            if(m_Failed || m_Data.size() - m_Pos < size)
+                m_Failed = true;
+
+            return !m_Failed;
+        }
+
+        const std::vector<uint8_t>& m_Data;
+        size_t m_Pos;
+        bool m_Failed;
+    };
+}
+
+bool InputRecording::getHeroPosition(GameEngine& engine, Math::float3& out)
+{
+    if(!engine.getMainWorld().isValid())
+        return false;
+
+    World::WorldInstance& world = engine.getMainWorld().get();
+    Handle::EntityHandle hero = world.getScriptEngine().getPlayerEntity();
+
+    if(!hero.isValid())
+        return false;
+
+    out = world.getEntity<Components::PositionComponent>(hero).m_WorldMatrix.Translation();
+    return true;
+}
+
+bool InputRecording::saveToFile(const Recording& recording, const std::string& file)
+{
+    std::vector<uint8_t> data;
+    Writer w(data);
+
+    w.u8(MAGIC[0]); w.u8(MAGIC[1]); w.u8(MAGIC[2]); w.u8(MAGIC[3]);
+    w.u32(VERSION);
+    w.str(recording.world);
+    w.u32(recording.seed);
+    w.u32(static_cast<uint32_t>(recording.frames.size()));
+
+    const Frame* last = nullptr;
+    for(const Frame& f : recording.frames)
+    {
+        w.f32(f.deltaTime);
+
+        if(last && last->firstAction == f.firstAction && last->numActions == f.numActions)
+        {
+            w.u16(REPEAT_ACTIONS);
+        }
+        else
+        {
+            if(f.numActions >= REPEAT_ACTIONS)
+            {
+                LogError() << "InputRecording: Too many actions in a single frame: " << f.numActions;
+                return false;
+            }
+
+            w.u16(static_cast<uint16_t>(f.numActions));
+
+            for(uint32_t i = f.firstAction; i < f.firstAction + f.numActions; i++)
+            {
+                const RecordedAction& a = recording.actions[i];
+                w.u8(static_cast<uint8_t>(a.actionType) | (a.triggered ? TRIGGERED_BIT : 0));
+                w.f32(a.intensity);
+            }
+        }
+
+        last = &f;
+    }
+
+    w.u32(static_cast<uint32_t>(recording.checkpoints.size()));
+    for(const Checkpoint& c : recording.checkpoints)
+    {
+        w.u32(c.frame);
+        w.f32(c.heroPosition.x);
+        w.f32(c.heroPosition.y);
+        w.f32(c.heroPosition.z);
+    }
+
+    return Savegame::writeFileAtomic(data, file);
+}
+
+bool InputRecording::loadFromFile(const std::string& file, Recording& out)
+{
+    std::ifstream f(file, std::ios::binary);
+
+    if(!f.is_open())
+        return false;
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    Reader r(data);
+
+    uint8_t magic[4] = {r.u8(), r.u8(), r.u8(), r.u8()};
+    if(memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || r.u32() > VERSION)
+        return false;
+
+    out = Recording();
+    out.world = r.str();
+    out.seed = r.u32();
+
+    uint32_t numFrames = r.u32();
+    for(uint32_t i = 0; i < numFrames && !r.failed(); i++)
+    {
+        Frame frame;
+        frame.deltaTime = r.f32();
+
+        uint16_t numActions = r.u16();
+        if(numActions == REPEAT_ACTIONS)
+        {
+            if(out.frames.empty())
+                return false;
+
+            frame.firstAction = out.frames.back().firstAction;
+            frame.numActions = out.frames.back().numActions;
+        }
+        else
+        {
+            frame.firstAction = static_cast<uint32_t>(out.actions.size());
+            frame.numActions = numActions;
+
+            for(uint16_t j = 0; j < numActions && !r.failed(); j++)
+            {
+                uint8_t type = r.u8();
+
+                RecordedAction a;
+                a.actionType = static_cast<ActionType>(type & ~TRIGGERED_BIT);
+                a.triggered = (type & TRIGGERED_BIT) != 0;
+                a.intensity = r.f32();
+
+                if(a.actionType >= ActionType::Count)
+                    return false;
+
+                out.actions.push_back(a);
+            }
+        }
+
+        out.frames.push_back(frame);
+    }
+
+    uint32_t numCheckpoints = r.u32();
+    for(uint32_t i = 0; i < numCheckpoints && !r.failed(); i++)
+    {
+        Checkpoint c;
+        c.frame = r.u32();
+        c.heroPosition.x = r.f32();
+        c.heroPosition.y = r.f32();
+        c.heroPosition.z = r.f32();
+
+        out.checkpoints.push_back(c);
+    }
+
+    return !r.failed();
+}
+
+InputRecording::Recorder::Recorder() :
+        m_IsRecording(false),
+        m_FrameStart(0)
+{
+}
+
+InputRecording::Recorder::~Recorder()
+{
+    stop();
+}
+
+void InputRecording::Recorder::start(const std::string& world, uint32_t seed)
+{
+    stop();
+
+    m_Recording = Recording();
+    m_Recording.world = world;
+    m_Recording.seed = seed;
+    m_FrameStart = 0;
+    m_IsRecording = true;
+
+    Input::setDispatchListener([this](ActionType actionType, bool triggered, float intensity){
+        m_Recording.actions.push_back({actionType, triggered, intensity});
+    });
+}
+
+void InputRecording::Recorder::stop()
+{
+    if(!m_IsRecording)
+        return;
+
+    Input::setDispatchListener(Input::DispatchListener());
+    m_IsRecording = false;
+}
+
+void InputRecording::Recorder::onFrameEnd(float deltaTime, GameEngine& engine)
+{
+    if(!m_IsRecording)
+        return;
+
+    std::vector<RecordedAction>& actions = m_Recording.actions;
+
+    Frame frame;
+    frame.deltaTime = deltaTime;
+    frame.firstAction = m_FrameStart;
+    frame.numActions = static_cast<uint32_t>(actions.size()) - m_FrameStart;
+
+    // Most frames fire the same actions as the one before, share them instead
+    if(!m_Recording.frames.empty())
+    {
+        const Frame& last = m_Recording.frames.back();
+
+        if(last.numActions == frame.numActions
+           && std::equal(actions.begin() + last.firstAction, actions.begin() + last.firstAction + last.numActions,
+                         actions.begin() + frame.firstAction))
+        {
+            actions.resize(frame.firstAction);
+            frame.firstAction = last.firstAction;
+        }
+    }
+
+    m_Recording.frames.push_back(frame);
+    m_FrameStart = static_cast<uint32_t>(actions.size());
+
+    Math::float3 hero;
+    if(m_Recording.frames.size() % CHECKPOINT_INTERVAL == 0 && getHeroPosition(engine, hero))
+        m_Recording.checkpoints.push_back({static_cast<uint32_t>(m_Recording.frames.size() - 1), hero});
+}
+
+InputRecording::Player::Player(const Recording& recording) :
+        m_Recording(recording),
+        m_Frame(0),
+        m_NextCheckpoint(0),
+        m_NumChecked(0),
+        m_NumDrifted(0),
+        m_MaxDrift(0.0f)
+{
+}
+
+float InputRecording::Player::beginFrame()
+{
+    const Frame& frame = m_Recording.frames[m_Frame];
+
+    for(uint32_t i = frame.firstAction; i < frame.firstAction + frame.numActions; i++)
+    {
+        const RecordedAction& a = m_Recording.actions[i];
+        Input::fireAction(a.actionType, a.triggered, a.intensity);
+    }
+
+    return frame.deltaTime;
+}
+
+void InputRecording::Player::endFrame(GameEngine& engine)
+{
+    // Skip checkpoints of frames which weren't played, in case the recording is broken
+    while(m_NextCheckpoint < m_Recording.checkpoints.size() && m_Recording.checkpoints[m_NextCheckpoint].frame < m_Frame)
+        m_NextCheckpoint++;
+
+    if(m_NextCheckpoint < m_Recording.checkpoints.size() && m_Recording.checkpoints[m_NextCheckpoint].frame == m_Frame)
+    {
+        const Checkpoint& c = m_Recording.checkpoints[m_NextCheckpoint++];
+
+        Math::float3 hero;
+        float drift = getHeroPosition(engine, hero) ? (hero - c.heroPosition).length() : std::numeric_limits<float>::infinity();
+
+        m_NumChecked++;
+        m_MaxDrift = std::max(m_MaxDrift, drift);
+
+        if(drift > DRIFT_TOLERANCE)
+        {
+            // Only report the first one, everything after that is most likely off as well
+            if(m_NumDrifted == 0)
+                LogWarn() << "InputRecording: Replay drifted from the recording by " << drift << "m at frame " << m_Frame;
+
+            m_NumDrifted++;
+        }
+    }
+
+    m_Frame++;
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include "Input.h"
+
+namespace Engine
+{
+    class GameEngine;
+
+    /**
+     * Recording and replaying of input, so a walkthrough can be re-run frame by frame as benchmark.
+     *
+     * Instead of raw key-presses, the actions fired by Input are stored, together with the delta-time each frame
+     * was simulated with. Replaying them in the same order on a freshly loaded world with the same random-seed
+     * drives the game the same way again. Every CHECKPOINT_INTERVAL frames, the position of the hero is stored
+     * as well, so a replay can tell when it went a different way than the recording did.
+     *
+     * File-format:
+     *   Header:     "RGIR", uint32 version, string world, uint32 seed, uint32 number of frames
+     *   Frame:      float32 delta-time, uint16 number of actions (REPEAT_ACTIONS: same actions as last frame), actions
+     *   Action:     uint8 action-type (highest bit: triggered), float32 intensity
+     *   Checkpoints: uint32 count, (uint32 frame, 3x float32 hero-position)
+     * Strings are stored as uint32 length and characters, all numbers in little-endian.
+     */
+    namespace InputRecording
+    {
+        const uint32_t VERSION = 1;
+        const uint32_t CHECKPOINT_INTERVAL = 60;
+
+        /**
+         * AI-ticks per frame the world is recorded and replayed with. The time-budget of the AI-scheduler would
+         * tick different NPCs on a different machine, so a fixed number is used instead.
+         */
+        const uint32_t AI_TICKS_PER_FRAME = 16;
+
+        /**
+         * Hero-positions further apart than this (in meters) from the recorded ones count as drift
+         */
+        const float DRIFT_TOLERANCE = 0.1f;
+
+        struct RecordedAction
+        {
+            ActionType actionType;
+            bool triggered;
+            float intensity;
+
+            bool operator==(const RecordedAction& o) const
+            {
+                return actionType == o.actionType && triggered == o.triggered && intensity == o.intensity;
+            }
+        };
+
+        struct Frame
+        {
+            float deltaTime;
+
+            /**
+             * Range inside Recording::actions. Frames firing the same actions as the one before share the range.
+             */
+            uint32_t firstAction;
+            uint32_t numActions;
+        };
+
+        struct Checkpoint
+        {
+            uint32_t frame; // Checked after this frame was simulated
+            Math::float3 heroPosition;
+        };
+
+        struct Recording
+        {
+            std::string world;
+            uint32_t seed = 0;
+            std::vector<Frame> frames;
+            std::vector<RecordedAction> actions;
+            std::vector<Checkpoint> checkpoints;
+        };
+
+        /**
+         * @return Whether the main-world has a hero. Writes its position to out, if so.
+         */
+        bool getHeroPosition(GameEngine& engine, Math::float3& out);
+
+        bool saveToFile(const Recording& recording, const std::string& file);
+        bool loadFromFile(const std::string& file, Recording& out);
+
+        /**
+         * Listens to the actions fired by Input and collects them into frames
+         */
+        class Recorder
+        {
+        public:
+            Recorder();
+            ~Recorder();
+
+            /**
+             * Starts a new recording. The caller is responsible for seeding the random-generator
+             * with the given seed and for starting on a freshly loaded world.
+             */
+            void start(const std::string& world, uint32_t seed);
+
+            /**
+             * Stops listening to Input. The recording stays available.
+             */
+            void stop();
+
+            bool isRecording() const { return m_IsRecording; }
+
+            /**
+             * To be called after each engine-update with the delta-time it was run with.
+             * Everything fired since the last call is stored as one frame.
+             */
+            void onFrameEnd(float deltaTime, GameEngine& engine);
+
+            const Recording& getRecording() const { return m_Recording; }
+
+        private:
+            Recording m_Recording;
+            bool m_IsRecording;
+
+            /**
+             * Index of the first action fired this frame
+             */
+            uint32_t m_FrameStart;
+        };
+
+        /**
+         * Feeds a recording back into Input, frame by frame
+         */
+        class Player
+        {
+        public:
+            Player(const Recording& recording);
+
+            /**
+             * @return Whether all frames were played
+             */
+            bool isDone() const { return m_Frame >= m_Recording.frames.size(); }
+
+            /**
+             * Fires the actions of the next frame
+             * @return Delta-time to run the engine-update of this frame with
+             */
+            float beginFrame();
+
+            /**
+             * Compares the hero-position against the recording, if there is a checkpoint for the frame just played.
+             * To be called after the engine-update.
+             */
+            void endFrame(GameEngine& engine);
+
+            size_t getNumCheckedCheckpoints() const { return m_NumChecked; }
+            size_t getNumDriftedCheckpoints() const { return m_NumDrifted; }
+
+            /**
+             * @return Largest distance between a recorded and a replayed hero-position
+             */
+            float getMaxDrift() const { return m_MaxDrift; }
+
+        private:
+            const Recording& m_Recording;
+            size_t m_Frame;
+            size_t m_NextCheckpoint;
+            size_t m_NumChecked;
+            size_t m_NumDrifted;
+            float m_MaxDrift;
+        };
+    }
+}
@@ -0,0 +1,1142 @@
+#include "LoadBenchmark.h"
+#include "BaseEngine.h"
+#include <random>
+#include <algorithm>
+#include <memory>
+#include <set>
+#include <functional>
+#include <vdfs/fileIndex.h>
+#include <utils/logger.h>
+#include <ui/PrintScreenMessages.h>
+#include <memory/VirtualMemory.h>
+#include <bx/timer.h>
+#include <list>
+#include <logic/messages/EventMessageQueue.h>
+#include <memory/SizeClassPool.h>
+#include <utils/Name.h>
+#include <map>
+#include <unordered_map>
+#include <components/VobClasses.h>
+#include <logic/Controller.h>
+#include <logic/RoutineScheduler.h>
+
+using namespace Engine;
+
+namespace
+{
+    /**
+     * Runs T::init on every component of the given entity, like creating an entity did with the bundled layout
+     */
+    template<typename... T>
+    void initBundledComponents(Components::BundledComponentAllocator& alloc, Handle::EntityHandle h)
+    {
+        int unused[] = {0, (T::init(alloc.getElement<T>(h)), 0)...};
+        (void)unused;
+    }
+
+    /**
+     * Components used by the n-th entity of the benchmark-mix
+     */
+    Components::ComponentMask getLayoutBenchmarkMask(size_t n)
+    {
+        using namespace Components;
+
+        switch(n % 20)
+        {
+            case 0: // NPC
+                return PositionComponent::MASK | VisualComponent::MASK | StaticMeshComponent::MASK | BBoxComponent::MASK
+                       | ObjectComponent::MASK | LogicComponent::MASK | AnimationComponent::MASK
+                       | PhysicsComponent::MASK | CompoundComponent::MASK;
+
+            case 1: case 2: case 3: case 4: case 5: // Vob
+                return PositionComponent::MASK | VisualComponent::MASK | StaticMeshComponent::MASK | BBoxComponent::MASK
+                       | ObjectComponent::MASK | PhysicsComponent::MASK;
+
+            default: // Part of the world-mesh
+                return PositionComponent::MASK | StaticMeshComponent::MASK;
+        }
+    }
+
+    /**
+     * Touches the components set in the mask, so they exist in the sparse layout
+     */
+    template<typename A>
+    void touchLayoutBenchmarkComponents(A& alloc, Handle::EntityHandle h, Components::ComponentMask mask)
+    {
+        using namespace Components;
+
+        alloc.template getElement<EntityComponent>(h).m_ComponentMask = mask;
+        alloc.template getElement<PositionComponent>(h).m_WorldMatrix.Translation(Math::float3(1.0f, 2.0f, 3.0f));
+        alloc.template getElement<StaticMeshComponent>(h).m_Color = 0xFFFFFFFF;
+
+        if(mask & VisualComponent::MASK) alloc.template getElement<VisualComponent>(h);
+        if(mask & BBoxComponent::MASK) alloc.template getElement<BBoxComponent>(h);
+        if(mask & ObjectComponent::MASK) alloc.template getElement<ObjectComponent>(h);
+        if(mask & LogicComponent::MASK) alloc.template getElement<LogicComponent>(h);
+        if(mask & AnimationComponent::MASK) alloc.template getElement<AnimationComponent>(h);
+        if(mask & PhysicsComponent::MASK) alloc.template getElement<PhysicsComponent>(h);
+        if(mask & CompoundComponent::MASK) alloc.template getElement<CompoundComponent>(h);
+    }
+
+    /**
+     * Creates a copy of the given message, either from the message-pool or from the heap
+     */
+    template<bool POOLED, typename T>
+    Logic::EventMessages::EventMessage* copyStormMessage(const T& msg)
+    {
+        return POOLED ? new T(msg) : ::new T(msg);
+    }
+
+    template<bool POOLED>
+    void deleteStormMessage(Logic::EventMessages::EventMessage* msg)
+    {
+        if(POOLED)
+            delete msg;
+        else
+            ::delete msg;
+    }
+
+    /**
+     * Makes the n-th message of the storm. Strings are kept short, so they don't allocate on their own.
+     */
+    template<bool POOLED>
+    Logic::EventMessages::EventMessage* makeStormMessage(size_t n)
+    {
+        using namespace Logic::EventMessages;
+
+        switch(n % 4)
+        {
+            case 0:
+            {
+                ConversationMessage msg;
+                msg.subType = ConversationMessage::ST_PlayAni;
+                msg.animation = "T_STAND";
+                return copyStormMessage<POOLED>(msg);
+            }
+
+            case 1:
+            {
+                MovementMessage msg;
+                msg.subType = MovementMessage::ST_GotoPos;
+                return copyStormMessage<POOLED>(msg);
+            }
+
+            case 2:
+            {
+                StateMessage msg;
+                msg.subType = StateMessage::EV_Wait;
+                msg.waitTime = 1.0f;
+                return copyStormMessage<POOLED>(msg);
+            }
+
+            default:
+            {
+                MobMessage msg;
+                msg.subType = MobMessage::ST_STARTINTERACTION;
+                msg.isOverlay = true;
+                return copyStormMessage<POOLED>(msg);
+            }
+        }
+    }
+
+    /**
+     * Fills the given vob with a random position and bounding-box
+     */
+    void randomizeVob(ZenLoad::zCVobData& v, std::mt19937& rng)
+    {
+        std::uniform_real_distribution<float> pos(-10000.0f, 10000.0f); // Centimeters, like in the ZEN
+        std::uniform_real_distribution<float> height(-500.0f, 500.0f);
+        std::uniform_real_distribution<float> size(20.0f, 400.0f);
+
+        float x = pos(rng);
+        float y = height(rng);
+        float z = pos(rng);
+        float s = size(rng);
+
+        for(int i=0;i<16;i++)
+            v.worldMatrix.mv[i] = (i % 5 == 0) ? 1.0f : 0.0f;
+
+        v.worldMatrix.mv[12] = x;
+        v.worldMatrix.mv[13] = y;
+        v.worldMatrix.mv[14] = z;
+
+        v.position.x = x;
+        v.position.y = y;
+        v.position.z = z;
+
+        v.bbox[0].x = x - s;
+        v.bbox[0].y = y - s;
+        v.bbox[0].z = z - s;
+        v.bbox[1].x = x + s;
+        v.bbox[1].y = y + s;
+        v.bbox[1].z = z + s;
+    }
+}
+
+std::vector<ZenLoad::zCVobData> LoadBenchmark::makeSyntheticVobTree(size_t numVobs,
+                                                                    const std::vector<std::string>& visuals,
+                                                                    uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::uniform_int_distribution<int> numChildren(0, 3);
+
+    std::vector<ZenLoad::zCVobData> roots;
+    size_t created = 0;
+
+    // Like in real worlds, most vobs are roots and some have a couple of children attached
+    while(created < numVobs)
+    {
+        roots.emplace_back();
+        ZenLoad::zCVobData& root = roots.back();
+        created++;
+
+        size_t nc = std::min(static_cast<size_t>(numChildren(rng)), numVobs - created);
+        root.childVobs.resize(nc);
+        created += nc;
+    }
+
+    size_t i = 0;
+    std::function<void(ZenLoad::zCVobData&)> fill = [&](ZenLoad::zCVobData& v)
+    {
+        randomizeVob(v, rng);
+
+        v.cdDyn = true;
+
+        if(i % 3 == 2 || visuals.empty())
+        {
+            v.objectClass = "zCVobSpot:zCVob";
+            v.vobName = "FP_BENCH_" + std::to_string(i);
+        }
+        else
+        {
+            v.objectClass = "zCVob";
+            v.visual = visuals[rng() % visuals.size()];
+        }
+
+        i++;
+
+        for(ZenLoad::zCVobData& c : v.childVobs)
+            fill(c);
+    };
+
+    for(ZenLoad::zCVobData& v : roots)
+        fill(v);
+
+    return roots;
+}
+
+std::vector<std::string> LoadBenchmark::findStaticVisuals(BaseEngine& engine, size_t maxNum)
+{
+    std::vector<std::string> visuals;
+
+    for(auto& f : engine.getVDFSIndex().getKnownFiles())
+    {
+        // Compiled static meshes. The loader maps the .3DS-name back to these.
+        size_t ext = f.fileName.find(".MRM");
+        if(ext != std::string::npos)
+            visuals.push_back(f.fileName.substr(0, ext) + ".3DS");
+    }
+
+    // Keep this deterministic, no matter how the archives were ordered
+    std::sort(visuals.begin(), visuals.end());
+
+    if(visuals.size() > maxNum)
+        visuals.resize(maxNum);
+
+    return visuals;
+}
+
+World::WorldInstance::VobLoadStats LoadBenchmark::run(BaseEngine& engine, size_t numVobs, size_t numVisuals, uint32_t seed)
+{
+    std::vector<std::string> visuals = findStaticVisuals(engine, numVisuals);
+    std::vector<ZenLoad::zCVobData> tree = makeSyntheticVobTree(numVobs, visuals, seed);
+
+    LogInfo() << "Load-benchmark: " << numVobs << " vobs using " << visuals.size() << " visuals (seed " << seed << ")";
+
+    // Worlds are too big for the stack
+    std::unique_ptr<World::WorldInstance> world(new World::WorldInstance);
+    world->init(engine);
+
+    // Static collision needs to be in place for the traces, even if there is no worldmesh
+    world->getPhysicsSystem().postProcessLoad();
+
+    World::WorldInstance::VobLoadStats stats = world->insertVobs(tree);
+
+    // Would be drawn otherwise
+    engine.getRootUIView().removeChild(&world->getPrintScreenManager());
+
+    return stats;
+}
+
+LoadBenchmark::ConstructionStats LoadBenchmark::measureWorldConstruction(size_t numWorlds)
+{
+    const double freq = double(bx::getHPFrequency());
+
+    ConstructionStats stats;
+    stats.numWorlds = numWorlds;
+    stats.committedEntityStorage = 0;
+    stats.rssBefore = Memory::VirtualMemory::getResidentSetSize();
+
+    std::vector<std::unique_ptr<World::WorldInstance>> worlds;
+
+    int64_t start = bx::getHPCounter();
+    for(size_t i = 0; i < numWorlds; i++)
+        worlds.emplace_back(new World::WorldInstance);
+
+    stats.timeConstruct = (bx::getHPCounter() - start) / freq;
+    stats.rssAfter = Memory::VirtualMemory::getResidentSetSize();
+
+    for(auto& w : worlds)
+        stats.committedEntityStorage += w->getComponentAllocator().getNumCommittedBytes()
+                                        + w->getPhysicsSystem().getNumCommittedBytes();
+
+    start = bx::getHPCounter();
+    worlds.clear();
+    stats.timeDestruct = (bx::getHPCounter() - start) / freq;
+
+    LogInfo() << "World-construction: " << numWorlds << " worlds in " << stats.timeConstruct * 1000.0 << "ms"
+              << " (destruction: " << stats.timeDestruct * 1000.0 << "ms)"
+              << ", RSS +" << (stats.rssAfter - stats.rssBefore) / 1024 << "KB"
+              << ", entity-storage committed: " << stats.committedEntityStorage / 1024 << "KB";
+
+    return stats;
+}
+
+LoadBenchmark::RemovalStats LoadBenchmark::measureEntityRemoval(BaseEngine& engine, size_t numEntities, uint32_t seed)
+{
+    const double freq = double(bx::getHPFrequency());
+
+    RemovalStats stats;
+    stats.numEntities = numEntities;
+
+    std::unique_ptr<World::WorldInstance> world(new World::WorldInstance);
+    world->init(engine);
+    engine.getRootUIView().removeChild(&world->getPrintScreenManager());
+
+    std::vector<Handle::EntityHandle> entities;
+    entities.reserve(numEntities);
+
+    int64_t start = bx::getHPCounter();
+    for(size_t i = 0; i < numEntities; i++)
+    {
+        Handle::EntityHandle e = world->addEntity(Components::ObjectComponent::MASK
+                                                  | Components::NBBoxComponent::MASK
+                                                  | Components::CompoundComponent::MASK);
+
+        // Names are interned and never freed, so don't flood the table
+        world->getEntity<Components::ObjectComponent>(e).m_Name = Utils::Name("BENCHMARK_ENTITY_" + std::to_string(i % 64));
+        world->getEntity<Components::NBBoxComponent>(e).m_BBox3D.resize(8);
+        world->getEntity<Components::CompoundComponent>(e).m_Attachments.resize(4);
+
+        entities.push_back(e);
+    }
+    stats.timeCreate = (bx::getHPCounter() - start) / freq;
+
+    // Despawn a random half
+    std::vector<Handle::EntityHandle> wave = entities;
+    std::shuffle(wave.begin(), wave.end(), std::mt19937(seed));
+    wave.resize(wave.size() / 2);
+
+    std::set<Handle::EntityHandle> despawned(wave.begin(), wave.end());
+
+    start = bx::getHPCounter();
+    for(Handle::EntityHandle e : wave)
+        world->removeEntity(e);
+    stats.timeDespawnWave = (bx::getHPCounter() - start) / freq;
+
+    // Unload the rest
+    start = bx::getHPCounter();
+    for(Handle::EntityHandle e : entities)
+    {
+        if(despawned.find(e) == despawned.end())
+            world->removeEntity(e);
+    }
+    stats.timeUnload = (bx::getHPCounter() - start) / freq;
+
+    stats.committedAfter = world->getComponentAllocator().getNumCommittedBytes();
+
+    LogInfo() << "Entity-removal: " << numEntities << " entities, create " << stats.timeCreate * 1000.0 << "ms"
+              << ", despawn-wave of " << wave.size() << ": " << stats.timeDespawnWave * 1000.0 << "ms"
+              << ", unload of the rest: " << stats.timeUnload * 1000.0 << "ms"
+              << ", still committed: " << stats.committedAfter / 1024 << "KB";
+
+    return stats;
+}
+
+LoadBenchmark::LayoutStats LoadBenchmark::measureComponentLayouts(size_t numEntities)
+{
+    using namespace Components;
+
+    const double freq = double(bx::getHPFrequency());
+
+    LayoutStats stats;
+    stats.numEntities = numEntities;
+
+    // Way too big for the stack
+    std::unique_ptr<BundledComponentAllocator> bundled(new BundledComponentAllocator);
+    std::unique_ptr<ComponentAllocator> sparse(new ComponentAllocator);
+
+    int64_t start = bx::getHPCounter();
+    for(size_t i = 0; i < numEntities; i++)
+    {
+        Handle::EntityHandle h = bundled->createObject();
+        initBundledComponents<ALL_COMPONENTS>(*bundled, h);
+        touchLayoutBenchmarkComponents(*bundled, h, getLayoutBenchmarkMask(i));
+    }
+    stats.timeCreateBundled = (bx::getHPCounter() - start) / freq;
+
+    start = bx::getHPCounter();
+    for(size_t i = 0; i < numEntities; i++)
+    {
+        Handle::EntityHandle h = sparse->createObject();
+        touchLayoutBenchmarkComponents(*sparse, h, getLayoutBenchmarkMask(i));
+    }
+    stats.timeCreateSparse = (bx::getHPCounter() - start) / freq;
+
+    stats.committedBundled = bundled->getNumCommittedBytes();
+    stats.committedSparse = sparse->getNumCommittedBytes();
+
+    // Render-like pass: Position and color of everything with a static mesh
+    Math::float3 sumBundled(0.0f, 0.0f, 0.0f);
+    uint32_t colorsBundled = 0;
+
+    start = bx::getHPCounter();
+    {
+        EntityComponent* ents = bundled->getElements<EntityComponent>();
+        PositionComponent* psc = bundled->getElements<PositionComponent>();
+        StaticMeshComponent* sms = bundled->getElements<StaticMeshComponent>();
+        size_t num = bundled->getNumObtainedElements();
+
+        for(size_t i = 0; i < num; i++)
+        {
+            if((ents[i].m_ComponentMask & StaticMeshComponent::MASK) == 0)
+                continue;
+
+            sumBundled += psc[i].m_WorldMatrix.Translation();
+            colorsBundled ^= sms[i].m_Color;
+        }
+    }
+    stats.timeIterateBundled = (bx::getHPCounter() - start) / freq;
+
+    Math::float3 sumSparse(0.0f, 0.0f, 0.0f);
+    uint32_t colorsSparse = 0;
+
+    start = bx::getHPCounter();
+    {
+        StaticMeshComponent* sms = sparse->getElements<StaticMeshComponent>();
+        const Handle::EntityHandle* owners = sparse->getOwners<StaticMeshComponent>();
+        size_t num = sparse->getNumElements<StaticMeshComponent>();
+
+        for(size_t i = 0; i < num; i++)
+        {
+            PositionComponent* psc = sparse->tryGetElement<PositionComponent>(owners[i]);
+            if(psc)
+                sumSparse += psc->m_WorldMatrix.Translation();
+
+            colorsSparse ^= sms[i].m_Color;
+        }
+    }
+    stats.timeIterateSparse = (bx::getHPCounter() - start) / freq;
+
+    // Keeps the compiler from throwing the loops away
+    if(colorsBundled != colorsSparse || (sumBundled - sumSparse).lengthSquared() > 1.0f)
+        LogWarn() << "Component-layouts: Iteration results differ!";
+
+    LogInfo() << "Component-layouts: " << numEntities << " entities"
+              << ", bundled: " << stats.committedBundled / 1024 << "KB"
+              << " (create " << stats.timeCreateBundled * 1000.0 << "ms, iterate " << stats.timeIterateBundled * 1000.0 << "ms)"
+              << ", sparse: " << stats.committedSparse / 1024 << "KB"
+              << " (create " << stats.timeCreateSparse * 1000.0 << "ms, iterate " << stats.timeIterateSparse * 1000.0 << "ms)";
+
+    return stats;
+}
+
+std::vector<LoadBenchmark::QueryStats> LoadBenchmark::measureQueries(World::WorldInstance& world, size_t numPasses)
+{
+    using namespace Components;
+
+    const double freq = double(bx::getHPFrequency());
+    const ComponentMask masks[] = {LogicComponent::MASK,
+                                   AnimationComponent::MASK,
+                                   PhysicsComponent::MASK,
+                                   BBoxComponent::MASK,
+                                   LogicComponent::MASK | AnimationComponent::MASK};
+
+    ComponentAllocator& alloc = world.getComponentAllocator();
+    size_t numEntities = alloc.getNumObtainedElements();
+
+    std::vector<QueryStats> result;
+    for(ComponentMask mask : masks)
+    {
+        QueryStats stats;
+        stats.mask = mask;
+
+        // Registers the query, if no system did so yet
+        stats.numMatching = alloc.query(mask).size();
+
+        size_t touchedScan = 0;
+        int64_t start = bx::getHPCounter();
+        for(size_t p = 0; p < numPasses; p++)
+        {
+            EntityComponent* ents = alloc.getElements<EntityComponent>();
+            for(size_t i = 0; i < numEntities; i++)
+            {
+                if((ents[i].m_ComponentMask & mask) != mask)
+                    continue;
+
+                touchedScan += alloc.getElement<EntityComponent>(ents[i].m_ThisEntity).m_ThisEntity.index;
+            }
+        }
+        stats.timeScan = (bx::getHPCounter() - start) / freq;
+
+        size_t touchedQuery = 0;
+        start = bx::getHPCounter();
+        for(size_t p = 0; p < numPasses; p++)
+        {
+            for(Handle::EntityHandle h : alloc.query(mask))
+                touchedQuery += alloc.getElement<EntityComponent>(h).m_ThisEntity.index;
+        }
+        stats.timeQuery = (bx::getHPCounter() - start) / freq;
+
+        // Keeps the compiler from throwing the loops away
+        if(touchedScan != touchedQuery)
+            LogWarn() << "Query-benchmark: Mask " << mask << " doesn't match the scan!";
+
+        LogInfo() << "Query-benchmark: Mask " << mask << ": " << stats.numMatching << " of " << numEntities << " entities"
+                  << ", scan " << stats.timeScan * 1000.0 << "ms, query " << stats.timeQuery * 1000.0 << "ms"
+                  << " (" << numPasses << " passes)";
+
+        result.push_back(stats);
+    }
+
+    return result;
+}
+
+LoadBenchmark::AnimHandlerStats LoadBenchmark::measureAnimHandlers(size_t numHandlers, size_t numPasses)
+{
+    const double freq = double(bx::getHPFrequency());
+    const double deltaTime = 1.0 / 60.0;
+
+    AnimHandlerStats stats;
+    stats.numHandlers = numHandlers;
+    stats.numPasses = numPasses;
+
+    std::mt19937 rng(1);
+
+    // Scatter the handlers between other allocations of random size, like loading a world does
+    std::vector<std::unique_ptr<Components::AnimHandler>> scattered;
+    std::vector<std::unique_ptr<uint8_t[]>> filler;
+    std::uniform_int_distribution<size_t> fillerSize(64, 4096);
+    for(size_t i = 0; i < numHandlers; i++)
+    {
+        for(int j = 0; j < 4; j++)
+            filler.emplace_back(new uint8_t[fillerSize(rng)]);
+
+        scattered.emplace_back(new Components::AnimHandler);
+    }
+
+    // Entities don't come in allocation-order after they have been created and removed for a while
+    std::shuffle(scattered.begin(), scattered.end(), rng);
+
+    std::unique_ptr<World::WorldAllocators::AnimHandlerAllocator> pool(new World::WorldAllocators::AnimHandlerAllocator);
+    for(size_t i = 0; i < numHandlers; i++)
+        pool->createObject();
+
+    // Bigger than any cache
+    std::vector<uint8_t> flush(32 * 1024 * 1024);
+    auto flushCaches = [&](size_t pass)
+    {
+        std::fill(flush.begin(), flush.end(), static_cast<uint8_t>(pass));
+    };
+
+    size_t sumScattered = 0;
+    stats.timeScattered = 0.0;
+    for(size_t p = 0; p < numPasses; p++)
+    {
+        flushCaches(p);
+
+        int64_t start = bx::getHPCounter();
+        for(auto& h : scattered)
+        {
+            h->updateAnimations(deltaTime);
+            sumScattered += h->getNumNodes() + h->getAnimationStateHash();
+        }
+        stats.timeScattered += (bx::getHPCounter() - start) / freq;
+    }
+
+    size_t sumPooled = 0;
+    stats.timePooled = 0.0;
+    for(size_t p = 0; p < numPasses; p++)
+    {
+        flushCaches(p);
+
+        int64_t start = bx::getHPCounter();
+        Components::AnimHandler* handlers = pool->getElements();
+        for(size_t i = 0, num = pool->getNumObtainedElements(); i < num; i++)
+        {
+            handlers[i].updateAnimations(deltaTime);
+            sumPooled += handlers[i].getNumNodes() + handlers[i].getAnimationStateHash();
+        }
+        stats.timePooled += (bx::getHPCounter() - start) / freq;
+    }
+
+    // Keeps the compiler from throwing the loops away
+    if(sumScattered != sumPooled)
+        LogWarn() << "AnimHandler-benchmark: Results differ!";
+
+    LogInfo() << "AnimHandler-benchmark: " << numHandlers << " handlers, " << numPasses << " passes"
+              << ", scattered: " << stats.timeScattered * 1000.0 << "ms"
+              << ", pooled: " << stats.timePooled * 1000.0 << "ms";
+
+    return stats;
+}
+
+LoadBenchmark::MessageStormStats LoadBenchmark::measureMessageStorm(size_t numNpcs, size_t numFrames, size_t messagesPerFrame)
+{
+    using namespace Logic::EventMessages;
+
+    typedef std::function<void(Handle::EntityHandle, EventMessage*)> LegacyCallback;
+
+    const double freq = double(bx::getHPFrequency());
+
+    MessageStormStats stats;
+    stats.numMessages = numNpcs * numFrames * messagesPerFrame;
+    stats.numAllocationsLegacy = 0;
+
+    Handle::EntityHandle host;
+    host.index = 1;
+    host.generation = 1;
+
+    // How it used to be done
+    size_t calledLegacy = 0;
+    {
+        struct LegacyEntry
+        {
+            EventMessage* msg;
+            std::list<std::pair<Handle::EntityHandle, LegacyCallback>> onMessageDone;
+        };
+
+        std::vector<std::vector<LegacyEntry*>> queues(numNpcs);
+        std::mt19937 rng(1);
+        size_t n = 0;
+
+        int64_t start = bx::getHPCounter();
+        for(size_t f = 0; f < numFrames; f++)
+        {
+            for(auto& q : queues)
+            {
+                for(size_t m = 0; m < messagesPerFrame; m++, n++)
+                {
+                    LegacyEntry* e = new LegacyEntry;
+                    e->msg = makeStormMessage<false>(n);
+                    stats.numAllocationsLegacy += 2;
+
+                    if(n % 4 == 0)
+                    {
+                        // About the size of what the mob-controller captures
+                        e->onMessageDone.push_back(std::make_pair(host, LegacyCallback([&calledLegacy, host, n](Handle::EntityHandle h, EventMessage*){
+                            calledLegacy += (h == host) + n % 2;
+                        })));
+
+                        stats.numAllocationsLegacy++;
+                    }
+
+                    q.push_back(e);
+                }
+
+                // Random half is done
+                for(LegacyEntry* e : q)
+                    e->msg->deleted = e->msg->deleted || (rng() & 1);
+
+                for(auto it = q.begin(); it != q.end();)
+                {
+                    if((*it)->msg->deleted)
+                    {
+                        for(auto cb : (*it)->onMessageDone)
+                            cb.second(cb.first, (*it)->msg);
+
+                        deleteStormMessage<false>((*it)->msg);
+                        delete (*it);
+                        it = q.erase(it);
+                    }
+                    else
+                    {
+                        it++;
+                    }
+                }
+            }
+        }
+
+        for(auto& q : queues)
+        {
+            for(LegacyEntry* e : q)
+            {
+                deleteStormMessage<false>(e->msg);
+                delete e;
+            }
+        }
+
+        stats.timeLegacy = (bx::getHPCounter() - start) / freq;
+    }
+
+    // Pooled messages and the intrusive queue
+    size_t calledPooled = 0;
+    {
+        Memory::SizeClassPool::Stats poolBefore = getMessagePool().getStats();
+
+        std::vector<std::unique_ptr<EventMessageQueue>> queues;
+        for(size_t i = 0; i < numNpcs; i++)
+            queues.emplace_back(new EventMessageQueue);
+
+        std::mt19937 rng(1);
+        size_t n = 0;
+
+        int64_t start = bx::getHPCounter();
+        for(size_t f = 0; f < numFrames; f++)
+        {
+            for(auto& qp : queues)
+            {
+                EventMessageQueue& q = *qp;
+
+                for(size_t m = 0; m < messagesPerFrame; m++, n++)
+                {
+                    EventMessage* msg = makeStormMessage<true>(n);
+
+                    if(n % 4 == 0)
+                    {
+                        msg->addDoneCallback(host, [&calledPooled, host, n](Handle::EntityHandle h, EventMessage*){
+                            calledPooled += (h == host) + n % 2;
+                        });
+                    }
+
+                    q.pushBack(msg);
+                }
+
+                // Random half is done
+                q.forEach([&](EventMessage* msg){
+                    msg->deleted = msg->deleted || (rng() & 1);
+                });
+
+                for(EventMessage* msg = q.front(); msg;)
+                {
+                    EventMessage* next = EventMessageQueue::next(msg);
+
+                    if(msg->deleted)
+                    {
+                        for(size_t i = 0; i < msg->onMessageDone.size(); i++)
+                        {
+                            auto cb = msg->onMessageDone[i];
+                            cb.second(cb.first, msg);
+                        }
+
+                        q.remove(msg);
+                        deleteStormMessage<true>(msg);
+                    }
+
+                    msg = next;
+                }
+            }
+        }
+
+        for(auto& q : queues)
+        {
+            while(!q->empty())
+            {
+                EventMessage* msg = q->front();
+                q->remove(msg);
+                deleteStormMessage<true>(msg);
+            }
+        }
+
+        stats.timePooled = (bx::getHPCounter() - start) / freq;
+        stats.numAllocationsPooled = getMessagePool().getStats().numSystemAllocations - poolBefore.numSystemAllocations;
+    }
+
+    // Both take out the same messages in the same order
+    if(calledLegacy != calledPooled)
+        LogWarn() << "Message-storm: Callbacks differ!";
+
+    LogInfo() << "Message-storm: " << stats.numMessages << " messages to " << numNpcs << " NPCs"
+              << ", legacy: " << stats.timeLegacy * 1000.0 << "ms (" << stats.numAllocationsLegacy << " allocations)"
+              << ", pooled: " << stats.timePooled * 1000.0 << "ms (" << stats.numAllocationsPooled << " allocations)";
+
+    return stats;
+}
+
+LoadBenchmark::NameStats LoadBenchmark::measureNames(size_t numNames, size_t numLookups)
+{
+    NameStats stats = {};
+    stats.numNames = numNames;
+    stats.numLookups = numLookups;
+
+    double freq = static_cast<double>(bx::getHPFrequency());
+
+    std::vector<std::string> strings;
+    strings.reserve(numNames);
+    for(size_t i = 0; i < numNames; i++)
+        strings.push_back("FP_ROAM_BENCHMARK_WAYPOINT_" + std::to_string(i));
+
+    std::vector<Utils::Name> names(strings.begin(), strings.end());
+
+    std::map<std::string, size_t> stringMap;
+    std::unordered_map<std::string, size_t> stringHashMap;
+    std::unordered_map<Utils::Name, size_t> nameHashMap;
+    for(size_t i = 0; i < numNames; i++)
+    {
+        stringMap[strings[i]] = i;
+        stringHashMap[strings[i]] = i;
+        nameHashMap[names[i]] = i;
+    }
+
+    // Same random order for every map
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<size_t> dist(0, numNames - 1);
+    std::vector<size_t> order(numLookups);
+    for(size_t& o : order)
+        o = dist(rng);
+
+    size_t sumStringMap = 0, sumStringHashMap = 0, sumNameHashMap = 0;
+
+    int64_t start = bx::getHPCounter();
+    for(size_t o : order)
+        sumStringMap += stringMap.find(strings[o])->second;
+    stats.timeStringMap = (bx::getHPCounter() - start) / freq;
+
+    start = bx::getHPCounter();
+    for(size_t o : order)
+        sumStringHashMap += stringHashMap.find(strings[o])->second;
+    stats.timeStringHashMap = (bx::getHPCounter() - start) / freq;
+
+    start = bx::getHPCounter();
+    for(size_t o : order)
+        sumNameHashMap += nameHashMap.find(names[o])->second;
+    stats.timeNameHashMap = (bx::getHPCounter() - start) / freq;
+
+    if(sumStringMap != sumStringHashMap || sumStringMap != sumNameHashMap)
+        LogWarn() << "Names: Lookups differ!";
+
+    // Every reference to a name as string carries its own copy (if it doesn't fit into the SSO-buffer),
+    // while a name is only a pointer into the table
+    for(const std::string& s : strings)
+        stats.numBytesStrings += sizeof(std::string) + (s.size() >= sizeof(std::string) - 1 ? s.capacity() + 1 : 0);
+
+    stats.numBytesNames = names.size() * sizeof(Utils::Name);
+    stats.numBytesNameTable = Utils::Name::getNumBytes();
+
+    LogInfo() << "Names: " << numLookups << " lookups of " << numNames << " names"
+              << ", std::map<string>: " << stats.timeStringMap * 1000.0 << "ms"
+              << ", unordered_map<string>: " << stats.timeStringHashMap * 1000.0 << "ms"
+              << ", unordered_map<Name>: " << stats.timeNameHashMap * 1000.0 << "ms"
+              << " | as strings: " << stats.numBytesStrings / 1024 << "KB"
+              << ", as names: " << stats.numBytesNames / 1024 << "KB"
+              << " (+ " << stats.numBytesNameTable / 1024 << "KB name-table for "
+              << Utils::Name::getNumNames() << " names)";
+
+    return stats;
+}
+
+LoadBenchmark::VobViewStats LoadBenchmark::measureVobViews(World::WorldInstance& world, size_t numFrames, size_t accessesPerNpc)
+{
+    using namespace Components;
+
+    VobViewStats stats = {};
+
+    const double freq = double(bx::getHPFrequency());
+    ComponentAllocator& alloc = world.getComponentAllocator();
+    std::vector<Handle::EntityHandle> npcs(world.getScriptEngine().getWorldNPCs().begin(),
+                                           world.getScriptEngine().getWorldNPCs().end());
+
+    stats.numNpcs = npcs.size();
+
+    // What asNpcVob did before the views: Copy the entity, look up every component through the handle-tables
+    // and check the controller
+    size_t touchedResolve = 0;
+    int64_t start = bx::getHPCounter();
+    for(size_t f = 0; f < numFrames; f++)
+    {
+        for(Handle::EntityHandle e : npcs)
+        {
+            for(size_t a = 0; a < accessesPerNpc; a++)
+            {
+                EntityComponent entity = alloc.getElement<EntityComponent>(e);
+
+                Logic::Controller* logic = hasComponent<LogicComponent>(entity)
+                                           ? alloc.getElement<LogicComponent>(e).m_pLogicController : nullptr;
+                Logic::VisualController* visual = hasComponent<VisualComponent>(entity)
+                                                  ? alloc.getElement<VisualComponent>(e).m_pVisualController : nullptr;
+                ObjectComponent* object = hasComponent<ObjectComponent>(entity)
+                                          ? &alloc.getElement<ObjectComponent>(e) : nullptr;
+                PositionComponent* position = hasComponent<PositionComponent>(entity)
+                                              ? &alloc.getElement<PositionComponent>(e) : nullptr;
+
+                if(logic && logic->getControllerType() == Logic::EControllerType::PlayerController)
+                    touchedResolve += (visual != nullptr) + (object != nullptr) + (position != nullptr);
+            }
+        }
+    }
+    stats.timeResolve = (bx::getHPCounter() - start) / freq;
+
+    ComponentAllocator::ViewStats before = alloc.getViewStats();
+
+    size_t touchedCached = 0;
+    start = bx::getHPCounter();
+    for(size_t f = 0; f < numFrames; f++)
+    {
+        for(Handle::EntityHandle e : npcs)
+        {
+            for(size_t a = 0; a < accessesPerNpc; a++)
+            {
+                VobTypes::NpcVobInformation npc = VobTypes::asNpcVob(world, e);
+
+                if(npc.playerController)
+                    touchedCached += (npc.visual != nullptr) + (npc.object != nullptr) + (npc.position != nullptr);
+            }
+        }
+    }
+    stats.timeCached = (bx::getHPCounter() - start) / freq;
+
+    ComponentAllocator::ViewStats after = alloc.getViewStats();
+
+    if(numFrames)
+    {
+        stats.numLookupsPerFrame = (after.numLookups - before.numLookups) / numFrames;
+        stats.numResolvesPerFrame = (after.numResolves - before.numResolves) / numFrames;
+    }
+
+    // Keeps the compiler from throwing the loops away
+    if(touchedResolve != touchedCached)
+        LogWarn() << "Vob-views: Results differ!";
+
+    LogInfo() << "Vob-views: " << stats.numNpcs << " NPCs, " << stats.numLookupsPerFrame << " lookups per frame"
+              << " (" << stats.numResolvesPerFrame << " resolved)"
+              << ", resolving: " << stats.timeResolve * 1000.0 << "ms"
+              << ", cached: " << stats.timeCached * 1000.0 << "ms"
+              << " (" << numFrames << " frames)";
+
+    return stats;
+}
+
+LoadBenchmark::RoutineStats LoadBenchmark::measureRoutines(size_t numNpcs, size_t numFrames, float minutesPerFrame)
+{
+    RoutineStats stats = {};
+    stats.numNpcs = numNpcs;
+    stats.numFrames = numFrames;
+
+    const double freq = double(bx::getHPFrequency());
+
+    // Split each day into 2 to 6 entries, starting somewhere in the morning
+    std::mt19937 rng(1337);
+    std::vector<std::vector<Logic::RoutineEntry>> routines(numNpcs);
+    for(std::vector<Logic::RoutineEntry>& r : routines)
+    {
+        int numEntries = 2 + static_cast<int>(rng() % 5);
+        int start = 5 * 60 + static_cast<int>(rng() % 180);
+        int length = Logic::Routine::MINUTES_PER_DAY / numEntries;
+
+        for(int i = 0; i < numEntries; i++)
+        {
+            int s = (start + i * length) % Logic::Routine::MINUTES_PER_DAY;
+            int e = (start + (i + 1) * length) % Logic::Routine::MINUTES_PER_DAY;
+
+            Logic::RoutineEntry entry;
+            entry.hoursStart = s / 60;
+            entry.minutesStart = s % 60;
+            entry.hoursEnd = e / 60;
+            entry.minutesEnd = e % 60;
+            entry.symFunc = static_cast<size_t>(i);
+            entry.isOverlay = false;
+
+            r.push_back(entry);
+        }
+    }
+
+    // Game-time of every frame, with a skip of 8 hours in the middle
+    std::vector<int64_t> times(numFrames);
+    double t = 8 * 60;
+    for(size_t f = 0; f < numFrames; f++)
+    {
+        if(f == numFrames / 2)
+            t += 8 * 60;
+
+        times[f] = static_cast<int64_t>(t);
+        t += minutesPerFrame;
+    }
+
+    std::vector<size_t> activeScan(numNpcs, 0);
+    size_t switchesScan = 0;
+
+    int64_t start = bx::getHPCounter();
+    for(int64_t now : times)
+    {
+        int minuteOfDay = static_cast<int>(now % Logic::Routine::MINUTES_PER_DAY);
+        int h = minuteOfDay / 60, m = minuteOfDay % 60;
+
+        for(size_t n = 0; n < numNpcs; n++)
+        {
+            std::vector<Logic::RoutineEntry>& r = routines[n];
+
+            if(r[activeScan[n]].timeInRange(h, m))
+                continue;
+
+            for(size_t i = 0; i < r.size(); i++)
+            {
+                if(i != activeScan[n] && r[i].timeInRange(h, m))
+                {
+                    activeScan[n] = i;
+                    switchesScan++;
+                    break;
+                }
+            }
+        }
+    }
+    stats.timeScan = (bx::getHPCounter() - start) / freq;
+
+    std::vector<size_t> activeScheduled(numNpcs, 0);
+    size_t switchesScheduled = 0;
+
+    Logic::RoutineScheduler scheduler;
+    auto fn = [&](Handle::EntityHandle npc, int64_t now) -> int64_t {
+        std::vector<Logic::RoutineEntry>& r = routines[npc.index];
+        size_t idx = Logic::Routine::findActiveEntry(r, activeScheduled[npc.index],
+                                                     static_cast<int>(now % Logic::Routine::MINUTES_PER_DAY));
+
+        if(idx != activeScheduled[npc.index])
+        {
+            activeScheduled[npc.index] = idx;
+            switchesScheduled++;
+        }
+
+        return Logic::Routine::getNextTransition(r, now);
+    };
+
+    start = bx::getHPCounter();
+    for(size_t n = 0; n < numNpcs; n++)
+    {
+        Handle::EntityHandle h;
+        h.index = static_cast<uint32_t>(n);
+        h.generation = 0;
+
+        scheduler.schedule(h, times.empty() ? 0 : times.front());
+    }
+
+    for(int64_t now : times)
+        scheduler.update(now, fn);
+
+    stats.timeScheduled = (bx::getHPCounter() - start) / freq;
+    stats.numSwitches = switchesScheduled;
+
+    if(activeScan != activeScheduled || switchesScan != switchesScheduled)
+        LogWarn() << "Routines: Scheduled routines differ from the scan!";
+
+    LogInfo() << "Routines: " << numNpcs << " NPCs, " << numFrames << " frames, " << stats.numSwitches << " switches"
+              << ", scan: " << stats.timeScan * 1000.0 << "ms"
+              << ", scheduled: " << stats.timeScheduled * 1000.0 << "ms";
+
+    return stats;
+}
+
+std::vector<LoadBenchmark::ExportStats> LoadBenchmark::measureExport(World::WorldInstance& world, size_t maxThreads, size_t numPasses)
+{
+    std::vector<ExportStats> stats;
+
+    const double freq = double(bx::getHPFrequency());
+    std::string serial;
+
+    for(size_t numThreads = 1; numThreads <= std::max<size_t>(1, maxThreads); numThreads *= 2)
+    {
+        ExportStats s = {};
+        s.numThreads = numThreads;
+        s.matchesSerial = true;
+
+        for(size_t i = 0; i < numPasses; i++)
+        {
+            json j;
+
+            int64_t start = bx::getHPCounter();
+            world.exportWorld(j, numThreads);
+            s.time += (bx::getHPCounter() - start) / freq;
+
+            std::string dump = j.dump();
+            if(serial.empty())
+                serial = std::move(dump);
+            else
+                s.matchesSerial = s.matchesSerial && dump == serial;
+        }
+
+        stats.push_back(s);
+    }
+
+    return stats;
+}
+
+LoadBenchmark::OffscreenStats LoadBenchmark::measureOffscreenSimulation(World::WorldInstance& world, const Math::Matrix& cameraWorld,
+                                                                        float updateRange, size_t numFrames, int minutesPerFrame)
+{
+    OffscreenStats stats = {};
+
+    Logic::OffscreenSimulation& offscreen = world.getOffscreenSimulation();
+    Content::Sky& sky = world.getSky();
+    Components::ComponentAllocator& alloc = world.getComponentAllocator();
+
+    const std::set<Handle::EntityHandle>& npcs = world.getScriptEngine().getWorldNPCs();
+    stats.numNpcs = npcs.size();
+    stats.numFrames = numFrames;
+
+    for(Handle::EntityHandle e : npcs)
+    {
+        Components::PositionComponent* position = alloc.tryGetElement<Components::PositionComponent>(e);
+
+        if(position && (position->m_WorldMatrix.Translation() - cameraWorld.Translation()).length() <= updateRange)
+            stats.numInRange++;
+    }
+
+    const bool wasEnabled = offscreen.getConfig().enabled;
+
+    int startHours, startMinutes;
+    sky.getTimeOfDay(startHours, startMinutes);
+
+    // Runs the frames from the same time of day onward. The clock only goes forward, so this starts over on the next day.
+    auto run = [&](float range, bool coarse, size_t* numSimulated)
+    {
+        offscreen.getConfig().enabled = coarse;
+
+        // One frame to hand back the NPCs of the last mode and to settle the routines of the skipped time
+        sky.setTimeOfDay(startHours, startMinutes);
+        world.onFrameUpdate(0.0, range * range, cameraWorld);
+
+        double time = 0.0;
+        for(size_t f = 0; f < numFrames; f++)
+        {
+            int hours, minutes;
+            sky.getTimeOfDay(hours, minutes);
+
+            int next = (hours * 60 + minutes + minutesPerFrame) % (24 * 60);
+            sky.setTimeOfDay(next / 60, next % 60);
+
+            world.onFrameUpdate(1.0 / 60.0, range * range, cameraWorld);
+
+            const World::WorldInstance::FrameTimings& t = world.getLastFrameTimings();
+            time += t.physics + t.logic + t.animation;
+
+            if(numSimulated)
+                *numSimulated += offscreen.getStats().numSimulated;
+        }
+
+        return time;
+    };
+
+    stats.timeFrozen = run(updateRange, false, nullptr);
+
+    size_t numSimulated = 0;
+    size_t routesBefore = offscreen.getStats().numRoutesPlanned;
+    stats.timeCoarse = run(updateRange, true, &numSimulated);
+    stats.avgSimulated = numFrames ? static_cast<double>(numSimulated) / numFrames : 0.0;
+    stats.numRoutesPlanned = offscreen.getStats().numRoutesPlanned - routesBefore;
+
+    // Last, as it moves everyone around the most
+    stats.timeFull = run(1000000.0f, false, nullptr);
+
+    offscreen.getConfig().enabled = wasEnabled;
+
+    return stats;
+}
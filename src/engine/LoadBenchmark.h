@@ -0,0 +1,268 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <zenload/zTypes.h>
+#include "World.h"
+
+namespace Engine
+{
+    class BaseEngine;
+
+    namespace LoadBenchmark
+    {
+        /**
+         * Creates a ZEN-like vob-tree with random positions and visuals
+         * @param numVobs Total number of vobs to create, including children
+         * @param visuals Visuals to pick from. Every third vob won't get a visual, like spots or triggers.
+         * @param seed Seed for the random generator. Same seed means same tree.
+         * @return Root-vobs of the generated tree
+         */
+        std::vector<ZenLoad::zCVobData> makeSyntheticVobTree(size_t numVobs,
+                                                             const std::vector<std::string>& visuals,
+                                                             uint32_t seed);
+
+        /**
+         * Collects up to the given number of static-mesh visuals known to the engines VDFS-index
+         */
+        std::vector<std::string> findStaticVisuals(BaseEngine& engine, size_t maxNum);
+
+        /**
+         * Loads a synthetic vob-tree into a fresh world which is not registered at the engine, so this won't
+         * show up anywhere. The world only lives during this call.
+         * @param numVobs Number of vobs to insert
+         * @param numVisuals Number of unique visuals to use
+         * @param seed Seed for the random generator
+         * @return Timings of the load-stages
+         */
+        World::WorldInstance::VobLoadStats run(BaseEngine& engine, size_t numVobs, size_t numVisuals, uint32_t seed);
+
+        /**
+         * Memory and time needed to construct empty worlds
+         */
+        struct ConstructionStats
+        {
+            size_t numWorlds;
+            double timeConstruct; // Seconds, for all worlds
+            double timeDestruct;
+            size_t rssBefore; // Bytes, 0 if unknown on this platform
+            size_t rssAfter;
+            size_t committedEntityStorage; // Bytes committed by the entity-sized allocators, for all worlds
+        };
+
+        /**
+         * Constructs the given number of worlds without loading anything into them and measures what that costs.
+         * This is the overhead every loaded world pays before any content comes in.
+         */
+        ConstructionStats measureWorldConstruction(size_t numWorlds);
+
+        /**
+         * Timings of mass entity-removal, in seconds
+         */
+        struct RemovalStats
+        {
+            size_t numEntities;
+            double timeCreate;
+            double timeDespawnWave; // Random half of the entities
+            double timeUnload; // The rest, in creation-order
+            size_t committedAfter; // Bytes still committed by the component-storage
+        };
+
+        /**
+         * Fills a fresh world with entities carrying strings and vectors, then removes a random half of them
+         * like a despawn-wave would, and the rest like unloading the world does.
+         * @param numEntities Number of entities to create
+         * @param seed Seed for picking the entities of the despawn-wave
+         */
+        RemovalStats measureEntityRemoval(BaseEngine& engine, size_t numEntities, uint32_t seed);
+
+        /**
+         * Memory and iteration-time of the sparse component-storage compared to storing every component
+         * for every entity
+         */
+        struct LayoutStats
+        {
+            size_t numEntities;
+            size_t committedBundled; // Bytes
+            size_t committedSparse;
+            double timeCreateBundled; // Seconds
+            double timeCreateSparse;
+            double timeIterateBundled; // Seconds, for one pass over all static meshes
+            double timeIterateSparse;
+        };
+
+        /**
+         * Fills both component-layouts with the same mix of entities as a loaded world has: Mostly world-mesh parts
+         * with only position and mesh, some vobs with visual and physics, few NPCs which use nearly everything.
+         * Then does a render-like pass over all static meshes on both.
+         */
+        LayoutStats measureComponentLayouts(size_t numEntities);
+
+        /**
+         * Cost of finding the entities a system cares about, for one mask
+         */
+        struct QueryStats
+        {
+            Components::ComponentMask mask;
+            size_t numMatching;
+            double timeScan; // Seconds, for all passes going through every entity and testing its mask
+            double timeQuery; // Seconds, for all passes going through the cached query-list
+        };
+
+        /**
+         * Compares scanning all entities of the given world and testing their masks against iterating the cached
+         * query-lists, for the masks the engines systems use. Both touch the matching entities component the same way.
+         * @param numPasses How often to run each variant
+         */
+        std::vector<QueryStats> measureQueries(World::WorldInstance& world, size_t numPasses);
+
+        /**
+         * Time spent walking anim-handlers, in seconds, for all passes
+         */
+        struct AnimHandlerStats
+        {
+            size_t numHandlers;
+            size_t numPasses;
+            double timeScattered; // One heap-allocation per handler, like every AnimationComponent used to have
+            double timePooled; // Continuous inside the worlds anim-handler pool
+        };
+
+        /**
+         * Runs the animation-update over the given number of anim-handlers, once with every handler allocated
+         * separately between other allocations, like on a heap which has been in use for a while, and once
+         * with all of them inside the pool. The caches are flushed before every pass, as there is plenty of
+         * other work between two animation-updates in a real frame.
+         * @param numHandlers Number of handlers, ie. animated NPCs
+         * @param numPasses Number of updates to run
+         */
+        AnimHandlerStats measureAnimHandlers(size_t numHandlers, size_t numPasses);
+
+        /**
+         * Cost of pushing event-messages through the NPCs queues
+         */
+        struct MessageStormStats
+        {
+            size_t numMessages;
+            double timeLegacy; // Seconds. Heap-allocated messages in a vector, callbacks in a std::list of std::function
+            double timePooled; // Seconds. Pooled messages in the intrusive queue, with inline callbacks
+            size_t numAllocationsLegacy; // Messages and callback-nodes allocated on the heap
+            size_t numAllocationsPooled; // Allocations the message-pool made from the system
+        };
+
+        /**
+         * Sends a storm of mixed event-messages to a number of synthetic NPC-queues, every fourth one carrying
+         * a done-callback. Each frame, a random half of the queued messages gets done and is taken out again,
+         * like the EventManager does it.
+         * @param numNpcs Number of queues
+         * @param numFrames Number of frames to simulate
+         * @param messagesPerFrame Messages every NPC gets per frame
+         */
+        MessageStormStats measureMessageStorm(size_t numNpcs, size_t numFrames, size_t messagesPerFrame);
+
+        /**
+         * Cost of looking up and storing names as plain strings vs. as interned names
+         */
+        struct NameStats
+        {
+            size_t numNames;
+            size_t numLookups;
+            double timeStringMap; // Seconds. std::map keyed by std::string, like the caches used to be
+            double timeStringHashMap; // Seconds. std::unordered_map keyed by std::string
+            double timeNameHashMap; // Seconds. std::unordered_map keyed by Utils::Name
+            size_t numBytesStrings; // Every name stored once per reference as std::string
+            size_t numBytesNames; // Every name stored once per reference as Utils::Name
+            size_t numBytesNameTable; // Total size of the global name-table afterwards
+        };
+
+        /**
+         * Builds waypoint-like names and looks them up in maps keyed by strings and by interned names.
+         * The names are the same on every run, so running this again won't grow the name-table.
+         * @param numNames Number of distinct names
+         * @param numLookups Number of random lookups per map
+         */
+        NameStats measureNames(size_t numNames, size_t numLookups);
+
+        /**
+         * Cost of getting typed vob-information of the NPCs in a world, as the AI does it every frame
+         */
+        struct VobViewStats
+        {
+            size_t numNpcs;
+            size_t numLookupsPerFrame; // asNpcVob-calls per simulated frame
+            size_t numResolvesPerFrame; // Of these, how many had to look up the components again
+            double timeResolve; // Seconds. Resolving all components on every access, like asVob used to
+            double timeCached; // Seconds. Through the cached component-views
+        };
+
+        /**
+         * Simulates the accesses of the AI to the NPCs of the given world
+         * @param numFrames Number of frames to simulate
+         * @param accessesPerNpc How often each NPC is turned into an NpcVobInformation per frame
+         */
+        VobViewStats measureVobViews(World::WorldInstance& world, size_t numFrames, size_t accessesPerNpc);
+
+        /**
+         * Cost of keeping the daily routines of NPCs up to date
+         */
+        struct RoutineStats
+        {
+            size_t numNpcs;
+            size_t numFrames;
+            size_t numSwitches; // Routine-entries switched, same for both
+            double timeScan; // Seconds. Every NPC checks its routine every frame, like doAIState used to
+            double timeScheduled; // Seconds. Through the RoutineScheduler
+        };
+
+        /**
+         * Runs synthetic daily routines of a number of NPCs over some game-days. Halfway through, the time skips
+         * forward as if everyone went to sleep.
+         * @param numNpcs Number of NPCs
+         * @param numFrames Number of frames to simulate
+         * @param minutesPerFrame Game-minutes passing each frame
+         */
+        RoutineStats measureRoutines(size_t numNpcs, size_t numFrames, float minutesPerFrame);
+
+        /**
+         * Cost of exporting the vobs of a world with a given number of threads
+         */
+        struct ExportStats
+        {
+            size_t numThreads;
+            double time; // Seconds, for all passes
+            bool matchesSerial; // Whether the export came out exactly like the single-threaded one
+        };
+
+        /**
+         * Exports the given world with 1, 2, 4, ... up to the given number of threads and compares the dumped
+         * results against the single-threaded export.
+         * @param maxThreads Highest number of threads to try
+         * @param numPasses How often to export per thread-count
+         */
+        std::vector<ExportStats> measureExport(World::WorldInstance& world, size_t maxThreads, size_t numPasses);
+
+        /**
+         * Cost of the NPCs outside of the update-range, with the same NPCs alive in every mode
+         */
+        struct OffscreenStats
+        {
+            size_t numNpcs;
+            size_t numInRange; // At the start, with the given update-range
+            size_t numFrames;
+            double timeFrozen; // Seconds. NPCs out of range aren't updated at all
+            double timeCoarse; // Seconds. NPCs out of range walk the waynet in the OffscreenSimulation
+            double timeFull; // Seconds. Every NPC gets the full update, as if the update-range was unlimited
+            double avgSimulated; // NPCs in the OffscreenSimulation per frame, in coarse mode
+            size_t numRoutesPlanned; // By the OffscreenSimulation, in coarse mode
+        };
+
+        /**
+         * Runs the given world through a stretch of the day in all three modes. Each mode starts at the same time of
+         * day, so the same routines switch while it runs.
+         * @param cameraWorld Where the update-range is measured from
+         * @param updateRange Update-range in meters
+         * @param numFrames Number of frames to simulate per mode
+         * @param minutesPerFrame Game-minutes passing each frame
+         */
+        OffscreenStats measureOffscreenSimulation(World::WorldInstance& world, const Math::Matrix& cameraWorld,
+                                                  float updateRange, size_t numFrames, int minutesPerFrame);
+    }
+}
@@ -0,0 +1,834 @@
+#include "Savegame.h"
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+#include <cstring>
+#include <algorithm>
+#include <cstdio>
+#include <utils/Utils.h>
+#include <utils/Profiler.h>
+
+using namespace Engine;
+
+namespace
+{
+    const uint8_t MAGIC[4] = {'R', 'G', 'S', 'V'};
+    const uint8_t MAGIC_COMPRESSED[4] = {'R', 'G', 'S', 'Z'};
+
+    const uint32_t CHUNK_STRINGTABLE = 0x54525453; // "STRT"
+    const uint32_t CHUNK_MEMBER = 0x424D454D; // "MEMB"
+
+    /**
+     * Type-tags of the encoded values
+     */
+    enum EValueTag : uint8_t
+    {
+        VT_Null,
+        VT_False,
+        VT_True,
+        VT_Int,     // Zigzag-varint
+        VT_UInt,    // Varint
+        VT_Float32, // Used whenever the value survives the conversion
+        VT_Float64,
+        VT_String,  // Index into the string-table
+        VT_Array,   // Count, values
+        VT_Object   // Count, (key-index, value)-pairs
+    };
+
+    class Writer
+    {
+    public:
+        Writer(std::vector<uint8_t>& out) : m_Out(out){}
+
+        void u8(uint8_t v){ m_Out.push_back(v); }
+
+        void u32(uint32_t v)
+        {
+            for(int i=0;i<4;i++)
+                m_Out.push_back(static_cast<uint8_t>(v >> (i * 8)));
+        }
+
+        void varint(uint64_t v)
+        {
+            while(v >= 0x80)
+            {
+                m_Out.push_back(static_cast<uint8_t>(v | 0x80));
+                v >>= 7;
+            }
+            m_Out.push_back(static_cast<uint8_t>(v));
+        }
+
+        void raw(const void* data, size_t size)
+        {
+            const uint8_t* d = reinterpret_cast<const uint8_t*>(data);
+            m_Out.insert(m_Out.end(), d, d + size);
+        }
+
+        /**
+         * Starts a chunk. Returns the position of the size-field, which has to be passed to endChunk().
+         */
+        size_t beginChunk(uint32_t fourcc)
+        {
+            u32(fourcc);
+            size_t sizePos = m_Out.size();
+            u32(0);
+            return sizePos;
+        }
+
+        void endChunk(size_t sizePos)
+        {
+            uint32_t size = static_cast<uint32_t>(m_Out.size() - sizePos - 4);
+            for(int i=0;i<4;i++)
+                m_Out[sizePos + i] = static_cast<uint8_t>(size >> (i * 8));
+        }
+
+    private:
+        std::vector<uint8_t>& m_Out;
+    };
+
+    class Reader
+    {
+    public:
+        Reader(const uint8_t* data, size_t size) : m_Data(data), m_Size(size), m_Pos(0), m_Failed(false){}
+
+        bool failed() const { return m_Failed; }
+        bool atEnd() const { return m_Pos >= m_Size; }
+        size_t position() const { return m_Pos; }
+
+        uint8_t u8()
+        {
+            if(!require(1))
+                return 0;
+
+            return m_Data[m_Pos++];
+        }
+
+        uint32_t u32()
+        {
+            if(!require(4))
+                return 0;
+
+            uint32_t v = 0;
+            for(int i=0;i<4;i++)
+                v |= static_cast<uint32_t>(m_Data[m_Pos++]) << (i * 8);
+
+            return v;
+        }
+
+        uint64_t varint()
+        {
+            uint64_t v = 0;
+            for(int shift = 0; shift < 64; shift += 7)
+            {
+                uint8_t b = u8();
+                v |= static_cast<uint64_t>(b & 0x7F) << shift;
+
+                if((b & 0x80) == 0 || m_Failed)
+                    return v;
+            }
+
+            m_Failed = true;
+            return 0;
+        }
+
+        const uint8_t* raw(size_t size)
+        {
+            if(!require(size))
+                return nullptr;
+
+            const uint8_t* p = m_Data + m_Pos;
+            m_Pos += size;
+            return p;
+        }
+
+    private:
+        bool require(size_t n)
+        {
+            if(m_Failed || m_Size - m_Pos < n)
+            {
+                m_Failed = true;
+                return false;
+            }
+
+            return true;
+        }
+
+        const uint8_t* m_Data;
+        size_t m_Size;
+        size_t m_Pos;
+        bool m_Failed;
+    };
+
+    /**
+     * Collects all strings of the document, so each only has to be written once
+     */
+    class StringTable
+    {
+    public:
+        uint64_t intern(const std::string& s)
+        {
+            auto it = m_Indices.find(s);
+            if(it != m_Indices.end())
+                return (*it).second;
+
+            uint64_t idx = m_Strings.size();
+            m_Indices[s] = idx;
+            m_Strings.push_back(&(*m_Indices.find(s)).first);
+            return idx;
+        }
+
+        uint64_t indexOf(const std::string& s) const
+        {
+            return (*m_Indices.find(s)).second;
+        }
+
+        void collect(const json& j)
+        {
+            if(j.is_string())
+            {
+                intern(j.get<std::string>());
+            }
+            else if(j.is_object())
+            {
+                for(auto it = j.begin(); it != j.end(); ++it)
+                {
+                    intern(it.key());
+                    collect(it.value());
+                }
+            }
+            else if(j.is_array())
+            {
+                for(const json& v : j)
+                    collect(v);
+            }
+        }
+
+        void write(Writer& w) const
+        {
+            w.varint(m_Strings.size());
+            for(const std::string* s : m_Strings)
+            {
+                w.varint(s->size());
+                w.raw(s->data(), s->size());
+            }
+        }
+
+    private:
+        std::unordered_map<std::string, uint64_t> m_Indices;
+        std::vector<const std::string*> m_Strings;
+    };
+
+    void writeValue(Writer& w, const StringTable& strings, const json& j)
+    {
+        switch(j.type())
+        {
+            case json::value_t::null:
+            case json::value_t::discarded:
+                w.u8(VT_Null);
+                break;
+
+            case json::value_t::boolean:
+                w.u8(j.get<bool>() ? VT_True : VT_False);
+                break;
+
+            case json::value_t::number_integer:
+            {
+                int64_t v = j.get<int64_t>();
+                w.u8(VT_Int);
+                w.varint((static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+            }
+                break;
+
+            case json::value_t::number_unsigned:
+                w.u8(VT_UInt);
+                w.varint(j.get<uint64_t>());
+                break;
+
+            case json::value_t::number_float:
+            {
+                double d = j.get<double>();
+                float f = static_cast<float>(d);
+
+                // Most of our values originally were floats
+                if(static_cast<double>(f) == d)
+                {
+                    w.u8(VT_Float32);
+                    w.raw(&f, sizeof(f));
+                }else
+                {
+                    w.u8(VT_Float64);
+                    w.raw(&d, sizeof(d));
+                }
+            }
+                break;
+
+            case json::value_t::string:
+                w.u8(VT_String);
+                w.varint(strings.indexOf(j.get<std::string>()));
+                break;
+
+            case json::value_t::array:
+                w.u8(VT_Array);
+                w.varint(j.size());
+                for(const json& v : j)
+                    writeValue(w, strings, v);
+                break;
+
+            case json::value_t::object:
+                w.u8(VT_Object);
+                w.varint(j.size());
+                for(auto it = j.begin(); it != j.end(); ++it)
+                {
+                    w.varint(strings.indexOf(it.key()));
+                    writeValue(w, strings, it.value());
+                }
+                break;
+        }
+    }
+
+    bool readString(Reader& r, const std::vector<std::string>& strings, const std::string*& out)
+    {
+        uint64_t idx = r.varint();
+        if(r.failed() || idx >= strings.size())
+            return false;
+
+        out = &strings[idx];
+        return true;
+    }
+
+    bool readValue(Reader& r, const std::vector<std::string>& strings, json& out)
+    {
+        switch(r.u8())
+        {
+            case VT_Null:
+                out = nullptr;
+                break;
+
+            case VT_False:
+                out = false;
+                break;
+
+            case VT_True:
+                out = true;
+                break;
+
+            case VT_Int:
+            {
+                uint64_t z = r.varint();
+                out = static_cast<int64_t>((z >> 1) ^ (~(z & 1) + 1));
+            }
+                break;
+
+            case VT_UInt:
+                out = r.varint();
+                break;
+
+            case VT_Float32:
+            {
+                const uint8_t* p = r.raw(sizeof(float));
+                if(!p)
+                    return false;
+
+                float f;
+                memcpy(&f, p, sizeof(f));
+                out = f;
+            }
+                break;
+
+            case VT_Float64:
+            {
+                const uint8_t* p = r.raw(sizeof(double));
+                if(!p)
+                    return false;
+
+                double d;
+                memcpy(&d, p, sizeof(d));
+                out = d;
+            }
+                break;
+
+            case VT_String:
+            {
+                const std::string* s;
+                if(!readString(r, strings, s))
+                    return false;
+
+                out = *s;
+            }
+                break;
+
+            case VT_Array:
+            {
+                uint64_t num = r.varint();
+                out = json::array();
+                for(uint64_t i = 0; i < num && !r.failed(); i++)
+                {
+                    out.push_back(json());
+                    if(!readValue(r, strings, out.back()))
+                        return false;
+                }
+            }
+                break;
+
+            case VT_Object:
+            {
+                uint64_t num = r.varint();
+                out = json::object();
+                for(uint64_t i = 0; i < num && !r.failed(); i++)
+                {
+                    const std::string* key;
+                    if(!readString(r, strings, key))
+                        return false;
+
+                    if(!readValue(r, strings, out[*key]))
+                        return false;
+                }
+            }
+                break;
+
+            default:
+                return false;
+        }
+
+        return !r.failed();
+    }
+}
+
+void Savegame::writeBinary(const json& j, std::vector<uint8_t>& out)
+{
+    out.clear();
+    Writer w(out);
+
+    StringTable strings;
+    strings.collect(j);
+
+    w.raw(MAGIC, sizeof(MAGIC));
+    w.u32(BINARY_VERSION);
+    w.u32(static_cast<uint32_t>(1 + (j.is_object() ? j.size() : 0)));
+
+    size_t chunk = w.beginChunk(CHUNK_STRINGTABLE);
+    strings.write(w);
+    w.endChunk(chunk);
+
+    if(!j.is_object())
+        return;
+
+    for(auto it = j.begin(); it != j.end(); ++it)
+    {
+        chunk = w.beginChunk(CHUNK_MEMBER);
+        w.varint(strings.indexOf(it.key()));
+        writeValue(w, strings, it.value());
+        w.endChunk(chunk);
+    }
+}
+
+bool Savegame::isBinary(const std::vector<uint8_t>& data)
+{
+    return data.size() >= sizeof(MAGIC) && memcmp(data.data(), MAGIC, sizeof(MAGIC)) == 0;
+}
+
+bool Savegame::readBinary(const std::vector<uint8_t>& data, json& out)
+{
+    if(!isBinary(data))
+        return false;
+
+    Reader r(data.data(), data.size());
+    r.raw(sizeof(MAGIC));
+
+    uint32_t version = r.u32();
+    uint32_t numChunks = r.u32();
+
+    if(r.failed() || version > BINARY_VERSION)
+        return false;
+
+    std::vector<std::string> strings;
+    out = json::object();
+
+    for(uint32_t c = 0; c < numChunks; c++)
+    {
+        uint32_t fourcc = r.u32();
+        uint32_t size = r.u32();
+        const uint8_t* payload = r.raw(size);
+
+        if(!payload)
+            return false;
+
+        Reader cr(payload, size);
+
+        if(fourcc == CHUNK_STRINGTABLE)
+        {
+            uint64_t num = cr.varint();
+            strings.clear();
+            strings.reserve(static_cast<size_t>(std::min<uint64_t>(num, size)));
+
+            for(uint64_t i = 0; i < num && !cr.failed(); i++)
+            {
+                uint64_t len = cr.varint();
+                const uint8_t* s = cr.raw(static_cast<size_t>(len));
+
+                if(!s)
+                    return false;
+
+                strings.emplace_back(reinterpret_cast<const char*>(s), static_cast<size_t>(len));
+            }
+        }
+        else if(fourcc == CHUNK_MEMBER)
+        {
+            const std::string* key;
+            if(!readString(cr, strings, key))
+                return false;
+
+            if(!readValue(cr, strings, out[*key]))
+                return false;
+        }
+
+        // Unknown chunks are skipped
+
+        if(cr.failed())
+            return false;
+    }
+
+    return true;
+}
+
+void Savegame::compress(const std::vector<uint8_t>& data, std::vector<uint8_t>& out)
+{
+    // Simple LZ77 in the spirit of LZ4: Sequences of (token, literals, offset, match-length).
+    // The token holds 4 bits of literal-length and 4 bits of match-length, longer lengths follow as 255-runs.
+    const int HASH_BITS = 16;
+    const size_t MIN_MATCH = 4;
+    const size_t MAX_OFFSET = 0xFFFF;
+    const uint32_t NONE = 0xFFFFFFFF;
+
+    out.clear();
+    out.reserve(data.size() / 2 + 16);
+
+    Writer w(out);
+    w.raw(MAGIC_COMPRESSED, sizeof(MAGIC_COMPRESSED));
+    w.u32(static_cast<uint32_t>(data.size()));
+
+    std::vector<uint32_t> table(1 << HASH_BITS, NONE);
+    const size_t n = data.size();
+    size_t ip = 0;
+    size_t anchor = 0;
+
+    auto read32 = [&](size_t p)
+    {
+        uint32_t v;
+        memcpy(&v, &data[p], sizeof(v));
+        return v;
+    };
+
+    auto writeLength = [&](size_t len)
+    {
+        while(len >= 255)
+        {
+            out.push_back(255);
+            len -= 255;
+        }
+        out.push_back(static_cast<uint8_t>(len));
+    };
+
+    auto writeSequence = [&](size_t litLen, size_t offset, size_t matchLen)
+    {
+        size_t ml = matchLen ? matchLen - MIN_MATCH : 0;
+
+        out.push_back(static_cast<uint8_t>((std::min<size_t>(litLen, 15) << 4) | std::min<size_t>(ml, 15)));
+
+        if(litLen >= 15)
+            writeLength(litLen - 15);
+
+        out.insert(out.end(), data.begin() + anchor, data.begin() + anchor + litLen);
+
+        // Last sequence only has literals
+        if(!matchLen)
+            return;
+
+        out.push_back(static_cast<uint8_t>(offset));
+        out.push_back(static_cast<uint8_t>(offset >> 8));
+
+        if(ml >= 15)
+            writeLength(ml - 15);
+    };
+
+    while(ip + MIN_MATCH <= n)
+    {
+        uint32_t v = read32(ip);
+        uint32_t h = (v * 2654435761u) >> (32 - HASH_BITS);
+        uint32_t candidate = table[h];
+        table[h] = static_cast<uint32_t>(ip);
+
+        if(candidate != NONE && ip - candidate <= MAX_OFFSET && read32(candidate) == v)
+        {
+            size_t len = MIN_MATCH;
+            while(ip + len < n && data[candidate + len] == data[ip + len])
+                len++;
+
+            writeSequence(ip - anchor, ip - candidate, len);
+
+            ip += len;
+            anchor = ip;
+        }else
+        {
+            ip++;
+        }
+    }
+
+    writeSequence(n - anchor, 0, 0);
+}
+
+bool Savegame::isCompressed(const std::vector<uint8_t>& data)
+{
+    return data.size() >= sizeof(MAGIC_COMPRESSED) + 4
+           && memcmp(data.data(), MAGIC_COMPRESSED, sizeof(MAGIC_COMPRESSED)) == 0;
+}
+
+bool Savegame::decompress(const std::vector<uint8_t>& data, std::vector<uint8_t>& out)
+{
+    if(!isCompressed(data))
+        return false;
+
+    Reader r(data.data(), data.size());
+    r.raw(sizeof(MAGIC_COMPRESSED));
+    uint32_t size = r.u32();
+
+    out.clear();
+    out.reserve(size);
+
+    auto readLength = [&](size_t len)
+    {
+        if(len < 15)
+            return len;
+
+        uint8_t b;
+        do
+        {
+            b = r.u8();
+            len += b;
+        }while(b == 255 && !r.failed());
+
+        return len;
+    };
+
+    while(!r.atEnd())
+    {
+        uint8_t token = r.u8();
+
+        size_t litLen = readLength(token >> 4);
+        const uint8_t* lit = r.raw(litLen);
+        if(!lit)
+            return false;
+
+        out.insert(out.end(), lit, lit + litLen);
+
+        // Last sequence?
+        if(r.atEnd())
+            break;
+
+        size_t offset = r.u8();
+        offset |= static_cast<size_t>(r.u8()) << 8;
+        size_t matchLen = readLength(token & 0x0F) + 4;
+
+        if(r.failed() || offset == 0 || offset > out.size() || out.size() + matchLen > size)
+            return false;
+
+        // Matches may overlap with what they produce
+        size_t from = out.size() - offset;
+        for(size_t i = 0; i < matchLen; i++)
+            out.push_back(out[from + i]);
+    }
+
+    return !r.failed() && out.size() == size;
+}
+
+void Savegame::encode(const json& j, ESaveFormat format, std::vector<uint8_t>& out)
+{
+    switch(format)
+    {
+        case SF_Json:
+        {
+            std::string str = writeJson(j);
+            out.assign(str.begin(), str.end());
+        }
+            break;
+
+        case SF_Binary:
+            writeBinary(j, out);
+            break;
+
+        case SF_CompressedBinary:
+        {
+            std::vector<uint8_t> raw;
+            writeBinary(j, raw);
+            compress(raw, out);
+        }
+            break;
+    }
+}
+
+std::string Savegame::writeJson(const json& j)
+{
+    return Utils::iso_8859_1_to_utf8(j.dump(4));
+}
+
+bool Savegame::saveToFile(const json& j, const std::string& file, ESaveFormat format)
+{
+    std::vector<uint8_t> data;
+    encode(j, format, data);
+
+    return writeFileAtomic(data, file);
+}
+
+bool Savegame::writeFileAtomic(const std::vector<uint8_t>& data, const std::string& file)
+{
+    std::string tmp = file + ".tmp";
+
+    {
+        std::ofstream f(tmp, std::ios::binary);
+
+        if(!f.is_open())
+            return false;
+
+        f.write(reinterpret_cast<const char*>(data.data()), data.size());
+        f.close();
+
+        if(!f.good())
+        {
+            std::remove(tmp.c_str());
+            return false;
+        }
+    }
+
+#ifdef _WIN32
+    // Rename won't overwrite existing files here
+    std::remove(file.c_str());
+#endif
+
+    return std::rename(tmp.c_str(), file.c_str()) == 0;
+}
+
+bool Savegame::loadFromFile(const std::string& file, json& out)
+{
+    std::ifstream f(file, std::ios::binary);
+
+    if(!f.is_open())
+        return false;
+
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+
+    if(isCompressed(data))
+    {
+        std::vector<uint8_t> raw;
+        if(!decompress(data, raw))
+            return false;
+
+        return readBinary(raw, out);
+    }
+
+    if(isBinary(data))
+        return readBinary(data, out);
+
+    // Old json-savegame
+    std::stringstream saveData;
+    saveData.write(reinterpret_cast<const char*>(data.data()), data.size());
+
+    try
+    {
+        out = json::parse(saveData);
+    }catch(const std::exception&)
+    {
+        return false;
+    }
+
+    return true;
+}
+
+Savegame::AsyncWriter::AsyncWriter()
+    : m_State(S_Idle),
+      m_Success(false)
+{
+}
+
+Savegame::AsyncWriter::~AsyncWriter()
+{
+    // Don't lose a save on shutdown
+    wait();
+}
+
+bool Savegame::AsyncWriter::start(json&& snapshot, const std::string& file, ESaveFormat format)
+{
+    if(isBusy())
+        return false;
+
+    // Previous result may not have been collected
+    wait();
+
+    m_Snapshot = std::move(snapshot);
+    m_File = file;
+    m_Success = false;
+    m_State = S_Encoding;
+
+    m_Thread = std::thread(&AsyncWriter::run, this, format);
+
+    return true;
+}
+
+float Savegame::AsyncWriter::getProgress() const
+{
+    switch(getState())
+    {
+        case S_Encoding: return 0.0f;
+        case S_Compressing: return 0.5f;
+        case S_Writing: return 0.8f;
+        case S_Done: return 1.0f;
+        default: return 0.0f;
+    }
+}
+
+void Savegame::AsyncWriter::wait()
+{
+    if(m_Thread.joinable())
+        m_Thread.join();
+}
+
+bool Savegame::AsyncWriter::pollFinished(bool& success, std::string& file)
+{
+    if(getState() != S_Done)
+        return false;
+
+    wait();
+
+    success = m_Success;
+    file = m_File;
+    m_State = S_Idle;
+
+    return true;
+}
+
+void Savegame::AsyncWriter::run(ESaveFormat format)
+{
+    Utils::Profiler::setThreadName("Savegame");
+    PROFILE_SCOPE("Savegame::AsyncWriter::run");
+
+    std::vector<uint8_t> data;
+
+    if(format == SF_CompressedBinary)
+    {
+        std::vector<uint8_t> raw;
+        writeBinary(m_Snapshot, raw);
+
+        m_State = S_Compressing;
+        compress(raw, data);
+    }else
+    {
+        encode(m_Snapshot, format, data);
+    }
+
+    // Not needed anymore, free the memory here instead of on the main-thread
+    m_Snapshot = json();
+
+    m_State = S_Writing;
+    m_Success = writeFileAtomic(data, m_File);
+
+    m_State = S_Done;
+}
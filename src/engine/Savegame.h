@@ -0,0 +1,182 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <cstdint>
+#include <thread>
+#include <atomic>
+#include <json.hpp>
+
+using json = nlohmann::json;
+
+namespace Engine
+{
+    /**
+     * Reading and writing of savegame-files. Everything in the engine exports its state into a json-object,
+     * this decides how that object ends up on disk.
+     *
+     * The binary format is a versioned list of chunks:
+     *   Header: "RGSV", uint32 version, uint32 number of chunks
+     *   Chunk:  uint32 fourcc, uint32 payload-size, payload
+     * The first chunk is the string-table ("STRT"). All strings of the document (keys and values) are
+     * stored only once in there and referenced by index. Every top-level member of the document is then
+     * written as its own "MEMB"-chunk. Readers skip chunks they don't know.
+     *
+     * Compressed savegames wrap the binary format:
+     *   Header: "RGSZ", uint32 uncompressed size
+     *   LZ-compressed binary savegame
+     */
+    namespace Savegame
+    {
+        enum ESaveFormat
+        {
+            SF_Binary,
+            SF_CompressedBinary,
+            SF_Json // Human readable, for debugging
+        };
+
+        const uint32_t BINARY_VERSION = 1;
+
+        /**
+         * Encodes the given document into the binary format
+         * @param j Document to encode. Must be an object.
+         * @param out Data to write into
+         */
+        void writeBinary(const json& j, std::vector<uint8_t>& out);
+
+        /**
+         * Decodes a document written by writeBinary
+         * @param data Binary savegame
+         * @param out Document to write into
+         * @return False, if the data was invalid or of a newer version
+         */
+        bool readBinary(const std::vector<uint8_t>& data, json& out);
+
+        /**
+         * @return Whether the given data looks like a binary savegame
+         */
+        bool isBinary(const std::vector<uint8_t>& data);
+
+        /**
+         * LZ-compresses the given data and puts it into the compressed-container
+         */
+        void compress(const std::vector<uint8_t>& data, std::vector<uint8_t>& out);
+
+        /**
+         * Unpacks data written by compress()
+         * @return False, if the data was invalid
+         */
+        bool decompress(const std::vector<uint8_t>& data, std::vector<uint8_t>& out);
+
+        /**
+         * @return Whether the given data is a compressed savegame
+         */
+        bool isCompressed(const std::vector<uint8_t>& data);
+
+        /**
+         * Encodes the given document in the given format
+         */
+        void encode(const json& j, ESaveFormat format, std::vector<uint8_t>& out);
+
+        /**
+         * Encodes the given document as json, like the engine always did. Strings are converted to UTF-8.
+         */
+        std::string writeJson(const json& j);
+
+        /**
+         * Writes the given document into a file. The data is written to a temporary file first, which then
+         * replaces the target, so a crash while saving won't leave a broken savegame behind.
+         * @param j Document to write
+         * @param file Target file
+         * @param format Format to use
+         * @return Whether the file could be written
+         */
+        bool saveToFile(const json& j, const std::string& file, ESaveFormat format = SF_CompressedBinary);
+
+        /**
+         * Writes already encoded data to the given file, using a temporary file and a rename
+         */
+        bool writeFileAtomic(const std::vector<uint8_t>& data, const std::string& file);
+
+        /**
+         * Reads a savegame-file of any supported format
+         * @param file File to read
+         * @param out Document to write into
+         * @return Whether the file could be read
+         */
+        bool loadFromFile(const std::string& file, json& out);
+
+        /**
+         * Writes savegames on a background-thread. The caller hands over a snapshot of the world-state,
+         * which is then encoded, compressed and written without touching the world again.
+         */
+        class AsyncWriter
+        {
+        public:
+            enum EState
+            {
+                S_Idle,
+                S_Encoding,
+                S_Compressing,
+                S_Writing,
+                S_Done
+            };
+
+            AsyncWriter();
+            ~AsyncWriter();
+
+            /**
+             * Starts writing the given snapshot
+             * @param snapshot State to write. Taken over by the writer.
+             * @param file Target file
+             * @param format Format to use
+             * @return False, if there already is a save in progress
+             */
+            bool start(json&& snapshot, const std::string& file, ESaveFormat format = SF_CompressedBinary);
+
+            /**
+             * @return Whether a save is currently running
+             */
+            bool isBusy() const { return getState() != S_Idle && getState() != S_Done; }
+
+            /**
+             * @return What the background-thread is doing right now
+             */
+            EState getState() const { return static_cast<EState>(m_State.load()); }
+
+            /**
+             * @return Rough progress of the current save, 0..1
+             */
+            float getProgress() const;
+
+            /**
+             * @return File currently being written
+             */
+            const std::string& getFile() const { return m_File; }
+
+            /**
+             * Blocks until the current save is done
+             */
+            void wait();
+
+            /**
+             * Collects the result of a finished save. Returns true only once per save, also after wait().
+             * @param success Whether the file was written successfully
+             * @param file File which was written
+             */
+            bool pollFinished(bool& success, std::string& file);
+
+        private:
+
+            /**
+             * Thread-function
+             */
+            void run(ESaveFormat format);
+
+            std::thread m_Thread;
+            std::atomic<int> m_State;
+            std::atomic<bool> m_Success;
+            json m_Snapshot;
+            std::string m_File;
+        };
+    }
+}
@@ -3,9 +3,11 @@
 //
 
 #include <utils/logger.h>
-#include <set>
 #include <numeric>
 #include <algorithm>
+#include <queue>
+#include <functional>
+#include <cfloat>
 #include "Waynet.h"
 
 using namespace World;
@@ -27,7 +29,7 @@ Waynet::WaynetInstance Waynet::makeWaynetFromZen(const ZenLoad::oCWorldData& zen
     for(const ZenLoad::zCWaypointData& zwp : zenWorld.waynet.waypoints)
     {
         Waypoint wp;
-        wp.name = zwp.wpName;
+        wp.name = Utils::Name(zwp.wpName);
 
         // FIXME: Only temporary, to make NPCs walk on the ground rather than IN the ground while there is no physics engine
         const float heightOffset = 0.0f;
@@ -64,91 +66,67 @@ Waynet::WaynetInstance Waynet::makeWaynetFromZen(const ZenLoad::oCWorldData& zen
 
 std::vector<size_t> Waynet::findWay(const WaynetInstance& waynet, size_t start, size_t end)
 {
-    // FIXME: This is not a very fast implementation. Improve!
-    // Simple Dijkstra-Implementation. Totally non-optimized.
+    // Dijkstra over a binary heap. Edges are weighted by their squared length.
+    const size_t num = waynet.waypoints.size();
 
+    if(start >= num || end >= num || start == end)
+        return std::vector<size_t>();
 
-    //LogInfo() << "Entered function: " << start;
-
-    // Give all other nodes a distance of infinity
-    std::vector<float> distances(waynet.waypoints.size(), FLT_MAX);
-    std::vector<size_t> prev(waynet.waypoints.size(), static_cast<size_t>(-1));
-    std::set<size_t> unvisitedSet;
+    std::vector<float> distances(num, FLT_MAX);
+    std::vector<size_t> prev(num, static_cast<size_t>(-1));
+    std::vector<char> visited(num, 0);
 
-    for(size_t i=0;i<waynet.waypoints.size();i++)
-        unvisitedSet.insert(i);
+    // Nodes can be in here more than once, only the entry with the shortest distance counts
+    typedef std::pair<float, size_t> OpenNode;
+    std::priority_queue<OpenNode, std::vector<OpenNode>, std::greater<OpenNode>> open;
 
-    // Init startnode with a distance of 0
     distances[start] = 0.0f;
-    size_t cn = start;
+    open.push(OpenNode(0.0f, start));
 
-    //LogInfo() << "Starting: " << cn;
-
-    do
+    while(!open.empty())
     {
+        size_t cn = open.top().second;
+        open.pop();
 
-        for (size_t e : waynet.waypoints[cn].edges)
-        {
-            if (unvisitedSet.find(e) != unvisitedSet.end())
-            {
-                // Check if this actually was a shorter path
-                float tentativeDist =
-                        distances[cn] + (waynet.waypoints[cn].position - waynet.waypoints[e].position).lengthSquared();
-                if (distances[e] > tentativeDist)
-                {
-                    distances[e] = tentativeDist;
-                    prev[e] = cn;
-                }
-            }
-        }
+        if(visited[cn])
+            continue;
 
-        //LogInfo() << "Visited: " << cn;
+        visited[cn] = 1;
 
-        unvisitedSet.erase(cn);
+        if(cn == end)
+            break;
 
-        if(!unvisitedSet.empty())
+        for (size_t e : waynet.waypoints[cn].edges)
         {
-            size_t smallest = *unvisitedSet.begin();
-            for (size_t n : unvisitedSet)
+            if(visited[e])
+                continue;
+
+            // Check if this actually was a shorter path
+            float tentativeDist =
+                    distances[cn] + (waynet.waypoints[cn].position - waynet.waypoints[e].position).lengthSquared();
+
+            if (distances[e] > tentativeDist)
             {
-                if (distances[smallest] > distances[n])
-                {
-                    smallest = n;
-                }
+                distances[e] = tentativeDist;
+                prev[e] = cn;
+                open.push(OpenNode(tentativeDist, e));
             }
-
-            cn = smallest;
         }
-
-
-    }while(unvisitedSet.find(end) != unvisitedSet.end() && cn != static_cast<size_t>(-1) && cn != end);
+    }
 
     // No path found
-    if(cn == static_cast<size_t>(-1))
+    if(prev[end] == static_cast<size_t>(-1))
         return std::vector<size_t>();
 
     // Put path together
     std::vector<size_t> path;
-    cn = end;
-
-    while(prev[cn] != static_cast<size_t>(-1))
-    {
+    for(size_t cn = end; cn != start; cn = prev[cn])
         path.push_back(cn);
-        cn = prev[cn];
-    }
 
-    // Happens on short paths
-    if(!path.empty() && path.back() != start)
-        path.push_back(start);
+    path.push_back(start);
 
     std::reverse(path.begin(), path.end());
 
-    /*LogInfo() << " ---------- PATH ----------";
-    for(size_t p : path)
-    {
-        LogInfo() << " - " << waynet.waypoints[p].name;
-    }*/
-
     return path;
 }
 
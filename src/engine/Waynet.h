@@ -1,9 +1,11 @@
 #pragma once
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <vector>
 #include <zenload/zTypes.h>
 #include <math/mathlib.h>
+#include <utils/Name.h>
 
 namespace World
 {
@@ -18,7 +20,7 @@ namespace World
 
         struct Waypoint
         {
-            std::string name;
+            Utils::Name name;
             std::string classname;
             Math::float3 position;
             Math::float3 direction;
@@ -41,7 +43,7 @@ namespace World
             /**
              * Map of waypoint names to their indices in the waypoints-vector
              */
-            std::map <std::string, WaypointIndex> waypointsByName;
+            std::unordered_map <Utils::Name, WaypointIndex> waypointsByName;
         };
 
 		/**
@@ -84,7 +86,7 @@ namespace World
         /**
          * @return True, if the given waypoint exists inside the waynet
          */
-        inline bool waypointExists(const WaynetInstance& waynet, const std::string& wp)
+        inline bool waypointExists(const WaynetInstance& waynet, const Utils::Name& wp)
         {
             return waynet.waypointsByName.find(wp) != waynet.waypointsByName.end();
         }
@@ -92,7 +94,7 @@ namespace World
         /**
          * @return Index of the waypoint named like the input string
          */
-        inline size_t getWaypointIndex(const WaynetInstance& waynet, const std::string& wp)
+        inline size_t getWaypointIndex(const WaynetInstance& waynet, const Utils::Name& wp)
         {
             auto it = waynet.waypointsByName.find(wp);
 
@@ -101,5 +103,21 @@ namespace World
 
             return (*it).second;
         }
+
+        inline size_t getWaypointIndex(const WaynetInstance& waynet, const std::string& wp)
+        {
+            Utils::Name n = Utils::Name::find(wp);
+
+            // Never interned, so it can't be a waypoint. Don't let it match an unnamed one.
+            if(n.empty() && !wp.empty())
+                return INVALID_WAYPOINT;
+
+            return getWaypointIndex(waynet, n);
+        }
+
+        inline bool waypointExists(const WaynetInstance& waynet, const std::string& wp)
+        {
+            return getWaypointIndex(waynet, wp) != INVALID_WAYPOINT;
+        }
     }
 }
@@ -12,6 +12,9 @@
 #include <logic/MobController.h>
 #include <stdlib.h>
 #include <iterator>
+#include <thread>
+#include <algorithm>
+#include <limits>
 
 #include <engine/GameEngine.h>
 #include <debugdraw/debugdraw.h>
@@ -20,17 +23,105 @@
 #include <entry/input.h>
 #include <ui/PrintScreenMessages.h>
 #include <ZenLib/zenload/zTypes.h>
+#include <bx/timer.h>
+#include <utils/Profiler.h>
+#include <content/AssetCache.h>
+#include <content/VDFSLock.h>
+#include "WorldLoader.h"
 
 using namespace World;
 
+namespace
+{
+    /**
+     * @return Whether the given vob-visual is a static mesh, which can be loaded up front. Writes the name
+     *         setVisual() will look it up by to out, if so.
+     */
+    bool getStaticVisualName(const std::string& vobVisual, std::string& out)
+    {
+        if(vobVisual.empty())
+            return false;
+
+        // Same as setVisual() does
+        out = vobVisual;
+        std::transform(out.begin(), out.end(), out.begin(), ::toupper);
+
+        return out.find(".3DS") != std::string::npos
+               || out.find(".MMB") != std::string::npos
+               || out.find(".MMS") != std::string::npos
+               || out.find(".MDMS") != std::string::npos;
+    }
+}
+
+bool World::prepareZen(const VDFS::FileIndex& idx, const std::string& zen, PreparedZen& out, Content::AssetCache* assetCache)
+{
+    PROFILE_SCOPE("World::prepareZen");
+
+    // The parser reads the whole file right away, everything after that works on its own copy
+    std::unique_lock<std::mutex> lock = Content::lockVDFS();
+
+    if(!idx.hasFile(zen))
+        return false;
+
+    out.zen = zen;
+
+    ZenLoad::ZenParser parser(zen, idx);
+    lock.unlock();
+
+    parser.readHeader();
+    out.world = ZenLoad::oCWorldData();
+    parser.readWorld(out.world);
+
+    out.worldMesh = ZenLoad::PackedMesh();
+    parser.getWorldMesh()->packMesh(out.worldMesh, 0.01f);
+
+    if(!assetCache)
+        return true;
+
+    std::set<std::string> uniqueTextures;
+    for(const auto& sm : out.worldMesh.subMeshes)
+        uniqueTextures.insert(sm.material.texture);
+
+    std::set<std::string> uniqueVisuals;
+    std::function<void(const std::vector<ZenLoad::zCVobData>&)> collect = [&](const std::vector<ZenLoad::zCVobData>& list)
+    {
+        for (const ZenLoad::zCVobData& v : list)
+        {
+            std::string visual;
+            if(getStaticVisualName(v.visual, visual))
+                uniqueVisuals.insert(visual);
+
+            collect(v.childVobs);
+        }
+    };
+    collect(out.world.rootVobs);
+
+    for(const Content::AssetCache::MeshPtr& mesh : assetCache->getMeshes(idx, std::vector<std::string>(uniqueVisuals.begin(), uniqueVisuals.end())))
+    {
+        if(!mesh)
+            continue;
+
+        for(const auto& sm : mesh->subMeshes)
+            uniqueTextures.insert(sm.material.texture);
+    }
+
+    assetCache->getTextures(idx, std::vector<std::string>(uniqueTextures.begin(), uniqueTextures.end()));
+
+    return true;
+}
+
 WorldInstance::WorldInstance()
 	: m_WorldMesh(*this),
       m_ScriptEngine(*this),
       m_PhysicsSystem(*this),
       m_Sky(*this),
+      m_AIScheduler(*this),
+      m_OffscreenSimulation(*this),
       m_DialogManager(*this),
-      m_PrintScreenMessageView(nullptr)
+      m_PrintScreenMessageView(nullptr),
+      m_AnimHandlerPoolFull(false)
 {
+    m_LastFrameTimings = {};
 	
 }
 
@@ -38,6 +129,8 @@ void WorldInstance::init(Engine::BaseEngine& engine)
 {
 	m_Allocators.m_LevelTextureAllocator.setVDFSIndex(&engine.getVDFSIndex());
     m_Allocators.m_LevelStaticMeshAllocator.setVDFSIndex(&engine.getVDFSIndex());
+    m_Allocators.m_LevelTextureAllocator.setAssetCache(&engine.getAssetCache());
+    m_Allocators.m_LevelStaticMeshAllocator.setAssetCache(&engine.getAssetCache());
     m_Allocators.m_LevelSkeletalMeshAllocator.setVDFSIndex(&engine.getVDFSIndex());
     m_Allocators.m_AnimationAllocator.setVDFSIndex(&engine.getVDFSIndex());
     m_AudioEngine.setVDFSIndex(&engine.getVDFSIndex());
@@ -55,13 +148,16 @@ void WorldInstance::init(Engine::BaseEngine& engine)
     getEngine()->getRootUIView().addChild(m_PrintScreenMessageView);
 }
 
-void WorldInstance::init(Engine::BaseEngine& engine, const std::string& zen, const json& j)
+void WorldInstance::init(Engine::BaseEngine& engine, const std::string& zen, const json& j, PreparedZen* prepared)
 {
-    m_ZenFile = zen;
+    PROFILE_SCOPE("World::init");
 
-	// Call other overload
-	init(engine);
+    WorldLoader loader(*this, engine, zen, j, prepared);
+    loader.finish();
+}
 
+void WorldInstance::loadScripts()
+{
 	// Init daedalus-vm
 	std::string datPath = "/_work/data/Scripts/_compiled/GOTHIC.DAT";
 	std::string datFile = Utils::getCaseSensitivePath(datPath, m_pEngine->getEngineArgs().gameBaseDirectory);
@@ -73,230 +169,97 @@ void WorldInstance::init(Engine::BaseEngine& engine, const std::string& zen, con
 	{
 		LogError() << "Failed to find GOTHIC.DAT at: " << datFile;
 	}
+}
 
-	// Load world
-    if(!zen.empty())
-    {
-        // Load ZEN
-        ZenLoad::ZenParser parser(zen, engine.getVDFSIndex());
-
-        parser.readHeader();
-        ZenLoad::oCWorldData world;
-		parser.readWorld(world);
-
-        ZenLoad::zCMesh *worldMesh = parser.getWorldMesh();
+void WorldInstance::initWorldMesh(PreparedZen& prepared)
+{
+    PROFILE_SCOPE("World::initWorldMesh");
 
-        LogInfo() << "Postprocessing worldmesh...";
+    ZenLoad::PackedMesh& packedWorldMesh = prepared.worldMesh;
 
-        ZenLoad::PackedMesh packedWorldMesh;
-        worldMesh->packMesh(packedWorldMesh, 0.01f);
+    // Init worldmesh-wrapper
+    m_WorldMesh.load(packedWorldMesh);
 
-        // Init worldmesh-wrapper
-        m_WorldMesh.load(packedWorldMesh);
+    Handle::MeshHandle worldMeshHandle = getStaticMeshAllocator().loadFromPacked(packedWorldMesh);
+    Meshes::WorldStaticMesh &worldMeshData = getStaticMeshAllocator().getMesh(worldMeshHandle);
 
-        Handle::MeshHandle worldMeshHandle = getStaticMeshAllocator().loadFromPacked(packedWorldMesh);
-        Meshes::WorldStaticMesh &worldMeshData = getStaticMeshAllocator().getMesh(worldMeshHandle);
+    // TODO: Put these into a compound-component or something
+    std::vector<Handle::EntityHandle> ents = Content::entitifyMesh(*this, worldMeshHandle, worldMeshData.mesh);
 
-        // TODO: Put these into a compound-component or something
-        std::vector<Handle::EntityHandle> ents = Content::entitifyMesh(*this, worldMeshHandle, worldMeshData.mesh);
+    // If we haven't already, create an instancebuffer for this mesh
+    //if(worldMeshData.instanceDataBufferIndex == (uint32_t)-1)
+    //    worldMeshData.instanceDataBufferIndex = ((Engine::GameEngine*)m_pEngine)->getDefaultRenderSystem().requestInstanceDataBuffer();
 
-        // If we haven't already, create an instancebuffer for this mesh
-        //if(worldMeshData.instanceDataBufferIndex == (uint32_t)-1)
-        //    worldMeshData.instanceDataBufferIndex = ((Engine::GameEngine*)m_pEngine)->getDefaultRenderSystem().requestInstanceDataBuffer();
+    // Create collisionmesh for the world
+    if(!ents.empty())
+    {
+        LogInfo() << "Generating world collision mesh...";
 
-        // Create collisionmesh for the world
-        if(!ents.empty())
-        {
-            LogInfo() << "Generating world collision mesh...";
+        // Create world-object using the static collision-shape
+        Components::PhysicsComponent& phys = Components::Actions::initComponent<Components::PhysicsComponent>(getComponentAllocator(), ents.front());
 
-            // Create world-object using the static collision-shape
-            Components::PhysicsComponent& phys = Components::Actions::initComponent<Components::PhysicsComponent>(getComponentAllocator(), ents.front());
+        phys.m_PhysicsObject = m_StaticWorldMeshCollsionShape;
+        phys.m_IsStatic = true;
 
-            phys.m_PhysicsObject = m_StaticWorldMeshCollsionShape;
-            phys.m_IsStatic = true;
+        // Create triangle-array
+        std::vector<Math::float3> triangles;
+        triangles.reserve(packedWorldMesh.vertices.size()); // Note: there are likely more
 
-            // Create triangle-array
-            std::vector<Math::float3> triangles;
-            triangles.reserve(packedWorldMesh.vertices.size()); // Note: there are likely more
+        for(auto& tri : packedWorldMesh.triangles)
+        {
+            triangles.push_back(tri.vertices[0].Position.v);
+            triangles.push_back(tri.vertices[1].Position.v);
+            triangles.push_back(tri.vertices[2].Position.v);
 
-            for(auto& tri : packedWorldMesh.triangles)
+            for(int i=0;i<3;i++)
             {
-                triangles.push_back(tri.vertices[0].Position.v);
-                triangles.push_back(tri.vertices[1].Position.v);
-                triangles.push_back(tri.vertices[2].Position.v);
-
-                for(int i=0;i<3;i++)
-                {
-                    if(Math::float3(tri.vertices[i].Position.v).length() < 100)
-                        tri.vertices[i].Color = 0x00000000;
-                }
+                if(Math::float3(tri.vertices[i].Position.v).length() < 100)
+                    tri.vertices[i].Color = 0x00000000;
             }
-
-            // Add world-mesh collision
-            Handle::CollisionShapeHandle wmch = m_PhysicsSystem.makeCollisionShapeFromMesh(triangles, Physics::CollisionShape::CT_WorldMesh);
-            m_PhysicsSystem.compoundShapeAddChild(m_StaticWorldMeshCollsionShape, wmch);
-        }
-
-        // Make sure static collision is initialized before adding the VOBs
-        m_PhysicsSystem.postProcessLoad();
-
-        for (Handle::EntityHandle e : ents)
-        {
-            // Init positions
-            Components::EntityComponent &entity = getEntity<Components::EntityComponent>(e);
-            Components::addComponent<Components::PositionComponent>(entity);
-
-            // Copy world-matrix (These are all identiy on the worldmesh)
-            Components::PositionComponent &pos = getEntity<Components::PositionComponent>(e);
-            pos.m_WorldMatrix = Math::Matrix::CreateIdentity();
-            pos.m_WorldMatrix.Translation(pos.m_WorldMatrix.Translation() * (1.0f / 100.0f));
-            pos.m_DrawDistanceFactor = -1.0f; // Always draw the worldmesh
-
-            Components::StaticMeshComponent& sm = getEntity<Components::StaticMeshComponent>(e);
-            sm.m_InstanceDataIndex = (uint32_t)-2; // Disable instancing
         }
 
-		// TODO: Refractor. Make a map of all vobs by classes or something.
-		ZenLoad::zCVobData startPoint;
-
-        std::function<void(const std::vector<ZenLoad::zCVobData>)> vobLoad = [&](
-                const std::vector<ZenLoad::zCVobData> &vobs) {
-            for (const ZenLoad::zCVobData &v : vobs)
-            {
-                vobLoad(v.childVobs);
-
-                bool allowCollision = true; // FIXME: Hack. Items shouldn't be placed into physicsworld right now
-
-				// Check for special vobs // FIXME: Should be somewhere else
-				Vob::VobInformation vob;
-				Handle::EntityHandle e;
-				if(v.objectClass == "oCItem:zCVob")
-				{
-					// Get item instance
-					if(getScriptEngine().hasSymbol(v.oCItem.instanceName))
-					{
-                        e = VobTypes::createItem(*this, v.oCItem.instanceName);
-
-						vob = Vob::asVob(*this, e);
-
-                        allowCollision = false;
-					}
-					else{
-						LogWarn() << "Invalid item instance: " << v.oCItem.instanceName;
-					}
-				}else if(v.objectClass.find("oCMobInter:oCMOB") != std::string::npos)
-                {
-                    e = VobTypes::createMob(*this);
-                    VobTypes::MobVobInformation mob = VobTypes::asMobVob(*this, e);
-                    mob.mobController->initFromVobDescriptor(v);
-
-                    vob = Vob::asVob(*this, e);
-                }
-				else {
-					// Normal zCVob or not implemented subclass
-					e = Vob::constructVob(*this);
-					vob = Vob::asVob(*this, e);
-				}
-
-				if(!vob.isValid())
-					continue;
-
-				// Setup
-				if(!v.vobName.empty())
-				{
-					Vob::setName(vob, v.vobName);
-
-					// Add to name-map
-					m_VobsByNames[v.vobName] = e;
-				}
-
-                // Set position
-                Math::Matrix m = Math::Matrix(v.worldMatrix.mv);
-                m.Translation(m.Translation() * (1.0f / 100.0f));
-                Vob::setTransform(vob, m);
-
-				// TODO: Need those without visual as well!
-				if(v.visual.empty())
-				{
-					// Check for startingpoint
-					if(v.objectClass == "zCVobStartpoint:zCVob")
-					{
-						startPoint = v;
-					}
-
-                    // Check for freepoint
-                    if(v.objectClass == "zCVobSpot:zCVob")
-                    {
-                        // Register freepoint
-                        Handle::EntityHandle h = addEntity(Components::ObjectComponent::MASK | Components::SpotComponent::MASK | Components::PositionComponent::MASK);
-                        getEntity<Components::ObjectComponent>(h).m_Name = v.vobName;
-                        m_FreePoints[v.vobName] = h;
-                    }
-				}
-				else
-				{
-					// Set whether we want collision with this vob
-					Vob::setCollisionEnabled(vob, v.cdDyn && allowCollision);
-
-                    Utils::BBox3D bbox = {Math::float3(v.bbox[0].v) * (1.0f / 100.0f),
-                                          Math::float3(v.bbox[1].v) * (1.0f / 100.0f)};
-
-                    //LogInfo() << "Vobsize (" << v.visual << "): " << (bbox.max - bbox.min).length() / 10.0f;
-                    vob.position->m_DrawDistanceFactor = std::max(0.12f, std::min(1.0f, (bbox.max - bbox.min).length() / 10.0f));
-                    //LogInfo() << "DistanceFactor (" << v.visual << "): " << vob.position->m_DrawDistanceFactor;
-
-					Vob::setVisual(vob, v.visual);
-
-					//if(!vob.visual)
-					//    LogInfo() << "No visual for: " << v.visual;
-
-
-
-					Vob::setBBox(vob, Math::float3(v.bbox[0].v) * (1.0f / 100.0f) - m.Translation(),
-						Math::float3(v.bbox[1].v) * (1.0f / 100.0f) - m.Translation(),
-						0 /*vob.visual ? 0 : 0xFF00AA00*/);
+        // Add world-mesh collision
+        Handle::CollisionShapeHandle wmch = m_PhysicsSystem.makeCollisionShapeFromMesh(triangles, Physics::CollisionShape::CT_WorldMesh);
+        m_PhysicsSystem.compoundShapeAddChild(m_StaticWorldMeshCollsionShape, wmch);
+    }
 
+    // Make sure static collision is initialized before adding the VOBs
+    m_PhysicsSystem.postProcessLoad();
 
+    for (Handle::EntityHandle e : ents)
+    {
+        // Init positions
+        Components::addComponent<Components::PositionComponent>(getComponentAllocator(), e);
 
-					// Trace down from this vob to get the shadow-value from the worldmesh
-					Math::float3 traceStart = Math::float3(m.Translation().x, v.bbox[1].y * (1.0f / 100.0f) , m.Translation().z);
-					Math::float3 traceEnd = Math::float3(m.Translation().x, (v.bbox[0].y * (1.0f / 100.0f)) - 5.0f, m.Translation().z);
-					Physics::RayTestResult hit = m_PhysicsSystem.raytrace(traceStart, traceEnd,
-						Physics::CollisionShape::CT_WorldMesh); // FIXME: Use boundingbox for this
+        // Copy world-matrix (These are all identiy on the worldmesh)
+        Components::PositionComponent &pos = getEntity<Components::PositionComponent>(e);
+        pos.m_WorldMatrix = Math::Matrix::CreateIdentity();
+        pos.m_WorldMatrix.Translation(pos.m_WorldMatrix.Translation() * (1.0f / 100.0f));
+        pos.m_DrawDistanceFactor = -1.0f; // Always draw the worldmesh
 
-					if(hit.hasHit)
-					{
-						float shadow = m_WorldMesh.interpolateTriangleShadowValue(hit.hitTriangleIndex, hit.hitPosition);
+        Components::StaticMeshComponent& sm = getEntity<Components::StaticMeshComponent>(e);
+        sm.m_InstanceDataIndex = (uint32_t)-2; // Disable instancing
+    }
+}
 
-						if(Vob::getVisual(vob))
-							Vob::getVisual(vob)->setShadowValue(shadow);
+void WorldInstance::finishLoading(const PreparedZen* prepared, const ZenLoad::zCVobData& startPoint, const json& j)
+{
+    PROFILE_SCOPE("World::finishLoading");
 
-					}else
-                    {
-                        if(Vob::getVisual(vob))
-                            Vob::getVisual(vob)->setShadowValue(0.6);
-                    }
-				}
-            }
-        };
+    if(prepared)
+    {
+        // Make sure static collision is initialized before adding the NPCs
+        m_PhysicsSystem.postProcessLoad();
 
-        if(j.empty())
         {
-            // Load vobs from zen (initial load)
-            LogInfo() << "Inserting vobs from zen...";
-            vobLoad(world.rootVobs);
-        } else
-        {
-            // Load vobs from saved json (Savegame)
-            LogInfo() << "Inserting vobs from json...";
-            importVobs(j["vobs"]);
+            Physics::CollisionShapeLibrary::Stats cs = m_pEngine->getCollisionShapeLibrary().getStats();
+            LogInfo() << "Collision-shape library: " << cs.numShapes << " shapes, " << cs.numHits << " hits, "
+                      << cs.numMisses << " builds (" << cs.buildTimeSpent * 1000.0 << "ms built, "
+                      << cs.buildTimeSaved * 1000.0 << "ms saved so far)";
         }
 
-        // Make sure static collision is initialized before adding the NPCs
-        m_PhysicsSystem.postProcessLoad();
-
         // Load waynet
-        m_Waynet = Waynet::makeWaynetFromZen(world);
+        m_Waynet = Waynet::makeWaynetFromZen(prepared->world);
 
 		// Insert startpoint as a waypoint with the name zCVobStartpoint:zCVob.
 		if(!startPoint.objectClass.empty())
@@ -304,19 +267,30 @@ void WorldInstance::init(Engine::BaseEngine& engine, const std::string& zen, con
 			Waynet::Waypoint startWP;
 			startWP.classname = startPoint.objectClass;
 			startWP.direction = Math::float3(startPoint.rotationMatrix.Forward().v);
-			startWP.name = startPoint.objectClass;
+			startWP.name = Utils::Name(startPoint.objectClass);
 			startWP.position = (1.0f / 100.0f) * Math::float3(startPoint.position.v);
 			startWP.underWater = false;
 			startWP.waterDepth = 0;
 			Waynet::addWaypoint(m_Waynet, startWP);
 		}
 
+        // Delta-saves only store what changed since the initial load, so they need the ZEN-state
+        bool isDelta = !j.empty() && isDeltaSave(j);
+
         // Init script-engine
-        initializeScriptEngineForZenWorld(zen.substr(0, zen.find('.')), j.empty());
-        //initializeScriptEngineForZenWorld(zen.substr(0, zen.find('.')), false);
+        initializeScriptEngineForZenWorld(m_ZenFile.substr(0, m_ZenFile.find('.')), j.empty() || isDelta);
+        //initializeScriptEngineForZenWorld(m_ZenFile.substr(0, m_ZenFile.find('.')), false);
+
+        // This is what the world looks like without any savegame
+        if(j.empty() || isDelta)
+            captureSaveBaseline();
 
         // Load values from savegame, if there is one
-        if(!j.empty())
+        if(isDelta)
+        {
+            importWorldDelta(j);
+        }
+        else if(!j.empty())
         {
             m_ScriptEngine.importScriptEngine(j["scriptEngine"]);
             m_DialogManager.importDialogManager(j["dialogManager"]);
@@ -363,6 +337,238 @@ void WorldInstance::init(Engine::BaseEngine& engine, const std::string& zen, con
     m_TestEntity = e;*/
 }
 
+WorldInstance::VobLoadStats WorldInstance::insertVobs(const std::vector<ZenLoad::zCVobData>& rootVobs, ZenLoad::zCVobData* startPoint)
+{
+    PROFILE_SCOPE("World::insertVobs");
+
+    VobInsertion insertion;
+    beginInsertVobs(rootVobs, startPoint, insertion);
+    continueInsertVobs(insertion, std::numeric_limits<int64_t>::max());
+
+    return insertion.stats;
+}
+
+void WorldInstance::beginInsertVobs(const std::vector<ZenLoad::zCVobData>& rootVobs, ZenLoad::zCVobData* startPoint, VobInsertion& out)
+{
+    const double freq = double(bx::getHPFrequency());
+    int64_t stageStart = bx::getHPCounter();
+
+    out = VobInsertion();
+    out.startPoint = startPoint;
+    out.visualsLoaded = false;
+    out.numTraced = 0;
+    out.numCreated = 0;
+
+    /****
+     * Stage 1: Flatten the vob-tree. Children come before their parents.
+     ****/
+
+    std::function<void(const std::vector<ZenLoad::zCVobData>&)> flatten = [&](const std::vector<ZenLoad::zCVobData>& list)
+    {
+        for (const ZenLoad::zCVobData& v : list)
+        {
+            flatten(v.childVobs);
+            out.vobs.push_back(&v);
+        }
+    };
+    flatten(rootVobs);
+
+    out.shadowValues.resize(out.vobs.size(), 0.6f);
+
+    out.stats.numVobs = out.vobs.size();
+    out.stats.timeFlatten = (bx::getHPCounter() - stageStart) / freq;
+}
+
+bool WorldInstance::continueInsertVobs(VobInsertion& insertion, int64_t deadline)
+{
+    // Checking the time for every single vob would cost more than some of them take
+    const size_t VOBS_PER_CHECK = 16;
+
+    const double freq = double(bx::getHPFrequency());
+    const std::vector<const ZenLoad::zCVobData*>& vobs = insertion.vobs;
+    VobLoadStats& stats = insertion.stats;
+    int64_t stageStart = bx::getHPCounter();
+
+    /****
+     * Stage 2: Load all unique static-mesh visuals and their textures. setVisual() will hit the caches then.
+     * Models are still loaded on demand.
+     ****/
+
+    if(!insertion.visualsLoaded)
+    {
+        std::set<std::string> uniqueVisuals;
+        for (const ZenLoad::zCVobData* v : vobs)
+        {
+            std::string visual;
+            if(getStaticVisualName(v->visual, visual))
+                uniqueVisuals.insert(visual);
+        }
+
+        std::vector<std::string> textures;
+        getStaticMeshAllocator().preloadMeshesVDF(std::vector<std::string>(uniqueVisuals.begin(), uniqueVisuals.end()), &textures);
+
+        std::set<std::string> uniqueTextures(textures.begin(), textures.end());
+        getTextureAllocator().preloadTexturesVDF(std::vector<std::string>(uniqueTextures.begin(), uniqueTextures.end()));
+
+        insertion.visualsLoaded = true;
+
+        stats.numUniqueVisuals = uniqueVisuals.size();
+        stats.timeLoadVisuals = (bx::getHPCounter() - stageStart) / freq;
+        stageStart = bx::getHPCounter();
+
+        if(stageStart >= deadline)
+            return false;
+    }
+
+    /****
+     * Stage 3: Trace down from all visual vobs to get their shadow-values from the worldmesh
+     ****/
+
+    while (insertion.numTraced < vobs.size())
+    {
+        const ZenLoad::zCVobData& v = *vobs[insertion.numTraced++];
+
+        if(!v.visual.empty())
+        {
+            Math::float3 position = Math::Matrix(v.worldMatrix.mv).Translation() * (1.0f / 100.0f);
+            Math::float3 traceStart = Math::float3(position.x, v.bbox[1].y * (1.0f / 100.0f), position.z);
+            Math::float3 traceEnd = Math::float3(position.x, (v.bbox[0].y * (1.0f / 100.0f)) - 5.0f, position.z);
+            Physics::RayTestResult hit = m_PhysicsSystem.raytrace(traceStart, traceEnd,
+                                                                  Physics::CollisionShape::CT_WorldMesh); // FIXME: Use boundingbox for this
+
+            if(hit.hasHit)
+                insertion.shadowValues[insertion.numTraced - 1] = m_WorldMesh.interpolateTriangleShadowValue(hit.hitTriangleIndex, hit.hitPosition);
+        }
+
+        if(insertion.numTraced % VOBS_PER_CHECK == 0 && bx::getHPCounter() >= deadline)
+        {
+            stats.timeShadowTrace += (bx::getHPCounter() - stageStart) / freq;
+            return false;
+        }
+    }
+
+    stats.timeShadowTrace += (bx::getHPCounter() - stageStart) / freq;
+    stageStart = bx::getHPCounter();
+
+    /****
+     * Stage 4: Create the entities
+     ****/
+
+    ZenLoad::zCVobData* startPoint = insertion.startPoint;
+
+    size_t numCreatedNow = 0;
+    while (insertion.numCreated < vobs.size())
+    {
+        if(numCreatedNow++ > 0 && insertion.numCreated % VOBS_PER_CHECK == 0 && bx::getHPCounter() >= deadline)
+        {
+            stats.timeCreateEntities += (bx::getHPCounter() - stageStart) / freq;
+            return false;
+        }
+
+        size_t i = insertion.numCreated++;
+        const ZenLoad::zCVobData& v = *vobs[i];
+
+        bool allowCollision = true; // FIXME: Hack. Items shouldn't be placed into physicsworld right now
+
+        // Check for special vobs // FIXME: Should be somewhere else
+        Vob::VobInformation vob;
+        Handle::EntityHandle e;
+        if(v.objectClass == "oCItem:zCVob")
+        {
+            // Get item instance
+            if(getScriptEngine().hasSymbol(v.oCItem.instanceName))
+            {
+                e = VobTypes::createItem(*this, v.oCItem.instanceName);
+
+                vob = Vob::asVob(*this, e);
+
+                allowCollision = false;
+            }
+            else{
+                LogWarn() << "Invalid item instance: " << v.oCItem.instanceName;
+            }
+        }else if(v.objectClass.find("oCMobInter:oCMOB") != std::string::npos)
+        {
+            e = VobTypes::createMob(*this);
+            VobTypes::MobVobInformation mob = VobTypes::asMobVob(*this, e);
+            mob.mobController->initFromVobDescriptor(v);
+
+            vob = Vob::asVob(*this, e);
+        }
+        else {
+            // Normal zCVob or not implemented subclass
+            e = Vob::constructVob(*this);
+            vob = Vob::asVob(*this, e);
+        }
+
+        if(!vob.isValid())
+            continue;
+
+        // Setup
+        if(!v.vobName.empty())
+        {
+            Utils::Name name(v.vobName);
+            Vob::setName(vob, name);
+
+            // Add to name-map
+            m_VobsByNames[name] = e;
+        }
+
+        // Set position
+        Math::Matrix m = Math::Matrix(v.worldMatrix.mv);
+        m.Translation(m.Translation() * (1.0f / 100.0f));
+        Vob::setTransform(vob, m);
+
+        // TODO: Need those without visual as well!
+        if(v.visual.empty())
+        {
+            // Check for startingpoint
+            if(v.objectClass == "zCVobStartpoint:zCVob" && startPoint)
+            {
+                *startPoint = v;
+            }
+
+            // Check for freepoint
+            if(v.objectClass == "zCVobSpot:zCVob")
+            {
+                // Register freepoint
+                Handle::EntityHandle h = addEntity(Components::ObjectComponent::MASK | Components::SpotComponent::MASK | Components::PositionComponent::MASK);
+                getEntity<Components::ObjectComponent>(h).m_Name = Utils::Name(v.vobName);
+                m_FreePoints[v.vobName] = h;
+            }
+        }
+        else
+        {
+            // Set whether we want collision with this vob
+            Vob::setCollisionEnabled(vob, v.cdDyn && allowCollision);
+
+            Utils::BBox3D bbox = {Math::float3(v.bbox[0].v) * (1.0f / 100.0f),
+                                  Math::float3(v.bbox[1].v) * (1.0f / 100.0f)};
+
+            vob.position->m_DrawDistanceFactor = std::max(0.12f, std::min(1.0f, (bbox.max - bbox.min).length() / 10.0f));
+
+            Vob::setVisual(vob, v.visual);
+
+            Vob::setBBox(vob, Math::float3(v.bbox[0].v) * (1.0f / 100.0f) - m.Translation(),
+                         Math::float3(v.bbox[1].v) * (1.0f / 100.0f) - m.Translation(),
+                         0 /*vob.visual ? 0 : 0xFF00AA00*/);
+
+            if(Vob::getVisual(vob))
+                Vob::getVisual(vob)->setShadowValue(insertion.shadowValues[i]);
+        }
+    }
+
+    stats.timeCreateEntities += (bx::getHPCounter() - stageStart) / freq;
+
+    LogInfo() << "Inserted " << stats.numVobs << " vobs (" << stats.numUniqueVisuals << " unique static visuals). Timings: "
+              << "flatten " << stats.timeFlatten * 1000.0 << "ms, "
+              << "visuals " << stats.timeLoadVisuals * 1000.0 << "ms, "
+              << "shadows " << stats.timeShadowTrace * 1000.0 << "ms, "
+              << "entities " << stats.timeCreateEntities * 1000.0 << "ms";
+
+    return true;
+}
+
 void WorldInstance::initializeScriptEngineForZenWorld(const std::string& worldName, bool firstStart)
 {
 	if(!worldName.empty())
@@ -377,25 +583,20 @@ void WorldInstance::initializeScriptEngineForZenWorld(const std::string& worldNa
 
 Components::ComponentAllocator::Handle WorldInstance::addEntity(Components::ComponentMask components)
 {
+    // Other components are created and initialized once they are first accessed
     auto h = m_Allocators.m_ComponentAllocator.createObject();
 
-    Components::Actions::forAllComponents(m_Allocators.m_ComponentAllocator, h, [&](auto& c)
-    {
-        c.init(c);
-    });
-
     Components::EntityComponent& entity = m_Allocators.m_ComponentAllocator.getElement<Components::EntityComponent>(h);
-    entity.m_ComponentMask = components;
+    entity.m_ComponentMask = 0;
     entity.m_ThisEntity = h;
 
+    m_Allocators.m_ComponentAllocator.setComponentMask(h, components);
+
     /*Components::BBoxComponent& bbox = m_Allocators.m_ComponentAllocator.getElement<Components::BBoxComponent>(h);
     bbox.m_BBox3D.min = -1.0f * Math::float3(rand() % 1000,rand() % 1000,rand() % 1000);
     bbox.m_BBox3D.max = Math::float3(rand() % 1000,rand() % 1000,rand() % 1000);
     entity.m_ComponentMask |= Components::BBoxComponent::MASK;*/
 
-    Components::LogicComponent& logic = m_Allocators.m_ComponentAllocator.getElement<Components::LogicComponent>(h);
-    logic.m_pLogicController = nullptr;
-
     // TODO: Make generic "on entity created"-method or something
 
     return h;
@@ -403,6 +604,8 @@ Components::ComponentAllocator::Handle WorldInstance::addEntity(Components::Comp
 
 void WorldInstance::onFrameUpdate(double deltaTime, float updateRangeSquared, const Math::Matrix& cameraWorld)
 {
+    PROFILE_SCOPE("World::onFrameUpdate");
+
     // Set frametime in worldinfo
     m_WorldInfo.lastFrameDeltaTime = deltaTime;
     m_WorldInfo.time += deltaTime;
@@ -410,53 +613,113 @@ void WorldInstance::onFrameUpdate(double deltaTime, float updateRangeSquared, co
     // Tell script engine the frame started
     m_ScriptEngine.onFrameStart();
 
+    getComponentAllocator().countViewFrame();
+
+    const double freq = double(bx::getHPFrequency());
+    int64_t stageStart = bx::getHPCounter();
+
     // Update physics
     m_PhysicsSystem.update(deltaTime);
 
+    m_LastFrameTimings.physics = (bx::getHPCounter() - stageStart) / freq;
+    stageStart = bx::getHPCounter();
+
     // Update sky
     m_Sky.interpolate(deltaTime);
 
-    size_t num = getComponentAllocator().getNumObtainedElements();
-    const auto& ctuple = getComponentDataBundle().m_Data;
+    // Let the NPCs whose daily routine switches now pick their new entry, whether they are in update-range or not
+    m_RoutineScheduler.update(m_Sky.getTimeInMinutes(), [this](Handle::EntityHandle npc, int64_t now) -> int64_t {
+        VobTypes::NpcVobInformation vob = VobTypes::asNpcVob(*this, npc);
+
+        if(!vob.playerController)
+            return -1;
 
-    Components::EntityComponent* ents = std::get<Components::EntityComponent*>(ctuple);
-    Components::StaticMeshComponent* sms = std::get<Components::StaticMeshComponent*>(ctuple);
-    Components::LogicComponent* logics = std::get<Components::LogicComponent*>(ctuple);
-    Components::AnimationComponent* anims = std::get<Components::AnimationComponent*>(ctuple);
-    Components::PositionComponent* positions = std::get<Components::PositionComponent*>(ctuple);
+        int64_t next = vob.playerController->getAIStateMachine().onRoutineTransition(now);
 
-    //#pragma omp parallel for
-    for (size_t i = 0; i<num; i++)
+        // NPCs out of range walk to their new routine-entry on the waynet
+        m_OffscreenSimulation.onRoutineTransition(npc);
+
+        return next;
+    });
+
+    Components::ComponentAllocator& alloc = getComponentAllocator();
+
+    // Simple distance-check // TODO: Frustum/Occlusion-Culling
+    auto isInUpdateRange = [&](Handle::EntityHandle h)
     {
-        // Simple distance-check // TODO: Frustum/Occlusion-Culling
-        if(Components::hasComponent<Components::PositionComponent>(ents[i]))
+        Components::PositionComponent* position = alloc.tryGetElement<Components::PositionComponent>(h);
+        if(!position || !Components::hasComponent<Components::PositionComponent>(alloc.getElement<Components::EntityComponent>(h)))
+            return true;
+
+        return (position->m_WorldMatrix.Translation() - cameraWorld.Translation()).lengthSquared() <=
+                updateRangeSquared * position->m_DrawDistanceFactor;
+    };
+
+    m_AIScheduler.beginFrame(cameraWorld);
+
+    {
+        PROFILE_SCOPE("World::updateLogic");
+
+        // Controllers may add or remove entities while updating, which changes the list. Always check against the current size.
+        const Components::EntityList& logics = query<Components::LogicComponent::MASK>();
+
+        //#pragma omp parallel for
+        for (size_t i = 0; i<logics.size(); i++)
         {
-            if ((positions[i].m_WorldMatrix.Translation() - cameraWorld.Translation()).lengthSquared() >
-                    updateRangeSquared * positions[i].m_DrawDistanceFactor )
+            Handle::EntityHandle h = logics[i];
+            Components::LogicComponent& logic = alloc.getElement<Components::LogicComponent>(h);
+
+            if(!logic.m_pLogicController)
                 continue;
-        }
 
-        Components::ComponentMask mask = ents[i].m_ComponentMask;
-        if(Components::hasComponent<Components::LogicComponent>(ents[i]))
-        {
-            if(logics[i].m_pLogicController)
+            if(isInUpdateRange(h))
+            {
+                // Continue where the offscreen simulation got it to
+                m_OffscreenSimulation.leave(h);
+
+                logic.m_pLogicController->onUpdate(deltaTime);
+            }
+            else if(m_OffscreenSimulation.getConfig().enabled
+                    && !m_OffscreenSimulation.isSimulated(h)
+                    && h != m_ScriptEngine.getPlayerEntity()
+                    && logic.m_pLogicController->getControllerType() == Logic::EControllerType::PlayerController)
             {
-                logics[i].m_pLogicController->onUpdate(deltaTime);
+                m_OffscreenSimulation.enter(h);
             }
         }
+    }
+
+    // Run the AI-states the NPCs asked for while updating, within the budget
+    m_AIScheduler.runFrame();
+
+    m_OffscreenSimulation.update(deltaTime);
+
+    m_LastFrameTimings.logic = (bx::getHPCounter() - stageStart) / freq;
+    stageStart = bx::getHPCounter();
+
+    {
+        PROFILE_SCOPE("World::updateAnimations");
+
+        // Only entities animating themselves have a handler, the ones with a parent use the parents one
+        WorldAllocators::AnimHandlerAllocator& pool = m_Allocators.m_AnimHandlerAllocator;
+        Components::AnimHandler* handlers = pool.getElements();
 
-        // Update animations, only if there isn't a valid parent registered
-        if(Components::hasComponent<Components::AnimationComponent>(ents[i])
-            && !anims[i].m_ParentAnimHandler.isValid())
+        for (size_t i = 0, num = pool.getNumObtainedElements(); i<num; i++)
         {
-            anims[i].getAnimHandler().updateAnimations(deltaTime);
+            if(isInUpdateRange(handlers[i].getOwner()))
+                handlers[i].updateAnimations(deltaTime);
         }
     }
 
+    m_LastFrameTimings.animation = (bx::getHPCounter() - stageStart) / freq;
+    stageStart = bx::getHPCounter();
+
     // TODO: Move this somewhere else, where other game-logic is!
     // TODO: Must be done before the main-camera gets updated, actually
     if(m_ScriptEngine.getPlayerEntity().isValid())
     {
+        PROFILE_SCOPE("World::updatePlayerInput");
+
         VobTypes::NpcVobInformation player = VobTypes::asNpcVob(*this, m_ScriptEngine.getPlayerEntity());
 
         if(player.playerController)
@@ -466,6 +729,8 @@ void WorldInstance::onFrameUpdate(double deltaTime, float updateRangeSquared, co
     // Update dialogs
     m_DialogManager.update(deltaTime);
 
+    m_LastFrameTimings.logic += (bx::getHPCounter() - stageStart) / freq;
+
     // Tell script engine the frame ended
     m_ScriptEngine.onFrameEnd();
 
@@ -519,8 +784,55 @@ void WorldInstance::onFrameUpdate(double deltaTime, float updateRangeSquared, co
     }*/
 }
 
+Components::AnimHandler& WorldInstance::getAnimHandler(Handle::EntityHandle e)
+{
+    Components::AnimationComponent& anim = getEntity<Components::AnimationComponent>(e);
+    WorldAllocators::AnimHandlerAllocator& pool = m_Allocators.m_AnimHandlerAllocator;
+
+    if(!anim.m_AnimHandler.isValid())
+    {
+        if(pool.getNumObtainedElements() >= Config::MAX_NUM_LEVEL_ANIM_HANDLERS)
+        {
+            if(!m_AnimHandlerPoolFull)
+                LogWarn() << "Out of anim-handlers (" << Config::MAX_NUM_LEVEL_ANIM_HANDLERS
+                          << "), entities created from now on share one and won't animate properly";
+
+            m_AnimHandlerPoolFull = true;
+
+            // Shared by everyone who didn't get one, so it doesn't belong to any of them
+            m_FallbackAnimHandler.setWorld(*this);
+            m_FallbackAnimHandler.setOwner(Handle::EntityHandle::makeInvalidHandle());
+
+            return m_FallbackAnimHandler;
+        }
+
+        anim.m_AnimHandler = pool.createObject();
+
+        Components::AnimHandler& handler = pool.getElement(anim.m_AnimHandler);
+        handler.setWorld(*this);
+        handler.setOwner(e);
+    }
+
+    return pool.getElement(anim.m_AnimHandler);
+}
+
+Components::AnimHandler* WorldInstance::tryGetAnimHandler(Handle::EntityHandle e)
+{
+    Components::AnimationComponent* anim = getComponentAllocator().tryGetElement<Components::AnimationComponent>(e);
+
+    if(!anim || !anim->m_AnimHandler.isValid())
+        return nullptr;
+
+    return &m_Allocators.m_AnimHandlerAllocator.getElement(anim->m_AnimHandler);
+}
+
 void WorldInstance::removeEntity(Handle::EntityHandle h)
 {
+    // Give back the anim-handler
+    Components::AnimationComponent* anim = getComponentAllocator().tryGetElement<Components::AnimationComponent>(h);
+    if(anim && anim->m_AnimHandler.isValid())
+        m_Allocators.m_AnimHandlerAllocator.removeObject(anim->m_AnimHandler);
+
     // Clean all components
     Components::Actions::forAllComponents(getComponentAllocator(), h, [](auto& c)
     {
@@ -536,17 +848,17 @@ std::vector<size_t> WorldInstance::findStartPoints()
 
 	// General
 
-	auto it = m_Waynet.waypointsByName.find("zCVobStartpoint:zCVob");
-	if(it != m_Waynet.waypointsByName.end())
-		pts.push_back((*it).second);
+	size_t wp = Waynet::getWaypointIndex(m_Waynet, "zCVobStartpoint:zCVob");
+	if(wp != Waynet::INVALID_WAYPOINT)
+		pts.push_back(wp);
 
 	if(!pts.empty())
 		return pts;
 
     // Gothic 1
-    it = m_Waynet.waypointsByName.find("WP_INTRO_SHORE");
-    if(it != m_Waynet.waypointsByName.end())
-        pts.push_back((*it).second);
+    wp = Waynet::getWaypointIndex(m_Waynet, "WP_INTRO_SHORE");
+    if(wp != Waynet::INVALID_WAYPOINT)
+        pts.push_back(wp);
 
     for(size_t i=0;i<m_Waynet.waypoints.size();i++)
     {
@@ -558,7 +870,7 @@ std::vector<size_t> WorldInstance::findStartPoints()
         // Doesn't actually seem the case, tho!
 
         // Take anything with START for now
-        if(m_Waynet.waypoints[i].name.find("START") != std::string::npos)
+        if(m_Waynet.waypoints[i].name.str().find("START") != std::string::npos)
             pts.push_back(i);
     }
 
@@ -578,11 +890,12 @@ WorldInstance::getFreepointsInRange(const Math::float3& center, float distance,
 
     float closest2 = FLT_MAX;
     float distance2 = distance * distance;
+    Utils::Name fpName = Utils::Name::find(name);
     std::vector<Handle::EntityHandle> fps = getFreepoints(name);
     for(auto& fp : fps)
     {
         Components::ObjectComponent& obj = getEntity<Components::ObjectComponent>(fp);
-        if(name.empty() || obj.m_Name == name)
+        if(name.empty() || obj.m_Name == fpName)
         {
             Components::SpotComponent& sp = getEntity<Components::SpotComponent>(fp);
             Components::PositionComponent& pos = getEntity<Components::PositionComponent>(fp);
@@ -646,8 +959,175 @@ EGameType WorldInstance::getBasicGameType()
     return GT_Gothic2;
 }
 
-void WorldInstance::exportWorld(json& j)
+bool WorldInstance::exportVob(size_t idx, json& j)
 {
+    Components::ComponentAllocator& alloc = getComponentAllocator();
+    Components::EntityComponent& ent = alloc.getElements<Components::EntityComponent>()[idx];
+
+    Components::LogicComponent* logic = alloc.tryGetElement<Components::LogicComponent>(ent.m_ThisEntity);
+    Components::VisualComponent* visual = alloc.tryGetElement<Components::VisualComponent>(ent.m_ThisEntity);
+
+    bool exported = false;
+
+    // Only export if both logic and visual want to be exported
+    /*if(Components::hasComponent<Components::LogicComponent>(ent)
+       && logic && logic->m_pLogicController && !logic->m_pLogicController->shouldExport())
+        return false;
+
+    if(Components::hasComponent<Components::VisualComponent>(ent)
+       && visual && visual->m_pVisualController && !visual->m_pVisualController->shouldExport())
+        return false;*/
+
+    // Do the actual export
+    if (Components::hasComponent<Components::LogicComponent>(ent) && logic)
+    {
+        if (logic->m_pLogicController && logic->m_pLogicController->shouldExport())
+        {
+            logic->m_pLogicController->exportObject(j["logic"]);
+            exported = true;
+        }
+    }
+
+    if (Components::hasComponent<Components::VisualComponent>(ent) && visual)
+    {
+        if (visual->m_pVisualController && visual->m_pVisualController->shouldExport())
+        {
+            visual->m_pVisualController->exportObject(j["visual"]);
+            exported = true;
+        }
+    }
+
+    return exported;
+}
+
+/**
+ * @return Readable name of the component-type with the given mask
+ */
+static const char* getComponentName(Components::ComponentMask mask)
+{
+    switch(mask)
+    {
+        case Components::LogicComponent::MASK: return "Logic";
+        case Components::PositionComponent::MASK: return "Position";
+        case Components::NBBoxComponent::MASK: return "NBBox";
+        case Components::BBoxComponent::MASK: return "BBox";
+        case Components::StaticMeshComponent::MASK: return "StaticMesh";
+        case Components::CompoundComponent::MASK: return "Compound";
+        case Components::ObjectComponent::MASK: return "Object";
+        case Components::VisualComponent::MASK: return "Visual";
+        case Components::AnimationComponent::MASK: return "Animation";
+        case Components::PhysicsComponent::MASK: return "Physics";
+        case Components::SpotComponent::MASK: return "Spot";
+        default: return "Unknown";
+    }
+}
+
+/**
+ * Script-instances are kept inside the gamestate, so we can only estimate them by what is registered here
+ * @param registered Entities registered at the script-engine
+ * @param instanceSize Size of the script-instance behind each entity. 0 if there is none.
+ */
+static Memory::AllocatorStats getScriptRegistrationStats(const std::set<Handle::EntityHandle>& registered,
+                                                         size_t instanceSize)
+{
+    // Node of a std::set: 3 pointers, color and the value
+    const size_t nodeSize = 4 * sizeof(void*) + sizeof(Handle::EntityHandle);
+
+    Memory::AllocatorStats s;
+    s.numLive = registered.size();
+    s.elementSize = instanceSize + nodeSize;
+    s.numBytesAllocated = registered.size() * nodeSize;
+    s.numBytesPayload = registered.size() * instanceSize;
+
+    return s;
+}
+
+void WorldInstance::collectMemoryStats(Memory::MemoryReport& report)
+{
+    Components::ComponentAllocator& components = m_Allocators.m_ComponentAllocator;
+
+    report.add("Components", "Entity", components.getEntityStats());
+    components.forEachComponentSet([&](auto& set){
+        typedef typename std::decay<decltype(set)>::type::Type C;
+        report.add("Components", getComponentName(C::MASK), set.getStats());
+    });
+
+    report.add("Components", "AnimHandler", m_Allocators.m_AnimHandlerAllocator.getStats());
+    report.addBytes("Components", "Views", components.getNumViewBytes());
+
+    report.add("Content", "Textures", m_Allocators.m_LevelTextureAllocator.getStats());
+    report.add("Content", "Static meshes", m_Allocators.m_LevelStaticMeshAllocator.getStats());
+    report.add("Content", "Skeletal meshes", m_Allocators.m_LevelSkeletalMeshAllocator.getStats());
+    report.add("Content", "Animations", m_Allocators.m_AnimationAllocator.getStats());
+    report.add("Content", "Sounds", m_AudioEngine.getStats());
+
+    Memory::AllocatorStats worldMeshes = m_Allocators.m_WorldMeshAllocator.getStats();
+    for(size_t i = 0; i < m_Allocators.m_WorldMeshAllocator.getNumObtainedElements(); i++)
+        worldMeshes.numBytesPayload += Meshes::getStaticMeshDynSizeBytes(m_Allocators.m_WorldMeshAllocator.getElements()[i].mesh);
+
+    report.add("Content", "World meshes", worldMeshes);
+    report.add("Content", "Materials", m_Allocators.m_MaterialAllocator.getStats());
+
+    report.add("Physics", "Objects", m_PhysicsSystem.getPhysicsObjectStats());
+    report.add("Physics", "Collision shapes", m_PhysicsSystem.getCollisionShapeStats());
+
+    report.add("Script", "NPCs", getScriptRegistrationStats(m_ScriptEngine.getWorldNPCs(),
+                                                            sizeof(Daedalus::GEngineClasses::C_Npc)));
+    report.add("Script", "Items", getScriptRegistrationStats(m_ScriptEngine.getWorldItems(),
+                                                             sizeof(Daedalus::GEngineClasses::C_Item)));
+    report.add("Script", "Mobs", getScriptRegistrationStats(m_ScriptEngine.getWorldMobs(), 0));
+}
+
+std::vector<std::pair<size_t, json>> WorldInstance::exportVobs(size_t numThreads)
+{
+    // Below this, starting a thread costs more than it saves
+    const size_t MIN_ENTITIES_PER_THREAD = 256;
+
+    size_t num = getComponentAllocator().getNumObtainedElements();
+
+    if(numThreads == 0)
+        numThreads = std::max(1u, std::thread::hardware_concurrency());
+
+    numThreads = std::max<size_t>(1, std::min(numThreads, num / MIN_ENTITIES_PER_THREAD));
+
+    std::vector<std::vector<std::pair<size_t, json>>> ranges(numThreads);
+
+    auto exportRange = [&](size_t r)
+    {
+        PROFILE_SCOPE("World::exportVobs");
+
+        size_t start = num * r / numThreads;
+        size_t end = num * (r + 1) / numThreads;
+
+        for (size_t i = start; i < end; i++)
+        {
+            json vob;
+            if(exportVob(i, vob))
+                ranges[r].emplace_back(i, std::move(vob));
+        }
+    };
+
+    // The calling thread takes the first range
+    std::vector<std::thread> threads;
+    for(size_t r = 1; r < numThreads; r++)
+        threads.emplace_back(exportRange, r);
+
+    exportRange(0);
+
+    for(std::thread& t : threads)
+        t.join();
+
+    std::vector<std::pair<size_t, json>> vobs = std::move(ranges[0]);
+    for(size_t r = 1; r < numThreads; r++)
+        std::move(ranges[r].begin(), ranges[r].end(), std::back_inserter(vobs));
+
+    return vobs;
+}
+
+void WorldInstance::exportWorld(json& j, size_t numThreads)
+{
+    PROFILE_SCOPE("World::exportWorld");
+
     // Write initial ZEN for loading the worldmesh later
     j["zenfile"] = m_ZenFile;
 
@@ -655,46 +1135,238 @@ void WorldInstance::exportWorld(json& j)
     {
         json& jvobs = j["vobs"];
 
-        size_t num = getComponentAllocator().getNumObtainedElements();
-        const auto& ctuple = getComponentDataBundle().m_Data;
+        for(auto& v : exportVobs(numThreads))
+            jvobs["controllers"][v.first] = std::move(v.second);
+    }
+
+    // Write script-values
+    m_ScriptEngine.exportScriptEngine(j["scriptEngine"]);
+
+    // Write dialog-info
+    m_DialogManager.exportDialogManager(j["dialogManager"]);
+}
+
+namespace
+{
+    /**
+     * @return Fingerprint of the given json-value. FNV-1a, since it ends up in savegames and std::hash is allowed to
+     *         differ between builds.
+     */
+    uint64_t fingerprint(const json& j)
+    {
+        uint64_t h = 14695981039346656037ULL;
+        for(char c : j.dump())
+        {
+            h ^= static_cast<uint8_t>(c);
+            h *= 1099511628211ULL;
+        }
+
+        return h;
+    }
+
+    /**
+     * Version of the delta-saves written by exportWorldDelta()
+     */
+    const int DELTA_SAVE_VERSION = 2;
+
+    /**
+     * Groups the exported script-globals by symbol. Arrays are stored as one entry per element.
+     * @param globals Array of [name, value]-pairs
+     * @return Symbol-name -> Array of its pairs
+     */
+    std::map<std::string, json> groupScriptGlobals(const json& globals)
+    {
+        std::map<std::string, json> symbols;
+
+        for(const json& p : globals)
+            symbols[p[0].get<std::string>()].push_back(p);
+
+        return symbols;
+    }
+}
+
+void WorldInstance::captureSaveBaseline()
+{
+    int64_t start = bx::getHPCounter();
+
+    m_SaveBaseline = SaveBaseline();
+
+    Components::EntityComponent* ents = getComponentAllocator().getElements<Components::EntityComponent>();
+
+    // Counts how many entities with the same fingerprint were seen already
+    std::unordered_map<uint64_t, uint32_t> occurrences;
+
+    for(auto& v : exportVobs(0))
+    {
+        Handle::EntityHandle h = ents[v.first].m_ThisEntity;
+        uint64_t fp = fingerprint(v.second);
+
+        SaveBaseline::StableId id(fp, occurrences[fp]++);
+        m_SaveBaseline.entities[h.index] = std::make_pair(h, id);
+        m_SaveBaseline.entitiesById[id] = h;
+    }
+
+    json script;
+    m_ScriptEngine.exportScriptEngine(script);
+
+    for(const auto& p : groupScriptGlobals(script["globals"]))
+        m_SaveBaseline.scriptSymbols[p.first] = fingerprint(p.second);
+
+    m_SaveBaseline.valid = true;
+
+    LogInfo() << "Captured savegame-baseline of " << m_SaveBaseline.entities.size() << " entities and "
+              << m_SaveBaseline.scriptSymbols.size() << " script-symbols in "
+              << (bx::getHPCounter() - start) * 1000.0 / double(bx::getHPFrequency()) << "ms";
+}
+
+bool WorldInstance::exportWorldDelta(json& j)
+{
+    if(!m_SaveBaseline.valid)
+        return false;
+
+    j["zenfile"] = m_ZenFile;
+    j["delta"] = DELTA_SAVE_VERSION;
+
+    // Write Vobs
+    {
+        json& jvobs = j["vobs"];
+        jvobs["removed"] = json::array();
+        jvobs["changed"] = json::array();
+        jvobs["controllers"] = json::array();
+
+        Components::EntityComponent* ents = getComponentAllocator().getElements<Components::EntityComponent>();
 
-        Components::EntityComponent* ents = std::get<Components::EntityComponent*>(ctuple);
-        Components::LogicComponent* logics = std::get<Components::LogicComponent*>(ctuple);
-        Components::VisualComponent* visuals = std::get<Components::VisualComponent*>(ctuple);
+        // Everything not found in here anymore got removed
+        std::set<uint32_t> seen;
 
-        // TODO: This could be done in parallel
-        for (size_t i = 0; i < num; i++)
+        for(auto& v : exportVobs(0))
         {
-            // Only export if both logic and visual want to be exported
-            /*if(Components::hasComponent<Components::LogicComponent>(ents[i])
-               && logics[i].m_pLogicController && !logics[i].m_pLogicController->shouldExport())
-                continue;
+            json& vob = v.second;
 
-            if(Components::hasComponent<Components::VisualComponent>(ents[i])
-               && visuals[i].m_pVisualController && !visuals[i].m_pVisualController->shouldExport())
-                continue;*/
+            Handle::EntityHandle h = ents[v.first].m_ThisEntity;
+            uint32_t index = h.index;
+            auto it = m_SaveBaseline.entities.find(index);
 
-            // Do the actual export
-            if (Components::hasComponent<Components::LogicComponent>(ents[i]))
-            {
-                if (logics[i].m_pLogicController && logics[i].m_pLogicController->shouldExport())
-                    logics[i].m_pLogicController->exportObject(jvobs["controllers"][i]["logic"]);
-            }
+            bool fromBaseline = it != m_SaveBaseline.entities.end() && (*it).second.first == h;
 
-            if (Components::hasComponent<Components::VisualComponent>(ents[i]))
+            if(fromBaseline)
             {
-                if (visuals[i].m_pVisualController && visuals[i].m_pVisualController->shouldExport())
-                    visuals[i].m_pVisualController->exportObject(jvobs["controllers"][i]["visual"]);
+                const SaveBaseline::StableId& id = (*it).second.second;
+                seen.insert(index);
+
+                if(id.first == fingerprint(vob))
+                    continue;
+
+                // NPCs have script-instances attached, which would be lost when re-creating them
+                if(vob.find("logic") != vob.end() && vob["logic"]["type"] == "PlayerController")
+                {
+                    jvobs["changed"].push_back({{"id", {id.first, id.second}}, {"vob", std::move(vob)}});
+                    continue;
+                }
+
+                jvobs["removed"].push_back({id.first, id.second});
             }
 
+            jvobs["controllers"].push_back(std::move(vob));
+        }
+
+        for(const auto& p : m_SaveBaseline.entities)
+        {
+            if(seen.find(p.first) == seen.end())
+                jvobs["removed"].push_back({p.second.second.first, p.second.second.second});
         }
     }
 
-    // Write script-values
-    m_ScriptEngine.exportScriptEngine(j["scriptEngine"]);
+    // Write changed script-values
+    {
+        json script;
+        m_ScriptEngine.exportScriptEngine(script);
 
-    // Write dialog-info
+        json& globals = j["scriptEngine"]["globals"];
+        globals = json::array();
+
+        for(const auto& p : groupScriptGlobals(script["globals"]))
+        {
+            auto it = m_SaveBaseline.scriptSymbols.find(p.first);
+            if(it != m_SaveBaseline.scriptSymbols.end() && (*it).second == fingerprint(p.second))
+                continue;
+
+            for(const json& v : p.second)
+                globals.push_back(v);
+        }
+    }
+
+    // Nothing is known at the start, so this is a delta already
     m_DialogManager.exportDialogManager(j["dialogManager"]);
+
+    return true;
+}
+
+void WorldInstance::importWorldDelta(const json& j)
+{
+    if(j["delta"] != DELTA_SAVE_VERSION)
+    {
+        LogError() << "Delta-save: Unsupported version " << j["delta"] << ", expected " << DELTA_SAVE_VERSION;
+        return;
+    }
+
+    const json& jvobs = j["vobs"];
+
+    auto getBaselineEntity = [&](const json& jid)
+    {
+        SaveBaseline::StableId id(jid[0].get<uint64_t>(), jid[1].get<uint32_t>());
+
+        auto it = m_SaveBaseline.entitiesById.find(id);
+        if(it == m_SaveBaseline.entitiesById.end())
+        {
+            LogWarn() << "Delta-save: Entity " << id.first << "#" << id.second
+                      << " is not part of this world. Savegame and ZEN don't match?";
+            return Handle::EntityHandle::makeInvalidHandle();
+        }
+
+        return (*it).second;
+    };
+
+    // Remove first, so re-created entities don't exist twice
+    for(const json& r : jvobs["removed"])
+    {
+        Handle::EntityHandle h = getBaselineEntity(r);
+        if(!h.isValid())
+            continue;
+
+        if(h == m_ScriptEngine.getPlayerEntity())
+        {
+            LogWarn() << "Delta-save: Not removing the player";
+            continue;
+        }
+
+        // NPCs are known to the script-engine and linked to their script-instance
+        VobTypes::NpcVobInformation npc = VobTypes::asNpcVob(*this, h);
+        if(npc.playerController)
+        {
+            m_ScriptEngine.unregisterNPC(h);
+            VobTypes::unlinkNPCFromScriptInstance(*this, h, VobTypes::getScriptHandle(npc));
+        }
+
+        removeEntity(h);
+    }
+
+    for(const json& c : jvobs["changed"])
+    {
+        Handle::EntityHandle h = getBaselineEntity(c["id"]);
+        if(!h.isValid())
+            continue;
+
+        VobTypes::NpcVobInformation npc = VobTypes::asNpcVob(*this, h);
+        if(npc.playerController)
+            npc.playerController->importObject(c["vob"]["logic"]);
+    }
+
+    // New and re-created entities
+    importVobs(jvobs);
+
+    m_ScriptEngine.importScriptEngine(j["scriptEngine"]);
+    m_DialogManager.importDialogManager(j["dialogManager"]);
 }
 
 void WorldInstance::importSingleVob(const json& j)
@@ -5,6 +5,7 @@
 #include <content/Texture.h>
 #include <components/Entities.h>
 #include <memory/StaticReferencedAllocator.h>
+#include <memory/ChunkedReferencedAllocator.h>
 #include <content/VertexTypes.h>
 #include "WorldMesh.h"
 #include <content/StaticMeshAllocator.h>
@@ -16,7 +17,11 @@
 #include <content/AnimationAllocator.h>
 #include <content/Sky.h>
 #include <logic/DialogManager.h>
+#include <logic/RoutineScheduler.h>
+#include <logic/AIScheduler.h>
+#include <logic/OffscreenSimulation.h>
 #include <content/AudioEngine.h>
+#include <memory/MemoryReport.h>
 #include <json.hpp>
 
 using json = nlohmann::json;
@@ -24,6 +29,7 @@ using json = nlohmann::json;
 namespace ZenLoad
 {
 	class ZenParser;
+	struct zCVobData;
 }
 
 namespace Engine
@@ -31,6 +37,11 @@ namespace Engine
 	class BaseEngine;
 }
 
+namespace Content
+{
+	class AssetCache;
+}
+
 namespace World
 {
     struct WorldAllocators
@@ -42,6 +53,9 @@ namespace World
 		>;
 
 		typedef MeshAllocator<Meshes::UVNormColorVertex, uint32_t> WorldMeshAllocator;
+		typedef Memory::ChunkedReferencedAllocator<
+				Components::AnimHandler,
+				Config::MAX_NUM_LEVEL_ANIM_HANDLERS> AnimHandlerAllocator;
 		typedef Memory::StaticReferencedAllocator<
 				Materials::TexturedMaterial,
 				Config::MAX_NUM_LEVEL_MATERIALS> MaterialAllocator;
@@ -52,6 +66,9 @@ namespace World
 		Meshes::SkeletalMeshAllocator m_LevelSkeletalMeshAllocator;
 		Animations::AnimationAllocator m_AnimationAllocator;
 
+		// Continuous storage for the anim-handlers of all animated entities
+		AnimHandlerAllocator m_AnimHandlerAllocator;
+
 		// TODO: Refractor this one into StaticMeshAllocator
 		WorldMeshAllocator m_WorldMeshAllocator;
 		MaterialAllocator m_MaterialAllocator;
@@ -67,6 +84,25 @@ namespace World
         std::vector<size_t> m_VisibleEntities;
     };
 
+	/**
+	 * Everything of a ZEN-world which only depends on the VDFS: The parsed world and the packed worldmesh.
+	 * This can be created on any thread, so the next world can be read while the current one keeps running.
+	 */
+	struct PreparedZen
+	{
+		std::string zen;
+		ZenLoad::oCWorldData world;
+		ZenLoad::PackedMesh worldMesh;
+	};
+
+	/**
+	 * Parses the given ZEN and packs its worldmesh. Doesn't touch any world, so this is safe to be called from any thread.
+	 * @param assetCache Optional. Textures of the worldmesh and the static vob-visuals with their textures are
+	 *					 decoded into this cache, so loading the world won't have to do it later.
+	 * @return False, if the ZEN could not be found
+	 */
+	bool prepareZen(const VDFS::FileIndex& idx, const std::string& zen, PreparedZen& out, Content::AssetCache* assetCache = nullptr);
+
 	/**
 	 * Basic gametype this is. Needed for sky configuration, for example
 	 */
@@ -76,8 +112,11 @@ namespace World
 		GT_Gothic2
 	};
 
+    class WorldLoader;
+
     class WorldInstance : public Handle::HandleTypeDescriptor<Handle::WorldHandle>
     {
+		friend class WorldLoader;
     public:
 
 		/**
@@ -106,9 +145,96 @@ namespace World
 		void init(Engine::BaseEngine& engine);
 
 		/**
+		* Loads the whole world at once. Use a WorldLoader to spread this over multiple frames instead.
 		* @param zen file
+		* @param prepared Optional. Result of prepareZen() for the given zen, so it doesn't have to be read again.
+		*				  Its contents are consumed.
 		*/
-		void init(Engine::BaseEngine& engine, const std::string& zen, const json& j = json());
+		void init(Engine::BaseEngine& engine, const std::string& zen, const json& j = json(), PreparedZen* prepared = nullptr);
+
+		/**
+		 * Loads the compiled scripts. First step of loading a world, see WorldLoader.
+		 */
+		void loadScripts();
+
+		/**
+		 * Uploads the worldmesh and builds its static collision. Afterwards, the world can be drawn and walked on.
+		 * @param prepared Read ZEN. The vertex-colors of the worldmesh are modified.
+		 */
+		void initWorldMesh(PreparedZen& prepared);
+
+		/**
+		 * Builds the waynet, initializes the scripts for this world and applies the savegame, if any.
+		 * Last step of loading a world, after the vobs were inserted.
+		 * @param prepared Read ZEN, nullptr if this world doesn't have one
+		 * @param startPoint Startpoint-vob found while inserting the vobs
+		 * @param j Savegame, empty if there is none
+		 */
+		void finishLoading(const PreparedZen* prepared, const ZenLoad::zCVobData& startPoint, const json& j);
+
+		/**
+		 * Timings of the vob-loading stages, in seconds
+		 */
+		struct VobLoadStats
+		{
+			VobLoadStats()
+			{
+				numVobs = 0;
+				numUniqueVisuals = 0;
+				timeFlatten = 0.0;
+				timeLoadVisuals = 0.0;
+				timeShadowTrace = 0.0;
+				timeCreateEntities = 0.0;
+			}
+
+			size_t numVobs;
+			size_t numUniqueVisuals;
+			double timeFlatten;
+			double timeLoadVisuals;
+			double timeShadowTrace;
+			double timeCreateEntities;
+		};
+
+		/**
+		 * Inserts the given vob-tree into the world. This works in stages:
+		 *  1. Flatten the tree
+		 *  2. Load all unique static visuals (in parallel)
+		 *  3. Trace the shadow-values for all vobs from the worldmesh
+		 *  4. Create the entities
+		 * Static collision of the worldmesh must already be in place.
+		 * @param rootVobs Vobs to insert, including their children
+		 * @param startPoint Optional. Will be set to the startpoint-vob, if one was found.
+		 * @return Timings of the stages
+		 */
+		VobLoadStats insertVobs(const std::vector<ZenLoad::zCVobData>& rootVobs, ZenLoad::zCVobData* startPoint = nullptr);
+
+		/**
+		 * A vob-tree being inserted over multiple calls, see beginInsertVobs()
+		 */
+		struct VobInsertion
+		{
+			std::vector<const ZenLoad::zCVobData*> vobs; // Flattened, children before their parents
+			std::vector<float> shadowValues;
+			ZenLoad::zCVobData* startPoint;
+			bool visualsLoaded;
+			size_t numTraced;
+			size_t numCreated;
+			VobLoadStats stats;
+		};
+
+		/**
+		 * Does the first stage of insertVobs(). The rest is done by continueInsertVobs().
+		 * The vob-tree has to stay alive until the insertion is done.
+		 */
+		void beginInsertVobs(const std::vector<ZenLoad::zCVobData>& rootVobs, ZenLoad::zCVobData* startPoint, VobInsertion& out);
+
+		/**
+		 * Continues with the remaining stages of insertVobs() until the given time is reached. The visuals are loaded
+		 * in one go, traces and entities are split between calls. Always makes some progress, even if the time is already up.
+		 * @param deadline bx::getHPCounter()-value to stop at
+		 * @return Whether all vobs are inserted now
+		 */
+		bool continueInsertVobs(VobInsertion& insertion, int64_t deadline);
 
         /**
          * Creates an entity with the given components and returns its handle
@@ -125,6 +251,21 @@ namespace World
          */
         void onFrameUpdate(double deltaTime, float updateRangeSquared, const Math::Matrix& cameraWorld);
 
+		/**
+		 * Timings of the stages of onFrameUpdate, in seconds
+		 */
+		struct FrameTimings
+		{
+			double physics;
+			double logic; // Controllers, AI-states, routines, dialogs and the player
+			double animation;
+		};
+
+		/**
+		 * @return How long the stages of the last onFrameUpdate took
+		 */
+		const FrameTimings& getLastFrameTimings() const { return m_LastFrameTimings; }
+
 		/**
 		 * @return The component associated with the given handle
 		 */
@@ -138,6 +279,11 @@ namespace World
          * @return The vob-entity of a vob using the given name
          */
         Handle::EntityHandle getVobEntityByName(const std::string& name)
+        {
+            return getVobEntityByName(Utils::Name::find(name));
+        }
+
+        Handle::EntityHandle getVobEntityByName(const Utils::Name& name)
         {
             auto it = m_VobsByNames.find(name);
             if(it == m_VobsByNames.end())
@@ -160,10 +306,6 @@ namespace World
         /**
          * Data access
          */
-        Components::ComponentAllocator::DataBundle getComponentDataBundle()
-		{
-            return m_Allocators.m_ComponentAllocator.getDataBundle();
-        }
 		WorldAllocators& getAllocators()
 		{
 			return m_Allocators;
@@ -180,6 +322,15 @@ namespace World
 		{
 			return m_Allocators.m_ComponentAllocator;
 		}
+
+		/**
+		 * @return All entities having at least the components set in MASK, see ComponentAllocator::query()
+		 */
+		template<Components::ComponentMask MASK>
+		const Components::EntityList& query()
+		{
+			return m_Allocators.m_ComponentAllocator.query(MASK);
+		}
 		Meshes::StaticMeshAllocator& getStaticMeshAllocator()
 		{
 			return m_Allocators.m_LevelStaticMeshAllocator;
@@ -192,6 +343,23 @@ namespace World
 		{
 			return m_Allocators.m_AnimationAllocator;
 		}
+		WorldAllocators::AnimHandlerAllocator& getAnimHandlerAllocator()
+		{
+			return m_Allocators.m_AnimHandlerAllocator;
+		}
+
+		/**
+		 * @return AnimHandler of the given entities animation-component. Taken from the pool on first access.
+		 *         If the pool is full, a handler shared by all entities which didn't get one is returned.
+		 *         Note: Handlers move around inside the pool when others are removed, so don't keep the reference!
+		 */
+		Components::AnimHandler& getAnimHandler(Handle::EntityHandle e);
+
+		/**
+		 * Same as getAnimHandler(), but doesn't take one from the pool
+		 * @return AnimHandler of the given entity, nullptr if it doesn't have one (yet)
+		 */
+		Components::AnimHandler* tryGetAnimHandler(Handle::EntityHandle e);
 
 		// TODO: Depricated, remove
 		WorldAllocators::MaterialAllocator& getMaterialAllocator()
@@ -234,6 +402,18 @@ namespace World
 		{
 			return m_DialogManager;
 		}
+		Logic::RoutineScheduler& getRoutineScheduler()
+		{
+			return m_RoutineScheduler;
+		}
+		Logic::AIScheduler& getAIScheduler()
+		{
+			return m_AIScheduler;
+		}
+		Logic::OffscreenSimulation& getOffscreenSimulation()
+		{
+			return m_OffscreenSimulation;
+		}
 		Content::AudioEngine& getAudioEngine()
 		{
 			return m_AudioEngine;
@@ -272,8 +452,14 @@ namespace World
 		/**
 		 * Exports this world into a json-object
 		 * @param j json-object to write into
+		 * @param numThreads Number of threads to export the vobs on, 0 for one per core. The result is the same for any number.
 		 */
-		void exportWorld(json& j);
+		void exportWorld(json& j, size_t numThreads = 0);
+
+		/**
+		 * Adds the usage of all allocators and systems of this world to the given report
+		 */
+		void collectMemoryStats(Memory::MemoryReport& report);
 
         /**
          * Imports vobs from a json-object
@@ -281,6 +467,76 @@ namespace World
          */
         void importVobs(const json& j);
 
+		/**
+		 * Fingerprints of the world-state right after the ZEN was loaded. Delta-saves only store what differs
+		 * from this, which relies on a fresh load of the same ZEN always creating the same entities.
+		 */
+		struct SaveBaseline
+		{
+			SaveBaseline()
+			{
+				valid = false;
+			}
+
+			/**
+			 * Identifies an entity across loads: Fingerprint of its exported state after loading the ZEN and the
+			 * how-manieth entity with that fingerprint it is. Only depends on what got created, not on the order the
+			 * handles were given out in. Entities with the same fingerprint are identical, so which of them gets which
+			 * count doesn't matter.
+			 */
+			typedef std::pair<uint64_t, uint32_t> StableId;
+
+			/**
+			 * Entity-handle index -> Handle and stable ID of the entity
+			 */
+			std::map<uint32_t, std::pair<Handle::EntityHandle, StableId>> entities;
+
+			/**
+			 * Stable ID -> Entity
+			 */
+			std::map<StableId, Handle::EntityHandle> entitiesById;
+
+			/**
+			 * Script-symbol -> Fingerprint of its values
+			 */
+			std::unordered_map<std::string, uint64_t> scriptSymbols;
+
+			bool valid;
+		};
+
+		/**
+		 * Remembers the current state as the one delta-saves are relative to. Only valid directly after
+		 * loading the ZEN.
+		 */
+		void captureSaveBaseline();
+
+		/**
+		 * @return Whether delta-saves are possible for this world, which is not the case when it was loaded from a full savegame
+		 */
+		bool hasSaveBaseline(){ return m_SaveBaseline.valid; }
+
+		/**
+		 * Exports only what changed since the baseline was captured:
+		 *  - Removed entities, by stable ID ("vobs/removed")
+		 *  - Changed NPCs by stable ID, updated in place on import ("vobs/changed")
+		 *  - New entities and other changed ones, which are re-created ("vobs/controllers")
+		 *  - Changed script-symbols
+		 * @param j json-object to write into
+		 * @return False, if there is no baseline
+		 */
+		bool exportWorldDelta(json& j);
+
+		/**
+		 * Applies a delta written by exportWorldDelta. The ZEN must just have been loaded freshly and the baseline captured.
+		 * Saved entities are matched to the ones of the fresh load by their stable ID.
+		 */
+		void importWorldDelta(const json& j);
+
+		/**
+		 * @return Whether the given savegame is a delta-save
+		 */
+		static bool isDeltaSave(const json& j){ return j.find("delta") != j.end(); }
+
 		/**
 		 * @return world-file this is built after
 		 */
@@ -293,6 +549,21 @@ namespace World
 
 	protected:
 
+		/**
+		 * Exports the controllers of the entity at the given index of the component-arrays
+		 * @return Whether there was anything to export
+		 */
+		bool exportVob(size_t idx, json& j);
+
+		/**
+		 * Runs exportVob() on all entities. The entities are split into one continuous range per thread,
+		 * each exporting into its own list, which are then joined in the order of the ranges.
+		 * Exporting must not create components or touch anything else shared, as it is done in parallel.
+		 * @param numThreads Number of threads to use, 0 for one per core
+		 * @return Index and export of every entity which had anything to export, ordered by index
+		 */
+		std::vector<std::pair<size_t, json>> exportVobs(size_t numThreads);
+
 		/**
 		 * Initializes the Script-Engine for a ZEN-World.
 		 * Will load the .DAT-Files and setup the VM.
@@ -343,6 +614,26 @@ namespace World
 		 */
 		Content::Sky m_Sky;
 
+		/**
+		 * Upcoming daily-routine transitions of the NPCs in this world
+		 */
+		Logic::RoutineScheduler m_RoutineScheduler;
+
+		/**
+		 * Decides which NPCs run their AI-state each frame
+		 */
+		Logic::AIScheduler m_AIScheduler;
+
+		/**
+		 * Moves the NPCs outside of the update-range along the waynet
+		 */
+		Logic::OffscreenSimulation m_OffscreenSimulation;
+
+		/**
+		 * Timings of the last frame
+		 */
+		FrameTimings m_LastFrameTimings;
+
 		/**
 		 * Static collision-shape for the world
 		 */
@@ -359,7 +650,7 @@ namespace World
         /**
          * Map of vobs by their names (If they have one)
          */
-        std::unordered_map<std::string, Handle::EntityHandle> m_VobsByNames;
+        std::unordered_map<Utils::Name, Handle::EntityHandle> m_VobsByNames;
 
 		/**
 		 * List of freepoints
@@ -385,5 +676,16 @@ namespace World
 		 * Information about the state of the world
 		 */
 		WorldInfo m_WorldInfo;
+
+		/**
+		 * State after loading the ZEN, for delta-saves
+		 */
+		SaveBaseline m_SaveBaseline;
+
+		/**
+		 * Handed out by getAnimHandler() once the pool is full, so that doesn't crash the game
+		 */
+		Components::AnimHandler m_FallbackAnimHandler;
+		bool m_AnimHandlerPoolFull;
     };
 }
@@ -0,0 +1,225 @@
+#include "WorldLoader.h"
+#include "BaseEngine.h"
+#include <limits>
+#include <algorithm>
+#include <bx/timer.h>
+#include <utils/logger.h>
+#include <utils/Profiler.h>
+
+using namespace World;
+
+WorldLoader::WorldLoader(WorldInstance& world, Engine::BaseEngine& engine, const std::string& zen, const json& savegame,
+                         PreparedZen* prepared) :
+        m_World(world),
+        m_Savegame(savegame),
+        m_Stage(LS_LoadScripts),
+        m_ZenRead(false),
+        m_ZenValid(false),
+        m_ReadTime(0.0),
+        m_VobsStarted(false),
+        m_Timings(),
+        m_Start(bx::getHPCounter())
+{
+    world.m_ZenFile = zen;
+    world.init(engine);
+
+    if(zen.empty())
+    {
+        m_ZenRead = true;
+    }
+    else if(prepared && prepared->zen == zen)
+    {
+        m_Prepared = std::move(*prepared);
+        m_ZenValid = true;
+        m_ZenRead = true;
+    }
+    else
+    {
+        LogInfo() << "Reading ZEN and postprocessing worldmesh...";
+
+        // Only touches the VDFS (under Content::lockVDFS()) and the asset-cache, which are safe to be used from here
+        m_Thread = std::thread([this, &engine, zen]()
+        {
+            Utils::Profiler::setThreadName("WorldLoader");
+
+            int64_t start = bx::getHPCounter();
+            m_ZenValid = prepareZen(engine.getVDFSIndex(), zen, m_Prepared, &engine.getAssetCache());
+            m_ReadTime = double(bx::getHPCounter() - start) / double(bx::getHPFrequency());
+
+            m_ZenRead = true;
+        });
+    }
+}
+
+WorldLoader::~WorldLoader()
+{
+    if(m_Thread.joinable())
+        m_Thread.join();
+}
+
+bool WorldLoader::update(double budget)
+{
+    run(bx::getHPCounter() + static_cast<int64_t>(budget * double(bx::getHPFrequency())), false);
+
+    return isDone();
+}
+
+void WorldLoader::finish()
+{
+    run(std::numeric_limits<int64_t>::max(), true);
+}
+
+void WorldLoader::run(int64_t deadline, bool wait)
+{
+    PROFILE_SCOPE("WorldLoader::run");
+
+    const double freq = double(bx::getHPFrequency());
+
+    while(m_Stage != LS_Done)
+    {
+        EStage stage = m_Stage;
+        int64_t start = bx::getHPCounter();
+
+        // Still reading in the background, try again next time
+        if(!step(deadline, wait))
+            break;
+
+        int64_t now = bx::getHPCounter();
+        double time = (now - start) / freq;
+
+        StageTimings& t = m_Timings[stage];
+        t.time += time;
+        t.longestStep = std::max(t.longestStep, time);
+        t.numSteps++;
+
+        if(m_Stage == LS_Done)
+            logTimings();
+
+        if(now >= deadline)
+            break;
+    }
+}
+
+bool WorldLoader::step(int64_t deadline, bool wait)
+{
+    switch(m_Stage)
+    {
+        case LS_LoadScripts:
+            // Items need the scripts before they can be inserted
+            m_World.loadScripts();
+            m_Stage = LS_ReadZen;
+            break;
+
+        case LS_ReadZen:
+            if(!m_ZenRead && !wait)
+                return false;
+
+            if(m_Thread.joinable())
+                m_Thread.join();
+
+            if(m_World.getZenFile().empty())
+            {
+                m_Stage = LS_Finish;
+            }
+            else if(!m_ZenValid)
+            {
+                LogError() << "Failed to read ZEN: " << m_World.getZenFile();
+                m_Stage = LS_Finish;
+            }
+            else
+            {
+                m_Stage = LS_WorldMesh;
+            }
+            break;
+
+        case LS_WorldMesh:
+            m_World.initWorldMesh(m_Prepared);
+            m_Stage = LS_Vobs;
+            break;
+
+        case LS_Vobs:
+            // Delta-saves only store what changed since the initial load, so they need the ZEN-state
+            if(!m_Savegame.empty() && !WorldInstance::isDeltaSave(m_Savegame))
+            {
+                // Load vobs from saved json (Savegame)
+                LogInfo() << "Inserting vobs from json...";
+                m_World.importVobs(m_Savegame["vobs"]);
+                m_Stage = LS_Finish;
+            }
+            else
+            {
+                // Load vobs from zen (initial load)
+                if(!m_VobsStarted)
+                {
+                    LogInfo() << "Inserting vobs from zen...";
+                    m_World.beginInsertVobs(m_Prepared.world.rootVobs, &m_StartPoint, m_VobInsertion);
+                    m_VobsStarted = true;
+                }
+
+                if(m_World.continueInsertVobs(m_VobInsertion, deadline))
+                    m_Stage = LS_Finish;
+            }
+            break;
+
+        case LS_Finish:
+            m_World.finishLoading(m_ZenValid ? &m_Prepared : nullptr, m_StartPoint, m_Savegame);
+            m_Stage = LS_Done;
+            break;
+
+        default:
+            break;
+    }
+
+    return true;
+}
+
+const char* WorldLoader::getStageName(EStage stage)
+{
+    switch(stage)
+    {
+        case LS_LoadScripts: return "Loading scripts";
+        case LS_ReadZen: return "Reading ZEN";
+        case LS_WorldMesh: return "Building worldmesh";
+        case LS_Vobs: return "Inserting vobs";
+        case LS_Finish: return "Initializing scripts";
+        case LS_Done: return "Done";
+        default: return "";
+    }
+}
+
+float WorldLoader::getProgress() const
+{
+    // Share of the total loading-time each stage usually takes
+    const float weights[LS_NumStages] = {0.05f, 0.25f, 0.15f, 0.35f, 0.2f, 0.0f};
+
+    float progress = 0.0f;
+    for(int i = 0; i < m_Stage; i++)
+        progress += weights[i];
+
+    if(m_Stage == LS_Vobs && m_VobsStarted && !m_VobInsertion.vobs.empty())
+    {
+        // Traces and entities take roughly the same time
+        float done = (m_VobInsertion.numTraced + m_VobInsertion.numCreated) / (2.0f * m_VobInsertion.vobs.size());
+        progress += weights[LS_Vobs] * done;
+    }
+
+    return std::min(progress, 1.0f);
+}
+
+void WorldLoader::logTimings()
+{
+    const double total = (bx::getHPCounter() - m_Start) / double(bx::getHPFrequency());
+
+    LogInfo() << "Loaded world " << m_World.getZenFile() << " in " << total * 1000.0 << "ms";
+
+    if(m_ReadTime > 0.0)
+        LogInfo() << " - Reading ZEN in the background: " << m_ReadTime * 1000.0 << "ms";
+
+    for(int i = 0; i < LS_Done; i++)
+    {
+        const StageTimings& t = m_Timings[i];
+
+        LogInfo() << " - " << getStageName(static_cast<EStage>(i)) << ": " << t.time * 1000.0 << "ms over "
+                  << t.numSteps << " steps, longest step " << t.longestStep * 1000.0 << "ms";
+    }
+}
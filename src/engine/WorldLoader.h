@@ -0,0 +1,136 @@
+#pragma once
+#include <string>
+#include <thread>
+#include <atomic>
+#include "World.h"
+
+namespace Engine
+{
+    class BaseEngine;
+}
+
+namespace World
+{
+    /**
+     * Loads a world in steps, so it can be spread over multiple frames instead of blocking until everything is there.
+     * The ZEN is read on a background thread while the scripts are loaded. Everything touching the world itself is
+     * done on the main-thread, within the time given to update(). Vobs are inserted a few at a time, the other
+     * stages are done in one piece each.
+     *
+     * The world can be drawn and walked on once isWorldMeshReady() returns true, the vobs show up afterwards.
+     * It must not be updated before isDone() returns true, since there are no scripts and no NPCs before that.
+     */
+    class WorldLoader
+    {
+    public:
+
+        enum EStage
+        {
+            LS_LoadScripts,
+            LS_ReadZen,
+            LS_WorldMesh,
+            LS_Vobs,
+            LS_Finish, // Waynet, script-initialization and savegame
+            LS_Done,
+            LS_NumStages
+        };
+
+        /**
+         * Starts loading. Does init(engine) on the world right away and starts reading the ZEN in the background.
+         * @param zen ZEN-file to load. Can be empty, for a world without any.
+         * @param savegame Savegame to apply, empty if there is none. Must stay alive until the world is loaded.
+         * @param prepared Optional. Result of prepareZen() for the given zen, so it doesn't have to be read again.
+         *                 Its contents are consumed.
+         */
+        WorldLoader(WorldInstance& world, Engine::BaseEngine& engine, const std::string& zen, const json& savegame,
+                    PreparedZen* prepared = nullptr);
+        ~WorldLoader();
+
+        /**
+         * Continues loading for about the given time. A stage which can't be split may take longer.
+         * @param budget Seconds to spend
+         * @return Whether the world is completely loaded now
+         */
+        bool update(double budget);
+
+        /**
+         * Loads everything left, waiting for the background-thread if needed
+         */
+        void finish();
+
+        /**
+         * @return Whether the world is completely loaded
+         */
+        bool isDone() const { return m_Stage == LS_Done; }
+
+        /**
+         * @return Whether the worldmesh and its collision are there, so the camera can move around
+         */
+        bool isWorldMeshReady() const { return m_Stage > LS_WorldMesh; }
+
+        /**
+         * @return Stage currently being worked on
+         */
+        EStage getStage() const { return m_Stage; }
+
+        /**
+         * @return Readable name of the given stage
+         */
+        static const char* getStageName(EStage stage);
+
+        /**
+         * @return Rough guess of how much of the world is loaded, 0..1
+         */
+        float getProgress() const;
+
+    private:
+
+        /**
+         * Works on the stages until the given time is reached
+         * @param deadline bx::getHPCounter()-value to stop at
+         * @param wait Whether to wait for the background-thread. Otherwise, the loader returns while it is still busy.
+         */
+        void run(int64_t deadline, bool wait);
+
+        /**
+         * Does some work on the current stage
+         * @return False, if the stage had to wait for the background-thread
+         */
+        bool step(int64_t deadline, bool wait);
+
+        /**
+         * Writes the time every stage took to the log
+         */
+        void logTimings();
+
+        WorldInstance& m_World;
+        const json& m_Savegame;
+        EStage m_Stage;
+
+        /**
+         * The read ZEN. Written by the background-thread until m_ZenRead is set.
+         */
+        PreparedZen m_Prepared;
+        std::thread m_Thread;
+        std::atomic<bool> m_ZenRead;
+        bool m_ZenValid;
+        double m_ReadTime; // Seconds the background-thread took
+
+        WorldInstance::VobInsertion m_VobInsertion;
+        bool m_VobsStarted;
+        ZenLoad::zCVobData m_StartPoint;
+
+        /**
+         * Main-thread time spent per stage
+         */
+        struct StageTimings
+        {
+            double time; // Seconds, in total
+            double longestStep; // Seconds. The longest the stage blocked a single frame.
+            size_t numSteps; // Times the stage was worked on, about one per frame
+        };
+
+        StageTimings m_Timings[LS_NumStages];
+        int64_t m_Start;
+    };
+}
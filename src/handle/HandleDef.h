@@ -25,6 +25,7 @@ namespace Handle
 	typedef Memory::GenericHandle<16, 16, 10> PhysicsObjectHandle;
 	typedef Memory::GenericHandle<16, 16, 10> CollisionShapeHandle; // TODO: Should not be the same as PhysicsObjectHandle
 	typedef Memory::GenericHandle<16, 16, 12> AudioHandle;
+	typedef Memory::GenericHandle<16, 16, 13> AnimHandlerHandle;
 	typedef PtrHandle<World::WorldInstance> WorldHandle;
 
     // Internal handle-types (API specific)
@@ -0,0 +1,188 @@
+#include "AIScheduler.h"
+#include <algorithm>
+#include <cmath>
+#include <bx/timer.h>
+#include <utils/Profiler.h>
+#include <engine/World.h>
+#include <components/VobClasses.h>
+#include "PlayerController.h"
+
+using namespace Logic;
+
+AIScheduler::AIScheduler(World::WorldInstance& world) :
+        m_World(world),
+        m_Frame(0)
+{
+    resetStats();
+}
+
+void AIScheduler::beginFrame(const Math::Matrix& cameraWorld)
+{
+    m_Frame++;
+    m_Submitted.clear();
+
+    m_CameraPosition = cameraWorld.Translation();
+
+    // Same convention as the player-transforms: The look-direction is the negated forward-vector
+    m_CameraDirection = -1.0f * cameraWorld.Forward();
+}
+
+void AIScheduler::submit(Handle::EntityHandle npc, const Math::float3& position, float deltaTime, bool urgent)
+{
+    if(m_Slots.size() <= npc.index)
+        m_Slots.resize(npc.index + 1, {Handle::EntityHandle::makeInvalidHandle(), 0.0f, 0, 1, false, false});
+
+    Slot& s = m_Slots[npc.index];
+
+    if(s.npc != npc)
+    {
+        // New NPC on this slot. Tick on the first frame it shows up.
+        s.npc = npc;
+        s.accumulatedTime = 0.0f;
+        s.lastTickFrame = m_Frame - static_cast<int64_t>(m_Config.maxInterval);
+        s.submitted = false;
+    }
+
+    s.accumulatedTime += deltaTime;
+    s.urgent = urgent || !m_Config.enabled;
+    s.interval = s.urgent ? 1 : computeInterval(position);
+
+    if(!s.submitted)
+    {
+        s.submitted = true;
+        m_Submitted.push_back(npc.index);
+    }
+}
+
+void AIScheduler::remove(Handle::EntityHandle npc)
+{
+    if(npc.index >= m_Slots.size() || m_Slots[npc.index].npc != npc)
+        return;
+
+    m_Slots[npc.index].npc.invalidate();
+    m_Slots[npc.index].submitted = false;
+}
+
+void AIScheduler::runFrame()
+{
+    PROFILE_SCOPE("AIScheduler::runFrame");
+
+    const double toMicroseconds = 1000000.0 / double(bx::getHPFrequency());
+
+    size_t numTicks = 0;
+
+    // Urgent ones first, they don't count against the budget
+    m_Due.clear();
+    for(size_t i = 0; i < m_Submitted.size(); i++)
+    {
+        uint32_t idx = m_Submitted[i];
+        Slot& s = m_Slots[idx];
+
+        // May have been removed by an other NPCs AI
+        if(!s.submitted)
+            continue;
+
+        if(s.urgent)
+        {
+            tick(s);
+            numTicks++;
+            m_Stats.numUrgentTicks++;
+        }
+        else if(m_Frame - s.lastTickFrame >= s.interval)
+        {
+            m_Due.push_back(idx);
+        }
+        else
+        {
+            s.submitted = false;
+        }
+    }
+
+    // Whoever waited the longest goes first, so everyone gets their turn
+    std::sort(m_Due.begin(), m_Due.end(), [this](uint32_t a, uint32_t b){
+        return m_Slots[a].lastTickFrame < m_Slots[b].lastTickFrame;
+    });
+
+    int64_t start = bx::getHPCounter();
+    double elapsed = 0.0;
+    size_t numBudgeted = 0;
+
+    for(size_t i = 0; i < m_Due.size(); i++)
+    {
+        Slot& s = m_Slots[m_Due[i]];
+
+        if(!s.submitted)
+            continue;
+
+        // A time-budget always lets at least one through, so a tiny budget can't stall everyone
+        bool overBudget = m_Config.ticksPerFrame ? numBudgeted >= m_Config.ticksPerFrame
+                                                 : numBudgeted > 0 && elapsed >= m_Config.budgetMicroseconds;
+        if(overBudget)
+        {
+            m_Stats.numDeferred++;
+            s.submitted = false;
+            continue;
+        }
+
+        tick(s);
+        numTicks++;
+        numBudgeted++;
+
+        elapsed = (bx::getHPCounter() - start) * toMicroseconds;
+    }
+
+    if(!m_Config.ticksPerFrame && elapsed > m_Config.budgetMicroseconds)
+    {
+        m_Stats.numOverruns++;
+        m_Stats.overrunMicroseconds.add(static_cast<uint64_t>(elapsed - m_Config.budgetMicroseconds));
+    }
+
+    m_Stats.numFrames++;
+    m_Stats.numTicks += numTicks;
+    m_Stats.ticksPerFrame.add(numTicks);
+}
+
+void AIScheduler::resetStats()
+{
+    m_Stats.numFrames = 0;
+    m_Stats.numTicks = 0;
+    m_Stats.numUrgentTicks = 0;
+    m_Stats.numDeferred = 0;
+    m_Stats.numOverruns = 0;
+    m_Stats.ticksPerFrame.reset();
+    m_Stats.overrunMicroseconds.reset();
+}
+
+uint32_t AIScheduler::computeInterval(const Math::float3& position) const
+{
+    Math::float3 toNpc = position - m_CameraPosition;
+    float distance = std::sqrt(toNpc.lengthSquared());
+
+    if(distance <= m_Config.nearDistance)
+        return 1;
+
+    // Linear between near and far
+    float t = std::min(1.0f, (distance - m_Config.nearDistance) / std::max(0.001f, m_Config.farDistance - m_Config.nearDistance));
+    uint32_t interval = 1 + static_cast<uint32_t>(t * (m_Config.maxInterval - 1) * 0.5f);
+
+    // Nobody looks at what happens behind the camera
+    if(toNpc.dot(m_CameraDirection) < 0.0f)
+        interval *= 2;
+
+    return std::max<uint32_t>(1, std::min(interval, m_Config.maxInterval));
+}
+
+void AIScheduler::tick(Slot& s)
+{
+    // Take it out first, the AI may remove or re-submit this NPC
+    Handle::EntityHandle npc = s.npc;
+    float dt = s.accumulatedTime;
+
+    s.accumulatedTime = 0.0f;
+    s.lastTickFrame = m_Frame;
+    s.submitted = false;
+
+    VobTypes::NpcVobInformation vob = VobTypes::asNpcVob(m_World, npc);
+    if(vob.playerController)
+        vob.playerController->getAIStateMachine().doAIState(dt);
+}
@@ -0,0 +1,153 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <handle/HandleDef.h>
+#include <math/mathlib.h>
+#include <utils/Histogram.h>
+
+namespace World
+{
+    class WorldInstance;
+}
+
+namespace Logic
+{
+    /**
+     * Decides which NPCs get to run their AI-state (NpcScriptState::doAIState) in a frame.
+     * NPCs in combat, in a dialog or controlled by the player tick every frame. All others get an interval based on
+     * their distance to the camera and whether they are in front of it. Those that are due are ticked oldest first
+     * until the per-frame budget is used up, the rest waits for the next frame.
+     * The time an NPC didn't tick is accumulated and passed on, so state-timers stay correct.
+     *
+     * The budget is either time or a fixed number of ticks (Config::ticksPerFrame). Only the latter doesn't depend
+     * on how fast the machine is, so it has to be used wherever a run must be reproducible, like input-recordings.
+     */
+    class AIScheduler
+    {
+    public:
+
+        struct Config
+        {
+            Config() :
+                    enabled(true),
+                    budgetMicroseconds(1000.0f),
+                    nearDistance(20.0f),
+                    farDistance(60.0f),
+                    maxInterval(8),
+                    ticksPerFrame(0)
+            {
+            }
+
+            /** If false, every NPC ticks every frame, like before there was a scheduler */
+            bool enabled;
+
+            /** Time the non-urgent NPCs may take per frame */
+            float budgetMicroseconds;
+
+            /** NPCs closer than this tick every frame, NPCs further away than farDistance use the longest interval */
+            float nearDistance;
+            float farDistance;
+
+            /** Most frames a non-urgent NPC may go without a tick */
+            uint32_t maxInterval;
+
+            /** If not 0, the non-urgent NPCs may do this many ticks per frame instead of using budgetMicroseconds */
+            uint32_t ticksPerFrame;
+        };
+
+        struct Stats
+        {
+            size_t numFrames;
+            size_t numTicks;
+            size_t numUrgentTicks;
+            size_t numDeferred; // Due NPCs pushed into the next frame because of the budget
+            size_t numOverruns; // Frames where the budgeted ticks took longer than the budget. Only with a time-budget.
+            Utils::Histogram ticksPerFrame;
+            Utils::Histogram overrunMicroseconds;
+        };
+
+        AIScheduler(World::WorldInstance& world);
+
+        /**
+         * To be called before the controllers are updated
+         * @param cameraWorld Transform of the camera, used for distance and visibility
+         */
+        void beginFrame(const Math::Matrix& cameraWorld);
+
+        /**
+         * Requests an AI-tick for the given NPC. To be called from its controllers update.
+         * @param npc NPC wanting to tick
+         * @param position Position of the NPC
+         * @param deltaTime Time since the last frame
+         * @param urgent Whether the NPC must tick this frame (Combat, dialog, player)
+         */
+        void submit(Handle::EntityHandle npc, const Math::float3& position, float deltaTime, bool urgent);
+
+        /**
+         * Forgets about the given NPC. Must be called when it gets removed.
+         */
+        void remove(Handle::EntityHandle npc);
+
+        /**
+         * Ticks the NPCs which are due, within the budget. To be called after all controllers were updated.
+         */
+        void runFrame();
+
+        /**
+         * Configuration, can be changed at any time
+         */
+        Config& getConfig(){ return m_Config; }
+
+        const Stats& getStats() const { return m_Stats; }
+        void resetStats();
+
+    private:
+
+        /**
+         * State of one NPC, by entity-index
+         */
+        struct Slot
+        {
+            Handle::EntityHandle npc;
+
+            /** Time passed since the last tick */
+            float accumulatedTime;
+
+            /** Frame of the last tick. Signed, so new NPCs can be put before the first frame. */
+            int64_t lastTickFrame;
+
+            /** Frames between two ticks */
+            uint32_t interval;
+
+            /** Whether this was submitted in the current frame */
+            bool submitted;
+            bool urgent;
+        };
+
+        /**
+         * @return Interval for an NPC at the given position
+         */
+        uint32_t computeInterval(const Math::float3& position) const;
+
+        /**
+         * Runs the AI of the given slot and resets its accumulated time
+         */
+        void tick(Slot& s);
+
+        World::WorldInstance& m_World;
+
+        Config m_Config;
+        Stats m_Stats;
+
+        /** Entity-index -> Slot */
+        std::vector<Slot> m_Slots;
+
+        /** Entity-indices submitted this frame */
+        std::vector<uint32_t> m_Submitted;
+        std::vector<uint32_t> m_Due;
+
+        int64_t m_Frame;
+        Math::float3 m_CameraPosition;
+        Math::float3 m_CameraDirection;
+    };
+}
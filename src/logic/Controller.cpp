@@ -42,19 +42,25 @@ void Logic::Controller::exportPart(json& j)
 {
     j["type"] = "Controller";
 
+    // Only reads, so this can be exported from multiple threads at once. getEntityTransform() would create
+    // a missing position-component and resolving a vob-view writes to its cache.
+    Components::ComponentAllocator& alloc = m_World.getComponentAllocator();
+    Components::PositionComponent* position = alloc.tryGetElement<Components::PositionComponent>(m_Entity);
+    Components::ObjectComponent* object = alloc.tryGetElement<Components::ObjectComponent>(m_Entity);
+
+    Math::Matrix transform = position ? position->m_WorldMatrix : Math::Matrix::CreateIdentity();
+
     // This doesn't work sometimes when directly assigning... null-values end up on instance 7412
 
     float values[16];
 
     for(int i=0;i<16;i++)
-        values[i] = getEntityTransform().mv[i];
+        values[i] = transform.mv[i];
 
     for(int i=0;i<16;i++)
         j["transform"].push_back(values[i]);
 
-    Vob::VobInformation vob = Vob::asVob(m_World, m_Entity);
-
-    j["collision"] = vob.object->m_EnableCollision;
+    j["collision"] = object && object->m_EnableCollision;
     // TODO: EventMessages?
 }
 
@@ -12,6 +12,7 @@
 #include <logic/PlayerController.h>
 #include <ui/SubtitleBox.h>
 #include <ui/PrintScreenMessages.h>
+#include <utils/Profiler.h>
 
 /**
  * File containing the dialouges
@@ -52,8 +53,8 @@ void DialogManager::onAIProcessInfos(Daedalus::GameState::NpcHandle self,
     m_Interaction.infos = infos;
 
     // Get interaction partner ("other")
-    m_Interaction.player = ZMemory::handleCast<Daedalus::GameState::NpcHandle>(
-            getVM().getDATFile().getSymbolByName("other").instanceDataHandle);
+    ScriptEngine& s = m_World.getScriptEngine();
+    m_Interaction.player = s.getNPCFromSymbol(s.getKnownSymbols().other);
 
     if(infos.empty())
         return;
@@ -159,9 +160,19 @@ void DialogManager::onAIOutput(Daedalus::GameState::NpcHandle self, Daedalus::Ga
     selfnpc.playerController->getEM().onMessage(conv);
 }
 
+bool DialogManager::isInvolved(Handle::EntityHandle npc)
+{
+    if(!m_DialogActive)
+        return false;
+
+    return VobTypes::getEntityFromScriptInstance(m_World, m_Interaction.target) == npc
+           || VobTypes::getEntityFromScriptInstance(m_World, m_Interaction.player) == npc;
+}
 
 void DialogManager::update(double dt)
 {
+    PROFILE_SCOPE("DialogManager::update");
+
     if(m_ActiveDialogBox)
     {
         static bool visibilityHack = m_ActiveSubtitleBox->isHidden();
@@ -228,8 +239,9 @@ bool DialogManager::performChoice(size_t choice)
     Daedalus::GEngineClasses::C_Info& info = getGameState().getInfo(m_Interaction.choices[choice].info);
 
     // Set instances again, since they could have been changed across the frames
-    getVM().setInstance("self", ZMemory::toBigHandle(m_Interaction.target), Daedalus::IC_Npc);
-    getVM().setInstance("other", ZMemory::toBigHandle(m_Interaction.player), Daedalus::IC_Npc);
+    ScriptEngine& s = m_World.getScriptEngine();
+    s.setInstanceNPC(s.getKnownSymbols().self, m_Interaction.target);
+    s.setInstanceNPC(s.getKnownSymbols().other, m_Interaction.player);
 
     size_t fnSym = m_Interaction.choices[choice].functionSym;
 
@@ -265,8 +277,9 @@ void DialogManager::startDialog(Daedalus::GameState::NpcHandle target)
     LogInfo() << "Talk to: " << VobTypes::getScriptObject(targetVob).name[0];
 
     // Self is the NPC we're talking to here. Kind of reversed, but what do I know.
-    getVM().setInstance("self", ZMemory::toBigHandle(target), Daedalus::IC_Npc);
-    getVM().setInstance("other", ZMemory::toBigHandle(VobTypes::getScriptHandle(playerVob)), Daedalus::IC_Npc);
+    ScriptEngine& s = m_World.getScriptEngine();
+    s.setInstanceNPC(s.getKnownSymbols().self, target);
+    s.setInstanceNPC(s.getKnownSymbols().other, VobTypes::getScriptHandle(playerVob));
 
     targetVob.playerController->standUp();
 
@@ -274,11 +287,11 @@ void DialogManager::startDialog(Daedalus::GameState::NpcHandle target)
 
     EventMessages::StateMessage msg;
     msg.subType = EventMessages::StateMessage::EV_StartState;
-    msg.functionSymbol = m_World.getScriptEngine().getSymbolIndexByName("ZS_TALK");
+    msg.functionSymbol = s.getSymbolIndexByName("ZS_TALK");
 
     // Set other/victum // TODO: Refractor
-    msg.other = ZMemory::handleCast<Daedalus::GameState::NpcHandle>(m_World.getScriptEngine().getVM().getDATFile().getSymbolByName("OTHER").instanceDataHandle);
-    msg.victim = ZMemory::handleCast<Daedalus::GameState::NpcHandle>(m_World.getScriptEngine().getVM().getDATFile().getSymbolByName("VICTIM").instanceDataHandle);
+    msg.other = s.getNPCFromSymbol(s.getKnownSymbols().other);
+    msg.victim = s.getNPCFromSymbol(s.getKnownSymbols().victim);
 
     targetVob.playerController->getEM().onMessage(msg, playerVob.entity);
 
@@ -3,6 +3,7 @@
 #include <daedalus/DaedalusGameState.h>
 #include <daedalus/DaedalusDialogManager.h>
 #include <json.hpp>
+#include <handle/HandleDef.h>
 using json = nlohmann::json;
 
 namespace World
@@ -85,6 +86,11 @@ namespace Logic
          */
         bool isDialogActive() { return m_DialogActive; }
 
+        /**
+         * @return Whether the given NPC takes part in the active dialog
+         */
+        bool isInvolved(Handle::EntityHandle npc);
+
         /**
          * Removes all choices currently in the dialogbox
          */
@@ -294,8 +294,8 @@ void MobController::callOnStateFunc(Handle::EntityHandle npc, int state)
     if(idx != static_cast<size_t>(-1))
     {
         VobTypes::NpcVobInformation nv = VobTypes::asNpcVob(m_World, npc);
-        s.setInstanceNPC("self", VobTypes::getScriptHandle(nv));
-        s.setInstanceItem("item", nv.playerController->getInteractItem());
+        s.setInstanceNPC(s.getKnownSymbols().self, VobTypes::getScriptHandle(nv));
+        s.setInstanceItem(s.getKnownSymbols().item, nv.playerController->getInteractItem());
 
         s.prepareRunFunction();
         s.runFunctionBySymIndex(idx);
@@ -579,14 +579,12 @@ void MobController::onVisualChanged()
         return;
 
     // Add animation-component, if not already done
-    Components::AnimationComponent& anim = Components::Actions::initComponent<Components::AnimationComponent>(
-                m_World.getComponentAllocator(), m_Entity);
+    Components::Actions::initComponent<Components::AnimationComponent>(m_World.getComponentAllocator(), m_Entity);
 
     // Strip extension
     std::string libName = v.visual->getName().substr(0, v.visual->getName().find_last_of('.'));
 
-    anim.getAnimHandler().setWorld(m_World);
-    anim.getAnimHandler().loadMeshLibFromVDF(libName, m_World.getEngine()->getVDFSIndex());
+    m_World.getAnimHandler(m_Entity).loadMeshLibFromVDF(libName, m_World.getEngine()->getVDFSIndex());
 
     // find new interact positions now that the visual changed
     findInteractPositions();
@@ -45,7 +45,7 @@ NpcScriptState::NpcScriptState(World::WorldInstance& world, Handle::EntityHandle
 
 NpcScriptState::~NpcScriptState()
 {
-
+    m_World.getRoutineScheduler().unschedule(m_HostVob);
 }
 
 
@@ -56,9 +56,10 @@ bool Logic::NpcScriptState::startAIState(size_t symIdx, bool endOldState, bool i
     Daedalus::DATFile& dat = s.getVM().getDATFile();
 
     // Save script variables
-    m_StateOther = s.getNPCFromSymbol("other");
-    m_StateVictim = s.getNPCFromSymbol("victim");
-    m_StateItem = s.getItemFromSymbol("item");
+    const ScriptEngine::KnownSymbols& sym = s.getKnownSymbols();
+    m_StateOther = s.getNPCFromSymbol(sym.other);
+    m_StateVictim = s.getNPCFromSymbol(sym.victim);
+    m_StateItem = s.getItemFromSymbol(sym.item);
 
     if(!isPrgState)
     {
@@ -73,7 +74,7 @@ bool Logic::NpcScriptState::startAIState(size_t symIdx, bool endOldState, bool i
         m_NextState.name = s_PRGStates[symIdx];
         m_NextState.prgState = (EPrgStates)symIdx;
 
-        symIdx = dat.getSymbolIndexByName(s_PRGStates[symIdx]);
+        symIdx = s.getSymbolIndexByName(s_PRGStates[symIdx]);
     }
 
     //LogInfo() << "AISTATE-START: " << m_NextState.name << " on NPC: " << VobTypes::getScriptObject(vob).name[0] << " (WP: " << VobTypes::getScriptObject(vob).wp << ")";
@@ -87,7 +88,7 @@ bool Logic::NpcScriptState::startAIState(size_t symIdx, bool endOldState, bool i
 
         // Just call the function
         s.prepareRunFunction();
-        s.setInstance("self", VobTypes::getScriptObject(vob).instanceSymbol);
+        s.setInstance(sym.self, VobTypes::getScriptObject(vob).instanceSymbol);
         s.runFunctionBySymIndex(symIdx);
 
         m_CurrentState.isRoutineState = oldIsRoutineState;
@@ -100,11 +101,14 @@ bool Logic::NpcScriptState::startAIState(size_t symIdx, bool endOldState, bool i
     m_NextState.symEnd = 0;
     m_NextState.symLoop = 0;
 
-    if(dat.hasSymbolName(m_NextState.name + "_END"))
-        m_NextState.symEnd = dat.getSymbolIndexByName(m_NextState.name + "_END");
+    // Cached by the script-engine, so this only searches the DAT-file the first time a state is used
+    SymbolHandle symEnd = s.getSymbol(m_NextState.name + "_END");
+    if(symEnd.isValid())
+        m_NextState.symEnd = symEnd.index;
 
-    if(dat.hasSymbolName(m_NextState.name + "_LOOP"))
-        m_NextState.symLoop = dat.getSymbolIndexByName(m_NextState.name + "_LOOP");
+    SymbolHandle symLoop = s.getSymbol(m_NextState.name + "_LOOP");
+    if(symLoop.isValid())
+        m_NextState.symLoop = symLoop.index;
 
 
     m_NextState.valid = true;
@@ -132,7 +136,7 @@ bool Logic::NpcScriptState::startAIState(size_t symIdx, bool endOldState, bool i
 bool Logic::NpcScriptState::startAIState(const std::string & name, bool endOldState, bool isRoutineState)
 {
     // Get script symbol index
-    size_t idx = m_World.getScriptEngine().getVM().getDATFile().getSymbolIndexByName(name);
+    size_t idx = m_World.getScriptEngine().getSymbolIndexByName(name);
 
 	return startAIState(idx, endOldState, isRoutineState);
 }
@@ -171,28 +175,7 @@ bool NpcScriptState::doAIState(float deltaTime)
 
     std::string name = vob.playerController->getScriptInstance().name[0];
 
-    if(m_Routine.hasRoutine && isInRoutine())
-    {
-        int h, m;
-        m_World.getSky().getTimeOfDay(h, m);
-
-        if(!m_Routine.routine[m_Routine.routineActiveIdx].timeInRange(h, m))
-        {
-            // Find next
-            size_t i=0;
-            for(RoutineEntry& e : m_Routine.routine)
-            {
-                if(e.timeInRange(h, m) && i != m_Routine.routineActiveIdx)
-                {
-                    m_Routine.routineActiveIdx = i;
-                    m_Routine.startNewRoutine = true;
-                    break;
-                }
-
-                i++;
-            }
-        }
-    }
+    // Switching routine-entries is done by the RoutineScheduler, see onRoutineTransition()
 
     // Only do states if we do not have messages pending
     if(vob.playerController->getEM().isEmpty())
@@ -232,12 +215,13 @@ bool NpcScriptState::doAIState(float deltaTime)
         {
             // Prepare state function call
             auto& inst = VobTypes::getScriptObject(vob);
-            s.setInstanceNPC("self", VobTypes::getScriptHandle(vob));
+            const ScriptEngine::KnownSymbols& sym = s.getKnownSymbols();
+            s.setInstanceNPC(sym.self, VobTypes::getScriptHandle(vob));
 
             // These are set by the game, but seem to be always 0
-            s.setInstanceNPC("OTHER", m_StateOther);
-            s.setInstanceNPC("VICTIM", m_StateVictim);
-            s.setInstanceItem("ITEM", m_StateItem);
+            s.setInstanceNPC(sym.other, m_StateOther);
+            s.setInstanceNPC(sym.victim, m_StateVictim);
+            s.setInstanceItem(sym.item, m_StateItem);
 
             if(m_CurrentState.phase == NpcAIState::EPhase::Uninitialized)
             {
@@ -415,7 +399,7 @@ void NpcScriptState::insertRoutine(int hoursStart, int minutesStart, int hoursEn
 
     m_Routine.routine.push_back(entry);
 
-
+    scheduleRoutine();
 }
 
 bool NpcScriptState::isNpcStateDriven()
@@ -459,6 +443,43 @@ void NpcScriptState::reinitRoutine()
                   << " to: "
                   << s.getVM().getDATFile().getSymbolByIndex(m_Routine.routine[0].symFunc).name;
     }
+
+    scheduleRoutine();
+}
+
+int64_t NpcScriptState::onRoutineTransition(int64_t now)
+{
+    if(!m_Routine.hasRoutine || m_Routine.routine.empty())
+        return -1;
+
+    size_t idx = Routine::findActiveEntry(m_Routine.routine,
+                                          m_Routine.routineActiveIdx,
+                                          static_cast<int>(now % Routine::MINUTES_PER_DAY));
+
+    if(idx != m_Routine.routineActiveIdx)
+    {
+        // Picked up by doAIState once the NPC is in its routine and gets updated again
+        m_Routine.routineActiveIdx = idx;
+        m_Routine.startNewRoutine = true;
+    }
+
+    return Routine::getNextTransition(m_Routine.routine, now);
+}
+
+const RoutineEntry* NpcScriptState::getActiveRoutineEntry() const
+{
+    if(!m_Routine.hasRoutine || m_Routine.routineActiveIdx >= m_Routine.routine.size())
+        return nullptr;
+
+    return &m_Routine.routine[m_Routine.routineActiveIdx];
+}
+
+void NpcScriptState::scheduleRoutine()
+{
+    if(m_Routine.hasRoutine && !m_Routine.routine.empty())
+        m_World.getRoutineScheduler().schedule(m_HostVob, m_World.getSky().getTimeInMinutes());
+    else
+        m_World.getRoutineScheduler().unschedule(m_HostVob);
 }
 
 bool NpcScriptState::isInState(size_t stateMain)
@@ -559,6 +580,8 @@ void NpcScriptState::importScriptState(const json& j)
     m_Routine.routineActiveIdx = j["activeRoutineIdx"];
     m_Routine.hasRoutine = !m_Routine.routine.empty();
 
+    scheduleRoutine();
+
     // Start routine
     //reinitRoutine();
 }
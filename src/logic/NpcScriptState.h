@@ -2,6 +2,7 @@
 #include <string>
 #include <handle/HandleDef.h>
 #include <engine/World.h>
+#include "RoutineScheduler.h"
 
 namespace Logic
 {
@@ -163,6 +164,18 @@ namespace Logic
 		 */
 		void reinitRoutine();
 
+		/**
+		 * @return The routine-entry which should currently be active, nullptr if the NPC doesn't have a routine
+		 */
+		const RoutineEntry* getActiveRoutineEntry() const;
+
+		/**
+		 * Called by the worlds RoutineScheduler once the routine may have to switch to an other entry
+		 * @param now Game-time in minutes
+		 * @return Time of the next transition, -1 if there is none
+		 */
+		int64_t onRoutineTransition(int64_t now);
+
 		/**
 		 * Exports this object to a JSON-object
 		 * @param j JSON-object ot export
@@ -190,6 +203,11 @@ namespace Logic
          */
         void importState(NpcAIState& state, const json& j) const;
 
+		/**
+		 * Lets the RoutineScheduler check the routine on the next frame. Unschedules the NPC if it doesn't have one.
+		 */
+		void scheduleRoutine();
+
 		/**
 		 * Currently executed AI-state
 		 */
@@ -223,49 +241,6 @@ namespace Logic
 		Daedalus::GameState::ItemHandle m_StateItem;
 
 
-		/**
-		 * One entry for the routines. See insertRoutine for more info
-		 */
-		struct RoutineEntry
-		{
-			/**
-			 * @return Whether the given hours/minutes match to this state
-			 */
-			bool timeInRange(int hours, int minutes)
-			{
-				auto tbigger = [&](int h1, int m1, int h2, int m2){
-					return h1 > h2 || (h1 == h2 && m1 > m2);
-				};
-
-				auto tsmaller = [&](int h1, int m1, int h2, int m2){
-					return h1 < h2 || (h1 == h2 && m1 < m2);
-				};
-
-				auto trange = [&](int h1, int m1, int h, int m, int h2, int m2){
-					return tbigger(h,m,h1,m1) && tsmaller(h,m,h2,m2);
-				};
-
-				bool crossesZero = hoursEnd < hoursStart;
-
-				if(!crossesZero)
-					return trange(hoursStart, minutesStart, hours, minutes, hoursEnd, minutesEnd);
-				else
-				{
-					return trange(hoursStart, minutesStart, hours, minutes, 24, 0)
-							&& trange(0, 0, hours, minutes, hoursEnd, minutesEnd);
-				}
-			}
-
-			int hoursStart;
-			int minutesStart;
-			int hoursEnd;
-			int minutesEnd;
-			size_t symFunc;
-			std::string waypoint;
-			bool isOverlay;
-		};
-
-
 		struct
 		{
 			/**
@@ -0,0 +1,339 @@
+#include "OffscreenSimulation.h"
+#include <algorithm>
+#include <utils/Profiler.h>
+#include <engine/World.h>
+#include <components/VobClasses.h>
+#include "PlayerController.h"
+
+using namespace Logic;
+
+/**
+ * @return Whether the NPC would walk its routine in the full simulation, i.e. it is alive, conscious and not busy
+ *         with some other AI-state
+ */
+static bool isWalkingRoutine(VobTypes::NpcVobInformation& vob)
+{
+    EBodyState state = vob.playerController->getBodyState();
+    if(state == BS_DEAD || state == BS_UNCONSCIOUS)
+        return false;
+
+    return vob.playerController->getAIStateMachine().isInRoutine();
+}
+
+OffscreenSimulation::OffscreenSimulation(World::WorldInstance& world) :
+        m_World(world),
+        m_NumEntered(0),
+        m_NumLeft(0),
+        m_NumRoutesPlanned(0),
+        m_NumArrived(0)
+{
+}
+
+void OffscreenSimulation::enter(Handle::EntityHandle npc)
+{
+    if(isSimulated(npc))
+        return;
+
+    VobTypes::NpcVobInformation vob = VobTypes::asNpcVob(m_World, npc);
+    if(!vob.playerController)
+        return;
+
+    if(m_Slots.size() <= npc.index)
+        m_Slots.resize(npc.index + 1, INVALID_AGENT);
+
+    m_Slots[npc.index] = static_cast<uint32_t>(m_Agents.size());
+    m_Agents.emplace_back();
+
+    Agent& a = m_Agents.back();
+    a.npc = npc;
+    a.moveSpeed = std::max(vob.playerController->getMoveSpeed(), 0.1f);
+    a.waypoint = vob.playerController->getClosestWaypoint();
+    a.departure = vob.position->m_WorldMatrix.Translation();
+    a.next = 0;
+    a.time = 0.0f;
+    a.moved = false;
+    a.pendingRoute = false;
+
+    // Keep walking whatever the NPC was walking. Bodies and NPCs doing something else stay where they are.
+    std::vector<size_t> route = vob.playerController->getRemainingRoute();
+    if(!route.empty() && isWalkingRoutine(vob))
+        setRoute(a, a.departure, route);
+
+    m_NumEntered++;
+}
+
+void OffscreenSimulation::leave(Handle::EntityHandle npc)
+{
+    if(!isSimulated(npc))
+        return;
+
+    uint32_t idx = m_Slots[npc.index];
+    Agent& a = m_Agents[idx];
+
+    // Nothing to do if the NPC is still where the full simulation left it. A pending route is dropped, the full
+    // simulation picks up the routine-switch by itself.
+    if(a.moved)
+    {
+        VobTypes::NpcVobInformation vob = VobTypes::asNpcVob(m_World, npc);
+
+        if(vob.playerController)
+        {
+            std::vector<size_t> route(a.route.begin() + std::min(a.next, a.route.size()), a.route.end());
+            vob.playerController->resumeRoute(getPosition(a), a.waypoint, route);
+        }
+    }
+
+    removeAgent(idx);
+    m_NumLeft++;
+}
+
+void OffscreenSimulation::onRoutineTransition(Handle::EntityHandle npc)
+{
+    if(!isSimulated(npc))
+        return;
+
+    Agent& a = m_Agents[m_Slots[npc.index]];
+
+    // The full simulation doesn't start the new routine-state either. Checked again once the route gets planned.
+    VobTypes::NpcVobInformation vob = VobTypes::asNpcVob(m_World, npc);
+    if(!vob.playerController || !isWalkingRoutine(vob))
+        return;
+
+    if(!a.pendingRoute)
+    {
+        a.pendingRoute = true;
+        m_PendingRoutes.push_back(npc);
+    }
+}
+
+void OffscreenSimulation::stop(Handle::EntityHandle npc)
+{
+    if(!isSimulated(npc))
+        return;
+
+    Agent& a = m_Agents[m_Slots[npc.index]];
+
+    // Its entry in m_PendingRoutes is skipped once this is cleared
+    a.pendingRoute = false;
+
+    if(a.route.empty())
+        return;
+
+    // Stay where it got to. leave() puts it there, without a route to continue.
+    a.departure = getPosition(a);
+    a.route.clear();
+    a.arrival.clear();
+    a.next = 0;
+}
+
+void OffscreenSimulation::remove(Handle::EntityHandle npc)
+{
+    if(isSimulated(npc))
+        removeAgent(m_Slots[npc.index]);
+}
+
+void OffscreenSimulation::removeAgent(uint32_t idx)
+{
+    m_Slots[m_Agents[idx].npc.index] = INVALID_AGENT;
+
+    if(idx + 1 != m_Agents.size())
+    {
+        m_Agents[idx] = std::move(m_Agents.back());
+        m_Slots[m_Agents[idx].npc.index] = idx;
+    }
+
+    m_Agents.pop_back();
+}
+
+void OffscreenSimulation::update(float deltaTime)
+{
+    PROFILE_SCOPE("OffscreenSimulation::update");
+
+    if(!m_Config.enabled)
+    {
+        // Hand everyone back, so they freeze where they got to
+        while(!m_Agents.empty())
+            leave(m_Agents.back().npc);
+
+        m_PendingRoutes.clear();
+        return;
+    }
+
+    // Plan the routes of the NPCs whose routine switched. Those which left or were removed meanwhile are skipped.
+    size_t numPlanned = 0;
+    size_t numHandled = 0;
+    for(; numHandled < m_PendingRoutes.size() && numPlanned < m_Config.maxRoutesPerFrame; numHandled++)
+    {
+        Handle::EntityHandle npc = m_PendingRoutes[numHandled];
+
+        if(!isSimulated(npc) || !m_Agents[m_Slots[npc.index]].pendingRoute)
+            continue;
+
+        planRoutineRoute(m_Agents[m_Slots[npc.index]]);
+        numPlanned++;
+    }
+
+    m_PendingRoutes.erase(m_PendingRoutes.begin(), m_PendingRoutes.begin() + numHandled);
+
+    const World::Waynet::WaynetInstance& waynet = m_World.getWaynet();
+    Components::ComponentAllocator& alloc = m_World.getComponentAllocator();
+
+    for(Agent& a : m_Agents)
+    {
+        if(a.route.empty())
+            continue;
+
+        a.time += deltaTime;
+
+        size_t passed = a.next;
+        while(a.next < a.route.size() && a.arrival[a.next] <= a.time)
+            a.next++;
+
+        if(passed == a.next)
+            continue;
+
+        // Only put the NPC onto the waypoints themselves. Nobody sees it, so that is only done to have the
+        // distance-checks and everything else looking at the position be roughly correct.
+        a.waypoint = a.route[a.next - 1];
+
+        Components::PositionComponent* position = alloc.tryGetElement<Components::PositionComponent>(a.npc);
+        if(position)
+            position->m_WorldMatrix.Translation(waynet.waypoints[a.waypoint].position);
+
+        if(a.next == a.route.size())
+        {
+            // Stand there until the next route
+            a.departure = waynet.waypoints[a.waypoint].position;
+            a.route.clear();
+            a.arrival.clear();
+            a.next = 0;
+            m_NumArrived++;
+        }
+    }
+}
+
+void OffscreenSimulation::planRoutineRoute(Agent& agent)
+{
+    agent.pendingRoute = false;
+
+    VobTypes::NpcVobInformation vob = VobTypes::asNpcVob(m_World, agent.npc);
+    if(!vob.playerController || !isWalkingRoutine(vob))
+        return;
+
+    const RoutineEntry* entry = vob.playerController->getAIStateMachine().getActiveRoutineEntry();
+    if(!entry)
+        return;
+
+    const World::Waynet::WaynetInstance& waynet = m_World.getWaynet();
+    size_t target = World::Waynet::getWaypointIndex(waynet, entry->waypoint);
+    if(target == World::Waynet::INVALID_WAYPOINT)
+        return;
+
+    Math::float3 departure = getPosition(agent);
+
+    // Continue from the waypoint the NPC is walking towards, if it's on a route already
+    size_t start;
+    if(agent.next < agent.route.size())
+        start = agent.route[agent.next];
+    else if(agent.waypoint != World::Waynet::INVALID_WAYPOINT)
+        start = agent.waypoint;
+    else
+        start = World::Waynet::findNearestWaypointTo(waynet, departure);
+
+    std::vector<size_t> route = World::Waynet::findWay(waynet, start, target);
+
+    // findWay doesn't return anything for start == target, but the NPC might still have to get onto the waypoint
+    if(route.empty() && start == target)
+        route.push_back(target);
+
+    setRoute(agent, departure, route);
+}
+
+void OffscreenSimulation::setRoute(Agent& agent, const Math::float3& departure, const std::vector<size_t>& route)
+{
+    const World::Waynet::WaynetInstance& waynet = m_World.getWaynet();
+
+    agent.route = route;
+    agent.arrival.resize(route.size());
+    agent.departure = departure;
+    agent.next = 0;
+    agent.time = 0.0f;
+
+    if(route.empty())
+        return;
+
+    agent.moved = true;
+
+    float t = (waynet.waypoints[route[0]].position - departure).length() / agent.moveSpeed;
+    agent.arrival[0] = t;
+
+    for(size_t i = 1; i < route.size(); i++)
+    {
+        t += getEdgeLength(route[i - 1], route[i]) / agent.moveSpeed;
+        agent.arrival[i] = t;
+    }
+
+    m_NumRoutesPlanned++;
+}
+
+float OffscreenSimulation::getEdgeLength(size_t from, size_t to)
+{
+    const World::Waynet::WaynetInstance& waynet = m_World.getWaynet();
+
+    if(m_EdgeLengths.size() != waynet.waypoints.size())
+    {
+        m_EdgeLengths.resize(waynet.waypoints.size());
+
+        for(size_t i = 0; i < waynet.waypoints.size(); i++)
+        {
+            const World::Waynet::Waypoint& wp = waynet.waypoints[i];
+
+            m_EdgeLengths[i].resize(wp.edges.size());
+            for(size_t j = 0; j < wp.edges.size(); j++)
+                m_EdgeLengths[i][j] = (waynet.waypoints[wp.edges[j]].position - wp.position).length();
+        }
+    }
+
+    const std::vector<World::Waynet::WaypointIndex>& edges = waynet.waypoints[from].edges;
+    for(size_t j = 0; j < edges.size(); j++)
+    {
+        if(edges[j] == to)
+            return m_EdgeLengths[from][j];
+    }
+
+    // Not connected, shouldn't happen for routes coming from findWay
+    return (waynet.waypoints[to].position - waynet.waypoints[from].position).length();
+}
+
+Math::float3 OffscreenSimulation::getPosition(const Agent& agent) const
+{
+    const World::Waynet::WaynetInstance& waynet = m_World.getWaynet();
+
+    // Standing
+    if(agent.next >= agent.route.size())
+        return agent.departure;
+
+    Math::float3 from = agent.next == 0 ? agent.departure : waynet.waypoints[agent.route[agent.next - 1]].position;
+    float start = agent.next == 0 ? 0.0f : agent.arrival[agent.next - 1];
+    float end = agent.arrival[agent.next];
+
+    float p = end > start ? (agent.time - start) / (end - start) : 1.0f;
+
+    return Math::float3::lerp(from, waynet.waypoints[agent.route[agent.next]].position, std::min(std::max(p, 0.0f), 1.0f));
+}
+
+OffscreenSimulation::Stats OffscreenSimulation::getStats() const
+{
+    Stats s;
+    s.numSimulated = m_Agents.size();
+    s.numWalking = static_cast<size_t>(std::count_if(m_Agents.begin(), m_Agents.end(), [](const Agent& a){
+        return !a.route.empty();
+    }));
+    s.numEntered = m_NumEntered;
+    s.numLeft = m_NumLeft;
+    s.numRoutesPlanned = m_NumRoutesPlanned;
+    s.numRoutesPending = m_PendingRoutes.size();
+    s.numArrived = m_NumArrived;
+
+    return s;
+}
@@ -0,0 +1,195 @@
+#pragma once
+#include <vector>
+#include <cstdint>
+#include <handle/HandleDef.h>
+#include <math/mathlib.h>
+
+namespace World
+{
+    class WorldInstance;
+}
+
+namespace Logic
+{
+    /**
+     * Cheap stand-in for the NPCs outside of the update-range. Their controllers aren't updated, so without this
+     * they would freeze mid-route and snap to wherever their routine is once the player comes close.
+     * NPCs in here only walk the waynet: Once their routine switches, a route to the waypoint of the new entry is
+     * planned and the arrival-time at every waypoint on it is computed up front from the edge-lengths. Each frame then
+     * only compares times and moves the NPC to the last waypoint it passed. There are no animations, no raycasts and
+     * no AI-states. Once an NPC comes back into the update-range, it is put where it got to and continues the rest of
+     * its route in the full simulation.
+     */
+    class OffscreenSimulation
+    {
+    public:
+
+        struct Config
+        {
+            Config() :
+                    enabled(true),
+                    maxRoutesPerFrame(16)
+            {
+            }
+
+            /**
+             * If false, NPCs outside of the update-range freeze, like before there was an offscreen simulation.
+             * NPCs simulated in here when this is turned off are handed back during the next update.
+             */
+            bool enabled;
+
+            /** Routes to plan per frame at most. Many routines switch at the same time, the rest waits. */
+            size_t maxRoutesPerFrame;
+        };
+
+        struct Stats
+        {
+            size_t numSimulated; // NPCs currently in here
+            size_t numWalking; // Of those, the ones on a route
+            size_t numEntered; // Since the world started
+            size_t numLeft;
+            size_t numRoutesPlanned;
+            size_t numRoutesPending; // Waiting for the next frames
+            size_t numArrived;
+        };
+
+        OffscreenSimulation(World::WorldInstance& world);
+
+        /**
+         * @return Whether the given NPC is simulated in here
+         */
+        bool isSimulated(Handle::EntityHandle npc) const
+        {
+            return npc.index < m_Slots.size() && m_Slots[npc.index] != INVALID_AGENT
+                   && m_Agents[m_Slots[npc.index]].npc == npc;
+        }
+
+        /**
+         * Takes the NPC out of the full simulation. A route it was walking is continued in here.
+         */
+        void enter(Handle::EntityHandle npc);
+
+        /**
+         * Hands the NPC back to the full simulation, at the position it got to
+         */
+        void leave(Handle::EntityHandle npc);
+
+        /**
+         * Sends the NPC to the waypoint of its currently active routine-entry, if it is simulated in here.
+         * To be called after the RoutineScheduler switched its routine. The route is planned during one of the next updates.
+         */
+        void onRoutineTransition(Handle::EntityHandle npc);
+
+        /**
+         * Stops the NPC where it is and drops its pending route, if it is simulated in here.
+         * To be called when it dies or gets knocked out, so the body doesn't keep walking its routine.
+         */
+        void stop(Handle::EntityHandle npc);
+
+        /**
+         * Plans the pending routes and moves all NPCs in here along their routes
+         */
+        void update(float deltaTime);
+
+        /**
+         * Forgets about the given NPC. Must be called when it gets removed.
+         */
+        void remove(Handle::EntityHandle npc);
+
+        /**
+         * Configuration, can be changed at any time
+         */
+        Config& getConfig(){ return m_Config; }
+
+        Stats getStats() const;
+
+    private:
+
+        enum : uint32_t { INVALID_AGENT = static_cast<uint32_t>(-1) };
+
+        /**
+         * An NPC simulated in here
+         */
+        struct Agent
+        {
+            Handle::EntityHandle npc;
+
+            /** Move speed in m/s */
+            float moveSpeed;
+
+            /** Waypoint the NPC passed last, INVALID_WAYPOINT if it wasn't on the waynet yet */
+            size_t waypoint;
+
+            /** Waypoints still to visit. Empty while standing. */
+            std::vector<size_t> route;
+
+            /** Seconds after departure at which the waypoint of the same index in route is reached */
+            std::vector<float> arrival;
+
+            /** Where the NPC departed from, or where it stands while it has no route */
+            Math::float3 departure;
+
+            /** Index in route of the next waypoint to reach */
+            size_t next;
+
+            /** Seconds since departure */
+            float time;
+
+            /** Whether the NPC was moved since it entered */
+            bool moved;
+
+            /** Whether the NPC is waiting for a route to be planned */
+            bool pendingRoute;
+        };
+
+        /**
+         * Lets the agent walk the given route
+         * @param departure Position to start at
+         */
+        void setRoute(Agent& agent, const Math::float3& departure, const std::vector<size_t>& route);
+
+        /**
+         * Finds the route to the waypoint of the agents active routine-entry and lets it walk that
+         */
+        void planRoutineRoute(Agent& agent);
+
+        /**
+         * Removes the agent at the given index, moving the last one into its place
+         */
+        void removeAgent(uint32_t idx);
+
+        /**
+         * @return Length of the waynet-edge between the given waypoints
+         */
+        float getEdgeLength(size_t from, size_t to);
+
+        /**
+         * @return Position of the given agent, interpolated along its current route
+         */
+        Math::float3 getPosition(const Agent& agent) const;
+
+        World::WorldInstance& m_World;
+
+        Config m_Config;
+
+        /** All simulated NPCs, packed */
+        std::vector<Agent> m_Agents;
+
+        /** Entity-index -> Index into m_Agents */
+        std::vector<uint32_t> m_Slots;
+
+        /** NPCs waiting for a route, in the order their routine switched */
+        std::vector<Handle::EntityHandle> m_PendingRoutes;
+
+        /**
+         * Length of every waynet-edge, in the same order as the edges of the waypoints.
+         * Built once the first route is planned and again whenever the waynet changed size.
+         */
+        std::vector<std::vector<float>> m_EdgeLengths;
+
+        size_t m_NumEntered;
+        size_t m_NumLeft;
+        size_t m_NumRoutesPlanned;
+        size_t m_NumArrived;
+    };
+}
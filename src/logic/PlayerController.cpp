@@ -90,12 +90,23 @@ PlayerController::PlayerController(World::WorldInstance& world,
     m_NoAniRootPosHack = false;
 }
 
+PlayerController::~PlayerController()
+{
+    m_World.getAIScheduler().remove(m_Entity);
+    m_World.getOffscreenSimulation().remove(m_Entity);
+}
+
 void PlayerController::onUpdate(float deltaTime)
 {
     // This vob should react to messages
     getEM().processMessageQueue();
 
-    m_AIStateMachine.doAIState(deltaTime);
+    // The AI-state runs time-sliced, after all controllers were updated
+    bool urgent = isPlayerControlled()
+                  || m_EquipmentState.weaponMode != EWeaponMode::WeaponNone
+                  || m_World.getDialogManager().isInvolved(m_Entity);
+
+    m_World.getAIScheduler().submit(m_Entity, getEntityTransform().Translation(), deltaTime, urgent);
 
     ModelVisual* model = getModelVisual();
 
@@ -239,7 +250,43 @@ void PlayerController::rebuildRoute()
     m_MoveState.targetNode = 0;
 
     // Update script-instance with target waypoint
-    getScriptInstance().wp = m_World.getWaynet().waypoints[m_AIState.targetWaypoint].name;
+    getScriptInstance().wp = m_World.getWaynet().waypoints[m_AIState.targetWaypoint].name.str();
+}
+
+std::vector<size_t> PlayerController::getRemainingRoute() const
+{
+    if (m_MoveState.targetNode >= m_MoveState.currentPath.size())
+        return std::vector<size_t>();
+
+    return std::vector<size_t>(m_MoveState.currentPath.begin() + m_MoveState.targetNode, m_MoveState.currentPath.end());
+}
+
+void PlayerController::resumeRoute(const Math::float3& position, size_t closestWaypoint, const std::vector<size_t>& route)
+{
+    m_AIState.closestWaypoint = closestWaypoint;
+    m_AIState.targetWaypoint = route.empty() ? closestWaypoint : route.back();
+
+    m_MoveState.currentPath = route;
+    m_MoveState.targetNode = 0;
+    m_MoveState.currentPathPerc = 0.0f;
+    m_MoveState.currentRouteLength = World::Waynet::getPathLength(m_World.getWaynet(), route);
+
+    // Face where the NPC is going
+    if (!route.empty())
+    {
+        Math::float3 direction = m_World.getWaynet().waypoints[route.front()].position - position;
+        direction.y = 0.0f;
+
+        if (direction.lengthSquared() > 0.0f)
+            m_MoveState.direction = direction;
+    }
+
+    m_MoveState.position = position;
+
+    // This also update the entity transform from m_MoveState.position
+    setDirection(m_MoveState.direction);
+
+    placeOnGround();
 }
 
 bool PlayerController::travelPath(float deltaTime)
@@ -1290,9 +1337,10 @@ bool PlayerController::EV_State(EventMessages::StateMessage& message, Handle::En
             }
 
             // Set up script instances. // TODO: Self is originally not set by gothic here! Why?
-            m_World.getScriptEngine().setInstance("self", getScriptInstance().instanceSymbol);
-            m_World.getScriptEngine().setInstanceNPC("other", message.other);
-            m_World.getScriptEngine().setInstanceNPC("victim", message.victim);
+            const ScriptEngine::KnownSymbols& sym = m_World.getScriptEngine().getKnownSymbols();
+            m_World.getScriptEngine().setInstance(sym.self, getScriptInstance().instanceSymbol);
+            m_World.getScriptEngine().setInstanceNPC(sym.other, message.other);
+            m_World.getScriptEngine().setInstanceNPC(sym.victim, message.victim);
 
             getEM().clear();
 
@@ -1724,7 +1772,7 @@ bool PlayerController::useItem(Daedalus::GameState::ItemHandle item)
     // Call script function to be executed on use
     if(data.on_state[0])
     {
-        m_World.getScriptEngine().setInstanceNPC("self", getScriptHandle());
+        m_World.getScriptEngine().setInstanceNPC(m_World.getScriptEngine().getKnownSymbols().self, getScriptHandle());
         m_World.getScriptEngine().prepareRunFunction();
         m_World.getScriptEngine().runFunctionBySymIndex(data.on_state[0]);
     }
@@ -1755,15 +1803,15 @@ bool PlayerController::canUse(Daedalus::GameState::ItemHandle item)
             if(npc.attribute[data.cond_atr[i]] < data.cond_value[i])
             {
                 // Display messages, if this is the player and do debug-output
-                s.setInstanceNPC("self", getScriptHandle());
-                s.setInstanceItem("item", item);
+                s.setInstanceNPC(s.getKnownSymbols().self, getScriptHandle());
+                s.setInstanceItem(s.getKnownSymbols().item, item);
 
                 s.prepareRunFunction();
 
                 s.pushInt(data.cond_value[i]);
                 s.pushInt(data.cond_atr[i]);
                 s.pushInt(isPlayerControlled() ? 1 : 0);
-                s.runFunction("G_CANNOTUSE");
+                s.runFunction(s.getSymbol("G_CANNOTUSE"));
 
                 return false;
             }
@@ -2048,7 +2096,7 @@ void PlayerController::setupKeyBindings()
             }
 
             /*size_t targetWP = World::Waynet::findNearestWaypointTo(m_World.getWaynet(), getEntityTransform().Translation());
-                Handle::EntityHandle h = VobTypes::Wld_InsertNpc(m_World, "VLK_574_Mud", m_World.getWaynet().waypoints[targetWP].name);
+                Handle::EntityHandle h = VobTypes::Wld_InsertNpc(m_World, "VLK_574_Mud", m_World.getWaynet().waypoints[targetWP].name.str());
                 VobTypes::NpcVobInformation vob = VobTypes::asNpcVob(m_World, h);
 
                 vob.playerController->changeRoutine("");
@@ -2261,16 +2309,20 @@ void PlayerController::die(Handle::EntityHandle attackingNPC)
 
     setBodyState(EBodyState::BS_DEAD);
 
+    // Don't let the body walk on to the next routine-entry while nobody is looking
+    m_World.getOffscreenSimulation().stop(m_Entity);
+
     if(!m_AIStateMachine.isInState(NPC_PRGAISTATE_DEAD))
     {
-        Daedalus::GameState::NpcHandle oldOther = m_World.getScriptEngine().getNPCFromSymbol("other");
+        SymbolHandle other = m_World.getScriptEngine().getKnownSymbols().other;
+        Daedalus::GameState::NpcHandle oldOther = m_World.getScriptEngine().getNPCFromSymbol(other);
 
         VobTypes::NpcVobInformation attacker = VobTypes::asNpcVob(m_World, attackingNPC);
-        m_World.getScriptEngine().setInstanceNPC("other", VobTypes::getScriptHandle(attacker));
+        m_World.getScriptEngine().setInstanceNPC(other, VobTypes::getScriptHandle(attacker));
         m_AIStateMachine.startAIState(Logic::NPC_PRGAISTATE_DEAD, false, false, true);
 
         // Restore old other
-        m_World.getScriptEngine().setInstanceNPC("other", oldOther);
+        m_World.getScriptEngine().setInstanceNPC(other, oldOther);
     }
 
     setAttribute(Daedalus::GEngineClasses::C_Npc::EAttributes::EATR_HITPOINTS, 0);
@@ -2303,6 +2355,7 @@ void PlayerController::checkUnconscious()
     // Not yet unconscious, we can change that...
     getEM().onMessage(EventMessages::ConversationMessage::playAnimation("T_STAND_2_WOUNDEDB"));
     setBodyState(EBodyState::BS_UNCONSCIOUS);
+    m_World.getOffscreenSimulation().stop(m_Entity);
 }
 
 
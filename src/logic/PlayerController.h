@@ -76,6 +76,7 @@ namespace Logic
          * @param entity Entity owning this controller
          */
         PlayerController(World::WorldInstance& world, Handle::EntityHandle entity, Daedalus::GameState::NpcHandle scriptInstance);
+        ~PlayerController();
 
         /**
          * @return The type of this class. If you are adding a new base controller, be sure to add it to ControllerTypes.h
@@ -142,6 +143,29 @@ namespace Logic
          */
         void stopRoute();
 
+        /**
+         * @return Waypoints still to visit on the current route, empty if the NPC isn't walking one
+         */
+        std::vector<size_t> getRemainingRoute() const;
+
+        /**
+         * @return Waypoint this NPC was last positioned at, INVALID_WAYPOINT if unknown
+         */
+        size_t getClosestWaypoint() const { return m_AIState.closestWaypoint; }
+
+        /**
+         * @return Move speed in m/s
+         */
+        float getMoveSpeed() const { return m_NPCProperties.moveSpeed; }
+
+        /**
+         * Puts the NPC at the given position and continues walking the given route from there.
+         * Used to hand the NPC back from the OffscreenSimulation.
+         * @param closestWaypoint Waypoint the NPC passed last
+         * @param route Waypoints still to visit. Can be empty.
+         */
+        void resumeRoute(const Math::float3& position, size_t closestWaypoint, const std::vector<size_t>& route);
+
         /**
          * Teleports the entity to the given waypoint
          * @param Waypoint index to go to
@@ -0,0 +1,179 @@
+#include "RoutineScheduler.h"
+#include <algorithm>
+#include <utils/Profiler.h>
+
+using namespace Logic;
+
+size_t Routine::findActiveEntry(const std::vector<RoutineEntry>& routine, size_t activeIdx, int minuteOfDay)
+{
+    int h = minuteOfDay / 60;
+    int m = minuteOfDay % 60;
+
+    if(activeIdx < routine.size() && routine[activeIdx].timeInRange(h, m))
+        return activeIdx;
+
+    for(size_t i = 0; i < routine.size(); i++)
+    {
+        if(i != activeIdx && routine[i].timeInRange(h, m))
+            return i;
+    }
+
+    return activeIdx;
+}
+
+int64_t Routine::getNextTransition(const std::vector<RoutineEntry>& routine, int64_t now)
+{
+    if(routine.empty())
+        return -1;
+
+    int nowOfDay = static_cast<int>(now % MINUTES_PER_DAY);
+
+    // Ranges don't include start and end, so an entry becomes valid one minute after its start
+    // and stops being valid right at its end
+    int64_t next = MINUTES_PER_DAY;
+    for(const RoutineEntry& e : routine)
+    {
+        int boundaries[] = {e.hoursStart * 60 + e.minutesStart + 1, e.hoursEnd * 60 + e.minutesEnd};
+
+        for(int b : boundaries)
+        {
+            // Always in (0, MINUTES_PER_DAY]
+            int64_t d = ((b - nowOfDay - 1) % MINUTES_PER_DAY + MINUTES_PER_DAY) % MINUTES_PER_DAY + 1;
+            next = std::min(next, d);
+        }
+    }
+
+    return now + next;
+}
+
+RoutineScheduler::RoutineScheduler() :
+        m_LastUpdate(0),
+        m_NumScheduled(0),
+        m_NumFired(0),
+        m_NumRebuilds(0)
+{
+}
+
+void RoutineScheduler::schedule(Handle::EntityHandle npc, int64_t time)
+{
+    if(m_Slots.size() <= npc.index)
+        m_Slots.resize(npc.index + 1, {Handle::EntityHandle::makeInvalidHandle(), 0, false});
+
+    Slot& s = m_Slots[npc.index];
+
+    if(!s.scheduled)
+        m_NumScheduled++;
+
+    // Outdates whatever was queued for this slot before
+    s.npc = npc;
+    s.serial++;
+    s.scheduled = true;
+
+    push({time, npc, s.serial});
+}
+
+void RoutineScheduler::unschedule(Handle::EntityHandle npc)
+{
+    if(npc.index >= m_Slots.size())
+        return;
+
+    Slot& s = m_Slots[npc.index];
+
+    if(!s.scheduled || s.npc != npc)
+        return;
+
+    s.serial++;
+    s.scheduled = false;
+    m_NumScheduled--;
+
+    // Don't let the heap fill up with dead entries if NPCs come and go a lot
+    if(m_Heap.size() > 2 * m_NumScheduled + 64)
+    {
+        m_Heap.erase(std::remove_if(m_Heap.begin(), m_Heap.end(), [this](const Transition& t){
+            return !isLive(t);
+        }), m_Heap.end());
+
+        std::make_heap(m_Heap.begin(), m_Heap.end());
+    }
+}
+
+size_t RoutineScheduler::update(int64_t now, const TransitionFn& fn)
+{
+    PROFILE_SCOPE("RoutineScheduler::update");
+
+    size_t numFired = 0;
+
+    if(now < m_LastUpdate)
+    {
+        // Time went backwards. The queued transitions are all in the future now, let everyone look again.
+        m_NumRebuilds++;
+        m_Heap.clear();
+
+        for(Slot& s : m_Slots)
+        {
+            if(s.scheduled)
+                m_Heap.push_back({now, s.npc, s.serial});
+        }
+
+        std::make_heap(m_Heap.begin(), m_Heap.end());
+    }
+
+    m_LastUpdate = now;
+
+    while(!m_Heap.empty() && m_Heap.front().time <= now)
+    {
+        std::pop_heap(m_Heap.begin(), m_Heap.end());
+        Transition t = m_Heap.back();
+        m_Heap.pop_back();
+
+        if(!isLive(t))
+            continue;
+
+        // Take it out first, the function may reschedule on its own
+        Slot& s = m_Slots[t.npc.index];
+        s.scheduled = false;
+        m_NumScheduled--;
+
+        int64_t next = fn(t.npc, now);
+        numFired++;
+
+        // Transitions are always in the future, otherwise this would never end
+        if(next > now && !m_Slots[t.npc.index].scheduled)
+            schedule(t.npc, next);
+    }
+
+    m_NumFired += numFired;
+
+    return numFired;
+}
+
+void RoutineScheduler::clear()
+{
+    m_Heap.clear();
+    m_Slots.clear();
+    m_NumScheduled = 0;
+}
+
+RoutineScheduler::Stats RoutineScheduler::getStats() const
+{
+    Stats s;
+    s.numScheduled = m_NumScheduled;
+    s.numHeapEntries = m_Heap.size();
+    s.numFired = m_NumFired;
+    s.numRebuilds = m_NumRebuilds;
+
+    return s;
+}
+
+bool RoutineScheduler::isLive(const Transition& t) const
+{
+    const Slot& s = m_Slots[t.npc.index];
+
+    return s.scheduled && s.serial == t.serial && s.npc == t.npc;
+}
+
+void RoutineScheduler::push(const Transition& t)
+{
+    m_Heap.push_back(t);
+    std::push_heap(m_Heap.begin(), m_Heap.end());
+}
@@ -0,0 +1,178 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <functional>
+#include <handle/HandleDef.h>
+
+namespace Logic
+{
+    /**
+     * One entry of an NPCs daily routine. See NpcScriptState::insertRoutine for more info
+     */
+    struct RoutineEntry
+    {
+        /**
+         * @return Whether the given hours/minutes match to this state. Start and end themselves are not part of it.
+         */
+        bool timeInRange(int hours, int minutes) const
+        {
+            auto tbigger = [&](int h1, int m1, int h2, int m2){
+                return h1 > h2 || (h1 == h2 && m1 > m2);
+            };
+
+            auto tsmaller = [&](int h1, int m1, int h2, int m2){
+                return h1 < h2 || (h1 == h2 && m1 < m2);
+            };
+
+            auto trange = [&](int h1, int m1, int h, int m, int h2, int m2){
+                return tbigger(h,m,h1,m1) && tsmaller(h,m,h2,m2);
+            };
+
+            bool crossesZero = hoursEnd < hoursStart || (hoursEnd == hoursStart && minutesEnd < minutesStart);
+
+            if(!crossesZero)
+                return trange(hoursStart, minutesStart, hours, minutes, hoursEnd, minutesEnd);
+            else
+            {
+                // Either before midnight, midnight itself or after it
+                bool endsAtMidnight = hoursEnd == 0 && minutesEnd == 0;
+
+                return trange(hoursStart, minutesStart, hours, minutes, 24, 0)
+                        || (hours == 0 && minutes == 0 && !endsAtMidnight)
+                        || trange(0, 0, hours, minutes, hoursEnd, minutesEnd);
+            }
+        }
+
+        int hoursStart;
+        int minutesStart;
+        int hoursEnd;
+        int minutesEnd;
+        size_t symFunc;
+        std::string waypoint;
+        bool isOverlay;
+    };
+
+    namespace Routine
+    {
+        enum { MINUTES_PER_DAY = 24 * 60 };
+
+        /**
+         * @param routine Routine to look at
+         * @param activeIdx Entry currently active
+         * @param minuteOfDay Time to check, in minutes since midnight
+         * @return Entry which should be active at the given time. If the active entry is still in range or no entry
+         *         matches, this stays activeIdx.
+         */
+        size_t findActiveEntry(const std::vector<RoutineEntry>& routine, size_t activeIdx, int minuteOfDay);
+
+        /**
+         * @param routine Routine to look at
+         * @param now Game-time in minutes, see Sky::getTimeInMinutes()
+         * @return First time after now, at which any entry starts or ends. -1 if the routine is empty.
+         */
+        int64_t getNextTransition(const std::vector<RoutineEntry>& routine, int64_t now);
+    }
+
+    /**
+     * Keeps the upcoming routine-transitions of all NPCs of a world in a min-heap over game-time, so the NPCs don't
+     * have to check their routine every frame. Also works for NPCs outside of the update-range, which wouldn't
+     * advance their routine otherwise.
+     * Each NPC has at most one live transition. Rescheduling or removing an NPC leaves its old entry inside the heap,
+     * which is then skipped once it comes up.
+     */
+    class RoutineScheduler
+    {
+    public:
+
+        /**
+         * Called when a transition of an NPC is due.
+         * Gets the NPC and the current game-time, returns the time of the next transition or -1 for none.
+         */
+        typedef std::function<int64_t(Handle::EntityHandle, int64_t)> TransitionFn;
+
+        struct Stats
+        {
+            size_t numScheduled; // NPCs with a live transition
+            size_t numHeapEntries; // Including outdated ones
+            size_t numFired; // Transitions fired since the world started
+            size_t numRebuilds; // How often time went backwards
+        };
+
+        RoutineScheduler();
+
+        /**
+         * Sets the next transition of the given NPC. Replaces the one it had before.
+         * @param time Game-time in minutes. Anything not after the current time fires on the next update.
+         */
+        void schedule(Handle::EntityHandle npc, int64_t time);
+
+        /**
+         * Removes the transition of the given NPC, if it has one
+         */
+        void unschedule(Handle::EntityHandle npc);
+
+        /**
+         * Fires all transitions which are due at the given time. Skipping forward fires every NPC only once.
+         * If the time went backwards, all NPCs are fired again, so they can pick the right entry.
+         * @param now Current game-time in minutes
+         * @param fn Function to call for every transition
+         * @return Number of transitions fired
+         */
+        size_t update(int64_t now, const TransitionFn& fn);
+
+        /**
+         * Removes all transitions
+         */
+        void clear();
+
+        /**
+         * @return Usage of the scheduler
+         */
+        Stats getStats() const;
+
+    private:
+
+        struct Transition
+        {
+            int64_t time;
+            Handle::EntityHandle npc;
+            uint32_t serial;
+
+            /**
+             * Inverted, so the std-heap keeps the earliest one on top
+             */
+            bool operator<(const Transition& o) const { return time > o.time; }
+        };
+
+        /**
+         * State of one NPC, by entity-index
+         */
+        struct Slot
+        {
+            Handle::EntityHandle npc;
+            uint32_t serial;
+            bool scheduled;
+        };
+
+        /**
+         * @return Whether the given heap-entry is still the live transition of its NPC
+         */
+        bool isLive(const Transition& t) const;
+
+        void push(const Transition& t);
+
+        /** Upcoming transitions, earliest first */
+        std::vector<Transition> m_Heap;
+
+        /** Entity-index -> Slot */
+        std::vector<Slot> m_Slots;
+
+        /** Time of the last update */
+        int64_t m_LastUpdate;
+
+        size_t m_NumScheduled;
+        size_t m_NumFired;
+        size_t m_NumRebuilds;
+    };
+}
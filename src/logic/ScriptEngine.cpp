@@ -1,4 +1,5 @@
 #include "ScriptEngine.h"
+#include <algorithm>
 #include "PlayerController.h"
 #include <daedalus/DaedalusVM.h>
 #include <utils/logger.h>
@@ -11,17 +12,17 @@
 #include <engine/GameEngine.h>
 #include <ui/PrintScreenMessages.h>
 #include <ZenLib/daedalus/DATFile.h>
+#include <bgfx/bgfx.h>
+#include <utils/Profiler.h>
 
 using namespace Logic;
 
-// Set to 1 to generate valid timing data for script-calls
-#define PROFILE_SCRIPT_CALLS 0
-
 ScriptEngine::ScriptEngine(World::WorldInstance& world)
     : m_World(world)
 {
     m_pVM = nullptr;
-    m_ProfilingDataFrame = 0;
+    m_LookupsThisFrame = {};
+    m_LookupsLastFrame = {};
 }
 
 ScriptEngine::~ScriptEngine()
@@ -36,6 +37,8 @@ bool ScriptEngine::loadDAT(const std::string& file)
     LogInfo() << "Loading Daedalus compiled script file: " << file;
 
     m_pVM = new Daedalus::DaedalusVM(file);
+    m_SymbolIndicesByName.clear();
+    m_Profiler.reset(m_pVM->getDATFile().getSymTable().symbols.size());
 
     // Register externals
     const bool verbose = false;
@@ -53,6 +56,14 @@ bool ScriptEngine::loadDAT(const std::string& file)
 
     m_pVM->getGameState().setGameExternals(ext);
 
+    // Resolve everything the engine needs on every AI-tick
+    m_KnownSymbols.self = getSymbol("SELF");
+    m_KnownSymbols.other = getSymbol("OTHER");
+    m_KnownSymbols.victim = getSymbol("VICTIM");
+    m_KnownSymbols.item = getSymbol("ITEM");
+    m_KnownSymbols.hero = getSymbol("HERO");
+    m_KnownSymbols.pcHero = getSymbol("PC_HERO");
+
     return true;
 }
 
@@ -68,13 +79,23 @@ void ScriptEngine::prepareRunFunction()
 
 int32_t ScriptEngine::runFunction(const std::string& fname)
 {
-    assert(m_pVM->getDATFile().hasSymbolName(fname));
+    SymbolHandle fn = getSymbol(fname);
+    assert(fn.isValid());
+
+    return runFunction(fn);
+}
+
+int32_t ScriptEngine::runFunction(SymbolHandle fn)
+{
+    ScriptProfiler::Scope profile(m_Profiler, fn.index);
 
-    return runFunction(m_pVM->getDATFile().getSymbolByName(fname).address);
+    return runFunction(m_pVM->getDATFile().getSymbolByIndex(fn.index).address);
 }
 
 int32_t ScriptEngine::runFunction(size_t addr)
 {
+    PROFILE_SCOPE("ScriptEngine::runFunction");
+
 	if(addr == 0)
 		return -1;
 
@@ -101,17 +122,9 @@ int32_t ScriptEngine::runFunction(size_t addr)
 
 int32_t ScriptEngine::runFunctionBySymIndex(size_t symIdx)
 {
-#if PROFILE_SCRIPT_CALLS
-    startProfiling(symIdx);
-#endif
-
-    int32_t r = runFunction(getVM().getDATFile().getSymbolByIndex(symIdx).address);
-
-#if PROFILE_SCRIPT_CALLS
-    stopProfiling(symIdx);
-#endif
+    ScriptProfiler::Scope profile(m_Profiler, symIdx);
 
-    return r;
+    return runFunction(getVM().getDATFile().getSymbolByIndex(symIdx).address);
 }
 
 
@@ -139,33 +152,64 @@ void ScriptEngine::pushSymbol(const std::string& sname)
 void ScriptEngine::setInstance(const std::string& target, const std::string& source)
 {
     // Target is checked later
-    assert(m_pVM->getDATFile().hasSymbolName(source));
+    assert(hasSymbol(source));
 
     setInstance(target,
-                m_pVM->getDATFile().getSymbolIndexByName(source));
+                getSymbolIndexByName(source));
 }
 
 void ScriptEngine::setInstance(const std::string& target, size_t source)
 {
-    assert(m_pVM->getDATFile().hasSymbolName(target));
+    assert(hasSymbol(target));
 
-    auto& sym = m_pVM->getDATFile().getSymbolByIndex(source);
-
-    m_pVM->setInstance(target, sym.instanceDataHandle, sym.instanceDataClass);
+    setInstance(getSymbol(target), source);
 }
 
 void ScriptEngine::setInstanceNPC(const std::string& target, Daedalus::GameState::NpcHandle npc)
 {
-    assert(m_pVM->getDATFile().hasSymbolName(target));
+    assert(hasSymbol(target));
 
-    m_pVM->setInstance(target, ZMemory::toBigHandle(npc), Daedalus::EInstanceClass::IC_Npc);
+    setInstanceNPC(getSymbol(target), npc);
 }
 
 void ScriptEngine::setInstanceItem(const std::string& target, Daedalus::GameState::ItemHandle item)
 {
-    assert(m_pVM->getDATFile().hasSymbolName(target));
+    assert(hasSymbol(target));
+
+    setInstanceItem(getSymbol(target), item);
+}
+
+// These do what DaedalusVM::setInstance does after looking up the symbol by name
+
+void ScriptEngine::setInstance(SymbolHandle target, size_t source)
+{
+    assert(target.isValid());
+
+    auto& src = m_pVM->getDATFile().getSymbolByIndex(source);
+    auto& dst = m_pVM->getDATFile().getSymbolByIndex(target.index);
+
+    dst.instanceDataHandle = src.instanceDataHandle;
+    dst.instanceDataClass = src.instanceDataClass;
+}
+
+void ScriptEngine::setInstanceNPC(SymbolHandle target, Daedalus::GameState::NpcHandle npc)
+{
+    assert(target.isValid());
+
+    auto& dst = m_pVM->getDATFile().getSymbolByIndex(target.index);
+
+    dst.instanceDataHandle = ZMemory::toBigHandle(npc);
+    dst.instanceDataClass = Daedalus::EInstanceClass::IC_Npc;
+}
+
+void ScriptEngine::setInstanceItem(SymbolHandle target, Daedalus::GameState::ItemHandle item)
+{
+    assert(target.isValid());
+
+    auto& dst = m_pVM->getDATFile().getSymbolByIndex(target.index);
 
-    m_pVM->setInstance(target, ZMemory::toBigHandle(item), Daedalus::EInstanceClass::IC_Item);
+    dst.instanceDataHandle = ZMemory::toBigHandle(item);
+    dst.instanceDataClass = Daedalus::EInstanceClass::IC_Item;
 }
 
 
@@ -173,13 +217,13 @@ void ScriptEngine::initForWorld(const std::string& world, bool firstStart)
 {
     if(!m_World.getEngine()->getEngineArgs().cmdline.hasArg('c'))
     {
-        if (firstStart && m_pVM->getDATFile().hasSymbolName("startup_" + world))
+        if (firstStart && hasSymbol("startup_" + world))
         {
             prepareRunFunction();
             runFunction("startup_" + world);
         }
 
-        if (m_pVM->getDATFile().hasSymbolName("init_" + world))
+        if (hasSymbol("init_" + world))
         {
             prepareRunFunction();
             runFunction("init_" + world);
@@ -187,14 +231,14 @@ void ScriptEngine::initForWorld(const std::string& world, bool firstStart)
     }
 
     // Create player, if not already present
-    Daedalus::GameState::NpcHandle hplayer = getNPCFromSymbol("PC_HERO");
+    Daedalus::GameState::NpcHandle hplayer = getNPCFromSymbol(m_KnownSymbols.pcHero);
     if(firstStart || !hplayer.isValid())
     {
         std::vector<size_t> startpoints = m_World.findStartPoints();
 
         if (!startpoints.empty())
         {
-            std::string startpoint = m_World.getWaynet().waypoints[startpoints[0]].name;
+            std::string startpoint = m_World.getWaynet().waypoints[startpoints[0]].name.str();
 
             LogInfo() << "Inserting player of class 'PC_HERO' at startpoint '" << startpoint << "'";
 
@@ -233,10 +277,10 @@ void ScriptEngine::onNPCInserted(Daedalus::GameState::NpcHandle npc, const std::
             pc->teleportToWaypoint(World::Waynet::getWaypointIndex(m_World.getWaynet(), spawnpoint));
 
         // If this is the hero, link it
-        if(vob.playerController->getScriptInstance().instanceSymbol == m_pVM->getDATFile().getSymbolIndexByName("PC_HERO"))
+        if(vob.playerController->getScriptInstance().instanceSymbol == m_KnownSymbols.pcHero.index)
         {
             // Player should already be in the world and script-instances should be initialized.
-            Daedalus::GameState::NpcHandle hplayer = getNPCFromSymbol("PC_HERO");
+            Daedalus::GameState::NpcHandle hplayer = getNPCFromSymbol(m_KnownSymbols.pcHero);
 
             VobTypes::NpcVobInformation player = VobTypes::getVobFromScriptHandle(m_World, hplayer);
 
@@ -247,7 +291,7 @@ void ScriptEngine::onNPCInserted(Daedalus::GameState::NpcHandle npc, const std::
 
             // TODO: Take bindings out of playercontroller
             player.playerController->setupKeyBindings();
-            setInstanceNPC("hero", VobTypes::getScriptHandle(player));
+            setInstanceNPC(m_KnownSymbols.hero, VobTypes::getScriptHandle(player));
         }
     }
 }
@@ -257,9 +301,47 @@ Daedalus::GameState::DaedalusGameState& ScriptEngine::getGameState()
     return m_pVM->getGameState();
 }
 
+size_t ScriptEngine::getSymbolIndexByName(const Utils::Name& name)
+{
+    m_LookupsThisFrame.numNameLookups++;
+
+    auto it = m_SymbolIndicesByName.find(name);
+    if(it != m_SymbolIndicesByName.end())
+        return (*it).second;
+
+    m_LookupsThisFrame.numDATLookups++;
+
+    // Symbol-names are stored uppercase inside the DAT, just like our names
+    size_t idx = static_cast<size_t>(-1);
+    if(m_pVM->getDATFile().hasSymbolName(name.str()))
+        idx = m_pVM->getDATFile().getSymbolIndexByName(name.str());
+
+    m_SymbolIndicesByName[name] = idx;
+
+    return idx;
+}
+
 size_t ScriptEngine::getSymbolIndexByName(const std::string& name)
 {
-    return m_pVM->getDATFile().getSymbolIndexByName(name);
+    // Everything cached has been interned already
+    Utils::Name n = Utils::Name::find(name);
+    if(!n.empty())
+        return getSymbolIndexByName(n);
+
+    m_LookupsThisFrame.numNameLookups++;
+    m_LookupsThisFrame.numDATLookups++;
+
+    std::string upper = name;
+    std::transform(upper.begin(), upper.end(), upper.begin(), ::toupper);
+
+    // Misses aren't remembered, there is no telling how many different ones there will be
+    if(!m_pVM->getDATFile().hasSymbolName(upper))
+        return static_cast<size_t>(-1);
+
+    size_t idx = m_pVM->getDATFile().getSymbolIndexByName(upper);
+    m_SymbolIndicesByName[Utils::Name(upper)] = idx;
+
+    return idx;
 }
 
 void ScriptEngine::onInventoryItemInserted(Daedalus::GameState::ItemHandle item, Daedalus::GameState::NpcHandle npc)
@@ -312,8 +394,8 @@ void ScriptEngine::onNPCInitialized(Daedalus::GameState::NpcHandle npc)
 	{
 		prepareRunFunction();
 
-		m_pVM->setInstance("self", ZMemory::toBigHandle(npc), Daedalus::IC_Npc);
-		m_pVM->setCurrentInstance(getSymbolIndexByName("self"));
+		setInstanceNPC(m_KnownSymbols.self, npc);
+		m_pVM->setCurrentInstance(m_KnownSymbols.self.index);
 
 		runFunctionBySymIndex(npcData.daily_routine);
 	}
@@ -341,14 +423,39 @@ void ScriptEngine::onLogEntryAdded(const std::string& topic, const std::string&
     m_World.getPrintScreenManager().printMessage(entry);
 }
 
+bool ScriptEngine::hasSymbol(const Utils::Name& name)
+{
+    return getSymbolIndexByName(name) != static_cast<size_t>(-1);
+}
+
+SymbolHandle ScriptEngine::getSymbol(const Utils::Name& name)
+{
+    return SymbolHandle(getSymbolIndexByName(name));
+}
+
 bool ScriptEngine::hasSymbol(const std::string& name)
 {
-    return m_pVM->getDATFile().hasSymbolName(name);
+    return getSymbolIndexByName(name) != static_cast<size_t>(-1);
+}
+
+SymbolHandle ScriptEngine::getSymbol(const std::string& name)
+{
+    return SymbolHandle(getSymbolIndexByName(name));
 }
 
 Daedalus::GameState::NpcHandle ScriptEngine::getNPCFromSymbol(const std::string& symName)
 {
-    Daedalus::PARSymbol& sym = m_pVM->getDATFile().getSymbolByName(symName);
+    return getNPCFromSymbol(getSymbol(symName));
+}
+
+Daedalus::GameState::ItemHandle ScriptEngine::getItemFromSymbol(const std::string& symName)
+{
+    return getItemFromSymbol(getSymbol(symName));
+}
+
+Daedalus::GameState::NpcHandle ScriptEngine::getNPCFromSymbol(SymbolHandle symbol)
+{
+    Daedalus::PARSymbol& sym = m_pVM->getDATFile().getSymbolByIndex(symbol.index);
 
     if(sym.instanceDataClass != Daedalus::IC_Npc)
         return Daedalus::GameState::NpcHandle();
@@ -356,11 +463,11 @@ Daedalus::GameState::NpcHandle ScriptEngine::getNPCFromSymbol(const std::string&
     return ZMemory::handleCast<Daedalus::GameState::NpcHandle>(sym.instanceDataHandle);
 }
 
-Daedalus::GameState::ItemHandle ScriptEngine::getItemFromSymbol(const std::string& symName)
+Daedalus::GameState::ItemHandle ScriptEngine::getItemFromSymbol(SymbolHandle symbol)
 {
-    Daedalus::PARSymbol& sym = m_pVM->getDATFile().getSymbolByName(symName);
+    Daedalus::PARSymbol& sym = m_pVM->getDATFile().getSymbolByIndex(symbol.index);
 
-    if(sym.instanceDataClass != Daedalus::IC_Npc)
+    if(sym.instanceDataClass != Daedalus::IC_Item)
         return Daedalus::GameState::ItemHandle();
 
     return ZMemory::handleCast<Daedalus::GameState::ItemHandle>(sym.instanceDataHandle);
@@ -386,6 +493,11 @@ void ScriptEngine::unregisterMob(Handle::EntityHandle e)
     m_WorldMobs.erase(e);
 }
 
+void ScriptEngine::unregisterNPC(Handle::EntityHandle e)
+{
+    m_WorldNPCs.erase(e);
+}
+
 
 bool ScriptEngine::useItemOn(Daedalus::GameState::ItemHandle hitem, Handle::EntityHandle hnpc)
 {
@@ -415,82 +527,34 @@ bool ScriptEngine::useItemOn(Daedalus::GameState::ItemHandle hitem, Handle::Enti
 	return true;
 }
 
-void ScriptEngine::startProfiling(size_t fnSym)
-{
-    const int64_t now = bx::getHPCounter();
-
-    // Store starting time
-    m_TimeStartStack.push(now);
-}
-
-void ScriptEngine::stopProfiling(size_t fnSym)
-{
-    const double freq = double(bx::getHPFrequency() );
-
-    if(m_TimeByFunctionSymbol[m_ProfilingDataFrame].find(fnSym) == m_TimeByFunctionSymbol[m_ProfilingDataFrame].end())
-        m_TimeByFunctionSymbol[m_ProfilingDataFrame][fnSym] = 0.0;
-
-    // Make delta-time
-    m_TimeByFunctionSymbol[m_ProfilingDataFrame][fnSym] += (bx::getHPCounter() - m_TimeStartStack.top()) / freq;
-
-    m_TimeStartStack.pop();
-}
-
-
-void ScriptEngine::resetProfilingData()
-{
-    while(!m_TimeStartStack.empty())
-        m_TimeStartStack.pop();
-
-    m_TimeByFunctionSymbol[m_ProfilingDataFrame].clear();
-}
-
 void ScriptEngine::onFrameStart()
 {
-#if PROFILE_SCRIPT_CALLS
-    m_ProfilingDataFrame = (m_ProfilingDataFrame + 1) % 10;
-
-    resetProfilingData();
-#endif
+    m_LookupsLastFrame = m_LookupsThisFrame;
+    m_LookupsThisFrame = {};
 }
 
 void ScriptEngine::onFrameEnd()
 {
-#if PROFILE_SCRIPT_CALLS
-    // Get the 5 most costly calls
-    std::vector<std::pair<size_t, double>> calls;
-    std::map<size_t, double> combined;
-
-    volatile double sum = 0.0;
-    for(int i=0;i<10;i++)
-    {
-        for (auto& p : m_TimeByFunctionSymbol[i])
-        {
-            if(combined.find(p.first) == combined.end())
-                combined[p.first] = 0;
+    if(!m_Profiler.isEnabled())
+        return;
 
-            combined[p.first] += p.second / 10;
-        }
-    }
+    m_Profiler.onFrameEnd();
 
-    for (auto& p : combined)
-    {
-        sum += p.second;
-        calls.push_back(p);
-    }
+    // Show the most costly symbols, averaged over all frames since the profiler was reset
+    double frames = std::max<size_t>(1, m_Profiler.getNumFrames());
 
-    // Sort descending
-    std::sort(calls.begin(), calls.end(), [](const std::pair<size_t, double>& a, const std::pair<size_t, double>& b){
-        return a.second > b.second;
-    });
+    bgfx::dbgTextPrintf(60, 0, 0x0f, "Script profiling [ms/frame] (Total: %.3f, Overhead: ~%.1f%%):",
+                        m_Profiler.getTotalTime() * 1000.0 / frames,
+                        m_Profiler.getEstimatedOverhead() * 100.0);
 
-    bgfx::dbgTextPrintf(60, 0, 0x0f, "Script profiling [ms] (Total: %.3f):", sum * 1000.0);
-    for(int i=0;i<std::min(5, (int)calls.size()); i++)
+    auto top = m_Profiler.getTopSymbols(5);
+    for(size_t i = 0; i < top.size(); i++)
     {
-        std::string name = getVM().getDATFile().getSymbolByIndex(calls[i].first).name;
-        bgfx::dbgTextPrintf(60, 1 + i, 0x0f, "  %s: %.3f", name.c_str(), calls[i].second * 1000.0);
+        std::string name = getVM().getDATFile().getSymbolByIndex(top[i].first).name;
+        bgfx::dbgTextPrintf(60, 1 + i, 0x0f, "  %s: %.3f (incl. %.3f)", name.c_str(),
+                            ScriptProfiler::ticksToSeconds(top[i].second.exclusiveTicks) * 1000.0 / frames,
+                            ScriptProfiler::ticksToSeconds(top[i].second.inclusiveTicks) * 1000.0 / frames);
     }
-#endif
 }
 
 void ScriptEngine::exportScriptEngine(json& j)
@@ -3,8 +3,11 @@
 #include <daedalus/DaedalusGameState.h>
 #include <handle/HandleDef.h>
 #include <set>
+#include <unordered_map>
 #include <daedalus/DaedalusVM.h>
 #include <math/mathlib.h>
+#include <utils/Name.h>
+#include "ScriptProfiler.h"
 #include <json.hpp>
 using json = nlohmann::json;
 
@@ -20,9 +23,45 @@ namespace World
 
 namespace Logic
 {
+    /**
+     * Index of a script-symbol, resolved once and then used instead of its name
+     */
+    struct SymbolHandle
+    {
+        SymbolHandle() : index(static_cast<size_t>(-1)) {}
+        explicit SymbolHandle(size_t index) : index(index) {}
+
+        bool isValid() const { return index != static_cast<size_t>(-1); }
+
+        size_t index;
+    };
+
     class ScriptEngine
     {
     public:
+
+        /**
+         * Symbols the engine sets or reads all the time. Resolved right after loading the DAT-file.
+         */
+        struct KnownSymbols
+        {
+            SymbolHandle self;
+            SymbolHandle other;
+            SymbolHandle victim;
+            SymbolHandle item;
+            SymbolHandle hero;
+            SymbolHandle pcHero;
+        };
+
+        /**
+         * Number of symbol-lookups done by name
+         */
+        struct SymbolLookupStats
+        {
+            size_t numNameLookups; // Through any of the name-based functions
+            size_t numDATLookups; // Of these, how many weren't cached and had to search the DAT-file
+        };
+
         ScriptEngine(World::WorldInstance& world);
         ScriptEngine(World::WorldInstance& world, ScriptEngine&& other);
         virtual ~ScriptEngine();
@@ -77,6 +116,13 @@ namespace Logic
         void setInstanceNPC(const std::string& target, Daedalus::GameState::NpcHandle npc);
         void setInstanceItem(const std::string& target, Daedalus::GameState::NpcHandle npc);
 
+        /**
+         * Same as above, without looking up the target by name
+         */
+        void setInstance(SymbolHandle target, size_t source);
+        void setInstanceNPC(SymbolHandle target, Daedalus::GameState::NpcHandle npc);
+        void setInstanceItem(SymbolHandle target, Daedalus::GameState::ItemHandle item);
+
         /**
          * Runs a complete function with the arguments given by pushing onto the stack
          * Note: Must be prepared first, using prepareRunFunction.
@@ -84,6 +130,7 @@ namespace Logic
          * @return value returned by the function
          */
         int32_t runFunction(const std::string& fname);
+        int32_t runFunction(SymbolHandle fn);
         int32_t runFunction(size_t addr);
         int32_t runFunctionBySymIndex(size_t symIdx);
 
@@ -101,6 +148,12 @@ namespace Logic
          * Returns the symbol-index of the given symbol-name
          * @return Symbol-index, -1 of not found
          */
+        size_t getSymbolIndexByName(const Utils::Name& name);
+
+        /**
+         * Same as above, for names which may not be interned. Only symbols which exist are cached and interned,
+         * so looking up whatever comes from the scripts or the console doesn't grow the cache or the name-table.
+         */
         size_t getSymbolIndexByName(const std::string& name);
 
         /**
@@ -108,8 +161,25 @@ namespace Logic
          * @param name Symbol to check
          * @return Whether a symbol with the given name exists
          */
+        bool hasSymbol(const Utils::Name& name);
         bool hasSymbol(const std::string& name);
 
+        /**
+         * @return Handle of the given symbol. Invalid, if it doesn't exist. Cached, so externals can use this freely.
+         */
+        SymbolHandle getSymbol(const Utils::Name& name);
+        SymbolHandle getSymbol(const std::string& name);
+
+        /**
+         * @return Handles of the symbols the engine uses all the time
+         */
+        const KnownSymbols& getKnownSymbols() const { return m_KnownSymbols; }
+
+        /**
+         * @return Symbol-lookups by name done in the last frame
+         */
+        const SymbolLookupStats& getLastFrameLookupStats() const { return m_LookupsLastFrame; }
+
         /**
          * @return The entity of the NPC the player is currently playing as
          */
@@ -136,6 +206,8 @@ namespace Logic
          */
         Daedalus::GameState::NpcHandle getNPCFromSymbol(const std::string& symName);
         Daedalus::GameState::ItemHandle getItemFromSymbol(const std::string& symName);
+        Daedalus::GameState::NpcHandle getNPCFromSymbol(SymbolHandle sym);
+        Daedalus::GameState::ItemHandle getItemFromSymbol(SymbolHandle sym);
 
         /**
          * (Un)Registers an item-instance currently sitting inside the world
@@ -147,6 +219,12 @@ namespace Logic
         void registerMob(Handle::EntityHandle e);
         void unregisterMob(Handle::EntityHandle e);
 
+        /**
+         * Unregisters an NPC which is about to be removed from the world. NPCs register themselves on insertion.
+         * @param e Entity of the NPC
+         */
+        void unregisterNPC(Handle::EntityHandle e);
+
         /**
          * Applies the given items effects on the given NPC or equips it. Does not delete the item or anything else.
          * @param item Item to apply the effects from
@@ -166,23 +244,12 @@ namespace Logic
         const std::set<Handle::EntityHandle>& getWorldMobs(){ return m_WorldMobs; }
 
         /**
-         * @return Profile data for this frame. (Time by function-symbol)
+         * @return Profiler for the script-calls, off by default
          */
-        const std::map<size_t, double>& getProfilingData(){ return m_TimeByFunctionSymbol[m_ProfilingDataFrame]; };
-
-        /**
-         * Resets profiling data for the current frame
-         */
-        void resetProfilingData();
+        ScriptProfiler& getProfiler(){ return m_Profiler; }
 
     protected:
 
-        /**
-         * Starts/stops profiling on the given function-symbol
-         */
-        void startProfiling(size_t fnSym);
-        void stopProfiling(size_t fnSym);
-
         /**
          * Called when an npc got inserted into the world
          */
@@ -225,11 +292,26 @@ namespace Logic
          */
         Handle::EntityHandle m_PlayerEntity;
 
+        /**
+         * Symbol-indices looked up so far. The DAT-file only knows strings, this saves hashing them on every lookup.
+         * Only valid for the currently loaded DAT-file.
+         */
+        std::unordered_map<Utils::Name, size_t> m_SymbolIndicesByName;
+
+        /**
+         * Handles of the symbols the engine uses all the time
+         */
+        KnownSymbols m_KnownSymbols;
+
+        /**
+         * Symbol-lookups by name in the current and the last frame
+         */
+        SymbolLookupStats m_LookupsThisFrame;
+        SymbolLookupStats m_LookupsLastFrame;
+
         /**
          * Profiling
          */
-        std::map<size_t, double> m_TimeByFunctionSymbol[10];
-        std::stack<int64_t> m_TimeStartStack;
-        int m_ProfilingDataFrame;
+        ScriptProfiler m_Profiler;
     };
 }
\ No newline at end of file
@@ -0,0 +1,221 @@
+#include "ScriptProfiler.h"
+#include <cassert>
+#include <algorithm>
+#include <fstream>
+#include <bx/timer.h>
+
+using namespace Logic;
+
+ScriptProfiler::ScriptProfiler() :
+        m_Enabled(false),
+        m_TicksPerCall(0.0)
+{
+    reset();
+}
+
+void ScriptProfiler::setEnabled(bool enabled)
+{
+    if(enabled && m_TicksPerCall == 0.0)
+        m_TicksPerCall = measureTicksPerCall();
+
+    m_Enabled = enabled;
+}
+
+void ScriptProfiler::reset(size_t numSymbols)
+{
+    // Calls still running would point to nodes which are gone
+    assert(m_Stack.empty());
+
+    m_Symbols.assign(std::max(numSymbols, m_Symbols.size()), {0, 0, 0, false});
+    m_ActiveDepth.assign(m_Symbols.size(), 0);
+    m_CalledSymbols.clear();
+
+    m_Nodes.clear();
+    m_Nodes.push_back({static_cast<size_t>(-1), NO_NODE, NO_NODE, NO_NODE, 0, 0});
+
+    m_NumFrames = 0;
+    m_NumCalls = 0;
+    m_TotalTicks = 0;
+}
+
+std::function<void(Daedalus::DaedalusVM&)> ScriptProfiler::wrapExternal(size_t symbol,
+                                                                        const std::function<void(Daedalus::DaedalusVM&)>& fn)
+{
+    return [this, symbol, fn](Daedalus::DaedalusVM& vm){
+        if(!m_Enabled)
+        {
+            fn(vm);
+            return;
+        }
+
+        enter(symbol, true);
+        fn(vm);
+        leave();
+    };
+}
+
+void ScriptProfiler::onFrameEnd()
+{
+    if(m_Enabled)
+        m_NumFrames++;
+}
+
+void ScriptProfiler::enter(size_t symbol, bool isExternal)
+{
+    if(symbol >= m_Symbols.size())
+    {
+        m_Symbols.resize(symbol + 1, {0, 0, 0, false});
+        m_ActiveDepth.resize(symbol + 1, 0);
+    }
+
+    uint32_t parent = m_Stack.empty() ? 0 : m_Stack.back().node;
+
+    m_Symbols[symbol].isExternal = isExternal;
+    m_ActiveDepth[symbol]++;
+
+    // Take the time last, so the bookkeeping above isn't counted
+    m_Stack.push_back({findOrAddChild(parent, symbol), 0, 0});
+    m_Stack.back().start = bx::getHPCounter();
+}
+
+void ScriptProfiler::leave()
+{
+    int64_t now = bx::getHPCounter();
+
+    // May have been reset or switched on while the call was running
+    if(m_Stack.empty())
+        return;
+
+    Frame f = m_Stack.back();
+    m_Stack.pop_back();
+
+    int64_t ticks = now - f.start;
+    int64_t exclusive = ticks - f.childTicks;
+
+    Node& n = m_Nodes[f.node];
+    n.numCalls++;
+    n.exclusiveTicks += exclusive;
+
+    SymbolStats& s = m_Symbols[n.symbol];
+    if(!s.numCalls)
+        m_CalledSymbols.push_back(n.symbol);
+
+    s.numCalls++;
+    s.exclusiveTicks += exclusive;
+
+    // Recursive calls are already covered by the outermost one
+    if(--m_ActiveDepth[n.symbol] == 0)
+        s.inclusiveTicks += ticks;
+
+    m_NumCalls++;
+
+    if(m_Stack.empty())
+        m_TotalTicks += ticks;
+    else
+        m_Stack.back().childTicks += ticks;
+}
+
+uint32_t ScriptProfiler::findOrAddChild(uint32_t parent, size_t symbol)
+{
+    for(uint32_t c = m_Nodes[parent].firstChild; c != NO_NODE; c = m_Nodes[c].nextSibling)
+    {
+        if(m_Nodes[c].symbol == symbol)
+            return c;
+    }
+
+    uint32_t c = static_cast<uint32_t>(m_Nodes.size());
+    m_Nodes.push_back({symbol, parent, NO_NODE, m_Nodes[parent].firstChild, 0, 0});
+    m_Nodes[parent].firstChild = c;
+
+    return c;
+}
+
+double ScriptProfiler::getTotalTime() const
+{
+    return ticksToSeconds(m_TotalTicks);
+}
+
+double ScriptProfiler::getEstimatedOverhead() const
+{
+    if(!m_TotalTicks)
+        return 0.0;
+
+    return std::min(1.0, m_NumCalls * m_TicksPerCall / m_TotalTicks);
+}
+
+std::vector<std::pair<size_t, ScriptProfiler::SymbolStats>> ScriptProfiler::getTopSymbols(size_t n, bool byExclusive) const
+{
+    std::vector<std::pair<size_t, SymbolStats>> r;
+    r.reserve(m_CalledSymbols.size());
+
+    for(size_t sym : m_CalledSymbols)
+        r.push_back({sym, m_Symbols[sym]});
+
+    auto time = [byExclusive](const SymbolStats& s){
+        return byExclusive ? s.exclusiveTicks : s.inclusiveTicks;
+    };
+
+    n = std::min(n, r.size());
+    std::partial_sort(r.begin(), r.begin() + n, r.end(), [&](const std::pair<size_t, SymbolStats>& a,
+                                                              const std::pair<size_t, SymbolStats>& b){
+        return time(a.second) > time(b.second);
+    });
+
+    r.resize(n);
+    return r;
+}
+
+bool ScriptProfiler::exportCollapsedStacks(const std::string& file,
+                                           const std::function<std::string(size_t)>& symbolName) const
+{
+    std::ofstream f(file);
+    if(!f.is_open())
+        return false;
+
+    std::vector<std::string> names;
+    for(size_t i = 1; i < m_Nodes.size(); i++)
+    {
+        int64_t us = static_cast<int64_t>(ticksToSeconds(m_Nodes[i].exclusiveTicks) * 1000000.0);
+        if(us <= 0)
+            continue;
+
+        // Walk up to the root, then write the path the other way around
+        names.clear();
+        for(uint32_t n = static_cast<uint32_t>(i); n != 0; n = m_Nodes[n].parent)
+            names.push_back(symbolName(m_Nodes[n].symbol));
+
+        for(size_t j = names.size(); j > 0; j--)
+            f << names[j - 1] << (j > 1 ? ";" : "");
+
+        f << " " << us << "\n";
+    }
+
+    return f.good();
+}
+
+double ScriptProfiler::ticksToSeconds(int64_t ticks)
+{
+    return double(ticks) / double(bx::getHPFrequency());
+}
+
+double ScriptProfiler::measureTicksPerCall()
+{
+    // Record some nested calls on a scratch-profiler, like a script calling externals would
+    const size_t numCalls = 30000;
+    ScriptProfiler p;
+    p.reset(16);
+    p.m_Enabled = true;
+
+    int64_t start = bx::getHPCounter();
+    for(size_t i = 0; i < numCalls / 3; i++)
+    {
+        p.enter(i % 16, false);
+        p.enter((i + 1) % 16, true);
+        p.leave();
+        p.enter((i + 2) % 16, true);
+        p.leave();
+        p.leave();
+    }
+
+    return double(bx::getHPCounter() - start) / numCalls;
+}
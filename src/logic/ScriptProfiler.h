@@ -0,0 +1,194 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <functional>
+
+namespace Daedalus
+{
+    class DaedalusVM;
+}
+
+namespace Logic
+{
+    /**
+     * Measures where the time inside the scripts goes. Can be switched on and off at runtime and costs a single
+     * branch per call while off.
+     *
+     * Calls are recorded whenever the engine enters the VM (ScriptEngine::runFunction*) and whenever the VM calls
+     * an external registered through wrapExternal(). Since externals can run scripts again (AI_StartState, ...),
+     * these nest and form a call-tree, which is kept together with the flat time per symbol.
+     * Calls from script to script happen inside the VM and count towards the script function the engine entered.
+     */
+    class ScriptProfiler
+    {
+    public:
+
+        /**
+         * Times are in ticks of bx::getHPCounter()
+         */
+        struct SymbolStats
+        {
+            uint64_t numCalls;
+            int64_t inclusiveTicks; // Counted once for recursive calls
+            int64_t exclusiveTicks; // Without the calls done from inside
+            bool isExternal;
+        };
+
+        ScriptProfiler();
+
+        /**
+         * Starts/stops recording. Calls already running when this is switched on are not recorded.
+         */
+        void setEnabled(bool enabled);
+        bool isEnabled() const { return m_Enabled; }
+
+        /**
+         * Throws away everything recorded so far
+         * @param numSymbols Number of symbols inside the DAT-file, to size the tables. Grows on demand otherwise.
+         */
+        void reset(size_t numSymbols = 0);
+
+        /**
+         * Records a call of the given symbol for as long as this object lives
+         */
+        class Scope
+        {
+        public:
+            Scope(ScriptProfiler& profiler, size_t symbol) :
+                    m_pProfiler(profiler.isEnabled() ? &profiler : nullptr)
+            {
+                if(m_pProfiler)
+                    m_pProfiler->enter(symbol, false);
+            }
+
+            ~Scope()
+            {
+                if(m_pProfiler)
+                    m_pProfiler->leave();
+            }
+
+        private:
+            ScriptProfiler* m_pProfiler;
+        };
+
+        /**
+         * @param symbol Symbol-index of the external
+         * @param fn Implementation of the external
+         * @return Function doing the same as fn, recording the call while the profiler is enabled
+         */
+        std::function<void(Daedalus::DaedalusVM&)> wrapExternal(size_t symbol,
+                                                                 const std::function<void(Daedalus::DaedalusVM&)>& fn);
+
+        /**
+         * To be called once per frame, so the times can be given per frame
+         */
+        void onFrameEnd();
+
+        /**
+         * @return Frames recorded since the last reset
+         */
+        size_t getNumFrames() const { return m_NumFrames; }
+
+        /**
+         * @return Calls recorded since the last reset
+         */
+        uint64_t getNumCalls() const { return m_NumCalls; }
+
+        /**
+         * @return Time spent inside recorded calls since the last reset, in seconds
+         */
+        double getTotalTime() const;
+
+        /**
+         * @return Estimated share of getTotalTime() caused by the profiler itself. Based on the time a call takes
+         *         to record on this machine, measured when the profiler is first enabled.
+         */
+        double getEstimatedOverhead() const;
+
+        /**
+         * @param n Maximum number of symbols to return
+         * @param byExclusive Whether to sort by exclusive or inclusive time
+         * @return The n most expensive symbols, most expensive first
+         */
+        std::vector<std::pair<size_t, SymbolStats>> getTopSymbols(size_t n, bool byExclusive = true) const;
+
+        /**
+         * Writes the call-tree in the "collapsed stacks" format, as read by flamegraph.pl and speedscope:
+         * One line per call-path, "A;B;C <exclusive microseconds>"
+         * @param file File to write
+         * @param symbolName Gives the name of a symbol
+         * @return Whether the file could be written
+         */
+        bool exportCollapsedStacks(const std::string& file, const std::function<std::string(size_t)>& symbolName) const;
+
+        /**
+         * @return Time in seconds for the given number of ticks
+         */
+        static double ticksToSeconds(int64_t ticks);
+
+    private:
+
+        /**
+         * One call-path. Children are linked as list, there are only a few per node.
+         */
+        struct Node
+        {
+            size_t symbol;
+            uint32_t parent;
+            uint32_t firstChild;
+            uint32_t nextSibling;
+            uint64_t numCalls;
+            int64_t exclusiveTicks;
+        };
+
+        /**
+         * Call currently running
+         */
+        struct Frame
+        {
+            uint32_t node;
+            int64_t start;
+            int64_t childTicks;
+        };
+
+        enum : uint32_t { NO_NODE = 0xFFFFFFFF };
+
+        void enter(size_t symbol, bool isExternal);
+        void leave();
+
+        /**
+         * @return Child of the given node for the given symbol. Created if it doesn't exist yet.
+         */
+        uint32_t findOrAddChild(uint32_t parent, size_t symbol);
+
+        /**
+         * @return Time recording a single call takes, in ticks
+         */
+        static double measureTicksPerCall();
+
+        bool m_Enabled;
+
+        /** Symbol-index -> Stats */
+        std::vector<SymbolStats> m_Symbols;
+
+        /** Symbol-index -> Number of times it is on the stack right now */
+        std::vector<uint32_t> m_ActiveDepth;
+
+        /** Symbols which were called at least once, so reporting doesn't have to look at all of them */
+        std::vector<size_t> m_CalledSymbols;
+
+        /** Call-tree, the first node is the root */
+        std::vector<Node> m_Nodes;
+
+        /** Calls currently running, innermost last */
+        std::vector<Frame> m_Stack;
+
+        size_t m_NumFrames;
+        uint64_t m_NumCalls;
+        int64_t m_TotalTicks;
+
+        /** Result of measureTicksPerCall(), 0 if not measured yet */
+        double m_TicksPerCall;
+    };
+}
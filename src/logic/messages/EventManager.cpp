@@ -7,6 +7,7 @@
 #include <ZenLib/utils/logger.h>
 #include "EventManager.h"
 #include <json.hpp>
+#include <algorithm>
 
 using json = nlohmann::json;
 using namespace Logic;
@@ -23,19 +24,19 @@ EventManager::~EventManager()
     // Remove all waiting callbacks we currently have out there
     for(EventMessages::EventMessage* ev : m_WaitingFor)
     {
-        for(auto it=ev->onMessageDone.begin(); it != ev->onMessageDone.end(); it++)
-        {
-            if((*it).first == m_HostVob)
-                it = ev->onMessageDone.erase(it);
-        }
+        auto& cbs = ev->onMessageDone;
+        cbs.erase(std::remove_if(cbs.begin(), cbs.end(), [this](const std::pair<Handle::EntityHandle, EventMessages::EventMessage::DoneCallback>& cb){
+            return cb.first == m_HostVob;
+        }), cbs.end());
     }
 
     // Free memory of all staging messages
-    for(EventMessages::EventMessage* ev : m_EventQueue)
+    while(!m_EventQueue.empty())
     {
+        EventMessages::EventMessage* ev = m_EventQueue.front();
+        m_EventQueue.remove(ev);
         delete ev;
     }
-    m_EventQueue.clear();
 }
 
 void EventManager::handleMessage(Logic::EventMessages::EventMessage* message, Handle::EntityHandle sourceVob)
@@ -61,7 +62,7 @@ void EventManager::handleMessage(Logic::EventMessages::EventMessage* message, Ha
         }*/
 
         // Queue this
-        m_EventQueue.push_back(message);
+        m_EventQueue.pushBack(message);
     }
 }
 
@@ -74,40 +75,48 @@ void EventManager::sendMessageToHost(EventMessages::EventMessage& message, Handl
 
 void EventManager::processMessageQueue()
 {
-    // Not using iterators here, because a message might get pushed inside a callback, which
-    // would make them invalid. This has to be done before deleting the message for this very reason.
-    for(size_t i=0, end=m_EventQueue.size();i<end;i++)
+    // Only go as far as the current last message. A message might get pushed inside a callback, which
+    // is handled the next time. Messages are only taken out here, so the next one stays valid.
+    EventMessages::EventMessage* last = m_EventQueue.back();
+    for(EventMessages::EventMessage* ev = m_EventQueue.front(); ev;)
     {
-        if(m_EventQueue[i]->deleted)
+        bool wasLast = ev == last;
+
+        if(ev->deleted)
         {
-            // Trigger done-callbacks
-            for(auto cb : m_EventQueue[i]->onMessageDone)
+            // Trigger done-callbacks. Copy them, in case one of them adds another callback.
+            for(size_t i=0;i<ev->onMessageDone.size();i++)
             {
-                cb.second(cb.first, m_EventQueue[i]);
+                auto cb = ev->onMessageDone[i];
+                cb.second(cb.first, ev);
             }
-        }
-    }
 
-    // Remove deleted messages from last time
-    for(auto it = m_EventQueue.begin();it != m_EventQueue.end();)
-    {
-        if((*it)->deleted)
+            // Remove the message. This doesn't touch any of the others.
+            EventMessages::EventMessage* next = EventMessages::EventMessageQueue::next(ev);
+            m_EventQueue.remove(ev);
+            delete ev;
+
+            ev = next;
+        }
+        else
         {
-            delete (*it);
-            it = m_EventQueue.erase(it);
-		}
-		else
-		{
-			it++;
-		}
+            ev = EventMessages::EventMessageQueue::next(ev);
+        }
+
+        if(wasLast)
+            break;
     }
 
     if(m_EventQueue.empty())
         return;
 
     // Process messages as far as we can
-    for(EventMessages::EventMessage* ev : m_EventQueue)
+    for(EventMessages::EventMessage* ev = m_EventQueue.front(); ev; ev = EventMessages::EventMessageQueue::next(ev))
     {
+        // Might have been flagged by a callback above
+        if(ev->deleted)
+            continue;
+
         sendMessageToHost(*ev);
 
         // FIXME: This event manager could have been deleted as a reaction to the message! Take care of that!
@@ -125,7 +134,7 @@ EventMessages::EventMessage* EventManager::getTalkingWithMessage(Handle::EntityH
 {
     EventMessages::EventMessage* lastNonOverlay = nullptr;
 
-    for(EventMessages::EventMessage* ev : m_EventQueue)
+    for(EventMessages::EventMessage* ev = m_EventQueue.front(); ev; ev = EventMessages::EventMessageQueue::next(ev))
     {
         if(!ev->isOverlay)
         {
@@ -146,7 +155,7 @@ EventMessages::EventMessage* EventManager::getTalkingWithMessage(Handle::EntityH
 void EventManager::triggerWaitEvent(EventMessages::EventMessage::MessageIdentifier identifier)
 {
     // Trigger all messages we have with that identifier
-    for(EventMessages::EventMessage* ev : m_EventQueue)
+    m_EventQueue.forEach([&](EventMessages::EventMessage* ev)
     {
         if(ev->messageType == EventMessages::EventMessageType::Conversation
                 && ev->subType == EventMessages::ConversationMessage::ST_WaitTillEnd)
@@ -159,7 +168,7 @@ void EventManager::triggerWaitEvent(EventMessages::EventMessage::MessageIdentifi
                 conv->deleted = true;
             }
         }
-    }
+    });
 
     // Remove waiting-handle
     // FIXME: This is some really ugly code, but I just want to remove the list-entry
@@ -177,25 +186,25 @@ void EventManager::waitForMessage(EventMessages::EventMessage* other)
     // Let the EM wait for this talking-action to complete
     onMessage(wait);
 
-    other->onMessageDone.push_back(std::make_pair(m_HostVob, [=](Handle::EntityHandle hostVob, EventMessages::EventMessage* inst) {
+    other->addDoneCallback(m_HostVob, [this](Handle::EntityHandle hostVob, EventMessages::EventMessage* inst) {
 
         // Let the other NPC know we are done
         triggerWaitEvent(inst);
-    }));
+    });
 
 }
 
 void EventManager::clear()
 {
-    for(EventMessages::EventMessage* ev : m_EventQueue)
+    m_EventQueue.forEach([](EventMessages::EventMessage* ev)
     {
         ev->deleted = true;
-    }
+    });
 }
 
 bool EventManager::isEmpty()
 {
-    for(EventMessages::EventMessage* ev : m_EventQueue)
+    for(EventMessages::EventMessage* ev = m_EventQueue.front(); ev; ev = EventMessages::EventMessageQueue::next(ev))
     {
         if(!ev->deleted)
             return false;
@@ -3,6 +3,7 @@
 #include <handle/HandleDef.h>
 #include <list>
 #include "EventMessage.h"
+#include "EventMessageQueue.h"
 
 namespace World
 {
@@ -20,9 +21,9 @@ namespace Logic
         template<typename T>
         void onMessage(const T& msg, Handle::EntityHandle sourceVob = Handle::EntityHandle::makeInvalidHandle())
         {
-            // Copy over the data from the given message so only we handle the memory allocations
-            T* msgcopy = new T;
-            *msgcopy = msg;
+            // Copy over the data from the given message so only we handle the memory allocations.
+            // This comes from the message-pool, see EventMessage.
+            T* msgcopy = new T(msg);
 
             // Handle the message and potentially add it to the queue
             handleMessage(msgcopy, sourceVob);
@@ -86,9 +87,9 @@ namespace Logic
         void sendMessageToHost(EventMessages::EventMessage& message, Handle::EntityHandle sourceVob = Handle::EntityHandle::makeInvalidHandle());
 
         /**
-         * Events registered and managed here.
+         * Events registered and managed here, in order of arrival
          */
-        std::vector<EventMessages::EventMessage*> m_EventQueue;
+        EventMessages::EventMessageQueue m_EventQueue;
 
         /**
          * Vob this belongs to
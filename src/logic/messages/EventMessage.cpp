@@ -4,9 +4,27 @@
 
 #include "EventMessage.h"
 #include <json.hpp>
+#include <memory/SizeClassPool.h>
 
 using json = nlohmann::json;
 
+Memory::SizeClassPool& Logic::EventMessages::getMessagePool()
+{
+    // Never destroyed, so messages outliving static destruction can still be freed
+    static Memory::SizeClassPool* s_Pool = new Memory::SizeClassPool;
+    return *s_Pool;
+}
+
+void* Logic::EventMessages::EventMessage::operator new(size_t size)
+{
+    return getMessagePool().allocate(size);
+}
+
+void Logic::EventMessages::EventMessage::operator delete(void* p, size_t size)
+{
+    getMessagePool().deallocate(p, size);
+}
+
 std::string Logic::EventMessages::MobMessage::exportPart()
 {
     return "";
@@ -2,14 +2,25 @@
 
 #include <handle/HandleDef.h>
 #include <engine/Waynet.h>
-#include <list>
+#include <vector>
+#include <utils/SmallFunction.h>
 #include <ZenLib/daedalus/DaedalusGameState.h>
 #include "../LogicDef.h"
 
+namespace Memory
+{
+    class SizeClassPool;
+}
+
 namespace Logic
 {
     namespace EventMessages
     {
+        /**
+         * @return Pool all event-messages are allocated from
+         */
+        Memory::SizeClassPool& getMessagePool();
+
         enum class EventMessageType
         {
             Event,
@@ -26,13 +37,35 @@ namespace Logic
             Mob
         };
 
+        struct EventMessage;
+
+        /**
+         * Links of a message inside an EventMessageQueue. These belong to the queue, so they are never copied
+         * along with the message.
+         */
+        struct EventMessageLink
+        {
+            EventMessageLink() : prev(nullptr), next(nullptr) {}
+            EventMessageLink(const EventMessageLink&) : prev(nullptr), next(nullptr) {}
+            EventMessageLink& operator=(const EventMessageLink&) { return *this; }
+
+            EventMessage* prev;
+            EventMessage* next;
+        };
+
         /**
          * Basic event-message. Contains type.
+         * All messages are allocated from a pool with size-classes, as every NPC goes through a couple of them each second.
          */
         struct EventMessage
         {
             typedef const void* MessageIdentifier;
 
+            /**
+             * Callback for when a message was processed. Small captures are stored without allocation.
+             */
+            typedef Utils::SmallFunction<void(Handle::EntityHandle hostVob, EventMessage*)> DoneCallback;
+
             EventMessage()
             {
                 subType = 0;
@@ -44,6 +77,15 @@ namespace Logic
                 isOverlay = false;
             }
 
+            virtual ~EventMessage(){}
+
+            /**
+             * Messages are taken from the message-pool. The size is the one of the actual message-type,
+             * thanks to the virtual destructor.
+             */
+            static void* operator new(size_t size);
+            static void operator delete(void* p, size_t size);
+
             /**
              * Export as JSON-String
              */
@@ -99,15 +141,20 @@ namespace Logic
              * @param hostVob Vob which the callback is set from
              * @param callback Callback function
              */
-            void addDoneCallback(Handle::EntityHandle hostVob, std::function<void(Handle::EntityHandle hostVob, EventMessage*)> callback)
+            void addDoneCallback(Handle::EntityHandle hostVob, DoneCallback callback)
             {
-                onMessageDone.push_back(std::make_pair(hostVob, callback));
+                onMessageDone.emplace_back(hostVob, std::move(callback));
             }
 
             /**
              * External callbacks to trigger if this message gets processed. Must also store the waiting entity.
              */
-            std::list<std::pair<Handle::EntityHandle, std::function<void(Handle::EntityHandle, EventMessage*)>>> onMessageDone;
+            std::vector<std::pair<Handle::EntityHandle, DoneCallback>> onMessageDone;
+
+            /**
+             * Position inside the queue of the EventManager
+             */
+            EventMessageLink queueLink;
         };
 
         struct NpcMessage : public EventMessage
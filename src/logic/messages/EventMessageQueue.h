@@ -0,0 +1,102 @@
+#pragma once
+
+#include <assert.h>
+#include "EventMessage.h"
+
+namespace Logic
+{
+    namespace EventMessages
+    {
+        /**
+         * Intrusive FIFO of event-messages, linked through EventMessage::queueLink.
+         * Messages can be taken out from anywhere in O(1), so completing one in the middle of the queue
+         * doesn't move the others around. The queue doesn't own the messages.
+         */
+        class EventMessageQueue
+        {
+        public:
+            EventMessageQueue() :
+                    m_pFront(nullptr),
+                    m_pBack(nullptr),
+                    m_Size(0)
+            {
+            }
+
+            EventMessageQueue(const EventMessageQueue&) = delete;
+            EventMessageQueue& operator=(const EventMessageQueue&) = delete;
+
+            /**
+             * Appends the message. It must not be inside any queue.
+             */
+            void pushBack(EventMessage* msg)
+            {
+                assert(!msg->queueLink.prev && !msg->queueLink.next && m_pFront != msg);
+
+                msg->queueLink.prev = m_pBack;
+                msg->queueLink.next = nullptr;
+
+                if(m_pBack)
+                    m_pBack->queueLink.next = msg;
+                else
+                    m_pFront = msg;
+
+                m_pBack = msg;
+                m_Size++;
+            }
+
+            /**
+             * Takes the given message out of the queue
+             */
+            void remove(EventMessage* msg)
+            {
+                EventMessageLink& l = msg->queueLink;
+
+                if(l.prev)
+                    l.prev->queueLink.next = l.next;
+                else
+                    m_pFront = l.next;
+
+                if(l.next)
+                    l.next->queueLink.prev = l.prev;
+                else
+                    m_pBack = l.prev;
+
+                l.prev = nullptr;
+                l.next = nullptr;
+                m_Size--;
+            }
+
+            /**
+             * @return First/Last message, nullptr if empty
+             */
+            EventMessage* front() { return m_pFront; }
+            EventMessage* back() { return m_pBack; }
+
+            /**
+             * @return Message after the given one, nullptr if it was the last one
+             */
+            static EventMessage* next(EventMessage* msg)
+            {
+                return msg->queueLink.next;
+            }
+
+            bool empty() const { return m_pFront == nullptr; }
+            size_t size() const { return m_Size; }
+
+            /**
+             * Calls f on every message, front to back. f must not take messages out of the queue.
+             */
+            template<typename F>
+            void forEach(F f)
+            {
+                for(EventMessage* m = m_pFront; m; m = m->queueLink.next)
+                    f(m);
+            }
+
+        private:
+            EventMessage* m_pFront;
+            EventMessage* m_pBack;
+            size_t m_Size;
+        };
+    }
+}
@@ -24,6 +24,17 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
     Engine::BaseEngine* engine = world.getEngine();
     World::WorldInstance* pWorld = &world;
 
+    // Lets the script-profiler see the time spent inside the engine
+    auto registerExternal = [&](const std::string& name, const std::function<void(Daedalus::DaedalusVM&)>& fn)
+    {
+        size_t sym = world.getScriptEngine().getSymbolIndexByName(name);
+
+        if(sym != static_cast<size_t>(-1))
+            vm->registerExternalFunction(name, world.getScriptEngine().getProfiler().wrapExternal(sym, fn));
+        else
+            vm->registerExternalFunction(name, fn);
+    };
+
     auto isSymInstanceValid = [vm](size_t instance)
     {
         return vm->getDATFile().getSymbolByIndex(instance).instanceDataHandle.isValid();
@@ -102,7 +113,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
     /**
      * Mdl_SetVisual
      */
-    vm->registerExternalFunction("Mdl_SetVisual", [=](Daedalus::DaedalusVM& vm) {
+    registerExternal("Mdl_SetVisual", [=](Daedalus::DaedalusVM& vm) {
         std::string visual = vm.popString();
 
         uint32_t arr_self;
@@ -128,7 +139,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
     /**
      * Mdl_SetVisualBody
      */
-    vm->registerExternalFunction("Mdl_SetVisualBody", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("Mdl_SetVisualBody", [=](Daedalus::DaedalusVM& vm){
 
         int32_t armorInstance = vm.popDataValue();
         size_t teethTexNr = static_cast<size_t>(vm.popDataValue());
@@ -181,7 +192,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
     /**
      * ta_min
      */
-    vm->registerExternalFunction("ta_min", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("ta_min", [=](Daedalus::DaedalusVM& vm){
         std::string waypoint = vm.popString(); if(verbose) LogInfo() << "waypoint: " << waypoint;
 
         uint32_t action = vm.popDataValue();
@@ -203,7 +214,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
     /**
      * EquipItem
      */
-    vm->registerExternalFunction("equipitem", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("equipitem", [=](Daedalus::DaedalusVM& vm){
         uint32_t instance = static_cast<uint32_t>(vm.popDataValue());
         uint32_t self = vm.popVar();
 
@@ -223,7 +234,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
     /**
      * GetDistTo...
      */
-    vm->registerExternalFunction("npc_getdisttonpc", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_getdisttonpc", [=](Daedalus::DaedalusVM& vm){
         uint32_t arr_npc2;
         uint32_t npc2 = vm.popVar(arr_npc2); if(verbose) LogInfo() << "npc2: " << npc2;
         uint32_t arr_npc1;
@@ -252,7 +263,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
 	
 	});
 
-    vm->registerExternalFunction("npc_getdisttowp", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_getdisttowp", [=](Daedalus::DaedalusVM& vm){
         std::string wpname = vm.popString(); if(verbose) LogInfo() << "wpname: " << wpname;
         uint32_t arr_self;
         uint32_t self = vm.popVar(arr_self); if(verbose) LogInfo() << "self: " << self;
@@ -279,7 +290,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         
     });
 
-    vm->registerExternalFunction("npc_getdisttoitem", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_getdisttoitem", [=](Daedalus::DaedalusVM& vm){
 
         uint32_t item = static_cast<uint32_t>(vm.popDataValue());
         uint32_t arr_npc;
@@ -296,13 +307,13 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         vm.setReturn(static_cast<int32_t>(dist));
     });
 
-    vm->registerExternalFunction("npc_getdisttoplayer", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_getdisttoplayer", [=](Daedalus::DaedalusVM& vm){
         uint32_t arr_npc1;
         uint32_t npc1 = vm.popVar(arr_npc1); if(verbose) LogInfo() << "npc1: " << npc1;
 
 
         VobTypes::NpcVobInformation vob1 = getNPCByInstance(npc1);
-        VobTypes::NpcVobInformation vob2 = getNPCByInstance(vm.getDATFile().getSymbolIndexByName("hero"));
+        VobTypes::NpcVobInformation vob2 = getNPCByInstance(pWorld->getScriptEngine().getKnownSymbols().hero.index);
 
         // Calculate distance
         float dist = (Vob::getTransform(vob1).Translation() - Vob::getTransform(vob2).Translation()).length();
@@ -313,7 +324,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         vm.setReturn(static_cast<int32_t>(dist));
     });
 
-    vm->registerExternalFunction("printdebuginstch", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("printdebuginstch", [=](Daedalus::DaedalusVM& vm){
 
         uint32_t arr_npc;
         std::string s = vm.popString();
@@ -328,7 +339,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         LogInfo() << "DEBUG: " << s;
     });
 
-    vm->registerExternalFunction("ai_turntonpc", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("ai_turntonpc", [=](Daedalus::DaedalusVM& vm){
         uint32_t arr_n1;
         int32_t target = vm.popVar(arr_n1); if(verbose) LogInfo() << "target: " << target;
         uint32_t arr_n0;
@@ -357,7 +368,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         vm.setReturn(0);
     });*/
 
-    vm->registerExternalFunction("printscreen", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("printscreen", [=](Daedalus::DaedalusVM& vm){
         int32_t timesec = vm.popDataValue(); if(verbose) LogInfo() << "timesec: " << timesec;
         std::string font = vm.popString(); if(verbose) LogInfo() << "font: " << font;
         int32_t posy = vm.popDataValue(); if(verbose) LogInfo() << "posy: " << posy;
@@ -371,7 +382,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
                                                         static_cast<double>(timesec));
     });
 
-    vm->registerExternalFunction("hlp_getinstanceid", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("hlp_getinstanceid", [=](Daedalus::DaedalusVM& vm){
         int32_t sym = vm.popVar();
 
         // Lookup what's behind this symbol. Could be a reference!
@@ -386,7 +397,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         }
     });
 
-    vm->registerExternalFunction("npc_isplayer", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_isplayer", [=](Daedalus::DaedalusVM& vm){
         uint32_t player = vm.popVar(); if(verbose) LogInfo() << "player: " << player;
 
         VobTypes::NpcVobInformation npc = getNPCByInstance(player);
@@ -401,7 +412,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         }
     });
 
-    vm->registerExternalFunction("npc_canseenpc", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_canseenpc", [=](Daedalus::DaedalusVM& vm){
         uint32_t other = vm.popVar();
         uint32_t self = vm.popVar();
 
@@ -421,7 +432,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
 
     });
 
-    vm->registerExternalFunction("npc_canseenpcfreelos", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_canseenpcfreelos", [=](Daedalus::DaedalusVM& vm){
         uint32_t other = vm.popVar();
         uint32_t self = vm.popVar();
 
@@ -434,7 +445,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
             vm.setReturn(0);
     });
 
-    vm->registerExternalFunction("npc_canseeitem", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_canseeitem", [=](Daedalus::DaedalusVM& vm){
 
         uint32_t other = vm.popVar();
         uint32_t self = vm.popVar();
@@ -448,7 +459,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
             vm.setReturn(0);
     });
 
-    vm->registerExternalFunction("npc_clearaiqueue", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_clearaiqueue", [=](Daedalus::DaedalusVM& vm){
         uint32_t self = vm.popVar();
 
         VobTypes::NpcVobInformation npc = getNPCByInstance(self);
@@ -457,7 +468,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
             npc.playerController->getEM().clear();
     });
 
-    vm->registerExternalFunction("ai_standup", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("ai_standup", [=](Daedalus::DaedalusVM& vm){
         uint32_t self = vm.popVar();
 
         VobTypes::NpcVobInformation npc = getNPCByInstance(self);
@@ -474,7 +485,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         }
     });
 
-    vm->registerExternalFunction("ai_standupquick", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("ai_standupquick", [=](Daedalus::DaedalusVM& vm){
         uint32_t self = vm.popVar();
 
         VobTypes::NpcVobInformation npc = getNPCByInstance(self);
@@ -491,7 +502,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         }
     });
 
-    vm->registerExternalFunction("npc_exchangeroutine", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_exchangeroutine", [=](Daedalus::DaedalusVM& vm){
         std::string routinename = vm.popString(); if(verbose) LogInfo() << "routinename: " << routinename;
         uint32_t arr_self;
         uint32_t self = vm.popVar(arr_self); if(verbose) LogInfo() << "self: " << self;
@@ -504,7 +515,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         }
     });
 
-    vm->registerExternalFunction("ai_gotowp", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("ai_gotowp", [=](Daedalus::DaedalusVM& vm){
         std::string wp = vm.popString();
         int32_t self = vm.popVar();
 
@@ -524,7 +535,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         }
     });
 
-    vm->registerExternalFunction("ai_gotonextfp", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("ai_gotonextfp", [=](Daedalus::DaedalusVM& vm){
         std::string fp = vm.popString(true);
         int32_t self = vm.popVar();
 
@@ -540,7 +551,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         }
     });
 
-    vm->registerExternalFunction("ai_gotonpc", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("ai_gotonpc", [=](Daedalus::DaedalusVM& vm){
         uint32_t other = vm.popVar();
         uint32_t self = vm.popVar();
 
@@ -558,11 +569,11 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         }
     });
 
-    vm->registerExternalFunction("infomanager_hasfinished", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("infomanager_hasfinished", [=](Daedalus::DaedalusVM& vm){
        vm.setReturn(pWorld->getDialogManager().isDialogActive() ? 0 : 1);
     });
 
-    vm->registerExternalFunction("npc_getnearestwp", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_getnearestwp", [=](Daedalus::DaedalusVM& vm){
         uint32_t arr_self;
         int32_t self = vm.popVar(arr_self); if(verbose) LogInfo() << "self: " << self;
 
@@ -574,7 +585,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
 
             if(wp != World::Waynet::INVALID_WAYPOINT)
             {
-                vm.setReturn(pWorld->getWaynet().waypoints[wp].name);
+                vm.setReturn(pWorld->getWaynet().waypoints[wp].name.str());
                 return;
             }
         }
@@ -582,7 +593,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         vm.setReturn("");
     });
 
-    vm->registerExternalFunction("npc_getnextwp", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_getnextwp", [=](Daedalus::DaedalusVM& vm){
         uint32_t arr_self;
         int32_t self = vm.popVar(arr_self); if(verbose) LogInfo() << "self: " << self;
 
@@ -594,7 +605,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
 
             if(wp != World::Waynet::INVALID_WAYPOINT)
             {
-                vm.setReturn(pWorld->getWaynet().waypoints[wp].name);
+                vm.setReturn(pWorld->getWaynet().waypoints[wp].name.str());
                 return;
             }
         }
@@ -602,7 +613,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         vm.setReturn("");
     });
 
-	vm->registerExternalFunction("npc_hasitems", [=](Daedalus::DaedalusVM& vm){
+	registerExternal("npc_hasitems", [=](Daedalus::DaedalusVM& vm){
 		uint32_t iteminstance = vm.popDataValue();
 		int32_t owner = vm.popVar();
 
@@ -619,7 +630,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
 		}
 	});
 
-	vm->registerExternalFunction("npc_removeinvitem", [=](Daedalus::DaedalusVM& vm){
+	registerExternal("npc_removeinvitem", [=](Daedalus::DaedalusVM& vm){
 		uint32_t iteminstance = vm.popDataValue(); 
 		uint32_t owner = vm.popVar(); 
 
@@ -633,7 +644,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
 		vm.setReturn(0);
 	});
 
-	vm->registerExternalFunction("npc_removeinvitems", [=](Daedalus::DaedalusVM& vm){
+	registerExternal("npc_removeinvitems", [=](Daedalus::DaedalusVM& vm){
 		uint32_t amount = vm.popDataValue();
 		uint32_t iteminstance = vm.popDataValue();
 		uint32_t owner = vm.popVar();
@@ -648,7 +659,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
 		vm.setReturn(0);
 	});
 
-    vm->registerExternalFunction("ai_startstate", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("ai_startstate", [=](Daedalus::DaedalusVM& vm){
         std::string wpname = vm.popString();
         int32_t statebehaviour = vm.popDataValue();
         uint32_t fnSym = vm.popVar();
@@ -667,7 +678,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         }
     });
 
-    vm->registerExternalFunction("npc_getstatetime", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_getstatetime", [=](Daedalus::DaedalusVM& vm){
         uint32_t self = vm.popVar();
 
         VobTypes::NpcVobInformation npc = getNPCByInstance(self);
@@ -681,7 +692,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         }
     });
 
-    vm->registerExternalFunction("wld_detectnpc", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("wld_detectnpc", [=](Daedalus::DaedalusVM& vm){
         int32_t guild = vm.popDataValue();
         int32_t aiState = vm.popDataValue();
         int32_t instance = vm.popDataValue();
@@ -730,7 +741,8 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
             {
                 VobTypes::NpcVobInformation vob = VobTypes::asNpcVob(*pWorld, nearestEnt);
 
-                pWorld->getScriptEngine().setInstanceNPC("other", VobTypes::getScriptHandle(vob));
+                pWorld->getScriptEngine().setInstanceNPC(pWorld->getScriptEngine().getKnownSymbols().other,
+                                                         VobTypes::getScriptHandle(vob));
             }
 
             vm.setReturn(nearestEnt.isValid() ? 1 : 0);
@@ -740,7 +752,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         }
     });
 
-    vm->registerExternalFunction("ai_wait", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("ai_wait", [=](Daedalus::DaedalusVM& vm){
         float duration = vm.popFloatValue();
         int32_t self = vm.popVar();
 
@@ -758,7 +770,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         vm.setReturn(0);
     });
 
-    vm->registerExternalFunction("ai_playani", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("ai_playani", [=](Daedalus::DaedalusVM& vm){
         std::string ani = vm.popString();
         uint32_t self = vm.popVar();
 
@@ -776,7 +788,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         vm.setReturn(0);
     });
 
-    vm->registerExternalFunction("mdl_applyoverlaymds", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("mdl_applyoverlaymds", [=](Daedalus::DaedalusVM& vm){
         std::string overlayname = vm.popString();
         uint32_t self = vm.popVar();
 
@@ -790,7 +802,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         vm.setReturn(0);
     });
 
-    vm->registerExternalFunction("mdl_removeoverlaymds", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("mdl_removeoverlaymds", [=](Daedalus::DaedalusVM& vm){
         std::string overlayname = vm.popString();
         uint32_t self = vm.popVar();
 
@@ -805,7 +817,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         vm.setReturn(0);
     });
 
-    vm->registerExternalFunction("wld_isfpavailable", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("wld_isfpavailable", [=](Daedalus::DaedalusVM& vm){
         std::string fpname = vm.popString(true);
         int32_t self = vm.popVar();
 
@@ -823,7 +835,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         }
     });
 
-    vm->registerExternalFunction("wld_isnextfpavailable", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("wld_isnextfpavailable", [=](Daedalus::DaedalusVM& vm){
         std::string fpname = vm.popString(true);
         int32_t self = vm.popVar();
 
@@ -841,7 +853,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         }
     });
 
-    vm->registerExternalFunction("npc_isonfp", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_isonfp", [=](Daedalus::DaedalusVM& vm){
         std::string fpname = vm.popString(true);
         int32_t self = vm.popVar();
 
@@ -861,7 +873,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         }
     });
 
-    vm->registerExternalFunction("info_addchoice", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("info_addchoice", [=](Daedalus::DaedalusVM& vm){
         uint32_t func = vm.popVar();
         std::string text = vm.popString();
         uint32_t info = vm.popVar();
@@ -878,13 +890,21 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         pWorld->getDialogManager().addChoice(choice);
     });
 
-    vm->registerExternalFunction("info_clearchoices", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("info_clearchoices", [=](Daedalus::DaedalusVM& vm){
         uint32_t info = vm.popVar();
 
         pWorld->getDialogManager().clearChoices();
     });
 
-	vm->registerExternalFunction("wld_insertnpc", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("wld_settime", [=](Daedalus::DaedalusVM& vm){
+        int32_t minute = vm.popDataValue();
+        int32_t hour = vm.popDataValue();
+
+        // Routines catch up on the next frame, see RoutineScheduler
+        pWorld->getSky().setTimeOfDay(hour, minute);
+    });
+
+	registerExternal("wld_insertnpc", [=](Daedalus::DaedalusVM& vm){
 		std::string spawnpoint = vm.popString(); 
 		uint32_t npcinstance = vm.popDataValue();
 
@@ -897,7 +917,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
 		vm.getGameState().insertNPC(npcinstance, spawnpoint);
 	});
 
-    vm->registerExternalFunction("wld_insertitem", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("wld_insertitem", [=](Daedalus::DaedalusVM& vm){
         std::string spawnpoint = vm.popString(true);
         uint32_t iteminstance = vm.popDataValue();
 
@@ -934,7 +954,7 @@ void ::Logic::ScriptExternals::registerEngineExternals(World::WorldInstance& wor
         Vob::setPosition(vob, position);
     });
 
-    vm->registerExternalFunction("npc_changeattribute", [=](Daedalus::DaedalusVM& vm){
+    registerExternal("npc_changeattribute", [=](Daedalus::DaedalusVM& vm){
         int32_t value = vm.popDataValue();
         int32_t atr = vm.popDataValue();
         uint32_t self = vm.popVar();
@@ -153,15 +153,14 @@ bool ModelVisual::load(const std::string& visual)
     for(Handle::EntityHandle e : m_PartEntities.mainSkelMeshEntities)
     {
         // Init positions
-        Components::EntityComponent& entity = m_World.getEntity<Components::EntityComponent>(e);
-        Components::addComponent<Components::PositionComponent>(entity);
+        Components::addComponent<Components::PositionComponent>(m_World.getComponentAllocator(), e);
 
         // Copy world-matrix
         Components::PositionComponent& pos = m_World.getEntity<Components::PositionComponent>(e);
         pos = hostPos;
 
         // Init animation components
-        Components::addComponent<Components::AnimationComponent>(entity);
+        Components::addComponent<Components::AnimationComponent>(m_World.getComponentAllocator(), e);
         Components::AnimationComponent& anim = m_World.getEntity<Components::AnimationComponent>(e);
 
         // Assign the main-vob as animation controller
@@ -224,8 +223,7 @@ bool ModelVisual::load(const std::string& visual)
             for (Handle::EntityHandle e : tmp)
             {
                 // Init positions
-                Components::EntityComponent &entity = m_World.getEntity<Components::EntityComponent>(e);
-                Components::addComponent<Components::PositionComponent>(entity);
+                Components::addComponent<Components::PositionComponent>(m_World.getComponentAllocator(), e);
 
                 // Important: Apply draw distance, and every other setting from the host
                 Components::PositionComponent& pos = m_World.getEntity<Components::PositionComponent>(e);
@@ -309,13 +307,13 @@ void ModelVisual::rebuildMainEntityList()
 
 void ModelVisual::setAnimation(const std::string& anim, bool loop)
 {
-    Components::AnimHandler& animHandler = m_World.getEntity<Components::AnimationComponent>(m_Entity).getAnimHandler();
+    Components::AnimHandler& animHandler = m_World.getAnimHandler(m_Entity);
 
     if(!anim.empty())
         if(loop)
-            animHandler.setAnimation(anim);
+            animHandler.setAnimation(Utils::Name(anim));
         else
-            animHandler.playAnimation(anim);
+            animHandler.playAnimation(Utils::Name(anim));
     else
         animHandler.stopAnimation();
 }
@@ -393,8 +391,7 @@ void ModelVisual::updateAttachmentTransforms()
 
 Components::AnimHandler &ModelVisual::getAnimationHandler()
 {
-    Components::AnimationComponent &anim = m_World.getEntity<Components::AnimationComponent>(m_Entity);
-    return anim.getAnimHandler();
+    return m_World.getAnimHandler(m_Entity);
 }
 
 void ModelVisual::onTransformChanged()
@@ -44,8 +44,7 @@ bool StaticMeshVisual::load(const std::string& visual)
     for(Handle::EntityHandle e : m_VisualEntities)
     {
         // Init positions
-        Components::EntityComponent& entity = m_World.getEntity<Components::EntityComponent>(e);
-        Components::addComponent<Components::PositionComponent>(entity);
+        Components::addComponent<Components::PositionComponent>(m_World.getComponentAllocator(), e);
 
         // Copy world-matrix
         Components::PositionComponent& pos = m_World.getEntity<Components::PositionComponent>(e);
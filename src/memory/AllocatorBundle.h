@@ -1,6 +1,6 @@
 #pragma once
 #include <tuple>
-#include "StaticReferencedAllocator.h"
+#include "ChunkedReferencedAllocator.h"
 #include <algorithm>
 #include "utils/tuple.h"
 
@@ -9,6 +9,7 @@ namespace Memory
     /**
      * Class wrapping different allocators into one. If an object is requested, all allocators
      * will create one. That means, that the handle given is valid on all of them.
+     * Storage is only committed as far as elements are actually used, see ChunkedReferencedAllocator.
      */
     template<int NUM_ALLOC, typename HT, typename... S>
     class AllocatorBundle
@@ -59,7 +60,7 @@ namespace Memory
         template<typename T>
         T& getElement(const Handle& h)
         {
-            return std::get<StaticReferencedAllocator<T, NUM_ALLOC>>(m_Allocators).getElement(h);
+            return std::get<ChunkedReferencedAllocator<T, NUM_ALLOC>>(m_Allocators).getElement(h);
         }
 
         /**
@@ -100,6 +101,19 @@ namespace Memory
             return m_NumObtainedObjects;
         }
 
+        /**
+         * @return Memory currently committed by all allocators together
+         */
+        size_t getNumCommittedBytes()
+        {
+            size_t num = 0;
+            Utils::for_each_in_tuple(m_Allocators, [&](auto& alloc){
+                num += alloc.getNumCommittedBytes();
+            });
+
+            return num;
+        }
+
         /**
          * Returns all datasets inside a single structure
          */
@@ -118,10 +132,10 @@ namespace Memory
         template<typename T>
         auto& getAllocator()
         {
-            return std::get<StaticReferencedAllocator<T, NUM_ALLOC>>(m_Allocators);
+            return std::get<ChunkedReferencedAllocator<T, NUM_ALLOC>>(m_Allocators);
         }
 
-        std::tuple<StaticReferencedAllocator<S, NUM_ALLOC>...> m_Allocators;
+        std::tuple<ChunkedReferencedAllocator<S, NUM_ALLOC>...> m_Allocators;
 
         /**
          * Duplicated count here for easier access. Would have to take one of the allocators value
@@ -0,0 +1,28 @@
+#pragma once
+#include <cstddef>
+
+namespace Memory
+{
+    /**
+     * Memory-usage of a single allocator. Cheap to get, so it can be queried at any time, even in release-builds.
+     */
+    struct AllocatorStats
+    {
+        AllocatorStats() :
+                numLive(0),
+                capacity(0),
+                highWater(0),
+                elementSize(0),
+                numBytesAllocated(0),
+                numBytesPayload(0)
+        {
+        }
+
+        size_t numLive; // Elements currently in use
+        size_t capacity; // Maximum number of elements
+        size_t highWater; // Most elements ever in use at once
+        size_t elementSize; // sizeof() of a single element
+        size_t numBytesAllocated; // Memory held by the allocator itself
+        size_t numBytesPayload; // Estimate of what the live elements own on top (vertices, samples, ...). Filled in by the owner.
+    };
+}
@@ -0,0 +1,399 @@
+#pragma once
+#include <cstdint>
+#include <new>
+#include <assert.h>
+#include <functional>
+#include <algorithm>
+#include <utility>
+#include "StaticReferencedAllocator.h"
+#include "VirtualMemory.h"
+
+namespace Memory
+{
+    /**
+     * Array of a fixed maximum size, which is only backed by memory as far as it is actually used.
+     * The address-space for all NUM elements is reserved up front, so elements never move and the
+     * array stays continuous. Memory is committed in chunks while growing.
+     * This only manages memory, constructing and destroying elements is up to the user.
+     * @param T Type of data stored
+     * @param NUM Maximum number of elements
+     */
+    template<typename T, unsigned int NUM>
+    class LazyCommittedArray
+    {
+    public:
+        LazyCommittedArray() :
+                m_NumAvailable(0),
+                m_CommittedBytes(0)
+        {
+            m_ReservedBytes = roundToChunk(sizeof(T) * NUM);
+            m_Data = reinterpret_cast<T*>(VirtualMemory::reserve(m_ReservedBytes));
+
+            if(!m_Data)
+                throw std::bad_alloc();
+        }
+
+        ~LazyCommittedArray()
+        {
+            release();
+        }
+
+        LazyCommittedArray(const LazyCommittedArray&) = delete;
+        LazyCommittedArray& operator=(const LazyCommittedArray&) = delete;
+
+        /**
+         * @return Start of the array
+         */
+        T* data()
+        {
+            return m_Data;
+        }
+
+        /**
+         * @return Number of elements currently backed by memory
+         */
+        size_t getNumAvailable()
+        {
+            return m_NumAvailable;
+        }
+
+        /**
+         * @return Memory currently backing this array
+         */
+        size_t getNumCommittedBytes()
+        {
+            return m_CommittedBytes;
+        }
+
+        /**
+         * Makes sure at least the given number of elements is backed by memory
+         */
+        inline void growTo(size_t num)
+        {
+            if(num > m_NumAvailable)
+                grow(num);
+        }
+
+        /**
+         * Frees the memory not needed to hold the given number of elements. Elements past that must
+         * already be destroyed. One chunk is kept as slack, so adding and removing around a chunk-border
+         * won't commit and decommit all the time.
+         */
+        void shrinkTo(size_t num)
+        {
+            size_t keepBytes = roundToChunk(num * sizeof(T)) + getChunkSize();
+
+            if(keepBytes >= m_CommittedBytes)
+                return;
+
+            VirtualMemory::decommit(reinterpret_cast<uint8_t*>(m_Data) + keepBytes, m_CommittedBytes - keepBytes);
+
+            m_NumAvailable = keepBytes / sizeof(T);
+            m_CommittedBytes = keepBytes;
+        }
+
+        /**
+         * Gives back the address-space. Elements must already be destroyed. The array is unusable afterwards.
+         */
+        void release()
+        {
+            if(!m_Data)
+                return;
+
+            VirtualMemory::decommit(m_Data, m_CommittedBytes);
+            VirtualMemory::release(m_Data, m_ReservedBytes);
+
+            m_Data = nullptr;
+            m_NumAvailable = 0;
+            m_CommittedBytes = 0;
+        }
+
+        /**
+         * @return Granularity memory is committed in
+         */
+        static size_t getChunkSize()
+        {
+            // Windows reserves in steps of 64k anyways
+            return std::max<size_t>(64 * 1024, VirtualMemory::getPageSize());
+        }
+
+    private:
+
+        static size_t roundToChunk(size_t numBytes)
+        {
+            size_t c = getChunkSize();
+            return ((numBytes + c - 1) / c) * c;
+        }
+
+        void grow(size_t num)
+        {
+            assert(num <= NUM);
+
+            size_t targetBytes = std::min(roundToChunk(num * sizeof(T)), m_ReservedBytes);
+
+            if(!VirtualMemory::commit(reinterpret_cast<uint8_t*>(m_Data) + m_CommittedBytes, targetBytes - m_CommittedBytes))
+                throw std::bad_alloc();
+
+            m_CommittedBytes = targetBytes;
+            m_NumAvailable = std::min<size_t>(m_CommittedBytes / sizeof(T), NUM);
+        }
+
+        T* m_Data;
+        size_t m_NumAvailable;
+        size_t m_CommittedBytes;
+        size_t m_ReservedBytes;
+    };
+
+    /**
+     * Drop-in replacement for the StaticReferencedAllocator, with the same handle semantics:
+     * Handles are handed out in the same order and elements are kept continuous in memory.
+     * Instead of allocating all NUM elements at once, storage is committed in chunks as the number
+     * of live elements grows, and trailing chunks are freed again when it shrinks.
+     * Like in the static allocator, only live elements are constructed.
+     * @param T Type of data stored in the allocator
+     * @param NUM Maximum number of elements
+     */
+    template<typename T, unsigned int NUM>
+    class ChunkedReferencedAllocator
+    {
+    public:
+
+        /**
+         * Outside-Mirror for the type this can create
+         */
+        typedef T Type;
+
+        ChunkedReferencedAllocator() :
+                m_NumObtainedElements(0),
+                m_NumHandlesUsed(0),
+                m_HighWater(0),
+                m_FreeHandles(nullptr),
+                m_LastInternalHandle(nullptr)
+        {
+        }
+
+        ~ChunkedReferencedAllocator()
+        {
+            kill();
+        }
+
+        /**
+         * Returns a handle to a free chunk of memory and marks it as used
+         */
+        typename T::HandleType createObject()
+        {
+            assert(m_NumObtainedElements != NUM);
+
+            // Use the element at the end of the array as target
+            size_t idx = m_NumObtainedElements;
+
+            m_Elements.growTo(idx + 1);
+            m_ElementsToInternalHandles.growTo(idx + 1);
+
+            // Reuse the last freed handle first, like the free-list of the static allocator does
+            FLHandle* handle;
+            if(m_FreeHandles)
+            {
+                handle = m_FreeHandles;
+                m_FreeHandles = handle->m_Next;
+            }else
+            {
+                m_InternalHandles.growTo(m_NumHandlesUsed + 1);
+                handle = new (&m_InternalHandles.data()[m_NumHandlesUsed++]) FLHandle;
+            }
+
+            m_NumObtainedElements++;
+            m_HighWater = std::max(m_HighWater, m_NumObtainedElements);
+
+            handle->m_Handle.index = static_cast<uint32_t>(idx);
+
+            // We're modifying this... Bump the generation;
+            handle->m_Handle.generation++;
+
+            // Store this as the new handle to the end of the list
+            m_LastInternalHandle = handle;
+
+            // Create output handle
+            typename T::HandleType hOut;
+            hOut.index = static_cast<uint32_t>(handle - m_InternalHandles.data());
+            hOut.generation = handle->m_Handle.generation;
+
+            // Connect element and internal handle
+            m_ElementsToInternalHandles.data()[idx] = hOut.index;
+
+            new (&m_Elements.data()[idx]) T();
+
+            return hOut;
+        }
+
+        /**
+         * @return the actual element to the handle h (Checks generation)
+         */
+        T& getElement(const typename T::HandleType& h)
+        {
+            assert(m_InternalHandles.data()[h.index].m_Handle.generation == h.generation);
+
+            return m_Elements.data()[m_InternalHandles.data()[h.index].m_Handle.index];
+        }
+
+        /**
+         * @return the actual element to the handle h (Does not check generation)
+         */
+        T& getElementForce(const typename T::HandleType& h)
+        {
+            return m_Elements.data()[m_InternalHandles.data()[h.index].m_Handle.index];
+        }
+
+        /**
+         * Marks the element with the given handle as free and calls the "OnRemoved"-Callback before doing so
+         */
+        void removeObject(const typename T::HandleType& h)
+        {
+            FLHandle* handles = m_InternalHandles.data();
+            T* elements = m_Elements.data();
+
+            // Check if the handle is still valid. If not, we are accessing a different object!
+            assert(handles[h.index].m_Handle.generation == h.generation);
+            assert(m_LastInternalHandle != nullptr); // Must have at least one handle in there
+
+            // We're modifying this... Bump the generation;
+            handles[h.index].m_Handle.generation++;
+
+            // Get actual index of handle-target
+            uint32_t actIdx = handles[h.index].m_Handle.index;
+
+            if(m_OnRemoved)
+                m_OnRemoved(elements[actIdx]);
+
+            // Move the last element into the hole and destroy what's left of it
+            uint32_t lastIdx = m_LastInternalHandle->m_Handle.index;
+
+            if(actIdx != lastIdx)
+                elements[actIdx] = std::move(elements[lastIdx]);
+
+            elements[lastIdx].~T();
+
+            // Fix the handle of the last element
+            m_LastInternalHandle->m_Handle.index = actIdx;
+            m_ElementsToInternalHandles.data()[actIdx] = m_LastInternalHandle - handles;
+
+            // Return the handle to the free-list
+            handles[h.index].m_Next = m_FreeHandles;
+            m_FreeHandles = &handles[h.index];
+            m_NumObtainedElements--;
+
+            // Get new back-object
+            if(m_NumObtainedElements > 0)
+                m_LastInternalHandle = &handles[m_ElementsToInternalHandles.data()[m_NumObtainedElements - 1]];
+            else
+                m_LastInternalHandle = nullptr;
+
+            // Give back what's not needed anymore. Handles have to stay for their generations.
+            m_Elements.shrinkTo(m_NumObtainedElements);
+            m_ElementsToInternalHandles.shrinkTo(m_NumObtainedElements);
+        }
+
+        /**
+         * Sets a callback to what should happen when an object got deleted
+         */
+        void setOnRemoveCallback(const std::function<void(T&)> onRemoved)
+        {
+            m_OnRemoved = onRemoved;
+        }
+
+        /**
+         * Returns all elements as continuous chunk of memory
+         */
+        T* getElements()
+        {
+            return m_Elements.data();
+        }
+
+        /**
+         * Returns the number of allocated elements, aka. how far to go using getElements()
+         */
+        size_t getNumObtainedElements()
+        {
+            return m_NumObtainedElements;
+        }
+
+        /**
+         * @return Memory currently committed by this allocator
+         */
+        size_t getNumCommittedBytes()
+        {
+            return m_Elements.getNumCommittedBytes()
+                   + m_ElementsToInternalHandles.getNumCommittedBytes()
+                   + m_InternalHandles.getNumCommittedBytes();
+        }
+
+        /**
+         * @return Usage of this allocator. The payload is left for the owner to fill in.
+         */
+        AllocatorStats getStats()
+        {
+            AllocatorStats s;
+            s.numLive = m_NumObtainedElements;
+            s.capacity = NUM;
+            s.highWater = m_HighWater;
+            s.elementSize = sizeof(T);
+            s.numBytesAllocated = getNumCommittedBytes();
+
+            return s;
+        }
+
+        /**
+         * Basically destructs the allocator and makes it unusable (frees memory)
+         */
+        void kill()
+        {
+            if(m_Elements.data())
+            {
+                for(size_t i = 0; i < m_NumObtainedElements; i++)
+                    m_Elements.data()[i].~T();
+            }
+
+            m_NumObtainedElements = 0;
+
+            m_Elements.release();
+            m_ElementsToInternalHandles.release();
+            m_InternalHandles.release();
+        }
+
+    private:
+
+        /** Internal handle, chained into a list while free */
+        struct FLHandle
+        {
+            FLHandle* m_Next;
+            typename T::HandleType m_Handle; // Invalid on construction
+        };
+
+        /** Actual element data */
+        LazyCommittedArray<T, NUM> m_Elements;
+
+        /** Contains the index of an internal handle for each element */
+        LazyCommittedArray<size_t, NUM> m_ElementsToInternalHandles;
+
+        /** Internal handles. Make handles with enough bits to hold NUM indices. Use the rest for generations. */
+        LazyCommittedArray<FLHandle, NUM> m_InternalHandles;
+
+        /** Number of live elements */
+        size_t m_NumObtainedElements;
+
+        /** Number of internal handles ever used. Everything after this was never handed out. */
+        size_t m_NumHandlesUsed;
+
+        /** Most elements ever obtained at once */
+        size_t m_HighWater;
+
+        /** Head of the list of freed handles */
+        FLHandle* m_FreeHandles;
+
+        /** Handle to the last element created */
+        FLHandle* m_LastInternalHandle;
+
+        /** Function to call when an object was removed */
+        std::function<void(T&)> m_OnRemoved;
+    };
+}
@@ -7,6 +7,7 @@ namespace Config
     static const int MAX_NUM_LEVEL_ENTITIES = 65536 * 2;
 	static const int MAX_NUM_LEVEL_VIBUFFERS = 8192;
 	static const int MAX_NUM_LEVEL_ANIMATIONS = 2048;
+	static const int MAX_NUM_LEVEL_ANIM_HANDLERS = 8192;
 	static const int MAX_NUM_LEVEL_MESHES = 8192;
 	static const int MAX_NUM_LEVEL_AUDIO_FILES = 2048;
 }
\ No newline at end of file
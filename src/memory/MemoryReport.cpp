@@ -0,0 +1,142 @@
+#include "MemoryReport.h"
+#include <algorithm>
+#include <utils/logger.h>
+
+using namespace Memory;
+
+/**
+ * @return The given amount of bytes as KB-string
+ */
+static std::string kb(size_t numBytes)
+{
+    return std::to_string(numBytes / 1024) + "KB";
+}
+
+MemoryReport::MemoryReport() :
+        m_ResidentSetSize(0),
+        m_VirtualCommitted(0)
+{
+}
+
+void MemoryReport::add(const std::string& category, const std::string& name, const AllocatorStats& stats)
+{
+    Entry e;
+    e.scope = m_Scope;
+    e.category = category;
+    e.name = name;
+    e.stats = stats;
+
+    m_Entries.push_back(e);
+}
+
+void MemoryReport::addBytes(const std::string& category, const std::string& name, size_t numBytes)
+{
+    AllocatorStats s;
+    s.numBytesAllocated = numBytes;
+
+    add(category, name, s);
+}
+
+void MemoryReport::setProcessStats(size_t residentSetSize, size_t virtualCommitted)
+{
+    m_ResidentSetSize = residentSetSize;
+    m_VirtualCommitted = virtualCommitted;
+}
+
+size_t MemoryReport::getTotalBytes(const Entry& e)
+{
+    return e.stats.numBytesAllocated + e.stats.numBytesPayload;
+}
+
+size_t MemoryReport::getTotalBytes(const std::string& category) const
+{
+    size_t num = 0;
+    for(const Entry& e : m_Entries)
+    {
+        if(category.empty() || e.category == category)
+            num += getTotalBytes(e);
+    }
+
+    return num;
+}
+
+std::string MemoryReport::toString() const
+{
+    // Categories in order of first appearance
+    std::vector<std::string> categories;
+    for(const Entry& e : m_Entries)
+    {
+        if(std::find(categories.begin(), categories.end(), e.category) == categories.end())
+            categories.push_back(e.category);
+    }
+
+    std::string r = "Tracked: " + kb(getTotalBytes()) + " (";
+    for(size_t i = 0; i < categories.size(); i++)
+    {
+        if(i != 0)
+            r += ", ";
+
+        r += categories[i] + " " + kb(getTotalBytes(categories[i]));
+    }
+
+    r += ") | Virtual committed: " + kb(m_VirtualCommitted);
+
+    if(m_ResidentSetSize)
+        r += " | RSS: " + kb(m_ResidentSetSize);
+
+    return r;
+}
+
+void MemoryReport::log() const
+{
+    LogInfo() << "Memory: " << toString();
+
+    for(const Entry& e : m_Entries)
+    {
+        const AllocatorStats& s = e.stats;
+
+        if(!s.numLive && !s.elementSize)
+        {
+            LogInfo() << "Memory: [" << e.scope << "] " << e.category << "/" << e.name << ": " << kb(getTotalBytes(e));
+            continue;
+        }
+
+        // Capacity and element-size are unknown for things we only count
+        std::string count = std::to_string(s.numLive);
+        if(s.capacity)
+            count += "/" + std::to_string(s.capacity);
+
+        if(s.highWater)
+            count += " (peak " + std::to_string(s.highWater) + ")";
+
+        if(s.elementSize)
+            count += " x " + std::to_string(s.elementSize) + " bytes";
+
+        LogInfo() << "Memory: [" << e.scope << "] " << e.category << "/" << e.name << ": " << count << ", "
+                  << kb(s.numBytesAllocated) << " allocated + " << kb(s.numBytesPayload) << " payload";
+    }
+}
+
+void MemoryReport::exportJSON(json& j) const
+{
+    j["residentSetSize"] = m_ResidentSetSize;
+    j["virtualCommitted"] = m_VirtualCommitted;
+    j["totalBytes"] = getTotalBytes();
+    j["entries"] = json::array();
+
+    for(const Entry& e : m_Entries)
+    {
+        json je;
+        je["scope"] = e.scope;
+        je["category"] = e.category;
+        je["name"] = e.name;
+        je["live"] = e.stats.numLive;
+        je["capacity"] = e.stats.capacity;
+        je["highWater"] = e.stats.highWater;
+        je["elementSize"] = e.stats.elementSize;
+        je["bytesAllocated"] = e.stats.numBytesAllocated;
+        je["bytesPayload"] = e.stats.numBytesPayload;
+
+        j["entries"].push_back(je);
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <string>
+#include <vector>
+#include <json.hpp>
+#include "AllocatorStats.h"
+
+using json = nlohmann::json;
+
+namespace Memory
+{
+    /**
+     * Snapshot of the memory-usage of the engine, put together from the stats of all instrumented allocators.
+     * Entries are grouped by scope (the engine or a single world) and category (components, content, ...).
+     * Collecting this only reads counters and walks live elements, so it can be done in release-builds as well.
+     */
+    class MemoryReport
+    {
+    public:
+
+        struct Entry
+        {
+            std::string scope;
+            std::string category;
+            std::string name;
+            AllocatorStats stats;
+        };
+
+        MemoryReport();
+
+        /**
+         * Sets the scope of all entries added from now on
+         */
+        void setScope(const std::string& scope){ m_Scope = scope; }
+
+        /**
+         * Adds the stats of an allocator
+         */
+        void add(const std::string& category, const std::string& name, const AllocatorStats& stats);
+
+        /**
+         * Adds something which is only known by its size
+         */
+        void addBytes(const std::string& category, const std::string& name, size_t numBytes);
+
+        /**
+         * Sets numbers which are measured for the whole process. These are not included in the totals.
+         * @param residentSetSize Physical memory of the process, 0 if unknown
+         * @param virtualCommitted Bytes committed through the VirtualMemory-interface
+         */
+        void setProcessStats(size_t residentSetSize, size_t virtualCommitted);
+
+        /**
+         * @return All entries, in the order they were added
+         */
+        const std::vector<Entry>& getEntries() const { return m_Entries; }
+
+        /**
+         * @return Allocated bytes and payload of the given entry
+         */
+        static size_t getTotalBytes(const Entry& e);
+
+        /**
+         * @return Sum of all entries. If a category is given, only of that one.
+         */
+        size_t getTotalBytes(const std::string& category = "") const;
+
+        /**
+         * @return Single line with the totals per category, for the console
+         */
+        std::string toString() const;
+
+        /**
+         * Writes one line per entry into the log
+         */
+        void log() const;
+
+        /**
+         * Writes everything into the given json-object
+         */
+        void exportJSON(json& j) const;
+
+    private:
+
+        std::vector<Entry> m_Entries;
+        std::string m_Scope;
+        size_t m_ResidentSetSize;
+        size_t m_VirtualCommitted;
+    };
+}
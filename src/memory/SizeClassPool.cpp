@@ -0,0 +1,101 @@
+#include "SizeClassPool.h"
+#include <new>
+#include <assert.h>
+
+using namespace Memory;
+
+// Multiples of 16, so every block stays aligned like ::operator new would do it
+const size_t SizeClassPool::s_SizeClasses[NUM_SIZE_CLASSES] = {64, 128, 256, 512};
+
+SizeClassPool::SizeClassPool()
+{
+    for(int i = 0; i < NUM_SIZE_CLASSES; i++)
+        m_FreeLists[i] = nullptr;
+
+    m_Stats.numAllocations = 0;
+    m_Stats.numLive = 0;
+    m_Stats.numPeakLive = 0;
+    m_Stats.numSystemAllocations = 0;
+    m_Stats.numBytesReserved = 0;
+}
+
+SizeClassPool::~SizeClassPool()
+{
+    for(uint8_t* c : m_Chunks)
+        ::operator delete(c);
+}
+
+int SizeClassPool::getSizeClass(size_t size)
+{
+    for(int i = 0; i < NUM_SIZE_CLASSES; i++)
+    {
+        if(size <= s_SizeClasses[i])
+            return i;
+    }
+
+    return -1;
+}
+
+void* SizeClassPool::allocate(size_t size)
+{
+    m_Stats.numAllocations++;
+    m_Stats.numLive++;
+
+    if(m_Stats.numLive > m_Stats.numPeakLive)
+        m_Stats.numPeakLive = m_Stats.numLive;
+
+    int sc = getSizeClass(size);
+    if(sc == -1)
+    {
+        m_Stats.numSystemAllocations++;
+        return ::operator new(size);
+    }
+
+    if(!m_FreeLists[sc])
+        refill(sc);
+
+    FreeBlock* b = m_FreeLists[sc];
+    m_FreeLists[sc] = b->m_Next;
+
+    return b;
+}
+
+void SizeClassPool::deallocate(void* p, size_t size)
+{
+    if(!p)
+        return;
+
+    assert(m_Stats.numLive > 0);
+    m_Stats.numLive--;
+
+    int sc = getSizeClass(size);
+    if(sc == -1)
+    {
+        ::operator delete(p);
+        return;
+    }
+
+    FreeBlock* b = reinterpret_cast<FreeBlock*>(p);
+    b->m_Next = m_FreeLists[sc];
+    m_FreeLists[sc] = b;
+}
+
+void SizeClassPool::refill(int sizeClass)
+{
+    size_t blockSize = s_SizeClasses[sizeClass];
+    size_t chunkSize = blockSize * BLOCKS_PER_CHUNK;
+
+    uint8_t* chunk = reinterpret_cast<uint8_t*>(::operator new(chunkSize));
+    m_Chunks.push_back(chunk);
+
+    m_Stats.numSystemAllocations++;
+    m_Stats.numBytesReserved += chunkSize;
+
+    // Chain the blocks in memory-order, so fresh allocations come out continuous
+    for(size_t i = BLOCKS_PER_CHUNK; i > 0; i--)
+    {
+        FreeBlock* b = reinterpret_cast<FreeBlock*>(chunk + (i - 1) * blockSize);
+        b->m_Next = m_FreeLists[sizeClass];
+        m_FreeLists[sizeClass] = b;
+    }
+}
@@ -0,0 +1,89 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+namespace Memory
+{
+    /**
+     * Allocator for many small, short-lived objects of varying size. Requests are rounded up to one of a few
+     * size-classes, each keeping a free-list of equally sized blocks. Blocks are taken from bigger chunks, so
+     * after warming up, allocating and freeing doesn't touch the system-allocator anymore.
+     * Requests bigger than the biggest size-class go straight to the system.
+     * Not thread-safe!
+     */
+    class SizeClassPool
+    {
+    public:
+
+        /**
+         * Number of blocks to get from the system at once, per size-class
+         */
+        enum { BLOCKS_PER_CHUNK = 64 };
+
+        SizeClassPool();
+        ~SizeClassPool();
+
+        SizeClassPool(const SizeClassPool&) = delete;
+        SizeClassPool& operator=(const SizeClassPool&) = delete;
+
+        /**
+         * @return Memory for an object of the given size
+         */
+        void* allocate(size_t size);
+
+        /**
+         * Gives back memory obtained from allocate()
+         * @param size Same size as given to allocate()
+         */
+        void deallocate(void* p, size_t size);
+
+        struct Stats
+        {
+            size_t numAllocations; // Calls to allocate()
+            size_t numLive; // Blocks currently handed out
+            size_t numPeakLive; // Most blocks handed out at once
+            size_t numSystemAllocations; // Chunks and oversized blocks requested from the system
+            size_t numBytesReserved; // Bytes inside all chunks
+        };
+
+        /**
+         * @return Counters since construction
+         */
+        Stats getStats() const
+        {
+            return m_Stats;
+        }
+
+        /**
+         * @return Index of the size-class an object of the given size goes into, or -1 if it is too big
+         */
+        static int getSizeClass(size_t size);
+
+    private:
+
+        enum { NUM_SIZE_CLASSES = 4 };
+
+        static const size_t s_SizeClasses[NUM_SIZE_CLASSES];
+
+        /**
+         * Unused block, chained into a free-list
+         */
+        struct FreeBlock
+        {
+            FreeBlock* m_Next;
+        };
+
+        /**
+         * Puts a new chunk of blocks into the free-list of the given size-class
+         */
+        void refill(int sizeClass);
+
+        FreeBlock* m_FreeLists[NUM_SIZE_CLASSES];
+
+        /** All chunks ever allocated. Only freed on destruction. */
+        std::vector<uint8_t*> m_Chunks;
+
+        Stats m_Stats;
+    };
+}
@@ -0,0 +1,375 @@
+#pragma once
+#include <tuple>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include "ChunkedReferencedAllocator.h"
+#include "utils/tuple.h"
+
+namespace Memory
+{
+    /**
+     * Storage for one type of component, keyed by the handle of the entity owning it (Sparse set).
+     * Components are kept in a dense array in no particular order, together with the handle of their owner.
+     * The sparse array maps the index of an entity-handle to the position inside the dense array.
+     * @param T Component-type. Must provide a static init(T&), which is called once a component is added.
+     * @param HT Entity-handle type
+     * @param NUM Maximum number of entities
+     */
+    template<typename T, typename HT, unsigned int NUM>
+    class SparseComponentSet
+    {
+    public:
+
+        /**
+         * Outside-Mirror for the type this stores
+         */
+        typedef T Type;
+
+        SparseComponentSet() :
+                m_NumElements(0),
+                m_HighWater(0)
+        {
+        }
+
+        ~SparseComponentSet()
+        {
+            clear();
+        }
+
+        /**
+         * @return Whether the given entity has storage for this component
+         */
+        bool has(const HT& h)
+        {
+            return denseIndexOf(h) != 0;
+        }
+
+        /**
+         * @return Component of the given entity, nullptr if it has none
+         */
+        T* tryGet(const HT& h)
+        {
+            uint32_t d = denseIndexOf(h);
+            if(!d)
+                return nullptr;
+
+            assert(m_Owners.data()[d - 1].generation == h.generation);
+            return &m_Dense.data()[d - 1];
+        }
+
+        /**
+         * @return Component of the given entity. Created, if it doesn't have one yet.
+         */
+        T& get(const HT& h)
+        {
+            T* c = tryGet(h);
+            return c ? *c : add(h);
+        }
+
+        /**
+         * Creates the component for the given entity. The entity must not already have one.
+         */
+        T& add(const HT& h)
+        {
+            assert(!has(h));
+
+            m_Sparse.growTo(h.index + 1);
+
+            size_t idx = m_NumElements++;
+            m_HighWater = std::max(m_HighWater, m_NumElements);
+
+            m_Dense.growTo(idx + 1);
+            m_Owners.growTo(idx + 1);
+
+            T* c = new (&m_Dense.data()[idx]) T();
+            m_Owners.data()[idx] = h;
+            m_Sparse.data()[h.index] = static_cast<uint32_t>(idx + 1);
+
+            T::init(*c);
+
+            return *c;
+        }
+
+        /**
+         * Removes the component of the given entity, if there is one. The last component is moved into the hole.
+         */
+        void remove(const HT& h)
+        {
+            uint32_t d = denseIndexOf(h);
+            if(!d)
+                return;
+
+            size_t idx = d - 1;
+            size_t last = m_NumElements - 1;
+            T* dense = m_Dense.data();
+            HT* owners = m_Owners.data();
+
+            if(idx != last)
+            {
+                dense[idx] = std::move(dense[last]);
+                owners[idx] = owners[last];
+                m_Sparse.data()[owners[idx].index] = static_cast<uint32_t>(idx + 1);
+            }
+
+            dense[last].~T();
+            m_Sparse.data()[h.index] = 0;
+            m_NumElements--;
+
+            m_Dense.shrinkTo(m_NumElements);
+            m_Owners.shrinkTo(m_NumElements);
+        }
+
+        /**
+         * Destroys all components
+         */
+        void clear()
+        {
+            for(size_t i = 0; i < m_NumElements; i++)
+            {
+                m_Sparse.data()[m_Owners.data()[i].index] = 0;
+                m_Dense.data()[i].~T();
+            }
+
+            m_NumElements = 0;
+            m_Dense.shrinkTo(0);
+            m_Owners.shrinkTo(0);
+        }
+
+        /**
+         * @return Dense array of all components, getNumElements() long
+         */
+        T* getElements()
+        {
+            return m_Dense.data();
+        }
+
+        /**
+         * @return Owning entity of each component in getElements()
+         */
+        const HT* getOwners()
+        {
+            return m_Owners.data();
+        }
+
+        /**
+         * @return Number of components stored
+         */
+        size_t getNumElements()
+        {
+            return m_NumElements;
+        }
+
+        /**
+         * @return Memory currently committed by this set
+         */
+        size_t getNumCommittedBytes()
+        {
+            return m_Dense.getNumCommittedBytes() + m_Owners.getNumCommittedBytes() + m_Sparse.getNumCommittedBytes();
+        }
+
+        /**
+         * @return Usage of this set
+         */
+        AllocatorStats getStats()
+        {
+            AllocatorStats s;
+            s.numLive = m_NumElements;
+            s.capacity = NUM;
+            s.highWater = m_HighWater;
+            s.elementSize = sizeof(T);
+            s.numBytesAllocated = getNumCommittedBytes();
+
+            return s;
+        }
+
+    private:
+
+        /**
+         * @return Position of the entities component inside the dense array + 1. 0 if it has none.
+         */
+        uint32_t denseIndexOf(const HT& h)
+        {
+            // Committed memory comes in zeroed, so anything not written to yet reads as "none"
+            return h.index < m_Sparse.getNumAvailable() ? m_Sparse.data()[h.index] : 0;
+        }
+
+        /** Components, continuous */
+        LazyCommittedArray<T, NUM> m_Dense;
+
+        /** Entity of each component */
+        LazyCommittedArray<HT, NUM> m_Owners;
+
+        /** Entity-index -> Dense-index + 1 */
+        LazyCommittedArray<uint32_t, NUM> m_Sparse;
+
+        size_t m_NumElements;
+
+        /** Most components ever stored at once */
+        size_t m_HighWater;
+    };
+
+    /**
+     * Replacement for the AllocatorBundle, which only stores the components an entity actually uses.
+     * The first type is stored for every entity and defines the handles. All other types live inside their
+     * own SparseComponentSet and are created on first access through getElement(), so entities which never
+     * touch a component don't pay for it.
+     * Iterating one component-type is done over its dense array (getElements/getOwners/getNumElements).
+     * Note: The arrays of different component-types are NOT parallel!
+     * @param NUM_ALLOC Maximum number of entities
+     * @param HT Handle-type
+     * @param E Type stored for every entity
+     * @param S Other component-types
+     */
+    template<int NUM_ALLOC, typename HT, typename E, typename... S>
+    class SparseAllocatorBundle
+    {
+    public:
+
+        typedef HT Handle;
+
+        /**
+         * Creates a new entity. Only E is constructed, everything else is created on demand.
+         */
+        Handle createObject()
+        {
+            return m_Entities.createObject();
+        }
+
+        /**
+         * Removes the given entity and all of its components
+         */
+        void removeObject(const Handle& h)
+        {
+            Utils::for_each_in_tuple(m_Sets, [&](auto& set){
+                set.remove(h);
+            });
+
+            m_Entities.removeObject(h);
+        }
+
+        /**
+         * @return The component of type T of the given entity. Created, if it doesn't exist yet.
+         */
+        template<typename T>
+        typename std::enable_if<std::is_same<T, E>::value, T&>::type getElement(const Handle& h)
+        {
+            return m_Entities.getElement(h);
+        }
+
+        template<typename T>
+        typename std::enable_if<!std::is_same<T, E>::value, T&>::type getElement(const Handle& h)
+        {
+            return getSet<T>().get(h);
+        }
+
+        /**
+         * @return The component of type T of the given entity, nullptr if it has none. Never creates one.
+         */
+        template<typename T>
+        T* tryGetElement(const Handle& h)
+        {
+            return getSet<T>().tryGet(h);
+        }
+
+        /**
+         * @return Dense array of all components of type T. For E, this is parallel to the entities.
+         */
+        template<typename T>
+        typename std::enable_if<std::is_same<T, E>::value, T*>::type getElements()
+        {
+            return m_Entities.getElements();
+        }
+
+        template<typename T>
+        typename std::enable_if<!std::is_same<T, E>::value, T*>::type getElements()
+        {
+            return getSet<T>().getElements();
+        }
+
+        /**
+         * @return Number of components of type T stored
+         */
+        template<typename T>
+        size_t getNumElements()
+        {
+            return getSet<T>().getNumElements();
+        }
+
+        /**
+         * @return Owning entity of each component in getElements<T>()
+         */
+        template<typename T>
+        const Handle* getOwners()
+        {
+            return getSet<T>().getOwners();
+        }
+
+        /**
+         * Calls f for E and every component the given entity has storage for
+         */
+        template<typename F>
+        void forEachComponentOf(const Handle& h, F f)
+        {
+            f(m_Entities.getElement(h));
+
+            Utils::for_each_in_tuple(m_Sets, [&](auto& set){
+                auto* c = set.tryGet(h);
+                if(c)
+                    f(*c);
+            });
+        }
+
+        /**
+         * Returns the number of entities. This is also the range for getElements<E>()
+         */
+        size_t getNumObtainedElements()
+        {
+            return m_Entities.getNumObtainedElements();
+        }
+
+        /**
+         * @return Memory currently committed for entities and all components
+         */
+        size_t getNumCommittedBytes()
+        {
+            size_t num = m_Entities.getNumCommittedBytes();
+            Utils::for_each_in_tuple(m_Sets, [&](auto& set){
+                num += set.getNumCommittedBytes();
+            });
+
+            return num;
+        }
+
+        /**
+         * @return Usage of the storage for E
+         */
+        AllocatorStats getEntityStats()
+        {
+            return m_Entities.getStats();
+        }
+
+        /**
+         * Calls f on the SparseComponentSet of every component-type except E
+         */
+        template<typename F>
+        void forEachComponentSet(F f)
+        {
+            Utils::for_each_in_tuple(m_Sets, f);
+        }
+
+    protected:
+
+        template<typename T>
+        SparseComponentSet<T, HT, NUM_ALLOC>& getSet()
+        {
+            return std::get<SparseComponentSet<T, HT, NUM_ALLOC>>(m_Sets);
+        }
+
+        /** Entities, defining the handles */
+        ChunkedReferencedAllocator<E, NUM_ALLOC> m_Entities;
+
+        /** Storage of all other components */
+        std::tuple<SparseComponentSet<S, HT, NUM_ALLOC>...> m_Sets;
+    };
+}
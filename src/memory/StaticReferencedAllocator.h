@@ -2,10 +2,14 @@
 #include <cstdint>
 #include "FreeList.h"
 #include "MemUtils.h"
+#include "AllocatorStats.h"
 #include <assert.h>
 #include <cstring>
 #include <functional>
 #include <algorithm>
+#include <new>
+#include <utility>
+#include <type_traits>
 
 namespace Memory
 {
@@ -82,11 +86,12 @@ namespace Memory
         typedef T Type;
 
         StaticReferencedAllocator() :
-                m_Elements(new T[NUM]),
+                m_Elements(new ElementStorage[NUM]),
                 m_ElementsToInternalHandles(new size_t[NUM]),
                 m_InternalHandles(new FLHandle[NUM]),
-                m_FreeList(m_InternalHandles, m_InternalHandles + NUM, sizeof(m_InternalHandles[0]), NUM, sizeof(m_InternalHandles[0]), 0),
-                m_LastInternalHandle(nullptr)
+                m_LastInternalHandle(nullptr),
+                m_HighWater(0),
+                m_FreeList(m_InternalHandles, m_InternalHandles + NUM, sizeof(m_InternalHandles[0]), NUM, sizeof(m_InternalHandles[0]), 0)
         {
             // Initialize handles
             for (size_t i = 0; i < NUM; i++) {
@@ -119,6 +124,8 @@ namespace Memory
             // Store this as the new handle to the end of the list
             m_LastInternalHandle = handle;
 
+            m_HighWater = std::max(m_HighWater, idx + 1);
+
             // Create output handle
             typename T::HandleType hOut;
             hOut.index = static_cast<uint32_t>(handle - m_InternalHandles);
@@ -127,8 +134,8 @@ namespace Memory
             // Connect element and internal handle
             m_ElementsToInternalHandles[idx] = hOut.index;
 
-            // Call constructor on object
-            //new (&reinterpret_cast<T*>(m_Elements)[idx]) T;
+            // Slots are only constructed while in use
+            new (&reinterpret_cast<T*>(m_Elements)[idx]) T();
 
             return hOut;
         }
@@ -169,12 +176,15 @@ namespace Memory
             if(m_OnRemoved)
                 m_OnRemoved(reinterpret_cast<T*>(m_Elements)[actIdx]);
 
-            // Call destructor on slot to free up memory
-            //reinterpret_cast<T*>(m_Elements)[actIdx].~T(); // FIXME: This leaks right here! I need to fix the moving of the last element first!
+            // Move the last element into the hole and destroy what's left of it.
+            // Moving lets strings, vectors and the like hand over their memory instead of copying it.
+            uint32_t lastIdx = m_LastInternalHandle->m_Handle.index;
+            T* elements = reinterpret_cast<T*>(m_Elements);
+
+            if(actIdx != lastIdx)
+                elements[actIdx] = std::move(elements[lastIdx]);
 
-            // Overwrite this element with the last one.
-            //memcpy(&reinterpret_cast<T*>(m_Elements)[actIdx], &reinterpret_cast<T*>(m_Elements)[m_LastInternalHandle->m_Handle.index], sizeof(T));
-            reinterpret_cast<T*>(m_Elements)[actIdx] = reinterpret_cast<T*>(m_Elements)[m_LastInternalHandle->m_Handle.index];
+            elements[lastIdx].~T();
 
             // Fix the handle of the last element
             m_LastInternalHandle->m_Handle.index = actIdx;
@@ -214,19 +224,45 @@ namespace Memory
             return m_FreeList.getNumObtainedElements();
         }
 
+        /**
+         * @return Usage of this allocator. The payload is left for the owner to fill in.
+         */
+        AllocatorStats getStats()
+        {
+            AllocatorStats s;
+            s.numLive = m_FreeList.getNumObtainedElements();
+            s.capacity = NUM;
+            s.highWater = m_HighWater;
+            s.elementSize = sizeof(T);
+
+            // Everything is allocated up front
+            s.numBytesAllocated = NUM * (sizeof(ElementStorage) + sizeof(size_t) + sizeof(FLHandle));
+
+            return s;
+        }
+
         /**
          * Basically destructs the allocator and makes it unusable (frees memory)
          */
         void kill()
         {
+            if(m_Elements)
+            {
+                for(size_t i = 0; i < m_FreeList.getNumObtainedElements(); i++)
+                    reinterpret_cast<T*>(m_Elements)[i].~T();
+            }
+
             delete[] m_Elements; m_Elements = nullptr;
             delete[] m_InternalHandles; m_InternalHandles = nullptr;
             delete[] m_ElementsToInternalHandles; m_ElementsToInternalHandles = nullptr;
         }
 
     private:
-        /** Actual element data */
-        T* m_Elements;
+        /** Uninitialized memory for one element */
+        typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type ElementStorage;
+
+        /** Actual element data. Only the first getNumObtainedElements() are constructed. */
+        ElementStorage* m_Elements;
 
         /** Contains the index of an internal handle for each element */
         size_t* m_ElementsToInternalHandles;
@@ -244,6 +280,9 @@ namespace Memory
         /** Handle to the last element created */
         FLHandle* m_LastInternalHandle;
 
+        /** Most elements ever obtained at once */
+        size_t m_HighWater;
+
         /** List of free handles */
         FreeList<FLHandle> m_FreeList;
 
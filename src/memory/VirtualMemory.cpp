@@ -0,0 +1,128 @@
+#include "VirtualMemory.h"
+#include <atomic>
+#include <cstdio>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#ifdef _MSC_VER
+#pragma comment(lib, "psapi.lib")
+#endif
+#else
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#ifdef __APPLE__
+#include <mach/mach.h>
+#endif
+
+using namespace Memory;
+
+namespace
+{
+    std::atomic<size_t> s_NumCommittedBytes(0);
+}
+
+size_t VirtualMemory::getPageSize()
+{
+#ifdef _WIN32
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    return info.dwPageSize;
+#else
+    static const size_t pageSize = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    return pageSize;
+#endif
+}
+
+void* VirtualMemory::reserve(size_t numBytes)
+{
+#ifdef _WIN32
+    return VirtualAlloc(nullptr, numBytes, MEM_RESERVE, PAGE_NOACCESS);
+#else
+    void* p = mmap(nullptr, numBytes, PROT_NONE, MAP_PRIVATE | MAP_ANONYMOUS | MAP_NORESERVE, -1, 0);
+    return p == MAP_FAILED ? nullptr : p;
+#endif
+}
+
+bool VirtualMemory::commit(void* start, size_t numBytes)
+{
+    if(!numBytes)
+        return true;
+
+#ifdef _WIN32
+    bool ok = VirtualAlloc(start, numBytes, MEM_COMMIT, PAGE_READWRITE) != nullptr;
+#else
+    bool ok = mprotect(start, numBytes, PROT_READ | PROT_WRITE) == 0;
+#endif
+
+    if(ok)
+        s_NumCommittedBytes += numBytes;
+
+    return ok;
+}
+
+void VirtualMemory::decommit(void* start, size_t numBytes)
+{
+    if(!numBytes)
+        return;
+
+#ifdef _WIN32
+    VirtualFree(start, numBytes, MEM_DECOMMIT);
+#else
+    // Drop the pages, so they are zero again once committed next time
+    madvise(start, numBytes, MADV_DONTNEED);
+    mprotect(start, numBytes, PROT_NONE);
+#endif
+
+    s_NumCommittedBytes -= numBytes;
+}
+
+void VirtualMemory::release(void* start, size_t numBytes)
+{
+    if(!start)
+        return;
+
+#ifdef _WIN32
+    VirtualFree(start, 0, MEM_RELEASE);
+#else
+    munmap(start, numBytes);
+#endif
+}
+
+size_t VirtualMemory::getNumCommittedBytes()
+{
+    return s_NumCommittedBytes;
+}
+
+size_t VirtualMemory::getResidentSetSize()
+{
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS pmc;
+    if(GetProcessMemoryInfo(GetCurrentProcess(), &pmc, sizeof(pmc)))
+        return pmc.WorkingSetSize;
+
+    return 0;
+#elif defined(__APPLE__)
+    mach_task_basic_info info;
+    mach_msg_type_number_t count = MACH_TASK_BASIC_INFO_COUNT;
+    if(task_info(mach_task_self(), MACH_TASK_BASIC_INFO, (task_info_t)&info, &count) == KERN_SUCCESS)
+        return info.resident_size;
+
+    return 0;
+#else
+    // Second value is the resident set, in pages
+    FILE* f = fopen("/proc/self/statm", "r");
+    if(!f)
+        return 0;
+
+    long size = 0, resident = 0;
+    int n = fscanf(f, "%ld %ld", &size, &resident);
+    fclose(f);
+
+    return n == 2 ? static_cast<size_t>(resident) * getPageSize() : 0;
+#endif
+}
@@ -0,0 +1,53 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+
+namespace Memory
+{
+    /**
+     * Thin wrapper around the platforms virtual-memory functions. Address-space can be reserved up front
+     * and backed by physical memory later, so big arrays keep their address while growing.
+     */
+    namespace VirtualMemory
+    {
+        /**
+         * @return Size of a page, as used by the OS
+         */
+        size_t getPageSize();
+
+        /**
+         * Reserves address-space without committing any memory
+         * @param numBytes Size of the range. Rounded up to the page-size.
+         * @return Start of the reserved range, nullptr on failure
+         */
+        void* reserve(size_t numBytes);
+
+        /**
+         * Backs the given range with memory, which is zero-initialized afterwards.
+         * Start and size must be multiples of the page-size.
+         */
+        bool commit(void* start, size_t numBytes);
+
+        /**
+         * Gives the memory of the given range back to the OS. The range stays reserved.
+         * Start and size must be multiples of the page-size.
+         */
+        void decommit(void* start, size_t numBytes);
+
+        /**
+         * Releases a range obtained from reserve()
+         * @param numBytes Same size as given to reserve()
+         */
+        void release(void* start, size_t numBytes);
+
+        /**
+         * @return Bytes currently committed through this interface, over all users
+         */
+        size_t getNumCommittedBytes();
+
+        /**
+         * @return Physical memory used by this process, or 0 if that is unknown on this platform
+         */
+        size_t getResidentSetSize();
+    }
+}
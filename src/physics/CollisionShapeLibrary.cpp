@@ -0,0 +1,251 @@
+#include "CollisionShapeLibrary.h"
+#include <cassert>
+#include <btBulletDynamicsCommon.h>
+#include <BulletCollision/CollisionShapes/btShapeHull.h>
+#include <BulletCollision/CollisionShapes/btConvexHullShape.h>
+#include <bx/timer.h>
+#include <utils/logger.h>
+
+using namespace Physics;
+
+CollisionShapeLibrary::CollisionShapeLibrary()
+{
+    m_NumHits = 0;
+    m_NumMisses = 0;
+    m_BuildTicksSpent = 0;
+    m_BuildTicksSaved = 0;
+}
+
+CollisionShapeLibrary::~CollisionShapeLibrary()
+{
+    for(auto& p : m_Shapes)
+    {
+        delete p.second.shape;
+        delete p.second.meshInterface;
+    }
+}
+
+CollisionShapeLibrary::ShapeKey CollisionShapeLibrary::makeKey(const std::vector<Math::float3>& triangles, EShapeKind kind)
+{
+    // FNV-1a over the raw vertex-data
+    const uint64_t FNV_OFFSET = 14695981039346656037ULL;
+    const uint64_t FNV_PRIME = 1099511628211ULL;
+
+    uint64_t h = FNV_OFFSET;
+    const uint8_t* data = reinterpret_cast<const uint8_t*>(triangles.data());
+    size_t numBytes = triangles.size() * sizeof(Math::float3);
+
+    for(size_t i=0;i<numBytes;i++)
+    {
+        h ^= data[i];
+        h *= FNV_PRIME;
+    }
+
+    ShapeKey key;
+    key.hash = h;
+    key.numTriangles = static_cast<uint32_t>(triangles.size() / 3);
+    key.kind = kind;
+
+    return key;
+}
+
+btCollisionShape* CollisionShapeLibrary::acquire(const std::vector<Math::float3>& triangles, EShapeKind kind,
+                                                 ShapeKey& outKey, const std::string& alias)
+{
+    if(triangles.size() < 3)
+        return nullptr;
+
+    outKey = makeKey(triangles, kind);
+
+    std::lock_guard<std::mutex> guard(m_Mutex);
+
+    if(!alias.empty())
+        m_KeysByAlias[std::to_string(kind) + ":" + alias] = outKey;
+
+    auto it = m_Shapes.find(outKey);
+    if(it != m_Shapes.end())
+        return onHit((*it).second);
+
+    Entry e = buildShape(triangles, kind);
+    e.refCount = 1;
+
+    m_NumMisses++;
+    m_BuildTicksSpent += e.buildTicks;
+
+    m_Shapes[outKey] = e;
+
+    return e.shape;
+}
+
+btCollisionShape* CollisionShapeLibrary::acquireByAlias(const std::string& alias, EShapeKind kind, ShapeKey& outKey)
+{
+    if(alias.empty())
+        return nullptr;
+
+    std::lock_guard<std::mutex> guard(m_Mutex);
+
+    auto ait = m_KeysByAlias.find(std::to_string(kind) + ":" + alias);
+    if(ait == m_KeysByAlias.end())
+        return nullptr;
+
+    // Shape may have been purged since
+    auto it = m_Shapes.find((*ait).second);
+    if(it == m_Shapes.end())
+        return nullptr;
+
+    outKey = (*ait).second;
+    return onHit((*it).second);
+}
+
+void CollisionShapeLibrary::release(const ShapeKey& key)
+{
+    std::lock_guard<std::mutex> guard(m_Mutex);
+
+    auto it = m_Shapes.find(key);
+    if(it == m_Shapes.end())
+    {
+        LogWarn() << "Physics: Tried to release unknown shape from the library";
+        return;
+    }
+
+    assert((*it).second.refCount > 0);
+    (*it).second.refCount--;
+}
+
+size_t CollisionShapeLibrary::purgeUnused()
+{
+    std::lock_guard<std::mutex> guard(m_Mutex);
+
+    size_t num = 0;
+    for(auto it = m_Shapes.begin(); it != m_Shapes.end();)
+    {
+        if((*it).second.refCount == 0)
+        {
+            delete (*it).second.shape;
+            delete (*it).second.meshInterface;
+
+            it = m_Shapes.erase(it);
+            num++;
+        }else
+        {
+            it++;
+        }
+    }
+
+    return num;
+}
+
+CollisionShapeLibrary::Stats CollisionShapeLibrary::getStats()
+{
+    std::lock_guard<std::mutex> guard(m_Mutex);
+
+    const double freq = double(bx::getHPFrequency());
+
+    Stats s;
+    s.numShapes = m_Shapes.size();
+    s.numUnreferenced = 0;
+    s.numHits = m_NumHits;
+    s.numMisses = m_NumMisses;
+    s.buildTimeSpent = m_BuildTicksSpent / freq;
+    s.buildTimeSaved = m_BuildTicksSaved / freq;
+    s.numTriangles = 0;
+    s.numBytesEstimated = 0;
+
+    for(auto& p : m_Shapes)
+    {
+        if(p.second.refCount == 0)
+            s.numUnreferenced++;
+
+        s.numTriangles += p.first.numTriangles;
+        s.numBytesEstimated += estimateShapeBytes(p.first, p.second);
+    }
+
+    return s;
+}
+
+size_t CollisionShapeLibrary::estimateShapeBytes(const ShapeKey& key, const Entry& e)
+{
+    size_t num = 0;
+
+    // Triangles are added without welding, so every one of them brings 3 vertices and 3 indices
+    if(e.meshInterface)
+        num += key.numTriangles * 3 * (sizeof(btVector3) + sizeof(int));
+
+    switch(key.kind)
+    {
+        case SK_TriangleMesh:
+            // Quantized BVH, at most 2 nodes per triangle
+            num += sizeof(btBvhTriangleMeshShape) + key.numTriangles * 2 * sizeof(btQuantizedBvhNode);
+            break;
+
+        case SK_ConvexHull:
+            num += sizeof(btConvexHullShape)
+                   + static_cast<btConvexHullShape*>(e.shape)->getNumPoints() * sizeof(btVector3);
+            break;
+    }
+
+    return num;
+}
+
+btCollisionShape* CollisionShapeLibrary::onHit(Entry& e)
+{
+    e.refCount++;
+
+    // Would have had to build this again without the library
+    m_NumHits++;
+    m_BuildTicksSaved += e.buildTicks;
+
+    return e.shape;
+}
+
+CollisionShapeLibrary::Entry CollisionShapeLibrary::buildShape(const std::vector<Math::float3>& triangles, EShapeKind kind)
+{
+    int64_t start = bx::getHPCounter();
+
+    Entry e;
+    e.refCount = 0;
+    e.meshInterface = new btTriangleMesh;
+
+    for(size_t i=0;i + 2<triangles.size();i+=3)
+    {
+        // Convert to btvector
+        btVector3 v[] = {{triangles[i].x,   triangles[i].y,   triangles[i].z},
+                         {triangles[i+1].x, triangles[i+1].y, triangles[i+1].z},
+                         {triangles[i+2].x, triangles[i+2].y, triangles[i+2].z}};
+
+        e.meshInterface->addTriangle(v[0], v[1], v[2]);
+    }
+
+    switch(kind)
+    {
+        case SK_TriangleMesh:
+            e.shape = new btBvhTriangleMeshShape(e.meshInterface, true);
+            break;
+
+        case SK_ConvexHull:
+        {
+            btConvexShape* tmpShape = new btConvexTriangleMeshShape(e.meshInterface);
+            btShapeHull* hull = new btShapeHull(tmpShape);
+
+            btScalar margin = tmpShape->getMargin();
+            hull->buildHull(margin);
+
+            e.shape = new btConvexHullShape((btScalar*)hull->getVertexPointer(), hull->numVertices());
+
+            delete tmpShape;
+            delete hull;
+
+            // The hull has its own copy of the vertices
+            delete e.meshInterface;
+            e.meshInterface = nullptr;
+        }
+            break;
+    }
+
+    // Shapes are shared between worlds, so they can't carry a handle
+    e.shape->setUserIndex(-1);
+
+    e.buildTicks = bx::getHPCounter() - start;
+
+    return e;
+}
@@ -0,0 +1,170 @@
+#pragma once
+#include <vector>
+#include <string>
+#include <mutex>
+#include <unordered_map>
+#include <math/mathlib.h>
+
+class btCollisionShape;
+class btTriangleMesh;
+
+namespace Physics
+{
+    /**
+     * Engine-wide store of collision-shapes which are expensive to build (BVH-trianglemeshes, convex hulls).
+     * Shapes are keyed by the contents of their triangle-data, so the same mesh used by many vobs or
+     * multiple worlds only gets built once. Shapes are refcounted and stay in the library after their last
+     * user is gone, so switching back and forth between worlds doesn't rebuild them.
+     *
+     * Note: Shapes in here are shared between worlds. Don't store per-world data (like the user-index) in them!
+     */
+    class CollisionShapeLibrary
+    {
+    public:
+
+        /**
+         * Kinds of shapes the library knows how to build
+         */
+        enum EShapeKind
+        {
+            SK_TriangleMesh,
+            SK_ConvexHull
+        };
+
+        /**
+         * Identifies a shape by its contents
+         */
+        struct ShapeKey
+        {
+            ShapeKey() : hash(0), numTriangles(0), kind(SK_TriangleMesh) {}
+
+            uint64_t hash;
+            uint32_t numTriangles;
+            EShapeKind kind;
+
+            bool operator==(const ShapeKey& o) const
+            {
+                return hash == o.hash && numTriangles == o.numTriangles && kind == o.kind;
+            }
+        };
+
+        struct ShapeKeyHash
+        {
+            size_t operator()(const ShapeKey& k) const
+            {
+                // Key already is a hash, just mix in the rest
+                return static_cast<size_t>(k.hash ^ (static_cast<uint64_t>(k.numTriangles) << 1) ^ static_cast<uint64_t>(k.kind));
+            }
+        };
+
+        /**
+         * Statistics about how well the library is doing
+         */
+        struct Stats
+        {
+            size_t numShapes;
+            size_t numUnreferenced;
+            size_t numHits;
+            size_t numMisses;
+            double buildTimeSpent; // Seconds
+            double buildTimeSaved; // Seconds
+            size_t numTriangles; // Over all shapes
+            size_t numBytesEstimated; // Vertices, indices and BVH-nodes of all shapes
+        };
+
+        CollisionShapeLibrary();
+        ~CollisionShapeLibrary();
+
+        /**
+         * Computes the key of the given triangle-list
+         * @param triangles Triangle-list, 3 vertices per triangle
+         * @param kind Kind of shape to build from these
+         */
+        static ShapeKey makeKey(const std::vector<Math::float3>& triangles, EShapeKind kind);
+
+        /**
+         * Gets the shape matching the given triangles or builds it, if it doesn't exist yet.
+         * Increases the shapes refcount.
+         * @param triangles Triangle-list, 3 vertices per triangle
+         * @param kind Kind of shape to build from these
+         * @param outKey Key of the returned shape. Pass this to release() once done.
+         * @param alias Optional name of the source-mesh. Allows skipping the hashing on later lookups.
+         * @return Shared shape. nullptr if no triangles were given.
+         */
+        btCollisionShape* acquire(const std::vector<Math::float3>& triangles, EShapeKind kind, ShapeKey& outKey,
+                                  const std::string& alias = "");
+
+        /**
+         * Tries to get a shape only by the alias of its source-mesh. Increases the shapes refcount on success.
+         * @param alias Name of the source-mesh
+         * @param kind Kind of shape
+         * @param outKey Key of the returned shape
+         * @return Shared shape. nullptr if not known yet.
+         */
+        btCollisionShape* acquireByAlias(const std::string& alias, EShapeKind kind, ShapeKey& outKey);
+
+        /**
+         * Decreases the refcount of the given shape. The shape is kept around until purgeUnused() is called.
+         */
+        void release(const ShapeKey& key);
+
+        /**
+         * Deletes all shapes nobody is referencing anymore
+         * @return Number of deleted shapes
+         */
+        size_t purgeUnused();
+
+        /**
+         * @return Current statistics
+         */
+        Stats getStats();
+
+    private:
+
+        struct Entry
+        {
+            btCollisionShape* shape;
+            btTriangleMesh* meshInterface; // Needs to stay alive as long as a BVH-shape uses it
+            size_t refCount;
+            int64_t buildTicks;
+        };
+
+        /**
+         * Creates the actual bullet-shape
+         */
+        static Entry buildShape(const std::vector<Math::float3>& triangles, EShapeKind kind);
+
+        /**
+         * @return Rough size of the data bullet keeps for the given shape
+         */
+        static size_t estimateShapeBytes(const ShapeKey& key, const Entry& e);
+
+        /**
+         * Marks a cache-hit on the given entry
+         */
+        btCollisionShape* onHit(Entry& e);
+
+        /**
+         * Shapes by their content-key
+         */
+        std::unordered_map<ShapeKey, Entry, ShapeKeyHash> m_Shapes;
+
+        /**
+         * Keys by "<kind>:<mesh-name>". Only a shortcut to skip extracting and hashing triangles.
+         */
+        std::unordered_map<std::string, ShapeKey> m_KeysByAlias;
+
+        /**
+         * Counters
+         */
+        size_t m_NumHits;
+        size_t m_NumMisses;
+        int64_t m_BuildTicksSpent;
+        int64_t m_BuildTicksSaved;
+
+        /**
+         * Worlds might get loaded from other threads
+         */
+        std::mutex m_Mutex;
+    };
+}
@@ -8,8 +8,8 @@
 #include <logic/Controller.h>
 #include "DebugDrawer.h"
 #include <engine/World.h>
-#include <BulletCollision/CollisionShapes/btShapeHull.h>
-#include <BulletCollision/CollisionShapes/btConvexHullShape.h>
+#include <engine/BaseEngine.h>
+#include <utils/Profiler.h>
 
 using namespace Physics;
 
@@ -46,7 +46,13 @@ PhysicsSystem::~PhysicsSystem()
 
 	for(size_t i = 0; i < m_CollisionShapeAllocator.getNumObtainedElements(); i++)
 	{
-		CollisionShape::clean(m_CollisionShapeAllocator.getElements()[i]);
+		CollisionShape& cs = m_CollisionShapeAllocator.getElements()[i];
+
+		// Shared shapes stay inside the library for the next world
+		if(cs.isShared)
+			getShapeLibrary().release(cs.libraryKey);
+		else
+			CollisionShape::clean(cs);
 	}
 
     delete m_pDynamicsWorld->getDebugDrawer();
@@ -68,34 +74,36 @@ void PhysicsSystem::debugDraw()
 
 void PhysicsSystem::update(double dt)
 {
+    PROFILE_SCOPE("PhysicsSystem::update");
+
     m_pDynamicsWorld->stepSimulation(static_cast<btScalar>(dt));
 
-    const auto& ctuple = m_World.getComponentDataBundle().m_Data;
-    size_t num = m_World.getComponentDataBundle().m_NumElements;
+    Components::ComponentAllocator& alloc = m_World.getComponentAllocator();
 
     // Copy all physics-transforms to the position-components
-    Components::EntityComponent* ents = std::get<Components::EntityComponent*>(ctuple);
-    Components::PhysicsComponent* phys = std::get<Components::PhysicsComponent*>(ctuple);
-    Components::PositionComponent* pos = std::get<Components::PositionComponent*>(ctuple);
-    Components::LogicComponent* log = std::get<Components::LogicComponent*>(ctuple);
-    Components::VisualComponent* vis = std::get<Components::VisualComponent*>(ctuple);
+    const Components::EntityList& bodies = m_World.query<Components::PhysicsComponent::MASK>();
 
-    for (size_t i = 0; i<num; i++)
+    for (size_t i = 0; i<bodies.size(); i++)
     {
-        Components::ComponentMask mask = ents[i].m_ComponentMask;
+        Handle::EntityHandle e = bodies[i];
+        Components::PhysicsComponent& phys = alloc.getElement<Components::PhysicsComponent>(e);
 
-        if((mask & Components::PhysicsComponent::MASK) != 0 && !phys[i].m_IsStatic)
-        {
-            // Copy to position-component
-            pos[i].m_WorldMatrix = Components::Actions::Physics::getRigidBodyTransform(phys[i]);
+        if(phys.m_IsStatic)
+            continue;
 
-            // Broadcast to others
-            if((mask & Components::LogicComponent::MASK) != 0 && log[i].m_pLogicController)
-                log[i].m_pLogicController->onTransformChanged();
+        Components::ComponentMask mask = alloc.getElement<Components::EntityComponent>(e).m_ComponentMask;
 
-            if((mask & Components::VisualComponent::MASK) != 0 && vis[i].m_pVisualController)
-                vis[i].m_pVisualController->onTransformChanged();
-        }
+        // Copy to position-component
+        alloc.getElement<Components::PositionComponent>(e).m_WorldMatrix = Components::Actions::Physics::getRigidBodyTransform(phys);
+
+        // Broadcast to others
+        Components::LogicComponent* log = alloc.tryGetElement<Components::LogicComponent>(e);
+        if((mask & Components::LogicComponent::MASK) != 0 && log && log->m_pLogicController)
+            log->m_pLogicController->onTransformChanged();
+
+        Components::VisualComponent* vis = alloc.tryGetElement<Components::VisualComponent>(e);
+        if((mask & Components::VisualComponent::MASK) != 0 && vis && vis->m_pVisualController)
+            vis->m_pVisualController->onTransformChanged();
     }
 }
 
@@ -111,12 +119,14 @@ void PhysicsSystem::removeRigidBody(btRigidBody *body)
 
 Handle::CollisionShapeHandle PhysicsSystem::makeCollisionShapeFromMesh(const Meshes::WorldStaticMesh &mesh, CollisionShape::ECollisionType type, const std::string &name)
 {
-    if(m_ShapeCache.find(name) != m_ShapeCache.end())
-        return m_ShapeCache[name];
-
-    // Init collision
-    btTriangleMesh* wm = new btTriangleMesh;
-
+    // Try without touching the mesh-data first
+    Handle::CollisionShapeHandle csh = acquireSharedShape({}, CollisionShapeLibrary::SK_TriangleMesh,
+                                                          CollisionShape::TriangleMesh, type, name);
+    if(csh.isValid())
+        return csh;
+
+    // Collect triangles
+    std::vector<Math::float3> triangles;
     for(size_t s=0;s<mesh.mesh.m_SubmeshStarts.size();s++)
     {
         if(!mesh.mesh.m_SubmeshMaterials[s].m_NoCollision)
@@ -125,115 +135,108 @@ Handle::CollisionShapeHandle PhysicsSystem::makeCollisionShapeFromMesh(const Mes
             {
                 size_t i = mesh.mesh.m_SubmeshStarts[s].m_StartIndex + j;
 
-                // TODO: Filter no-collision materials
-                auto &v0 = mesh.mesh.m_Vertices[mesh.mesh.m_Indices[i]].Position;
-                auto &v1 = mesh.mesh.m_Vertices[mesh.mesh.m_Indices[i + 1]].Position;
-                auto &v2 = mesh.mesh.m_Vertices[mesh.mesh.m_Indices[i + 2]].Position;
-
-                // Convert to btvector
-                btVector3 v[] = {{v0.x, v0.y, v0.z},
-                                 {v1.x, v1.y, v1.z},
-                                 {v2.x, v2.y, v2.z}};
-                wm->addTriangle(v[0], v[1], v[2]);
+                triangles.push_back(mesh.mesh.m_Vertices[mesh.mesh.m_Indices[i]].Position);
+                triangles.push_back(mesh.mesh.m_Vertices[mesh.mesh.m_Indices[i + 1]].Position);
+                triangles.push_back(mesh.mesh.m_Vertices[mesh.mesh.m_Indices[i + 2]].Position);
             }
         }
     }
 
-    if(wm->getNumTriangles() == 0)
-    {
-        delete wm;
+    return acquireSharedShape(triangles, CollisionShapeLibrary::SK_TriangleMesh, CollisionShape::TriangleMesh, type, name);
+}
+
+Handle::CollisionShapeHandle PhysicsSystem::makeCollisionShapeFromMesh(const std::vector<Math::float3> triangles,
+                                                                       CollisionShape::ECollisionType type,
+                                                                       const std::string &name)
+{
+    if(triangles.empty())
         return Handle::CollisionShapeHandle::makeInvalidHandle();
-    }
 
+    return acquireSharedShape(triangles, CollisionShapeLibrary::SK_TriangleMesh, CollisionShape::TriangleMesh, type, name);
+}
+
+
+Handle::CollisionShapeHandle PhysicsSystem::makeCompoundCollisionShape(CollisionShape::ECollisionType type)
+{
     Handle::CollisionShapeHandle csh = m_CollisionShapeAllocator.createObject();
     CollisionShape& cs = getCollisionShape(csh);
-    cs.collisionShape = new btBvhTriangleMeshShape(wm, true);
-    cs.shapeType = CollisionShape::TriangleMesh;
+
+    // TODO: Find out if "dynamicAABBTree" can be set to false for performance?
+    cs.collisionShape = new btCompoundShape();
+    cs.shapeType = CollisionShape::Compound;
     cs.collisionType = type;
+    cs.isShared = false;
 
     cs.collisionShape->setUserIndex(csh.index);
 
-    if(!name.empty())
-        m_ShapeCache[name] = csh;
-
     return csh;
 }
 
-Handle::CollisionShapeHandle PhysicsSystem::makeCollisionShapeFromMesh(const std::vector<Math::float3> triangles,
-                                                                       CollisionShape::ECollisionType type,
-                                                                       const std::string &name)
+Handle::CollisionShapeHandle PhysicsSystem::acquireSharedShape(const std::vector<Math::float3>& triangles,
+                                                               CollisionShapeLibrary::EShapeKind kind,
+                                                               CollisionShape::EShapeType shapeType,
+                                                               CollisionShape::ECollisionType collisionType,
+                                                               const std::string& alias)
 {
-    if(m_ShapeCache.find(name) != m_ShapeCache.end())
-        return m_ShapeCache[name];
+    CollisionShapeLibrary& lib = getShapeLibrary();
 
-    // Init collision
-    btTriangleMesh* wm = new btTriangleMesh;
+    SharedShapeKey sk;
+    sk.collisionType = collisionType;
 
-    for(size_t i=0;i<triangles.size();i+=3)
-    {
-        // Convert to btvector
-        btVector3 v[] = {{triangles[i].x,   triangles[i].y,   triangles[i].z},
-                         {triangles[i+1].x, triangles[i+1].y, triangles[i+1].z},
-                         {triangles[i+2].x, triangles[i+2].y, triangles[i+2].z}};
+    btCollisionShape* shape;
+    if(triangles.empty())
+        shape = lib.acquireByAlias(alias, kind, sk.key);
+    else
+        shape = lib.acquire(triangles, kind, sk.key, alias);
 
-        wm->addTriangle(v[0], v[1], v[2]);
-    }
+    if(!shape)
+        return Handle::CollisionShapeHandle::makeInvalidHandle();
 
-    if(wm->getNumTriangles() == 0)
+    // Already wrapped by this system? Only keep a single reference per world then.
+    auto it = m_SharedShapes.find(sk);
+    if(it != m_SharedShapes.end())
     {
-        delete wm;
-        return Handle::CollisionShapeHandle::makeInvalidHandle();
+        lib.release(sk.key);
+        return (*it).second;
     }
 
     Handle::CollisionShapeHandle csh = m_CollisionShapeAllocator.createObject();
     CollisionShape& cs = getCollisionShape(csh);
-    cs.collisionShape = new btBvhTriangleMeshShape(wm, true);
-    cs.shapeType = CollisionShape::TriangleMesh;
-    cs.collisionType = type;
-
-    cs.collisionShape->setUserIndex(csh.index);
+    cs.collisionShape = shape;
+    cs.shapeType = shapeType;
+    cs.collisionType = collisionType;
+    cs.isShared = true;
+    cs.libraryKey = sk.key;
 
-    if(!name.empty())
-        m_ShapeCache[name] = csh;
+    m_SharedShapes[sk] = csh;
 
     return csh;
 }
 
-
-Handle::CollisionShapeHandle PhysicsSystem::makeCompoundCollisionShape(CollisionShape::ECollisionType type, const std::string &name)
+CollisionShapeLibrary& PhysicsSystem::getShapeLibrary()
 {
-    if(m_ShapeCache.find(name) != m_ShapeCache.end())
-        return m_ShapeCache[name];
-
-    Handle::CollisionShapeHandle csh = m_CollisionShapeAllocator.createObject();
-    CollisionShape& cs = getCollisionShape(csh);
-
-    // TODO: Find out if "dynamicAABBTree" can be set to false for performance?
-    cs.collisionShape = new btCompoundShape();
-    cs.shapeType = CollisionShape::Compound;
-    cs.collisionType = type;
-
-    cs.collisionShape->setUserIndex(csh.index);
-
-    if(!name.empty())
-        m_ShapeCache[name] = csh;
-
-    return csh;
+    assert(m_World.getEngine());
+    return m_World.getEngine()->getCollisionShapeLibrary();
 }
 
 void PhysicsSystem::deleteCollisionShape(Handle::CollisionShapeHandle shape)
 {
-    // Remove from convex-cache
-    for(auto& c : m_ShapeCache)
+    CollisionShape& cs = getCollisionShape(shape);
+
+    if(cs.isShared)
     {
-        if(c.second == shape)
-        {
-            m_ShapeCache.erase(c.first);
-            break;
-        }
-    }
+        SharedShapeKey sk;
+        sk.key = cs.libraryKey;
+        sk.collisionType = cs.collisionType;
 
+        m_SharedShapes.erase(sk);
+        getShapeLibrary().release(cs.libraryKey);
+    }else
+    {
+        CollisionShape::clean(cs);
+    }
 
+    m_CollisionShapeAllocator.removeObject(shape);
 }
 
 Handle::CollisionShapeHandle PhysicsSystem::makeBoxCollisionShape(const Math::float3 &halfExtends)
@@ -245,6 +248,7 @@ Handle::CollisionShapeHandle PhysicsSystem::makeBoxCollisionShape(const Math::fl
     cs.collisionShape = s;
     cs.shapeType = CollisionShape::Box;
     cs.collisionType = CollisionShape::CT_Any;
+    cs.isShared = false;
 
     cs.collisionShape->setUserIndex(csh.index);
 
@@ -344,13 +348,13 @@ RayTestResult PhysicsSystem::raytrace(const Math::float3 &from, const Math::floa
 
 Handle::CollisionShapeHandle PhysicsSystem::makeConvexCollisionShapeFromMesh(const Meshes::WorldStaticMesh &mesh, const std::string &name)
 {
-    if(m_ShapeCache.find(name) != m_ShapeCache.end())
-        return m_ShapeCache[name];
-
-
-    // Init collision
-    btTriangleMesh* wm = new btTriangleMesh;
+    Handle::CollisionShapeHandle csh = acquireSharedShape({}, CollisionShapeLibrary::SK_ConvexHull,
+                                                          CollisionShape::ConvexMesh, CollisionShape::CT_Any, name);
+    if(csh.isValid())
+        return csh;
 
+    // Collect triangles
+    std::vector<Math::float3> triangles;
     for(size_t s=0;s<mesh.mesh.m_SubmeshStarts.size();s++)
     {
         for(size_t j=0;j<mesh.mesh.m_SubmeshStarts[s].m_NumIndices;j+=3)
@@ -358,41 +362,13 @@ Handle::CollisionShapeHandle PhysicsSystem::makeConvexCollisionShapeFromMesh(con
             size_t i = mesh.mesh.m_SubmeshStarts[s].m_StartIndex + j;
 
             // TODO: Filter no-collision materials
-            auto &v0 = mesh.mesh.m_Vertices[mesh.mesh.m_Indices[i]].Position;
-            auto &v1 = mesh.mesh.m_Vertices[mesh.mesh.m_Indices[i + 1]].Position;
-            auto &v2 = mesh.mesh.m_Vertices[mesh.mesh.m_Indices[i + 2]].Position;
-
-            // Convert to btvector
-            btVector3 v[] = {{v0.x, v0.y, v0.z},
-                             {v1.x, v1.y, v1.z},
-                             {v2.x, v2.y, v2.z}};
-            wm->addTriangle(v[0], v[1], v[2]);
+            triangles.push_back(mesh.mesh.m_Vertices[mesh.mesh.m_Indices[i]].Position);
+            triangles.push_back(mesh.mesh.m_Vertices[mesh.mesh.m_Indices[i + 1]].Position);
+            triangles.push_back(mesh.mesh.m_Vertices[mesh.mesh.m_Indices[i + 2]].Position);
         }
     }
 
-    btConvexShape* tmpShape = new btConvexTriangleMeshShape(wm);
-    btShapeHull* hull = new btShapeHull(tmpShape);
-
-    btScalar margin = tmpShape->getMargin();
-    hull->buildHull(margin);
-    tmpShape->setUserPointer(hull);
-
-    btConvexHullShape* simplifiedConvexShape = new btConvexHullShape((btScalar*)hull->getVertexPointer(),hull->numVertices());
-
-    Handle::CollisionShapeHandle csh = m_CollisionShapeAllocator.createObject();
-    CollisionShape& cs = getCollisionShape(csh);
-    cs.collisionShape = simplifiedConvexShape;
-    cs.shapeType = CollisionShape::ConvexMesh;
-
-    cs.collisionShape->setUserIndex(-1);
-
-    delete tmpShape;
-    delete hull;
-
-    if(!name.empty())
-        m_ShapeCache[name] = csh;
-
-    return csh;
+    return acquireSharedShape(triangles, CollisionShapeLibrary::SK_ConvexHull, CollisionShape::ConvexMesh, CollisionShape::CT_Any, name);
 }
 
 Handle::PhysicsObjectHandle
@@ -430,3 +406,48 @@ void PhysicsSystem::postProcessLoad()
     m_pDynamicsWorld->updateAabbs();
 }
 
+
+Memory::AllocatorStats PhysicsSystem::getPhysicsObjectStats()
+{
+    Memory::AllocatorStats s = m_PhysicsObjectAllocator.getStats();
+
+    for(size_t i = 0; i < m_PhysicsObjectAllocator.getNumObtainedElements(); i++)
+    {
+        if(m_PhysicsObjectAllocator.getElements()[i].rigidBody)
+            s.numBytesPayload += sizeof(btRigidBody);
+    }
+
+    return s;
+}
+
+Memory::AllocatorStats PhysicsSystem::getCollisionShapeStats()
+{
+    Memory::AllocatorStats s = m_CollisionShapeAllocator.getStats();
+
+    for(size_t i = 0; i < m_CollisionShapeAllocator.getNumObtainedElements(); i++)
+    {
+        const CollisionShape& cs = m_CollisionShapeAllocator.getElements()[i];
+
+        if(cs.isShared || !cs.collisionShape)
+            continue;
+
+        switch(cs.shapeType)
+        {
+            case CollisionShape::Box:
+                s.numBytesPayload += sizeof(btBoxShape);
+                break;
+
+            case CollisionShape::Compound:
+                s.numBytesPayload += sizeof(btCompoundShape)
+                                     + static_cast<btCompoundShape*>(cs.collisionShape)->getNumChildShapes()
+                                       * sizeof(btCompoundShapeChild);
+                break;
+
+            default:
+                s.numBytesPayload += sizeof(btCollisionShape);
+                break;
+        }
+    }
+
+    return s;
+}
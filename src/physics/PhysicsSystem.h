@@ -2,6 +2,8 @@
 #include <btBulletDynamicsCommon.h>
 #include <BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
 #include <content/StaticMeshAllocator.h>
+#include <memory/ChunkedReferencedAllocator.h>
+#include "CollisionShapeLibrary.h"
 
 namespace World
 {
@@ -43,9 +45,17 @@ namespace Physics
         EShapeType shapeType;
         ECollisionType collisionType;
 
+        /**
+         * Whether collisionShape is owned by the engines CollisionShapeLibrary. If so, it must be
+         * released using libraryKey instead of being deleted.
+         */
+        bool isShared;
+        CollisionShapeLibrary::ShapeKey libraryKey;
+
         static void clean(CollisionShape& s)
         {
-            delete s.collisionShape;
+            if(!s.isShared)
+                delete s.collisionShape;
         }
     };
 
@@ -87,8 +97,8 @@ namespace Physics
     /**
      * Default allocator-type
      */
-    typedef Memory::StaticReferencedAllocator<PhysicsObject, Config::MAX_NUM_LEVEL_ENTITIES> PhysicsObjectAllocator;
-    typedef Memory::StaticReferencedAllocator<CollisionShape, Config::MAX_NUM_LEVEL_ENTITIES> CollisionShapeAllocator;
+    typedef Memory::ChunkedReferencedAllocator<PhysicsObject, Config::MAX_NUM_LEVEL_ENTITIES> PhysicsObjectAllocator;
+    typedef Memory::ChunkedReferencedAllocator<CollisionShape, Config::MAX_NUM_LEVEL_ENTITIES> CollisionShapeAllocator;
 
     class PhysicsSystem
     {
@@ -120,8 +130,10 @@ namespace Physics
         btDiscreteDynamicsWorld* getDynamicsWorld(){ return m_pDynamicsWorld; }
 
         /**
-         * Creates a new collisionshape from the given mesh
+         * Creates a new collisionshape from the given mesh. The underlaying BVH is taken from the engines
+         * CollisionShapeLibrary, so identical meshes are only built once, even across worlds.
          * @param mesh Mesh to use as base
+         * @param name Name of the source-mesh. Used as shortcut for the library-lookup.
          * @return Static collision-shape using this mesh
          */
         Handle::CollisionShapeHandle makeCollisionShapeFromMesh(const Meshes::WorldStaticMesh& mesh, CollisionShape::ECollisionType type = CollisionShape::CT_Any, const std::string &name = "");
@@ -144,10 +156,9 @@ namespace Physics
 
         /**
          * Creates a compound-shape, being able to store multiple sub-shapes inside
-         * @param name Cache-name of this shape
          * @return Handle to the created shape
          */
-        Handle::CollisionShapeHandle makeCompoundCollisionShape(CollisionShape::ECollisionType type = CollisionShape::CT_Any, const std::string& name = "");
+        Handle::CollisionShapeHandle makeCompoundCollisionShape(CollisionShape::ECollisionType type = CollisionShape::CT_Any);
 
         /**
          * Creates a new rigid-body using the given collision-shape
@@ -167,7 +178,8 @@ namespace Physics
         void compoundShapeAddChild(Handle::CollisionShapeHandle target, Handle::CollisionShapeHandle childShape, const Math::Matrix& localTransform = Math::Matrix::CreateIdentity());
 
         /**
-         * Deletes a collisionshape from the cache
+         * Deletes a collisionshape. Shared shapes are given back to the library.
+         * Note: The shape must not be used by any rigid-body or compound-shape anymore!
          */
         void deleteCollisionShape(Handle::CollisionShapeHandle shape);
 
@@ -195,8 +207,44 @@ namespace Physics
             return m_CollisionShapeAllocator.getElement(h);
         }
 
+        /**
+         * @return Memory currently committed for physics-objects and collision-shapes
+         */
+        size_t getNumCommittedBytes()
+        {
+            return m_PhysicsObjectAllocator.getNumCommittedBytes() + m_CollisionShapeAllocator.getNumCommittedBytes();
+        }
+
+        /**
+         * @return Usage of the physics-object allocator. The payload are the rigid-bodies.
+         */
+        Memory::AllocatorStats getPhysicsObjectStats();
+
+        /**
+         * @return Usage of the collision-shape allocator. The payload are the shapes owned by this system,
+         *         shapes shared through the library are accounted there.
+         */
+        Memory::AllocatorStats getCollisionShapeStats();
+
     private:
 
+        /**
+         * Gets a shape from the engines shape-library and wraps it into a collision-shape of this system.
+         * Uses the same local shape if this system already references the library-shape.
+         * @param triangles Triangles to build from. If empty, only the alias is tried.
+         * @return Invalid handle, if no shape could be created
+         */
+        Handle::CollisionShapeHandle acquireSharedShape(const std::vector<Math::float3>& triangles,
+                                                        CollisionShapeLibrary::EShapeKind kind,
+                                                        CollisionShape::EShapeType shapeType,
+                                                        CollisionShape::ECollisionType collisionType,
+                                                        const std::string& alias);
+
+        /**
+         * @return The engine-wide shape library
+         */
+        CollisionShapeLibrary& getShapeLibrary();
+
         /**
          * Adds an internal rigid-body to the system
          */
@@ -239,8 +287,28 @@ namespace Physics
         CollisionShapeAllocator m_CollisionShapeAllocator;
 
         /**
-         * Map of collision-shapes by name
+         * Local shapes referencing a shape of the library, by the library-key and collision-type.
+         * Each entry holds exactly one reference to the library.
          */
-        std::unordered_map<std::string, Handle::CollisionShapeHandle> m_ShapeCache;
+        struct SharedShapeKey
+        {
+            CollisionShapeLibrary::ShapeKey key;
+            CollisionShape::ECollisionType collisionType;
+
+            bool operator==(const SharedShapeKey& o) const
+            {
+                return key == o.key && collisionType == o.collisionType;
+            }
+        };
+
+        struct SharedShapeKeyHash
+        {
+            size_t operator()(const SharedShapeKey& k) const
+            {
+                return CollisionShapeLibrary::ShapeKeyHash()(k.key) ^ static_cast<size_t>(k.collisionType + 1);
+            }
+        };
+
+        std::unordered_map<SharedShapeKey, Handle::CollisionShapeHandle, SharedShapeKeyHash> m_SharedShapes;
     };
 }
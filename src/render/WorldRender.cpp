@@ -7,6 +7,7 @@
 #include <engine/Waynet.h>
 #include <debugdraw/debugdraw.h>
 #include <utils/logger.h>
+#include <utils/Profiler.h>
 
 #include <logic/Controller.h>
 
@@ -65,6 +66,8 @@ namespace Render
 	 */
 	void drawWorld(World::WorldInstance& world, const RenderConfig& config, RenderSystem& system)
 	{
+        PROFILE_SCOPE("Render::drawWorld");
+
 		// Setup sky and fog
         setupSky(world, config);
 
@@ -73,18 +76,41 @@ namespace Render
 		const float drawDistance2 = config.state.drawDistanceSquared;
 
 		// Draw all components
-		const auto& ctuple = world.getComponentDataBundle().m_Data;
-		size_t num = world.getComponentDataBundle().m_NumElements;
+		Components::ComponentAllocator& alloc = world.getComponentAllocator();
 
 		auto& meshes = world.getStaticMeshAllocator();
 		auto& skelmeshes = world.getSkeletalMeshAllocator();
-		Components::StaticMeshComponent* sms = std::get<Components::StaticMeshComponent*>(ctuple);
-		Components::PositionComponent* psc = std::get<Components::PositionComponent*>(ctuple);
-		Components::EntityComponent* ents = std::get<Components::EntityComponent*>(ctuple);
-		Components::BBoxComponent* bboxes = std::get<Components::BBoxComponent*>(ctuple);
-		Components::LogicComponent* logics = std::get<Components::LogicComponent*>(ctuple);
-		Components::AnimationComponent* animations = std::get<Components::AnimationComponent*>(ctuple);
-		Components::PhysicsComponent* physics = std::get<Components::PhysicsComponent*>(ctuple);
+
+		// Only entities with a static mesh are drawn, so go through those directly
+		size_t num = alloc.getNumElements<Components::StaticMeshComponent>();
+		Components::StaticMeshComponent* sms = alloc.getElements<Components::StaticMeshComponent>();
+		const Handle::EntityHandle* smOwners = alloc.getOwners<Components::StaticMeshComponent>();
+
+		static const Math::Matrix s_Identity = Math::Matrix::CreateIdentity();
+
+		/**
+		 * Gets the world-matrix of the given entity and checks whether it's inside the draw-distance
+		 */
+		auto getTransformInRange = [&](Handle::EntityHandle e) -> const Math::Matrix*
+		{
+			Components::PositionComponent* psc = alloc.tryGetElement<Components::PositionComponent>(e);
+			if(!psc)
+				return &s_Identity;
+
+			// Simple distance-check // TODO: Frustum/Occlusion-Culling
+			float distance2 = (psc->m_WorldMatrix.Translation() - cameraPosition).lengthSquared();
+
+			//if(pos.Translation().lengthSquared() < 0.01f && psc->m_DrawDistanceFactor > 0)
+			//   return nullptr; // FIXME: HACK, against many many drawcalls in the center of the world
+
+			if(psc->m_DrawDistanceFactor >= 0)
+			{
+				if (distance2 > drawDistance2 * psc->m_DrawDistanceFactor)
+					return nullptr;
+			}
+
+			return &psc->m_WorldMatrix;
+		};
 
 		// Static mesh instancing
 		struct InstanceData
@@ -116,14 +142,8 @@ namespace Render
         size_t numSubmeshesDrawn = 0;
 		for (size_t i = 0; i<num; i++)
 		{
-			// Simple distance-check // TODO: Frustum/Occlusion-Culling
-			auto& pos = psc[i].m_WorldMatrix;
-			float distance2 = (pos.Translation() - cameraPosition).lengthSquared();
-
-            //if(pos.Translation().lengthSquared() < 0.01f && psc[i].m_DrawDistanceFactor > 0)
-             //   continue; // FIXME: HACK, against many many drawcalls in the center of the world
-
-			Components::ComponentMask mask = ents[i].m_ComponentMask;
+			Handle::EntityHandle e = smOwners[i];
+			Components::ComponentMask mask = alloc.getElement<Components::EntityComponent>(e).m_ComponentMask;
 
 			// FIXME: Temporary
 			/*if((mask & Components::PhysicsComponent::MASK) != 0)
@@ -131,11 +151,11 @@ namespace Render
 				 physics[i].m_RigidBody.setDebugDrawEnabled(psc[i].m_DrawDistanceFactor > 0.0f &&  distance2 < 10.0f * 10.0f);
 			}*/
 
-            if(psc[i].m_DrawDistanceFactor >= 0)
-            {
-                if (distance2 > drawDistance2 * psc[i].m_DrawDistanceFactor)
-                    continue;
-            }
+			const Math::Matrix* transform = getTransformInRange(e);
+			if(!transform)
+				continue;
+
+			const Math::Matrix& pos = *transform;
 
 			if ((mask & Components::StaticMeshComponent::MASK) != 0)
 			{
@@ -167,21 +187,28 @@ namespace Render
 					color.fromRGBA8(sms[i].m_Color);
 					bgfx::setUniform(config.uniforms.objectColor, color.v);
 
+					// Only look the handler up, rendering must not take any from the pool
+					Components::AnimationComponent& animation = alloc.getElement<Components::AnimationComponent>(e);
 					Components::AnimHandler* animHandler = nullptr;
-					if(animations[i].m_ParentAnimHandler.isValid())
+					if(animation.m_ParentAnimHandler.isValid())
 					{
-						Components::AnimationComponent& pac = world.getEntity<Components::AnimationComponent>(animations[i].m_ParentAnimHandler);
-						animHandler = &pac.getAnimHandler();
+						animHandler = world.tryGetAnimHandler(animation.m_ParentAnimHandler);
 					} else
 					{
-						animHandler = &animations[i].getAnimHandler();
+						animHandler = world.tryGetAnimHandler(e);
 					}
 
 					//animHandler->debugDrawSkeleton(pos);
 
-					// Copy everything to the temporary skeletal instance
+					// Copy everything to the temporary skeletal instance. Without a handler, there are no nodes to
+					// move, same as for a handler without a mesh-lib.
                     Math::Matrix nodeMat[ZenLoad::MAX_NUM_SKELETAL_NODES + 1];
-					animHandler->updateSkeletalMeshInfo(nodeMat + 1, ZenLoad::MAX_NUM_SKELETAL_NODES);
+					size_t numNodes = 0;
+					if(animHandler)
+					{
+						animHandler->updateSkeletalMeshInfo(nodeMat + 1, ZenLoad::MAX_NUM_SKELETAL_NODES);
+						numNodes = animHandler->getNumNodes();
+					}
                     nodeMat[0] = pos;
 
 					// They are vec4 inside the shader, thus numMatrices * 4
@@ -190,7 +217,7 @@ namespace Render
 
                     //float f[] = {1.0f, 0.0f, 0.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f};
                     //bgfx::setUniform(config.uniforms.nodeTransforms, f, 2);
-                    bgfx::setTransform(nodeMat, static_cast<uint16_t>(animHandler->getNumNodes() + 1));
+                    bgfx::setTransform(nodeMat, static_cast<uint16_t>(numNodes + 1));
 
 					auto& mesh = skelmeshes.getMesh(sms[i].m_StaticMeshVisual);
 					bgfx::setVertexBuffer(mesh.m_VertexBufferHandle);
@@ -277,33 +304,44 @@ namespace Render
 				//bgfx::submit(0, config.programs.mainWorldProgram);
 			}
 
-			if ((mask & Components::BBoxComponent::MASK) != 0)
-			{
-				if(bboxes[i].m_DebugColor != 0)
-				{
-					Aabb box = {bboxes[i].m_BBox3D.min.x, bboxes[i].m_BBox3D.min.y, bboxes[i].m_BBox3D.min.z,
-								bboxes[i].m_BBox3D.max.x, bboxes[i].m_BBox3D.max.y, bboxes[i].m_BBox3D.max.z};
-
-					ddPush();
-					Math::Matrix m = Math::Matrix::CreateIdentity();
-					m.Translation(pos.Translation());
-					ddSetTransform(m.mv);
-					ddSetColor(bboxes[i].m_DebugColor);
-					ddDraw(box);
-					ddPop();
-				}
-			}
+		}
+
+		// Debug-visualizations
+		{
+			const Components::EntityList& bboxes = world.query<Components::BBoxComponent::MASK>();
 
-			if((mask & Components::LogicComponent::MASK) != 0)
+			for (Handle::EntityHandle e : bboxes)
 			{
-				if(logics[i].m_pLogicController)
-				{
-					logics[i].m_pLogicController->onDebugDraw();
-				}
+				Components::BBoxComponent& bbox = alloc.getElement<Components::BBoxComponent>(e);
+				if(bbox.m_DebugColor == 0)
+					continue;
+
+				const Math::Matrix* pos = getTransformInRange(e);
+				if(!pos)
+					continue;
+
+				Aabb box = {bbox.m_BBox3D.min.x, bbox.m_BBox3D.min.y, bbox.m_BBox3D.min.z,
+							bbox.m_BBox3D.max.x, bbox.m_BBox3D.max.y, bbox.m_BBox3D.max.z};
+
+				ddPush();
+				Math::Matrix m = Math::Matrix::CreateIdentity();
+				m.Translation(pos->Translation());
+				ddSetTransform(m.mv);
+				ddSetColor(bbox.m_DebugColor);
+				ddDraw(box);
+				ddPop();
 			}
 
+			const Components::EntityList& logics = world.query<Components::LogicComponent::MASK>();
 
+			for (size_t i = 0; i<logics.size(); i++)
+			{
+				Handle::EntityHandle e = logics[i];
+				Components::LogicComponent& logic = alloc.getElement<Components::LogicComponent>(e);
 
+				if(logic.m_pLogicController && getTransformInRange(e))
+					logic.m_pLogicController->onDebugDraw();
+			}
 		}
 
 		// Now draw instances
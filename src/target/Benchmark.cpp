@@ -0,0 +1,369 @@
+/**
+ * Headless benchmark-runner. Runs the engine on bgfx's null-renderer without a window for a fixed number of frames
+ * at a fixed timestep and writes how long the stages of each frame took as JSON, so runs can be compared
+ * against each other.
+ *
+ * Usage: REGoth-bench -g <game-root> [-w <world.zen>] [--synthetic <numVobs>] [--frames <n>] [--warmup <n>]
+ *                     [--dt <seconds>] [--seed <n>] [--ai-ticks <n>] [--out <file.json>] [--trace <file.json>]
+ *        REGoth-bench -g <game-root> --replay <file> [--out <file.json>] [--trace <file.json>]
+ *        REGoth-bench -g <game-root> [-w <world.zen>] --micro "<name> [args]" [--out <file.json>]
+ *
+ * Without --synthetic, the world given by -w is loaded from the game-files, just like REGoth does. With it,
+ * an empty world is filled with a generated vob-tree instead, which only needs whatever visuals the game-files
+ * have (if any).
+ *
+ * --replay runs an input-recording made with "REGoth --record <file>" instead, using its world, seed and
+ * delta-times. All frames of the recording are measured and the hero-position is checked for drift along the way.
+ *
+ * The AI-scheduler ticks a fixed number of NPCs per frame (--ai-ticks, 0 for its usual time-budget), so the
+ * simulated work doesn't depend on how fast the machine is. Replays always use the number they were recorded with.
+ *
+ * --micro runs one of the benchmarks of MicroBenchmarks.h on the loaded world instead of simulating frames.
+ * "--micro help" lists them.
+ *
+ * --trace additionally records the measured frames with the zone-profiler and writes them as Chrome-trace.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+#include <bgfx/bgfx.h>
+#include <bx/timer.h>
+#include <bx/commandline.h>
+#include <debugdraw/debugdraw.h>
+#include <engine/GameEngine.h>
+#include <engine/LoadBenchmark.h>
+#include <engine/InputRecording.h>
+#include <content/VertexTypes.h>
+#include <utils/logger.h>
+#include <utils/Profiler.h>
+#include <json.hpp>
+#include "MicroBenchmarks.h"
+
+using json = nlohmann::json;
+
+namespace
+{
+    /**
+     * Per-frame samples of one stage, in milliseconds
+     */
+    struct Samples
+    {
+        std::vector<double> ms;
+
+        json toJSON() const
+        {
+            json j;
+
+            if(ms.empty())
+                return j;
+
+            std::vector<double> sorted = ms;
+            std::sort(sorted.begin(), sorted.end());
+
+            double sum = 0.0;
+            for(double v : sorted)
+                sum += v;
+
+            j["mean"] = sum / sorted.size();
+            j["median"] = sorted[sorted.size() / 2];
+            j["p95"] = sorted[std::min(sorted.size() - 1, sorted.size() * 95 / 100)];
+            j["min"] = sorted.front();
+            j["max"] = sorted.back();
+            j["total"] = sum;
+
+            return j;
+        }
+    };
+
+    const char* findOption(const bx::CommandLine& cmdLine, const char* name, const char* def)
+    {
+        const char* value = cmdLine.findOption(name);
+        return value ? value : def;
+    }
+
+    struct Options
+    {
+        size_t numFrames;
+        size_t numWarmup;
+        double dt;
+        uint32_t seed;
+        size_t numSyntheticVobs;
+        std::string outFile;
+        std::string traceFile;
+        std::string replayFile;
+        std::string microBenchmark; // Name and arguments, separated by spaces
+        uint32_t aiTicksPerFrame;
+    };
+
+    /**
+     * Runs the micro-benchmark given by --micro and writes its result
+     * @return Exit-code
+     */
+    int runMicroBenchmark(Engine::GameEngine& engine, const Options& o, const std::string& worldName)
+    {
+        std::vector<std::string> args;
+        std::istringstream ss(o.microBenchmark);
+        for(std::string arg; ss >> arg;)
+            args.push_back(arg);
+
+        if(args.empty() || args[0] == "help")
+        {
+            for(const std::string& usage : MicroBenchmarks::getUsage())
+                LogInfo() << "Benchmark: --micro \"" << usage << "\"";
+
+            return 0;
+        }
+
+        // The benchmarks parse their own arguments and throw on bad ones
+        std::string result;
+        std::string error;
+        try
+        {
+            if(!MicroBenchmarks::run(engine, args, result))
+                error = "Unknown micro-benchmark: " + o.microBenchmark;
+        }
+        catch(const std::exception& e)
+        {
+            error = "Micro-benchmark failed: " + o.microBenchmark + " (" + e.what() + ")";
+        }
+
+        if(!error.empty())
+        {
+            LogError() << "Benchmark: " << error << ". Available are:";
+            for(const std::string& usage : MicroBenchmarks::getUsage())
+                LogError() << " - " << usage;
+
+            return 1;
+        }
+
+        LogInfo() << "Benchmark: " << args[0] << ": " << result;
+
+        json j;
+        j["world"] = worldName;
+        j["seed"] = o.seed;
+        j["micro"] = o.microBenchmark;
+        j["result"] = result;
+
+        std::ofstream f(o.outFile);
+        f << j.dump(4);
+        f.close();
+
+        return f.fail() ? 1 : 0;
+    }
+
+    /**
+     * Loads the world, runs the frames and writes the results. Everything around it has to be set up already.
+     * @return Exit-code
+     */
+    int runBenchmark(Engine::GameEngine& engine, const Options& o, const Engine::InputRecording::Recording& recording,
+                     uint16_t width, uint16_t height)
+    {
+        std::string worldName = o.numSyntheticVobs ? "" : engine.getEngineArgs().startupZEN;
+
+        if(!o.replayFile.empty())
+            worldName = recording.world;
+        Handle::WorldHandle w = engine.addWorld(worldName);
+
+        if(!w.isValid())
+        {
+            LogError() << "Benchmark: Failed to load world: " << worldName;
+            return 1;
+        }
+
+        if(o.numSyntheticVobs && o.replayFile.empty())
+        {
+            World::WorldInstance& world = w.get();
+
+            std::vector<std::string> visuals = Engine::LoadBenchmark::findStaticVisuals(engine, 100);
+            world.getPhysicsSystem().postProcessLoad();
+            world.insertVobs(Engine::LoadBenchmark::makeSyntheticVobTree(o.numSyntheticVobs, visuals, o.seed));
+
+            worldName = "synthetic-" + std::to_string(o.numSyntheticVobs);
+        }
+
+        w.get().getAIScheduler().getConfig().ticksPerFrame = o.aiTicksPerFrame;
+
+        if(!o.microBenchmark.empty())
+            return runMicroBenchmark(engine, o, worldName);
+
+        LogInfo() << "Benchmark: Running " << o.numFrames << " frames (" << o.numWarmup << " warmup) of "
+                  << o.dt * 1000.0 << "ms on " << worldName << " (seed " << o.seed << ")";
+
+        // Scripts are measured through the profiler, take its overhead into account when reading the numbers
+        Logic::ScriptProfiler& scriptProfiler = w.get().getScriptEngine().getProfiler();
+        scriptProfiler.setEnabled(true);
+
+        Engine::InputRecording::Player replay(recording);
+
+        Samples frame, physics, logic, animation, renderSubmit, scripts;
+        const double freq = double(bx::getHPFrequency());
+
+        for(size_t i = 0; i < o.numWarmup + o.numFrames; i++)
+        {
+            if(i == o.numWarmup)
+            {
+                scriptProfiler.reset();
+
+                if(!o.traceFile.empty())
+                    Utils::Profiler::startCapture(o.numFrames, o.traceFile);
+            }
+
+            double scriptsBefore = scriptProfiler.getTotalTime();
+            int64_t start = bx::getHPCounter();
+
+            double frameDt = o.dt;
+            if(!o.replayFile.empty())
+                frameDt = replay.beginFrame();
+
+            ddBegin(0);
+            engine.frameUpdate(frameDt, width, height);
+            ddEnd();
+
+            if(!o.replayFile.empty())
+                replay.endFrame(engine);
+
+            bgfx::frame();
+
+            Utils::Profiler::onFrameEnd();
+
+            double frameTime = (bx::getHPCounter() - start) / freq;
+
+            if(i < o.numWarmup)
+                continue;
+
+            const World::WorldInstance::FrameTimings& t = w.get().getLastFrameTimings();
+
+            frame.ms.push_back(frameTime * 1000.0);
+            physics.ms.push_back(t.physics * 1000.0);
+            logic.ms.push_back(t.logic * 1000.0);
+            animation.ms.push_back(t.animation * 1000.0);
+            renderSubmit.ms.push_back(engine.getLastDrawTime() * 1000.0);
+            scripts.ms.push_back((scriptProfiler.getTotalTime() - scriptsBefore) * 1000.0);
+        }
+
+        json j;
+        j["world"] = worldName;
+        j["seed"] = o.seed;
+        j["aiTicksPerFrame"] = o.aiTicksPerFrame;
+        j["frames"] = o.numFrames;
+        j["warmup"] = o.numWarmup;
+        j["timestep"] = o.replayFile.empty() ? json(o.dt) : json("recorded");
+        j["numEntities"] = w.get().getComponentAllocator().getNumObtainedElements();
+        j["scriptProfilerOverhead"] = scriptProfiler.getEstimatedOverhead();
+
+        if(!o.replayFile.empty())
+        {
+            json& r = j["replay"];
+            r["file"] = o.replayFile;
+            r["checkpoints"] = replay.getNumCheckedCheckpoints();
+            r["driftedCheckpoints"] = replay.getNumDriftedCheckpoints();
+            r["maxDrift"] = replay.getMaxDrift();
+
+            LogInfo() << "Benchmark: Replay checked " << replay.getNumCheckedCheckpoints() << " checkpoints, "
+                      << replay.getNumDriftedCheckpoints() << " drifted (max " << replay.getMaxDrift() << "m)";
+        }
+
+        // All in milliseconds per frame. Scripts are part of logic.
+        json& phases = j["phases"];
+        phases["frame"] = frame.toJSON();
+        phases["physics"] = physics.toJSON();
+        phases["logic"] = logic.toJSON();
+        phases["animation"] = animation.toJSON();
+        phases["renderSubmit"] = renderSubmit.toJSON();
+        phases["scripts"] = scripts.toJSON();
+
+        std::ofstream f(o.outFile);
+        f << j.dump(4);
+        f.close();
+
+        if(!frame.ms.empty())
+            LogInfo() << "Benchmark: Mean frame " << phases["frame"]["mean"].get<double>() << "ms, written to "
+                      << o.outFile;
+
+        return f.fail() ? 1 : 0;
+    }
+}
+
+int main(int argc, char** argv)
+{
+    bx::CommandLine cmdLine(argc, (const char**)argv);
+
+    // Nothing is set up yet, so these can simply return
+    Options o;
+    try
+    {
+        o.numFrames = std::stoul(findOption(cmdLine, "frames", "1000"));
+        o.numWarmup = std::stoul(findOption(cmdLine, "warmup", "60"));
+        o.dt = std::stod(findOption(cmdLine, "dt", "0.0166666"));
+        o.seed = static_cast<uint32_t>(std::stoul(findOption(cmdLine, "seed", "1")));
+        o.numSyntheticVobs = std::stoul(findOption(cmdLine, "synthetic", "0"));
+
+        const std::string defaultAITicks = std::to_string(Engine::InputRecording::AI_TICKS_PER_FRAME);
+        o.aiTicksPerFrame = static_cast<uint32_t>(std::stoul(findOption(cmdLine, "ai-ticks", defaultAITicks.c_str())));
+    }
+    catch(const std::exception& e)
+    {
+        LogError() << "Benchmark: Invalid number given as option (" << e.what() << "). Usage: REGoth-bench -g <game-root> "
+                   << "[-w <world.zen>] [--synthetic <numVobs>] [--frames <n>] [--warmup <n>] [--dt <seconds>] "
+                   << "[--seed <n>] [--ai-ticks <n>] [--out <file.json>] [--trace <file.json>]";
+        return 1;
+    }
+
+    o.outFile = findOption(cmdLine, "out", "benchmark.json");
+    o.traceFile = findOption(cmdLine, "trace", "");
+    o.replayFile = findOption(cmdLine, "replay", "");
+    o.microBenchmark = findOption(cmdLine, "micro", "");
+
+    Engine::InputRecording::Recording recording;
+    if(!o.replayFile.empty())
+    {
+        if(!Engine::InputRecording::loadFromFile(o.replayFile, recording))
+        {
+            LogError() << "Benchmark: Failed to load input-recording: " << o.replayFile;
+            return 1;
+        }
+
+        // Every frame of the recording has to be played for it to stay in sync
+        o.seed = recording.seed;
+        o.numFrames = recording.frames.size();
+        o.numWarmup = 0;
+        o.aiTicksPerFrame = Engine::InputRecording::AI_TICKS_PER_FRAME;
+    }
+
+    // Some parts of the engine still use rand()
+    std::srand(o.seed);
+
+    // Same output-size on every machine, the null-renderer doesn't care anyways
+    const uint16_t width = 1280;
+    const uint16_t height = 720;
+
+    bgfx::init(bgfx::RendererType::Null);
+    bgfx::reset(width, height);
+
+    Meshes::UVNormColorVertex::init();
+    Meshes::UVNormVertex::init();
+    Meshes::UVVertex::init();
+    Meshes::PositionVertex::init();
+    Meshes::PositionColorVertex::init();
+    Meshes::PositionUVVertex::init();
+    Meshes::SkeletalVertex::init();
+
+    ddInit();
+
+    Engine::GameEngine* engine = new Engine::GameEngine;
+    engine->initEngine(argc, argv);
+
+    // Every way out of the run ends up here, so the engine is always torn down before bgfx
+    int result = runBenchmark(*engine, o, recording, width, height);
+
+    delete engine;
+
+    ddShutdown();
+    bgfx::shutdown();
+
+    return result;
+}
@@ -0,0 +1,331 @@
+#include "MicroBenchmarks.h"
+#include <algorithm>
+#include <fstream>
+#include <functional>
+#include <map>
+#include <thread>
+#include <bx/timer.h>
+#include <json.hpp>
+#include <engine/GameEngine.h>
+#include <engine/LoadBenchmark.h>
+#include <engine/Savegame.h>
+#include <utils/logger.h>
+
+namespace
+{
+    struct Benchmark
+    {
+        std::string usage; // Arguments, in the order they are given
+        std::function<std::string(Engine::GameEngine& engine, const std::vector<std::string>& args)> fn;
+    };
+
+    const std::map<std::string, Benchmark>& getBenchmarks()
+    {
+        static const std::map<std::string, Benchmark> s_Benchmarks = {
+
+            {"loadbench", {"[numVobs] [numVisuals] [seed]", [](Engine::GameEngine& engine, const std::vector<std::string>& args) -> std::string {
+
+                size_t numVobs = args.size() > 1 ? std::stoul(args[1]) : 10000;
+                size_t numVisuals = args.size() > 2 ? std::stoul(args[2]) : 500;
+                uint32_t seed = args.size() > 3 ? static_cast<uint32_t>(std::stoul(args[3])) : 1;
+
+                World::WorldInstance::VobLoadStats s = Engine::LoadBenchmark::run(engine, numVobs, numVisuals, seed);
+
+                return "Inserted " + std::to_string(s.numVobs) + " vobs ("
+                       + std::to_string(s.numUniqueVisuals) + " unique visuals): "
+                       + "flatten " + std::to_string(s.timeFlatten * 1000.0) + "ms, "
+                       + "visuals " + std::to_string(s.timeLoadVisuals * 1000.0) + "ms, "
+                       + "shadows " + std::to_string(s.timeShadowTrace * 1000.0) + "ms, "
+                       + "entities " + std::to_string(s.timeCreateEntities * 1000.0) + "ms";
+            }}},
+
+            {"savebench", {"", [](Engine::GameEngine& engine, const std::vector<std::string>& args) -> std::string {
+
+                const double freq = double(bx::getHPFrequency());
+                const std::string base = "savebench";
+                int64_t t;
+
+                auto fileSize = [](const std::string& f){
+                    std::ifstream s(f, std::ios::binary | std::ios::ate);
+                    return std::to_string(static_cast<long long>(s.tellg()));
+                };
+
+                t = bx::getHPCounter();
+                json j;
+                engine.getMainWorld().get().exportWorld(j);
+                double tExport = (bx::getHPCounter() - t) / freq;
+
+                // Save both formats
+                t = bx::getHPCounter();
+                Engine::Savegame::saveToFile(j, base + ".json", Engine::Savegame::SF_Json);
+                double tSaveJson = (bx::getHPCounter() - t) / freq;
+
+                t = bx::getHPCounter();
+                Engine::Savegame::saveToFile(j, base + ".sav", Engine::Savegame::SF_Binary);
+                double tSaveBinary = (bx::getHPCounter() - t) / freq;
+
+                t = bx::getHPCounter();
+                Engine::Savegame::saveToFile(j, base + ".savz", Engine::Savegame::SF_CompressedBinary);
+                double tSaveCompressed = (bx::getHPCounter() - t) / freq;
+
+                // Load them again
+                json lj;
+                t = bx::getHPCounter();
+                Engine::Savegame::loadFromFile(base + ".json", lj);
+                double tLoadJson = (bx::getHPCounter() - t) / freq;
+
+                json lb;
+                t = bx::getHPCounter();
+                bool binaryOk = Engine::Savegame::loadFromFile(base + ".sav", lb);
+                double tLoadBinary = (bx::getHPCounter() - t) / freq;
+
+                json lc;
+                t = bx::getHPCounter();
+                bool compressedOk = Engine::Savegame::loadFromFile(base + ".savz", lc);
+                double tLoadCompressed = (bx::getHPCounter() - t) / freq;
+
+                // Delta against the freshly loaded ZEN
+                std::string deltaResult = " | Delta: not possible, world was loaded from a full savegame";
+                t = bx::getHPCounter();
+                json jd;
+                if(engine.getMainWorld().get().exportWorldDelta(jd))
+                {
+                    double tExportDelta = (bx::getHPCounter() - t) / freq;
+
+                    t = bx::getHPCounter();
+                    Engine::Savegame::saveToFile(jd, base + ".delta.savz", Engine::Savegame::SF_CompressedBinary);
+                    double tSaveDelta = (bx::getHPCounter() - t) / freq;
+
+                    deltaResult = " | Delta: export " + std::to_string(tExportDelta * 1000.0) + "ms, "
+                                  + fileSize(base + ".delta.savz") + " bytes, save " + std::to_string(tSaveDelta * 1000.0) + "ms"
+                                  + " (" + std::to_string(jd["vobs"]["controllers"].size() + jd["vobs"]["changed"].size()) + " vobs"
+                                  + ", " + std::to_string(jd["vobs"]["removed"].size()) + " removed"
+                                  + ", " + std::to_string(jd["scriptEngine"]["globals"].size()) + " script-values)";
+                }
+
+                std::string result = "Export: " + std::to_string(tExport * 1000.0) + "ms"
+                       + " | Json: " + fileSize(base + ".json") + " bytes, save " + std::to_string(tSaveJson * 1000.0) + "ms"
+                       + ", load " + std::to_string(tLoadJson * 1000.0) + "ms"
+                       + " | Binary: " + fileSize(base + ".sav") + " bytes, save " + std::to_string(tSaveBinary * 1000.0) + "ms"
+                       + ", load " + std::to_string(tLoadBinary * 1000.0) + "ms"
+                       + " | Compressed: " + fileSize(base + ".savz") + " bytes, save " + std::to_string(tSaveCompressed * 1000.0) + "ms"
+                       + ", load " + std::to_string(tLoadCompressed * 1000.0) + "ms"
+                       + (binaryOk && lb == j && compressedOk && lc == j ? " (roundtrip ok)" : " (ROUNDTRIP FAILED)")
+                       + deltaResult;
+
+                LogInfo() << "Savegame benchmark: " << result;
+
+                return result;
+            }}},
+
+            {"worldbench", {"[numWorlds]", [](Engine::GameEngine& engine, const std::vector<std::string>& args) -> std::string {
+
+                size_t num = args.size() > 1 ? std::stoul(args[1]) : 4;
+
+                Engine::LoadBenchmark::ConstructionStats s = Engine::LoadBenchmark::measureWorldConstruction(num);
+
+                size_t rss = s.rssAfter > s.rssBefore ? s.rssAfter - s.rssBefore : 0;
+                World::WorldInstance& main = engine.getMainWorld().get();
+
+                return std::to_string(num) + " empty worlds: construct " + std::to_string(s.timeConstruct * 1000.0) + "ms"
+                       + ", destruct " + std::to_string(s.timeDestruct * 1000.0) + "ms"
+                       + ", RSS +" + std::to_string(rss / 1024) + "KB"
+                       + " | Main world entity-storage: "
+                       + std::to_string((main.getComponentAllocator().getNumCommittedBytes()
+                                         + main.getPhysicsSystem().getNumCommittedBytes()) / 1024) + "KB committed";
+            }}},
+
+            {"removebench", {"[numEntities] [seed]", [](Engine::GameEngine& engine, const std::vector<std::string>& args) -> std::string {
+
+                size_t num = args.size() > 1 ? std::stoul(args[1]) : 50000;
+                uint32_t seed = args.size() > 2 ? static_cast<uint32_t>(std::stoul(args[2])) : 1;
+
+                Engine::LoadBenchmark::RemovalStats s = Engine::LoadBenchmark::measureEntityRemoval(engine, num, seed);
+
+                return std::to_string(num) + " entities: create " + std::to_string(s.timeCreate * 1000.0) + "ms"
+                       + ", despawn half " + std::to_string(s.timeDespawnWave * 1000.0) + "ms"
+                       + ", unload rest " + std::to_string(s.timeUnload * 1000.0) + "ms"
+                       + ", " + std::to_string(s.committedAfter / 1024) + "KB left committed";
+            }}},
+
+            {"layoutbench", {"[numEntities]", [](Engine::GameEngine& engine, const std::vector<std::string>& args) -> std::string {
+
+                size_t num = args.size() > 1 ? std::stoul(args[1]) : 50000;
+
+                Engine::LoadBenchmark::LayoutStats s = Engine::LoadBenchmark::measureComponentLayouts(num);
+
+                return std::to_string(num) + " entities: bundled " + std::to_string(s.committedBundled / 1024) + "KB"
+                       + ", iterate " + std::to_string(s.timeIterateBundled * 1000.0) + "ms"
+                       + " | sparse " + std::to_string(s.committedSparse / 1024) + "KB"
+                       + ", iterate " + std::to_string(s.timeIterateSparse * 1000.0) + "ms";
+            }}},
+
+            {"querybench", {"[passes]", [](Engine::GameEngine& engine, const std::vector<std::string>& args) -> std::string {
+
+                if(!engine.getMainWorld().isValid())
+                    return "No world loaded";
+
+                size_t passes = args.size() > 1 ? std::stoul(args[1]) : 100;
+
+                std::vector<Engine::LoadBenchmark::QueryStats> stats =
+                        Engine::LoadBenchmark::measureQueries(engine.getMainWorld().get(), passes);
+
+                double scan = 0.0, query = 0.0;
+                for(const Engine::LoadBenchmark::QueryStats& s : stats)
+                {
+                    scan += s.timeScan;
+                    query += s.timeQuery;
+                }
+
+                return std::to_string(stats.size()) + " masks, " + std::to_string(passes) + " passes: scan "
+                       + std::to_string(scan * 1000.0) + "ms, query " + std::to_string(query * 1000.0) + "ms (see log)";
+            }}},
+
+            {"vobviews", {"[frames] [accessesPerNpc]", [](Engine::GameEngine& engine, const std::vector<std::string>& args) -> std::string {
+
+                if(!engine.getMainWorld().isValid())
+                    return "No world loaded";
+
+                size_t frames = args.size() > 1 ? std::stoul(args[1]) : 60;
+                size_t accesses = args.size() > 2 ? std::stoul(args[2]) : 8;
+
+                Engine::LoadBenchmark::VobViewStats s =
+                        Engine::LoadBenchmark::measureVobViews(engine.getMainWorld().get(), frames, accesses);
+
+                return std::to_string(s.numNpcs) + " NPCs, " + std::to_string(frames) + " frames: resolving "
+                       + std::to_string(s.timeResolve * 1000.0) + "ms, cached "
+                       + std::to_string(s.timeCached * 1000.0) + "ms";
+            }}},
+
+            {"animbench", {"[numHandlers] [passes]", [](Engine::GameEngine& engine, const std::vector<std::string>& args) -> std::string {
+
+                size_t num = args.size() > 1 ? std::stoul(args[1]) : 500;
+                size_t passes = args.size() > 2 ? std::stoul(args[2]) : 100;
+
+                Engine::LoadBenchmark::AnimHandlerStats s = Engine::LoadBenchmark::measureAnimHandlers(num, passes);
+
+                return std::to_string(num) + " anim-handlers, " + std::to_string(passes) + " passes: scattered "
+                       + std::to_string(s.timeScattered * 1000.0) + "ms, pooled "
+                       + std::to_string(s.timePooled * 1000.0) + "ms";
+            }}},
+
+            {"msgbench", {"[numNpcs] [frames] [messagesPerFrame]", [](Engine::GameEngine& engine, const std::vector<std::string>& args) -> std::string {
+
+                size_t npcs = args.size() > 1 ? std::stoul(args[1]) : 1000;
+                size_t frames = args.size() > 2 ? std::stoul(args[2]) : 60;
+                size_t perFrame = args.size() > 3 ? std::stoul(args[3]) : 4;
+
+                Engine::LoadBenchmark::MessageStormStats s = Engine::LoadBenchmark::measureMessageStorm(npcs, frames, perFrame);
+
+                return std::to_string(s.numMessages) + " messages: legacy " + std::to_string(s.timeLegacy * 1000.0) + "ms, "
+                       + std::to_string(s.numAllocationsLegacy) + " allocations | pooled "
+                       + std::to_string(s.timePooled * 1000.0) + "ms, "
+                       + std::to_string(s.numAllocationsPooled) + " allocations";
+            }}},
+
+            {"namebench", {"[numNames] [numLookups]", [](Engine::GameEngine& engine, const std::vector<std::string>& args) -> std::string {
+
+                size_t names = args.size() > 1 ? std::stoul(args[1]) : 10000;
+                size_t lookups = args.size() > 2 ? std::stoul(args[2]) : 1000000;
+
+                if(!names)
+                    return "Need at least one name";
+
+                Engine::LoadBenchmark::NameStats s = Engine::LoadBenchmark::measureNames(names, lookups);
+
+                return std::to_string(s.numLookups) + " lookups: map<string> " + std::to_string(s.timeStringMap * 1000.0) + "ms"
+                       + ", unordered_map<string> " + std::to_string(s.timeStringHashMap * 1000.0) + "ms"
+                       + ", unordered_map<Name> " + std::to_string(s.timeNameHashMap * 1000.0) + "ms"
+                       + " | strings " + std::to_string(s.numBytesStrings / 1024) + "KB"
+                       + ", names " + std::to_string(s.numBytesNames / 1024) + "KB";
+            }}},
+
+            {"routinebench", {"[numNpcs] [frames] [minutesPerFrame]", [](Engine::GameEngine& engine, const std::vector<std::string>& args) -> std::string {
+
+                size_t npcs = args.size() > 1 ? std::stoul(args[1]) : 5000;
+                size_t frames = args.size() > 2 ? std::stoul(args[2]) : 10000;
+                float minutesPerFrame = args.size() > 3 ? std::stof(args[3]) : 0.5f;
+
+                Engine::LoadBenchmark::RoutineStats s = Engine::LoadBenchmark::measureRoutines(npcs, frames, minutesPerFrame);
+
+                return std::to_string(s.numNpcs) + " NPCs, " + std::to_string(s.numSwitches) + " switches: scan "
+                       + std::to_string(s.timeScan * 1000.0) + "ms, scheduled "
+                       + std::to_string(s.timeScheduled * 1000.0) + "ms";
+            }}},
+
+            {"exportbench", {"[maxThreads] [passes]", [](Engine::GameEngine& engine, const std::vector<std::string>& args) -> std::string {
+
+                if(!engine.getMainWorld().isValid())
+                    return "No world loaded";
+
+                size_t maxThreads = args.size() > 1 ? std::stoul(args[1]) : std::max(1u, std::thread::hardware_concurrency());
+                size_t passes = args.size() > 2 ? std::stoul(args[2]) : 5;
+
+                std::vector<Engine::LoadBenchmark::ExportStats> stats =
+                        Engine::LoadBenchmark::measureExport(engine.getMainWorld().get(), maxThreads, passes);
+
+                std::string r;
+                for(const Engine::LoadBenchmark::ExportStats& s : stats)
+                {
+                    LogInfo() << "Export with " << s.numThreads << " threads: " << s.time * 1000.0 / passes << "ms"
+                              << " (" << stats.front().time / s.time << "x)" << (s.matchesSerial ? "" : ", DIFFERS from serial export!");
+
+                    r += std::to_string(s.numThreads) + ": " + std::to_string(s.time * 1000.0 / passes) + "ms"
+                         + (s.matchesSerial ? "" : " (differs!)") + " | ";
+                }
+
+                return r + "see log";
+            }}},
+
+            {"offscreenbench", {"[frames] [minutesPerFrame] [range]", [](Engine::GameEngine& engine, const std::vector<std::string>& args) -> std::string {
+
+                if(!engine.getMainWorld().isValid())
+                    return "No world loaded";
+
+                size_t frames = std::max<size_t>(1, args.size() > 1 ? std::stoul(args[1]) : 600);
+                int minutesPerFrame = args.size() > 2 ? std::stoi(args[2]) : 1;
+                float range = args.size() > 3 ? std::stof(args[3]) : 100.0f;
+
+                Engine::LoadBenchmark::OffscreenStats s = Engine::LoadBenchmark::measureOffscreenSimulation(
+                        engine.getMainWorld().get(),
+                        engine.getMainCamera<Components::PositionComponent>().m_WorldMatrix,
+                        range, frames, minutesPerFrame);
+
+                LogInfo() << "Offscreen: " << s.numNpcs << " NPCs, " << s.numInRange << " in range of " << range << "m, "
+                          << s.numFrames << " frames at " << minutesPerFrame << " game-minutes each";
+                LogInfo() << "Offscreen: Frozen: " << s.timeFrozen * 1000.0 / s.numFrames << "ms per frame";
+                LogInfo() << "Offscreen: Coarse: " << s.timeCoarse * 1000.0 / s.numFrames << "ms per frame, "
+                          << s.avgSimulated << " NPCs simulated offscreen, " << s.numRoutesPlanned << " routes planned";
+                LogInfo() << "Offscreen: Full:   " << s.timeFull * 1000.0 / s.numFrames << "ms per frame";
+
+                return "Frozen: " + std::to_string(s.timeFrozen * 1000.0 / s.numFrames) + "ms, "
+                       + "coarse: " + std::to_string(s.timeCoarse * 1000.0 / s.numFrames) + "ms, "
+                       + "full: " + std::to_string(s.timeFull * 1000.0 / s.numFrames) + "ms per frame (see log)";
+            }}},
+        };
+
+        return s_Benchmarks;
+    }
+}
+
+bool MicroBenchmarks::run(Engine::GameEngine& engine, const std::vector<std::string>& args, std::string& result)
+{
+    if(args.empty())
+        return false;
+
+    auto it = getBenchmarks().find(args[0]);
+    if(it == getBenchmarks().end())
+        return false;
+
+    result = it->second.fn(engine, args);
+    return true;
+}
+
+std::vector<std::string> MicroBenchmarks::getUsage()
+{
+    std::vector<std::string> r;
+    for(const auto& b : getBenchmarks())
+        r.push_back(b.second.usage.empty() ? b.first : b.first + " " + b.second.usage);
+
+    return r;
+}
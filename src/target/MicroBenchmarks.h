@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <vector>
+
+namespace Engine
+{
+    class GameEngine;
+}
+
+/**
+ * Benchmarks of single engine-parts, run by REGoth-bench through --micro. They used to be console-commands of the
+ * game itself, but don't belong into the shipped executable.
+ */
+namespace MicroBenchmarks
+{
+    /**
+     * Runs a micro-benchmark. Those working on a world use the engines main-world.
+     * @param args Name of the benchmark, followed by its arguments. Missing arguments use the defaults.
+     * @param result Readable summary of the measurements. Details go into the log.
+     * @return False, if there is no benchmark of that name
+     */
+    bool run(Engine::GameEngine& engine, const std::vector<std::string>& args, std::string& result);
+
+    /**
+     * @return Names of all micro-benchmarks, with their arguments
+     */
+    std::vector<std::string> getUsage();
+}
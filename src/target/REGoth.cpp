@@ -11,6 +11,9 @@
 #include <zenload/zCMesh.h>
 #include <engine/World.h>
 #include <engine/GameEngine.h>
+#include <engine/Savegame.h>
+#include <engine/InputRecording.h>
+#include <content/VDFSLock.h>
 #include <utils/bgfx_lib.h>
 #include <content/VertexTypes.h>
 #include <render/WorldRender.h>
@@ -24,10 +27,14 @@
 #include <ZenLib/utils/logger.h>
 #include <json.hpp>
 #include <fstream>
+#include <cstdlib>
+#include <limits>
 #include <ui/Console.h>
 #include <components/VobClasses.h>
 #include <logic/NpcScriptState.h>
 #include <logic/PlayerController.h>
+#include <utils/Profiler.h>
+#include <utils/Utils.h>
 
 using json = nlohmann::json;
 
@@ -243,6 +250,8 @@ class ExampleCubes : public /*entry::AppI*/ PLATFORM_CLASS
 	{
         std::cout << "Running REGoth Engine" << std::endl;
 
+        Utils::Profiler::setThreadName("Main");
+
 //		Args args(_argc, _argv);
 
 		axis = 0;
@@ -295,8 +304,29 @@ class ExampleCubes : public /*entry::AppI*/ PLATFORM_CLASS
 
         showSplash();
 
-        // Add startworld
-        Handle::WorldHandle w = m_pEngine->addWorld(m_pEngine->getEngineArgs().startupZEN);
+        // Recordings have to start on a freshly loaded world, with a known random-seed
+        Engine::BaseEngine::EngineArgs engineArgs = m_pEngine->getEngineArgs();
+        const bx::CommandLine& cmdLine = engineArgs.cmdline;
+        uint32_t seed = cmdLine.findOption("seed") ? static_cast<uint32_t>(std::stoul(cmdLine.findOption("seed"))) : 1;
+
+        if(cmdLine.findOption("record"))
+        {
+            m_RecordFile = cmdLine.findOption("record");
+            std::srand(seed);
+        }
+
+        // Add startworld. It is built over the next frames, unless the recording needs it to be there on the first one.
+        Handle::WorldHandle w = m_RecordFile.empty() ? m_pEngine->addWorldAsync(engineArgs.startupZEN)
+                                                     : m_pEngine->addWorld(engineArgs.startupZEN);
+
+        if(!m_RecordFile.empty())
+        {
+            if(w.isValid())
+                w.get().getAIScheduler().getConfig().ticksPerFrame = Engine::InputRecording::AI_TICKS_PER_FRAME;
+
+            m_Recorder.start(engineArgs.startupZEN, seed);
+            LogInfo() << "Recording input to " << m_RecordFile << " (seed " << seed << ")";
+        }
 
 		m_timeOffset = bx::getHPCounter();
 
@@ -346,48 +376,31 @@ class ExampleCubes : public /*entry::AppI*/ PLATFORM_CLASS
 
         m_Console.registerCommand("switchlevel", [this](const std::vector<std::string>& args) -> std::string {
 
-            auto& s1 = m_pEngine->getMainWorld().get().getScriptEngine();
-
             if(args.size() < 2)
-                return "Missing argument. Usage: switchlevel <zenfile>";
+                return "Missing argument. Usage: switchlevel <zenfile> [sync]";
 
             std::string file = args[1];
-            if(!m_pEngine->getVDFSIndex().hasFile(file))
-                return "File '" + file + "' not found.";
-
-            // Export hero
-            VobTypes::NpcVobInformation player = VobTypes::asNpcVob(m_pEngine->getMainWorld().get(), s1.getPlayerEntity());
-
-            json pex;
-            player.playerController->exportObject(pex);
-
-            // Temporary save
-            m_Console.submitCommand("save " + m_pEngine->getMainWorld().get().getZenFile() + ".json");
-
-            // Check if a savegame for this world exists
-            if(Utils::fileExists(file + ".json"))
+            bool exists;
             {
-                m_Console.submitCommand("load " + file + " " + file + ".json");
-            }else
-            {
-                clearActions();
-                m_pEngine->removeWorld(m_pEngine->getMainWorld());
-                m_pEngine->addWorld(args[1]);
+                std::unique_lock<std::mutex> lock = Content::lockVDFS();
+                exists = m_pEngine->getVDFSIndex().hasFile(file);
             }
 
-            // Import hero again
-            auto& s2 = m_pEngine->getMainWorld().get().getScriptEngine();
-            if(s2.getPlayerEntity().isValid())
-            {
-                player = VobTypes::asNpcVob(m_pEngine->getMainWorld().get(),
-                                            s2.getPlayerEntity()); // World and player changed
-                player.playerController->importObject(pex, true);
-            }else
+            if(!exists)
+                return "File '" + file + "' not found.";
+
+            // Read the world in the background first and switch once it is ready, unless told otherwise
+            bool sync = args.size() > 2 && args[2] == "sync";
+            if(sync || m_pEngine->isWorldPreloaded(file))
             {
-                LogError() << "Player not inserted into new world!";
+                m_PendingSwitch.clear();
+                return switchLevel(file);
             }
 
-            return "Successfully switched world to: " + file;
+            m_pEngine->preloadWorld(file);
+            m_PendingSwitch = file;
+
+            return "Preloading " + file + ", switching once it is ready";
         });
 
         m_Console.registerCommand("load", [this](const std::vector<std::string>& args) -> std::string {
@@ -406,6 +419,9 @@ class ExampleCubes : public /*entry::AppI*/ PLATFORM_CLASS
                 savegame = file;
             }
 
+            // Savegame may still be in the making
+            m_SaveWriter.wait();
+
             clearActions();
             m_pEngine->removeWorld(m_pEngine->getMainWorld());
             m_pEngine->addWorld(args[1], savegame);
@@ -419,17 +435,284 @@ class ExampleCubes : public /*entry::AppI*/ PLATFORM_CLASS
         m_Console.registerCommand("save", [this](const std::vector<std::string>& args) -> std::string {
 
             if(args.size() < 2)
-                return "Missing argument. Usage: save <savegame>";
+                return "Missing argument. Usage: save <savegame> [json|binary|delta]";
 
-            json j;
-            m_pEngine->getMainWorld().get().exportWorld(j);
+            // Json is only there for debugging
+            Engine::Savegame::ESaveFormat format = Engine::Savegame::SF_CompressedBinary;
+            if(args.size() == 3 && args[2] == "json")
+                format = Engine::Savegame::SF_Json;
+            else if(args.size() == 3 && args[2] == "binary")
+                format = Engine::Savegame::SF_Binary;
 
-            // Save
-            std::ofstream f(args[1]);
-            f << Utils::iso_8859_1_to_utf8(j.dump(4));
-            f.close();
+            // Only store what changed since the ZEN was loaded
+            bool delta = args.size() == 3 && args[2] == "delta";
+            if(delta && !m_pEngine->getMainWorld().get().hasSaveBaseline())
+                return "World was loaded from a full savegame, can't save a delta";
+
+            std::string error = saveAsync(args[1], format, delta);
+            if(!error.empty())
+                return error;
+
+            return "Saving world in background to: " + args[1];
+        });
+
+        m_Console.registerCommand("vobviews", [this](const std::vector<std::string>& args) -> std::string {
+
+            if(!m_pEngine->getMainWorld().isValid())
+                return "No world loaded";
+
+            Components::ComponentAllocator& alloc = m_pEngine->getMainWorld().get().getComponentAllocator();
+
+            // Usage of the game itself since the last call
+            Components::ComponentAllocator::ViewStats live = alloc.getViewStats();
+            size_t frames = std::max<size_t>(1, live.numFrames);
+            alloc.resetViewStats();
+
+            return std::to_string(live.numLookups / frames) + " lookups, "
+                   + std::to_string(live.numResolves / frames) + " resolves per frame ("
+                   + std::to_string(live.numFrames) + " frames)";
+        });
+
+        m_Console.registerCommand("ai", [this](const std::vector<std::string>& args) -> std::string {
+
+            if(!m_pEngine->getMainWorld().isValid())
+                return "No world loaded";
+
+            Logic::AIScheduler& ai = m_pEngine->getMainWorld().get().getAIScheduler();
+
+            if(args.size() > 1)
+            {
+                float budget;
+                size_t ticks;
+
+                if(args[1] == "on" || args[1] == "off")
+                    ai.getConfig().enabled = args[1] == "on";
+                else if(args[1] == "budget" && args.size() > 2 && Utils::parseFloat(args[2], budget) && budget > 0.0f)
+                    ai.getConfig().budgetMicroseconds = budget;
+                else if(args[1] == "ticks" && args.size() > 2 && Utils::parseUnsigned(args[2], ticks)
+                        && ticks <= std::numeric_limits<uint32_t>::max())
+                    ai.getConfig().ticksPerFrame = static_cast<uint32_t>(ticks);
+                else if(args[1] != "reset")
+                    return "Usage: ai [on|off|reset|budget <microseconds>|ticks <n, 0 for the time-budget>]";
+
+                ai.resetStats();
+            }
+
+            const Logic::AIScheduler::Stats& s = ai.getStats();
+            size_t frames = std::max<size_t>(1, s.numFrames);
+
+            LogInfo() << "AI: Ticks per frame: " << s.ticksPerFrame.toString();
+            LogInfo() << "AI: Budget overruns (us): " << s.overrunMicroseconds.toString();
+
+            std::string budget = ai.getConfig().ticksPerFrame ? std::to_string(ai.getConfig().ticksPerFrame) + " ticks"
+                                                              : std::to_string((int)ai.getConfig().budgetMicroseconds) + "us";
+
+            return std::string(ai.getConfig().enabled ? "Scheduled" : "Every frame") + ", budget "
+                   + budget + " | "
+                   + std::to_string(s.numTicks / frames) + " ticks per frame ("
+                   + std::to_string(s.numUrgentTicks / frames) + " urgent), "
+                   + std::to_string(s.numDeferred) + " deferred, "
+                   + std::to_string(s.numOverruns) + "/" + std::to_string(s.numFrames) + " frames over budget (see log)";
+        });
+
+        m_Console.registerCommand("scriptsyms", [this](const std::vector<std::string>& args) -> std::string {
+
+            if(!m_pEngine->getMainWorld().isValid())
+                return "No world loaded";
+
+            const Logic::ScriptEngine::SymbolLookupStats& s = m_pEngine->getMainWorld().get().getScriptEngine().getLastFrameLookupStats();
+
+            return "Symbol-lookups by name last frame: " + std::to_string(s.numNameLookups)
+                   + " (" + std::to_string(s.numDATLookups) + " not cached)";
+        });
+
+        m_Console.registerCommand("scriptprof", [this](const std::vector<std::string>& args) -> std::string {
+
+            if(!m_pEngine->getMainWorld().isValid())
+                return "No world loaded";
+
+            Logic::ScriptEngine& s = m_pEngine->getMainWorld().get().getScriptEngine();
+            Logic::ScriptProfiler& p = s.getProfiler();
+
+            if(args.size() > 1)
+            {
+                if(args[1] == "on" || args[1] == "off")
+                {
+                    p.setEnabled(args[1] == "on");
+                    p.reset();
+                }
+                else if(args[1] == "reset")
+                {
+                    p.reset();
+                }
+                else if(args[1] == "export")
+                {
+                    std::string file = args.size() > 2 ? args[2] : "scripts.folded";
+
+                    bool ok = p.exportCollapsedStacks(file, [&](size_t sym){
+                        return s.getVM().getDATFile().getSymbolByIndex(sym).name;
+                    });
+
+                    return ok ? "Wrote collapsed stacks to " + file : "Failed to write " + file;
+                }
+                else if(args[1] != "top")
+                    return "Usage: scriptprof [on|off|reset|top [n]|export [file]]";
+            }
+
+            double frames = std::max<size_t>(1, p.getNumFrames());
+            size_t n = 20;
+            if(args.size() > 2 && args[1] == "top" && !Utils::parseUnsigned(args[2], n))
+                return "Usage: scriptprof [on|off|reset|top [n]|export [file]]";
+
+            for(auto& e : p.getTopSymbols(n))
+            {
+                LogInfo() << "Script: " << s.getVM().getDATFile().getSymbolByIndex(e.first).name
+                          << (e.second.isExternal ? " (external)" : "")
+                          << ": " << e.second.numCalls << " calls, "
+                          << Logic::ScriptProfiler::ticksToSeconds(e.second.exclusiveTicks) * 1000.0 / frames << "ms excl., "
+                          << Logic::ScriptProfiler::ticksToSeconds(e.second.inclusiveTicks) * 1000.0 / frames << "ms incl. per frame";
+            }
+
+            return std::string(p.isEnabled() ? "Profiling" : "Not profiling") + " | "
+                   + std::to_string(p.getNumFrames()) + " frames, "
+                   + std::to_string(p.getNumCalls()) + " calls, "
+                   + std::to_string(p.getTotalTime() * 1000.0 / frames) + "ms per frame, overhead ~"
+                   + std::to_string(p.getEstimatedOverhead() * 100.0) + "% (see log)";
+        });
+
+        m_Console.registerCommand("profile", [this](const std::vector<std::string>& args) -> std::string {
+
+            if(args.size() > 1)
+            {
+                if(args[1] == "on" || args[1] == "off")
+                {
+                    Utils::Profiler::setEnabled(args[1] == "on");
+                    m_ProfilerOverlay = args[1] == "on";
+                }
+                else if(args[1] == "capture")
+                {
+                    size_t numFrames = 60;
+                    if(args.size() > 2 && (!Utils::parseUnsigned(args[2], numFrames) || numFrames == 0))
+                        return "Usage: profile capture [frames] [file]";
+
+                    std::string file = args.size() > 3 ? args[3] : "trace.json";
+
+                    if(!Utils::Profiler::startCapture(numFrames, file))
+                        return "There is already a capture running";
+
+                    return "Capturing " + std::to_string(numFrames) + " frames to " + file;
+                }
+                else if(args[1] != "top")
+                    return "Usage: profile [on|off|top [n]|capture [frames] [file]]";
+            }
+
+            size_t n = 20;
+            if(args.size() > 2 && args[1] == "top" && !Utils::parseUnsigned(args[2], n))
+                return "Usage: profile [on|off|top [n]|capture [frames] [file]]";
+
+            for(const Utils::Profiler::ZoneStats& z : Utils::Profiler::getTopZones(n))
+            {
+                LogInfo() << "Zone: " << z.name << ": " << z.numCalls << " calls, "
+                          << z.exclusive << "ms excl., " << z.inclusive << "ms incl. per frame";
+            }
+
+            return std::string(Utils::Profiler::isEnabled() ? "Profiling" : "Not profiling") + ", "
+                   + std::to_string(Utils::Profiler::getNumDroppedEvents()) + " events dropped (see log)";
+        });
+
+        m_Console.registerCommand("record", [this](const std::vector<std::string>& args) -> std::string {
+
+            if(args.size() > 1 && args[1] == "stop")
+                return stopRecording();
+
+            if(!m_Recorder.isRecording())
+                return "Not recording. Start REGoth with --record <file> to record input.";
+
+            return "Recording to " + m_RecordFile + ", " + std::to_string(m_Recorder.getRecording().frames.size()) + " frames";
+        });
+
+        m_Console.registerCommand("offscreen", [this](const std::vector<std::string>& args) -> std::string {
+
+            if(!m_pEngine->getMainWorld().isValid())
+                return "No world loaded";
+
+            Logic::OffscreenSimulation& offscreen = m_pEngine->getMainWorld().get().getOffscreenSimulation();
+
+            if(args.size() > 1)
+            {
+                if(args[1] == "on" || args[1] == "off")
+                    offscreen.getConfig().enabled = args[1] == "on";
+                else if(!(args[1] == "routes" && args.size() > 2
+                          && Utils::parseUnsigned(args[2], offscreen.getConfig().maxRoutesPerFrame)))
+                    return "Usage: offscreen [on|off|routes <per frame>]";
+            }
+
+            Logic::OffscreenSimulation::Stats s = offscreen.getStats();
+
+            return std::string(offscreen.getConfig().enabled ? "Coarse" : "Frozen") + " | "
+                   + std::to_string(s.numSimulated) + " NPCs offscreen, "
+                   + std::to_string(s.numWalking) + " walking, "
+                   + std::to_string(s.numRoutesPending) + " routes pending | "
+                   + std::to_string(s.numEntered) + " entered, "
+                   + std::to_string(s.numLeft) + " left, "
+                   + std::to_string(s.numRoutesPlanned) + " routes planned, "
+                   + std::to_string(s.numArrived) + " arrived";
+        });
+
+        m_Console.registerCommand("loadbudget", [this](const std::vector<std::string>& args) -> std::string {
+
+            if(args.size() < 2)
+                return "Missing argument. Usage: loadbudget <milliseconds per frame>";
 
-            return "World saved to file: " + args[1];
+            float budget;
+            if(!Utils::parseFloat(args[1], budget) || budget <= 0.0f)
+                return "Invalid budget. Usage: loadbudget <milliseconds per frame, greater than 0>";
+
+            m_pEngine->setWorldLoadBudget(budget / 1000.0);
+
+            return "Worlds are loaded with " + args[1] + "ms per frame";
+        });
+
+        m_Console.registerCommand("mem",[this](const std::vector<std::string>& args) -> std::string {
+
+            Memory::MemoryReport report;
+            m_pEngine->collectMemoryStats(report);
+
+            if(args.size() > 1 && args[1] == "json")
+            {
+                std::string file = args.size() > 2 ? args[2] : "memory.json";
+
+                json j;
+                report.exportJSON(j);
+
+                std::ofstream f(file);
+                f << j.dump(4);
+                f.close();
+
+                return "Memory-report written to: " + file;
+            }
+
+            // Full breakdown goes into the log, the console only has room for the totals
+            report.log();
+
+            return report.toString();
+        });
+
+        m_Console.registerCommand("physlib", [this](const std::vector<std::string>& args) -> std::string {
+
+            Physics::CollisionShapeLibrary& lib = m_pEngine->getCollisionShapeLibrary();
+
+            if(args.size() == 2 && args[1] == "purge")
+                return "Purged " + std::to_string(lib.purgeUnused()) + " unused collision-shapes";
+
+            Physics::CollisionShapeLibrary::Stats s = lib.getStats();
+
+            return "Shapes: " + std::to_string(s.numShapes)
+                   + " (" + std::to_string(s.numUnreferenced) + " unused)"
+                   + ", Hits: " + std::to_string(s.numHits)
+                   + ", Builds: " + std::to_string(s.numMisses)
+                   + ", Build-time spent: " + std::to_string(s.buildTimeSpent * 1000.0) + "ms"
+                   + ", saved: " + std::to_string(s.buildTimeSaved * 1000.0) + "ms";
         });
 
         m_Console.registerCommand("knockout", [this](const std::vector<std::string>& args) -> std::string {
@@ -541,6 +824,7 @@ class ExampleCubes : public /*entry::AppI*/ PLATFORM_CLASS
 	virtual int shutdown() BX_OVERRIDE
 	{
 		// Cleanup.
+        stopRecording();
 
 		delete m_pEngine;
 
@@ -556,6 +840,11 @@ class ExampleCubes : public /*entry::AppI*/ PLATFORM_CLASS
 
 	bool update() BX_OVERRIDE
 	{
+        // Sum up what the zones recorded last frame
+        Utils::Profiler::onFrameEnd();
+
+        PROFILE_SCOPE("Frame");
+
         if(!m_ConsoleOpen)
             Engine::Input::fireBindings();
         else
@@ -599,6 +888,21 @@ class ExampleCubes : public /*entry::AppI*/ PLATFORM_CLASS
         bgfx::dbgTextPrintf(0, 1, 0x4f, "REGoth-Engine (%s)", m_pEngine->getEngineArgs().startupZEN.c_str());
         bgfx::dbgTextPrintf(0, 2, 0x0f, "Frame: % 7.3f[ms] %.1f[fps]", 1000.0 * dt, 1.0f / (double(dt)));
 
+        updateSaveProgress();
+        drawLoadProgress();
+
+        // Switch the level once the target world was read in the background
+        if(!m_PendingSwitch.empty() && m_pEngine->isWorldPreloaded(m_PendingSwitch))
+        {
+            std::string file = m_PendingSwitch;
+            m_PendingSwitch.clear();
+
+            switchLevel(file);
+        }
+
+        if(m_ProfilerOverlay)
+            drawProfilerOverlay();
+
 
         // This dummy draw call is here to make sure that view 0 is cleared
         // if no other draw callvm.getDATFile().getSymbolByIndex(self)s are submitted to view 0.
@@ -613,41 +917,46 @@ class ExampleCubes : public /*entry::AppI*/ PLATFORM_CLASS
         ddBegin(0);
 
         m_pEngine->frameUpdate(dt, (uint16_t)getWindowWidth(), (uint16_t)getWindowHeight());
+        m_Recorder.onFrameEnd(dt, *m_pEngine);
         // Draw and process all UI-Views
         // Set render states.
 
 
-        m_pEngine->getRootUIView().update(dt, ms, m_pEngine->getDefaultRenderSystem().getConfig());
+        {
+            PROFILE_SCOPE("UI::View::update");
+            m_pEngine->getRootUIView().update(dt, ms, m_pEngine->getDefaultRenderSystem().getConfig());
+        }
 
 
         imguiBeginArea("Debug", 220, 20, 200, 150);
 
         auto loadWorld = [&](const std::string& world, const std::string& save){
+            // The recording only makes sense on the world it was started on
+            stopRecording();
+            m_SaveWriter.wait();
             clearActions();
             m_pEngine->removeWorld(m_pEngine->getMainWorld());
-            m_pEngine->addWorld(world, save);
+            m_pEngine->addWorldAsync(world, save);
         };
 
         if(imguiButton(m_ConsoleOpen ? "Close Console" : "Open Console"))
             m_ConsoleOpen = !m_ConsoleOpen;
 
         if(imguiButton("Load World"))
-            loadWorld("world.zen", "testsave.jsav");
+            loadWorld("world.zen", "testsave.savz");
 
         if(imguiButton("Load Newworld"))
-            loadWorld("newworld.zen", "testsave.jsav");
+            loadWorld("newworld.zen", "testsave.savz");
 
         if(imguiButton("Load Addonworld"))
-            loadWorld("Addonworld.zen", "testsave.jsav");
+            loadWorld("Addonworld.zen", "testsave.savz");
 
         if(imguiButton("Save world"))
         {
-            json j;
-            m_pEngine->getMainWorld().get().exportWorld(j);
-
-            std::ofstream f("testsave.jsav");
+            std::string error = saveAsync("testsave.savz", Engine::Savegame::SF_CompressedBinary);
 
-            f << Utils::iso_8859_1_to_utf8(j.dump(4));
+            if(!error.empty() && m_pEngine->getMainWorld().isValid())
+                m_pEngine->getMainWorld().get().getPrintScreenManager().printMessage(error);
         }
 
         imguiEndArea();
@@ -688,13 +997,204 @@ class ExampleCubes : public /*entry::AppI*/ PLATFORM_CLASS
             m_Console.update();
         }
 
-        // Advance to next frame. Rendering thread will be kicked to
-        // process submitted rendering primitives.
-        bgfx::frame();
+        {
+            PROFILE_SCOPE("bgfx::frame");
+
+            // Advance to next frame. Rendering thread will be kicked to
+            // process submitted rendering primitives.
+            bgfx::frame();
+        }
 
         return true;
 	}
 
+    /**
+     * Takes a snapshot of the main world and hands it to the background-writer.
+     * Only the snapshot is taken on the main-thread, which is measured against the frame-budget.
+     * @param delta Only save what changed since the ZEN was loaded, if possible
+     * @return Why the save couldn't be started, empty on success
+     */
+    std::string saveAsync(const std::string& file, Engine::Savegame::ESaveFormat format, bool delta = false)
+    {
+        // Target: 60fps
+        const double FRAME_BUDGET = 1.0 / 60.0;
+
+        if(!m_pEngine->getMainWorld().isValid())
+            return "No world loaded";
+
+        // A world still being loaded would be exported half-built
+        if(m_pEngine->getWorldLoader(m_pEngine->getMainWorld()))
+            return "World is still loading, can't save yet";
+
+        if(m_SaveWriter.isBusy())
+            return "Already saving to: " + m_SaveWriter.getFile();
+
+        int64_t start = bx::getHPCounter();
+
+        json j;
+        if(!delta || !m_pEngine->getMainWorld().get().exportWorldDelta(j))
+            m_pEngine->getMainWorld().get().exportWorld(j);
+
+        m_SaveWriter.start(std::move(j), file, format);
+
+        double hitch = (bx::getHPCounter() - start) / double(bx::getHPFrequency());
+
+        if(hitch > FRAME_BUDGET)
+            LogWarn() << "Savegame: Snapshot took " << hitch * 1000.0 << "ms on the main-thread, over the frame-budget of " << FRAME_BUDGET * 1000.0 << "ms";
+        else
+            LogInfo() << "Savegame: Snapshot took " << hitch * 1000.0 << "ms on the main-thread";
+
+        return "";
+    }
+
+    /**
+     * Stops a running input-recording and writes it to the file given by --record
+     * @return Message for the console
+     */
+    std::string stopRecording()
+    {
+        if(!m_Recorder.isRecording())
+            return "Not recording";
+
+        m_Recorder.stop();
+
+        const Engine::InputRecording::Recording& r = m_Recorder.getRecording();
+        if(!Engine::InputRecording::saveToFile(r, m_RecordFile))
+        {
+            LogError() << "Failed to write input-recording to " << m_RecordFile;
+            return "Failed to write " + m_RecordFile;
+        }
+
+        LogInfo() << "Wrote input-recording of " << r.frames.size() << " frames to " << m_RecordFile;
+        return "Wrote " + std::to_string(r.frames.size()) + " frames to " + m_RecordFile;
+    }
+
+    /**
+     * Moves the hero into the given world. The current world is saved, so it can be continued when coming back.
+     * If the target world was preloaded, only the parts which need the world itself are done here.
+     * @return Message for the console
+     */
+    std::string switchLevel(const std::string& file)
+    {
+        int64_t start = bx::getHPCounter();
+        bool preloaded = m_pEngine->isWorldPreloaded(file);
+
+        auto& s1 = m_pEngine->getMainWorld().get().getScriptEngine();
+
+        // Export hero
+        VobTypes::NpcVobInformation player = VobTypes::asNpcVob(m_pEngine->getMainWorld().get(), s1.getPlayerEntity());
+
+        json pex;
+        player.playerController->exportObject(pex);
+
+        // Temporary save
+        m_Console.submitCommand("save " + m_pEngine->getMainWorld().get().getZenFile() + ".sav");
+
+        // Check if a savegame for this world exists
+        if(Utils::fileExists(file + ".sav"))
+        {
+            m_Console.submitCommand("load " + file + " " + file + ".sav");
+        }else
+        {
+            clearActions();
+            m_pEngine->removeWorld(m_pEngine->getMainWorld());
+            m_pEngine->addWorld(file);
+        }
+
+        // Import hero again
+        auto& s2 = m_pEngine->getMainWorld().get().getScriptEngine();
+        if(s2.getPlayerEntity().isValid())
+        {
+            player = VobTypes::asNpcVob(m_pEngine->getMainWorld().get(),
+                                        s2.getPlayerEntity()); // World and player changed
+            player.playerController->importObject(pex, true);
+        }else
+        {
+            LogError() << "Player not inserted into new world!";
+        }
+
+        double stall = (bx::getHPCounter() - start) / double(bx::getHPFrequency());
+
+        Content::AssetCache::Stats assets = m_pEngine->getAssetCache().getStats();
+        LogInfo() << "Switched world to " << file << (preloaded ? " (preloaded)" : " (not preloaded)")
+                  << ", stalled for " << stall * 1000.0 << "ms. Asset-cache: " << assets.numTextures << " textures, "
+                  << assets.numMeshes << " meshes, " << assets.numBytes / (1024 * 1024) << "MB, "
+                  << assets.numHits << " hits, " << assets.numMisses << " misses";
+
+        return "Switched world to " + file + " in " + std::to_string(static_cast<int>(stall * 1000.0)) + "ms"
+               + (preloaded ? " (preloaded)" : "");
+    }
+
+    /**
+     * Lists the most expensive profiler-zones of the last report-window
+     */
+    void drawProfilerOverlay()
+    {
+        const size_t NUM_ZONES = 10;
+        const uint16_t x = 100;
+
+        bgfx::dbgTextPrintf(x, 1, 0x4f, "%-28s %8s %8s %6s", "Zone", "Excl[ms]", "Incl[ms]", "Calls");
+
+        uint16_t y = 2;
+        for(const Utils::Profiler::ZoneStats& z : Utils::Profiler::getTopZones(NUM_ZONES))
+        {
+            bgfx::dbgTextPrintf(x, y++, 0x0f, "%-28.28s %8.3f %8.3f %6.0f", z.name, z.exclusive, z.inclusive, z.numCalls);
+        }
+
+        if(Utils::Profiler::isCapturing())
+            bgfx::dbgTextPrintf(x, y, 0x0c, "Capturing...");
+    }
+
+    /**
+     * Shows how far the main world got, while it is still being loaded
+     */
+    void drawLoadProgress()
+    {
+        if(!m_pEngine->getMainWorld().isValid())
+            return;
+
+        World::WorldLoader* loader = m_pEngine->getWorldLoader(m_pEngine->getMainWorld());
+        if(!loader)
+            return;
+
+        bgfx::dbgTextPrintf(0, 4, 0x4f, "Loading %s: %s (%d%%)",
+                            m_pEngine->getMainWorld().get().getZenFile().c_str(),
+                            World::WorldLoader::getStageName(loader->getStage()),
+                            static_cast<int>(loader->getProgress() * 100.0f));
+    }
+
+    /**
+     * Shows the state of a running save and reports when it is done
+     */
+    void updateSaveProgress()
+    {
+        if(m_SaveWriter.isBusy())
+        {
+            const char* states[] = {"Idle", "Encoding", "Compressing", "Writing", "Done"};
+
+            bgfx::dbgTextPrintf(0, 7, 0x0f, "Saving %s: %s (%d%%)",
+                                m_SaveWriter.getFile().c_str(),
+                                states[m_SaveWriter.getState()],
+                                static_cast<int>(m_SaveWriter.getProgress() * 100.0f));
+        }
+
+        bool success;
+        std::string file;
+        if(m_SaveWriter.pollFinished(success, file))
+        {
+            if(success)
+            {
+                LogInfo() << "Savegame: World saved to file: " << file;
+
+                if(m_pEngine->getMainWorld().isValid())
+                    m_pEngine->getMainWorld().get().getPrintScreenManager().printMessage("Game saved");
+            }else
+            {
+                LogError() << "Savegame: Failed to write file: " << file;
+            }
+        }
+    }
+
 	Engine::GameEngine* m_pEngine;
 	uint32_t m_debug;
 	uint32_t m_reset;
@@ -704,6 +1204,15 @@ class ExampleCubes : public /*entry::AppI*/ PLATFORM_CLASS
     int32_t m_scrollArea;
     UI::Console m_Console;
     bool m_ConsoleOpen = false;
+    bool m_ProfilerOverlay = false;
+    Engine::InputRecording::Recorder m_Recorder;
+    std::string m_RecordFile;
+    Engine::Savegame::AsyncWriter m_SaveWriter;
+
+    /**
+     * World to switch to once it was preloaded
+     */
+    std::string m_PendingSwitch;
 };
 
 //ENTRY_IMPLEMENT_MAIN(ExampleCubes);
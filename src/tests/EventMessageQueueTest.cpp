@@ -0,0 +1,138 @@
+#include "Test.h"
+#include <logic/messages/EventMessageQueue.h>
+#include <vector>
+
+using namespace Logic::EventMessages;
+
+namespace
+{
+    /**
+     * @return Messages inside the queue, front to back, checking the backwards-links along the way
+     */
+    std::vector<EventMessage*> collect(EventMessageQueue& q)
+    {
+        std::vector<EventMessage*> r;
+        q.forEach([&](EventMessage* m){ r.push_back(m); });
+
+        EventMessage* expectedPrev = nullptr;
+        for(EventMessage* m : r)
+        {
+            TEST_CHECK(m->queueLink.prev == expectedPrev);
+            expectedPrev = m;
+        }
+
+        TEST_CHECK(q.back() == expectedPrev);
+        TEST_CHECK_EQUAL(q.size(), r.size());
+
+        return r;
+    }
+
+    void testFIFO()
+    {
+        EventMessageQueue q;
+        TEST_CHECK(q.empty());
+        TEST_CHECK(q.front() == nullptr);
+
+        EventMessage a, b, c;
+        q.pushBack(&a);
+        q.pushBack(&b);
+        q.pushBack(&c);
+
+        TEST_CHECK(!q.empty());
+        TEST_CHECK(q.front() == &a);
+        TEST_CHECK(EventMessageQueue::next(&a) == &b);
+        TEST_CHECK(EventMessageQueue::next(&c) == nullptr);
+        TEST_CHECK((collect(q) == std::vector<EventMessage*>{&a, &b, &c}));
+    }
+
+    void testRemove()
+    {
+        EventMessageQueue q;
+        EventMessage a, b, c, d;
+        q.pushBack(&a);
+        q.pushBack(&b);
+        q.pushBack(&c);
+        q.pushBack(&d);
+
+        // Middle, front and back each fix up different links
+        q.remove(&b);
+        TEST_CHECK((collect(q) == std::vector<EventMessage*>{&a, &c, &d}));
+        TEST_CHECK(b.queueLink.prev == nullptr && b.queueLink.next == nullptr);
+
+        q.remove(&a);
+        TEST_CHECK((collect(q) == std::vector<EventMessage*>{&c, &d}));
+
+        q.remove(&d);
+        TEST_CHECK((collect(q) == std::vector<EventMessage*>{&c}));
+
+        q.remove(&c);
+        TEST_CHECK(q.empty());
+        TEST_CHECK(q.back() == nullptr);
+
+        // Taken out messages can go into a queue again
+        q.pushBack(&b);
+        q.pushBack(&a);
+        TEST_CHECK((collect(q) == std::vector<EventMessage*>{&b, &a}));
+    }
+
+    void testLinksAreNotCopied()
+    {
+        EventMessageQueue q;
+        EventMessage a, b;
+        q.pushBack(&a);
+        q.pushBack(&b);
+
+        // A copy of a queued message isn't inside the queue
+        EventMessage copy(a);
+        TEST_CHECK(copy.queueLink.prev == nullptr && copy.queueLink.next == nullptr);
+
+        copy = b;
+        TEST_CHECK(copy.queueLink.prev == nullptr && copy.queueLink.next == nullptr);
+
+        q.pushBack(&copy);
+        TEST_CHECK((collect(q) == std::vector<EventMessage*>{&a, &b, &copy}));
+    }
+
+    void testPooledMessages()
+    {
+        EventMessageQueue q;
+
+        // Messages usually come from the message-pool
+        std::vector<EventMessage*> messages;
+        for(int i = 0; i < 100; i++)
+        {
+            messages.push_back(new EventMessage());
+            q.pushBack(messages.back());
+        }
+
+        // Complete every other one, like the EventManager does when messages finish out of order
+        for(size_t i = 0; i < messages.size(); i += 2)
+        {
+            q.remove(messages[i]);
+            delete messages[i];
+        }
+
+        TEST_CHECK_EQUAL(q.size(), 50u);
+
+        size_t i = 1;
+        for(EventMessage* m = q.front(); m; m = EventMessageQueue::next(m), i += 2)
+            TEST_CHECK(m == messages[i]);
+
+        while(!q.empty())
+        {
+            EventMessage* m = q.front();
+            q.remove(m);
+            delete m;
+        }
+    }
+}
+
+int main()
+{
+    testFIFO();
+    testRemove();
+    testLinksAreNotCopied();
+    testPooledMessages();
+
+    return Tests::result();
+}
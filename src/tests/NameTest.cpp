@@ -0,0 +1,106 @@
+#include "Test.h"
+#include <utils/Name.h>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace
+{
+    void testEmpty()
+    {
+        Utils::Name n;
+        TEST_CHECK(n.empty());
+        TEST_CHECK_EQUAL(n.getIndex(), 0u);
+        TEST_CHECK_EQUAL(n.str(), std::string());
+
+        // Interning the empty string gives the empty name
+        TEST_CHECK(Utils::Name("") == n);
+    }
+
+    void testCaseInsensitive()
+    {
+        Utils::Name a("Test_Waypoint");
+        Utils::Name b(std::string("TEST_WAYPOINT"));
+        Utils::Name c("test_waypoint");
+
+        TEST_CHECK(a == b);
+        TEST_CHECK(a == c);
+        TEST_CHECK(!a.empty());
+        TEST_CHECK_EQUAL(a.str(), std::string("TEST_WAYPOINT"));
+        TEST_CHECK_EQUAL(std::string(a.c_str()), std::string("TEST_WAYPOINT"));
+
+        Utils::Name other("Test_Waypoint_2");
+        TEST_CHECK(a != other);
+        TEST_CHECK(a.getIndex() != other.getIndex());
+
+        // Interned in that order
+        TEST_CHECK(a < other);
+    }
+
+    void testFindDoesNotIntern()
+    {
+        size_t before = Utils::Name::getNumNames();
+
+        // Misses don't grow the table
+        TEST_CHECK(Utils::Name::find("NameTest_Never_Interned").empty());
+        TEST_CHECK(Utils::Name::find("nametest_never_interned").empty());
+        TEST_CHECK_EQUAL(Utils::Name::getNumNames(), before);
+
+        Utils::Name n("NameTest_Interned");
+        TEST_CHECK_EQUAL(Utils::Name::getNumNames(), before + 1);
+        TEST_CHECK(Utils::Name::find("nametest_INTERNED") == n);
+
+        // Interning again doesn't add anything either
+        Utils::Name again("NAMETEST_interned");
+        TEST_CHECK(again == n);
+        TEST_CHECK_EQUAL(Utils::Name::getNumNames(), before + 1);
+    }
+
+    void testHash()
+    {
+        std::unordered_map<Utils::Name, int> map;
+        map[Utils::Name("NameTest_A")] = 1;
+        map[Utils::Name("NameTest_B")] = 2;
+
+        TEST_CHECK_EQUAL(map[Utils::Name("nametest_a")], 1);
+        TEST_CHECK_EQUAL(map.count(Utils::Name::find("NAMETEST_B")), 1u);
+        TEST_CHECK_EQUAL(map.count(Utils::Name::find("NameTest_C")), 0u);
+    }
+
+    void testThreads()
+    {
+        // Every thread interns the same names, all of them must end up with the same entries
+        const int numThreads = 4;
+        const int numNames = 1000;
+        std::vector<std::vector<Utils::Name>> results(numThreads);
+
+        std::vector<std::thread> threads;
+        for(int t = 0; t < numThreads; t++)
+        {
+            threads.emplace_back([&results, t, numNames](){
+                for(int i = 0; i < numNames; i++)
+                    results[t].push_back(Utils::Name("NameTest_Thread_" + std::to_string(i)));
+            });
+        }
+
+        for(std::thread& t : threads)
+            t.join();
+
+        for(int t = 1; t < numThreads; t++)
+            TEST_CHECK((results[t] == results[0]));
+
+        TEST_CHECK(Utils::Name::find("NAMETEST_THREAD_999") == results[0].back());
+    }
+}
+
+int main()
+{
+    testEmpty();
+    testCaseInsensitive();
+    testFindDoesNotIntern();
+    testHash();
+    testThreads();
+
+    return Tests::result();
+}
@@ -0,0 +1,207 @@
+#include "Test.h"
+#include <logic/RoutineScheduler.h>
+#include <map>
+#include <vector>
+
+using namespace Logic;
+
+namespace
+{
+    Handle::EntityHandle makeNpc(uint32_t index, uint32_t generation = 1)
+    {
+        Handle::EntityHandle h;
+        h.index = index;
+        h.generation = generation;
+        return h;
+    }
+
+    RoutineEntry makeEntry(int hoursStart, int minutesStart, int hoursEnd, int minutesEnd)
+    {
+        RoutineEntry e;
+        e.hoursStart = hoursStart;
+        e.minutesStart = minutesStart;
+        e.hoursEnd = hoursEnd;
+        e.minutesEnd = minutesEnd;
+        e.symFunc = 0;
+        e.isOverlay = false;
+        return e;
+    }
+
+    void testTimeInRange()
+    {
+        RoutineEntry day = makeEntry(8, 0, 20, 0);
+        TEST_CHECK(day.timeInRange(12, 0));
+        TEST_CHECK(day.timeInRange(8, 1));
+
+        // Start and end themselves are not part of it
+        TEST_CHECK(!day.timeInRange(8, 0));
+        TEST_CHECK(!day.timeInRange(20, 0));
+        TEST_CHECK(!day.timeInRange(22, 0));
+
+        RoutineEntry night = makeEntry(20, 0, 8, 0);
+        TEST_CHECK(night.timeInRange(23, 0));
+        TEST_CHECK(night.timeInRange(0, 0));
+        TEST_CHECK(night.timeInRange(3, 0));
+        TEST_CHECK(!night.timeInRange(12, 0));
+    }
+
+    void testFindActiveEntry()
+    {
+        std::vector<RoutineEntry> routine = {makeEntry(8, 0, 20, 0), makeEntry(20, 0, 8, 0)};
+
+        TEST_CHECK_EQUAL(Routine::findActiveEntry(routine, 1, 12 * 60), 0u);
+        TEST_CHECK_EQUAL(Routine::findActiveEntry(routine, 0, 23 * 60), 1u);
+
+        // At the boundary, neither matches, so the active one stays
+        TEST_CHECK_EQUAL(Routine::findActiveEntry(routine, 1, 8 * 60), 1u);
+        TEST_CHECK_EQUAL(Routine::findActiveEntry(routine, 0, 8 * 60), 0u);
+    }
+
+    void testGetNextTransition()
+    {
+        TEST_CHECK_EQUAL(Routine::getNextTransition({}, 100), -1);
+
+        std::vector<RoutineEntry> routine = {makeEntry(8, 0, 20, 0), makeEntry(20, 0, 8, 0)};
+        const int64_t day = Routine::MINUTES_PER_DAY;
+
+        // Next boundary is 20:00, where the day-entry ends
+        TEST_CHECK_EQUAL(Routine::getNextTransition(routine, 12 * 60), 20 * 60);
+
+        // Then 20:01, where the night-entry becomes valid
+        TEST_CHECK_EQUAL(Routine::getNextTransition(routine, 20 * 60), 20 * 60 + 1);
+
+        // Always strictly in the future, also across days
+        TEST_CHECK_EQUAL(Routine::getNextTransition(routine, 3 * day + 23 * 60), 4 * day + 8 * 60);
+    }
+
+    void testFiresInOrder()
+    {
+        RoutineScheduler s;
+        s.schedule(makeNpc(3), 30);
+        s.schedule(makeNpc(1), 10);
+        s.schedule(makeNpc(2), 20);
+
+        std::vector<uint32_t> fired;
+        auto record = [&](Handle::EntityHandle npc, int64_t now) -> int64_t {
+            fired.push_back(npc.index);
+            return -1;
+        };
+
+        TEST_CHECK_EQUAL(s.update(5, record), 0u);
+        TEST_CHECK_EQUAL(s.update(20, record), 2u);
+        TEST_CHECK((fired == std::vector<uint32_t>{1, 2}));
+
+        TEST_CHECK_EQUAL(s.update(100, record), 1u);
+        TEST_CHECK_EQUAL(fired.back(), 3u);
+
+        // Returning -1 doesn't schedule anything again
+        TEST_CHECK_EQUAL(s.getStats().numScheduled, 0u);
+        TEST_CHECK_EQUAL(s.getStats().numFired, 3u);
+    }
+
+    void testRescheduleAndUnschedule()
+    {
+        RoutineScheduler s;
+        std::map<uint32_t, int> numFired;
+        auto count = [&](Handle::EntityHandle npc, int64_t now) -> int64_t {
+            numFired[npc.index]++;
+            return -1;
+        };
+
+        // Only the last schedule counts
+        s.schedule(makeNpc(1), 10);
+        s.schedule(makeNpc(1), 50);
+        TEST_CHECK_EQUAL(s.getStats().numScheduled, 1u);
+
+        s.update(20, count);
+        TEST_CHECK_EQUAL(numFired[1], 0);
+
+        s.update(50, count);
+        TEST_CHECK_EQUAL(numFired[1], 1);
+
+        // Removed ones don't fire at all
+        s.schedule(makeNpc(2), 60);
+        s.unschedule(makeNpc(2));
+        TEST_CHECK_EQUAL(s.getStats().numScheduled, 0u);
+
+        s.update(100, count);
+        TEST_CHECK_EQUAL(numFired[2], 0);
+
+        // Unscheduling an other entity on the same slot must not touch the live one
+        s.schedule(makeNpc(3, 2), 110);
+        s.unschedule(makeNpc(3, 1));
+        s.update(110, count);
+        TEST_CHECK_EQUAL(numFired[3], 1);
+    }
+
+    void testSkipAheadFiresOnce()
+    {
+        RoutineScheduler s;
+        s.schedule(makeNpc(1), 10);
+
+        size_t numCalls = 0;
+        auto every10 = [&](Handle::EntityHandle npc, int64_t now) -> int64_t {
+            numCalls++;
+            return now + 10;
+        };
+
+        // Jumping forward a whole day fires once, with the time it jumped to
+        s.update(Routine::MINUTES_PER_DAY, every10);
+        TEST_CHECK_EQUAL(numCalls, 1u);
+
+        s.update(Routine::MINUTES_PER_DAY + 10, every10);
+        TEST_CHECK_EQUAL(numCalls, 2u);
+        TEST_CHECK_EQUAL(s.getStats().numScheduled, 1u);
+    }
+
+    void testTimeGoingBackwards()
+    {
+        RoutineScheduler s;
+        s.schedule(makeNpc(1), 500);
+        s.schedule(makeNpc(2), 600);
+        s.update(100, [](Handle::EntityHandle, int64_t) -> int64_t { return -1; });
+
+        // Everyone scheduled fires right away, so they can pick their entry for the new time
+        size_t numCalls = 0;
+        s.update(50, [&](Handle::EntityHandle npc, int64_t now) -> int64_t {
+            numCalls++;
+            TEST_CHECK_EQUAL(now, 50);
+            return 1000;
+        });
+
+        TEST_CHECK_EQUAL(numCalls, 2u);
+        TEST_CHECK_EQUAL(s.getStats().numRebuilds, 1u);
+        TEST_CHECK_EQUAL(s.getStats().numScheduled, 2u);
+    }
+
+    void testDeadEntriesAreCompacted()
+    {
+        RoutineScheduler s;
+
+        for(int round = 0; round < 10; round++)
+        {
+            for(uint32_t i = 0; i < 100; i++)
+                s.schedule(makeNpc(i), 1000 + i);
+
+            for(uint32_t i = 0; i < 100; i++)
+                s.unschedule(makeNpc(i));
+        }
+
+        TEST_CHECK_EQUAL(s.getStats().numScheduled, 0u);
+        TEST_CHECK(s.getStats().numHeapEntries <= 64u);
+    }
+}
+
+int main()
+{
+    testTimeInRange();
+    testFindActiveEntry();
+    testGetNextTransition();
+    testFiresInOrder();
+    testRescheduleAndUnschedule();
+    testSkipAheadFiresOnce();
+    testTimeGoingBackwards();
+    testDeadEntriesAreCompacted();
+
+    return Tests::result();
+}
@@ -0,0 +1,104 @@
+#include "Test.h"
+#include <memory/SizeClassPool.h>
+#include <cstdint>
+#include <cstring>
+#include <set>
+#include <vector>
+
+namespace
+{
+    void testSizeClasses()
+    {
+        TEST_CHECK_EQUAL(Memory::SizeClassPool::getSizeClass(1), 0);
+        TEST_CHECK_EQUAL(Memory::SizeClassPool::getSizeClass(64), 0);
+        TEST_CHECK_EQUAL(Memory::SizeClassPool::getSizeClass(65), 1);
+        TEST_CHECK_EQUAL(Memory::SizeClassPool::getSizeClass(512), 3);
+        TEST_CHECK_EQUAL(Memory::SizeClassPool::getSizeClass(513), -1);
+    }
+
+    void testReuse()
+    {
+        Memory::SizeClassPool pool;
+
+        // A whole chunk comes from a single system-allocation
+        std::vector<void*> blocks;
+        for(int i = 0; i < Memory::SizeClassPool::BLOCKS_PER_CHUNK; i++)
+            blocks.push_back(pool.allocate(48));
+
+        TEST_CHECK_EQUAL(pool.getStats().numSystemAllocations, 1u);
+        TEST_CHECK_EQUAL(pool.getStats().numLive, size_t(Memory::SizeClassPool::BLOCKS_PER_CHUNK));
+
+        // All distinct, aligned and usable
+        std::set<void*> unique(blocks.begin(), blocks.end());
+        TEST_CHECK_EQUAL(unique.size(), blocks.size());
+
+        for(void* p : blocks)
+        {
+            TEST_CHECK(reinterpret_cast<uintptr_t>(p) % 16 == 0);
+            memset(p, 0xAB, 48);
+        }
+
+        for(void* p : blocks)
+            pool.deallocate(p, 48);
+
+        TEST_CHECK_EQUAL(pool.getStats().numLive, 0u);
+
+        // Freed blocks are handed out again, without going to the system
+        for(int i = 0; i < Memory::SizeClassPool::BLOCKS_PER_CHUNK; i++)
+        {
+            void* p = pool.allocate(64);
+            TEST_CHECK(unique.count(p) == 1);
+        }
+
+        TEST_CHECK_EQUAL(pool.getStats().numSystemAllocations, 1u);
+        TEST_CHECK_EQUAL(pool.getStats().numPeakLive, size_t(Memory::SizeClassPool::BLOCKS_PER_CHUNK));
+
+        // Once the chunk is used up, the next one is taken
+        pool.allocate(64);
+        TEST_CHECK_EQUAL(pool.getStats().numSystemAllocations, 2u);
+    }
+
+    void testSizeClassesAreSeparate()
+    {
+        Memory::SizeClassPool pool;
+
+        void* small = pool.allocate(32);
+        pool.deallocate(small, 32);
+
+        // A bigger request must not get the smaller block
+        void* big = pool.allocate(200);
+        TEST_CHECK(big != small);
+        memset(big, 0, 200);
+
+        TEST_CHECK_EQUAL(pool.getStats().numSystemAllocations, 2u);
+        pool.deallocate(big, 200);
+    }
+
+    void testOversized()
+    {
+        Memory::SizeClassPool pool;
+
+        void* p = pool.allocate(4096);
+        memset(p, 0, 4096);
+
+        TEST_CHECK_EQUAL(pool.getStats().numSystemAllocations, 1u);
+        TEST_CHECK_EQUAL(pool.getStats().numBytesReserved, 0u);
+
+        pool.deallocate(p, 4096);
+        TEST_CHECK_EQUAL(pool.getStats().numLive, 0u);
+
+        // Null is ignored, like delete does
+        pool.deallocate(nullptr, 64);
+        TEST_CHECK_EQUAL(pool.getStats().numLive, 0u);
+    }
+}
+
+int main()
+{
+    testSizeClasses();
+    testReuse();
+    testSizeClassesAreSeparate();
+    testOversized();
+
+    return Tests::result();
+}
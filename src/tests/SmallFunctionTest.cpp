@@ -0,0 +1,157 @@
+#include "Test.h"
+#include <utils/SmallFunction.h>
+#include <memory>
+#include <string>
+#include <type_traits>
+#include <vector>
+
+namespace
+{
+    /**
+     * Counts how many instances of a callable are alive, so leaks and double-destroys show up
+     */
+    struct Tracked
+    {
+        static int s_NumAlive;
+        static int s_NumCopies;
+
+        Tracked() { s_NumAlive++; }
+        Tracked(const Tracked&) { s_NumAlive++; s_NumCopies++; }
+        Tracked(Tracked&&) noexcept { s_NumAlive++; }
+        ~Tracked() { s_NumAlive--; }
+    };
+
+    int Tracked::s_NumAlive = 0;
+    int Tracked::s_NumCopies = 0;
+
+    typedef Utils::SmallFunction<int(int)> Function;
+
+    struct Big
+    {
+        char padding[128];
+    };
+
+    void testEmpty()
+    {
+        Function f;
+        TEST_CHECK(!f);
+
+        f = [](int x){ return x; };
+        TEST_CHECK(static_cast<bool>(f));
+
+        f.reset();
+        TEST_CHECK(!f);
+    }
+
+    void testInline()
+    {
+        int base = 10;
+        Tracked t;
+        auto lambda = [base, t](int x){ return base + x; };
+
+        TEST_CHECK(Function::fitsInline<decltype(lambda)>());
+
+        {
+            Function f = lambda;
+            TEST_CHECK_EQUAL(f(5), 15);
+            TEST_CHECK_EQUAL(Tracked::s_NumAlive, 3);
+
+            // Copies are independent
+            Function copy = f;
+            TEST_CHECK_EQUAL(copy(1), 11);
+            TEST_CHECK_EQUAL(Tracked::s_NumAlive, 4);
+
+            // Moving leaves the source empty and doesn't duplicate the callable
+            Function moved = std::move(copy);
+            TEST_CHECK(!copy);
+            TEST_CHECK_EQUAL(moved(2), 12);
+            TEST_CHECK_EQUAL(Tracked::s_NumAlive, 4);
+        }
+
+        TEST_CHECK_EQUAL(Tracked::s_NumAlive, 2);
+    }
+
+    void testHeap()
+    {
+        Big big;
+        big.padding[0] = 7;
+        Tracked t;
+        auto lambda = [big, t](int x){ return big.padding[0] + x; };
+
+        TEST_CHECK(!Function::fitsInline<decltype(lambda)>());
+
+        {
+            Function f = lambda;
+            TEST_CHECK_EQUAL(f(1), 8);
+
+            Function copy = f;
+            TEST_CHECK_EQUAL(copy(2), 9);
+            TEST_CHECK_EQUAL(Tracked::s_NumAlive, 4);
+
+            Function moved = std::move(f);
+            TEST_CHECK(!f);
+            TEST_CHECK_EQUAL(moved(3), 10);
+            TEST_CHECK_EQUAL(Tracked::s_NumAlive, 4);
+
+            // Assigning over a stored callable destroys the old one
+            moved = copy;
+            TEST_CHECK_EQUAL(Tracked::s_NumAlive, 4);
+            moved = Function();
+            TEST_CHECK_EQUAL(Tracked::s_NumAlive, 3);
+        }
+
+        TEST_CHECK_EQUAL(Tracked::s_NumAlive, 2);
+    }
+
+    void testVectorGrowth()
+    {
+        // Without noexcept-moves, std::vector copies on reallocation, which is a new heap-allocation per callable
+        TEST_CHECK(std::is_nothrow_move_constructible<Function>::value);
+        TEST_CHECK(std::is_nothrow_move_assignable<Function>::value);
+
+        Tracked t;
+        Big big = {};
+        auto lambda = [t, big](int x){ return x + big.padding[0]; };
+
+        {
+            std::vector<Function> v;
+            for(int i = 0; i < 100; i++)
+                v.emplace_back(lambda);
+
+            int numCopies = Tracked::s_NumCopies;
+            v.shrink_to_fit();
+            v.emplace_back(lambda);
+            TEST_CHECK_EQUAL(Tracked::s_NumCopies, numCopies + 1);
+        }
+    }
+
+    void testArguments()
+    {
+        // Move-only arguments are passed through
+        Utils::SmallFunction<std::string(std::unique_ptr<std::string>)> f = [](std::unique_ptr<std::string> s){
+            return *s + "!";
+        };
+
+        TEST_CHECK_EQUAL(f(std::unique_ptr<std::string>(new std::string("Hello"))), std::string("Hello!"));
+
+        // References stay references
+        Utils::SmallFunction<void(int&)> inc = [](int& x){ x++; };
+        int v = 1;
+        inc(v);
+        TEST_CHECK_EQUAL(v, 2);
+    }
+}
+
+int main()
+{
+    testEmpty();
+    testInline();
+    TEST_CHECK_EQUAL(Tracked::s_NumAlive, 0);
+    testHeap();
+    TEST_CHECK_EQUAL(Tracked::s_NumAlive, 0);
+    testVectorGrowth();
+    TEST_CHECK_EQUAL(Tracked::s_NumAlive, 0);
+    testArguments();
+
+    return Tests::result();
+}
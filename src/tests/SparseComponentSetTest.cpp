@@ -0,0 +1,163 @@
+#include "Test.h"
+#include <memory/SparseAllocatorBundle.h>
+#include <memory/StaticReferencedAllocator.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+    struct Counters
+    {
+        int constructed;
+        int initialized;
+        int destroyed;
+    };
+
+    Counters s_Counters;
+
+    typedef Memory::GenericHandle<16, 16> Handle;
+
+    struct Component
+    {
+        Component()
+        {
+            s_Counters.constructed++;
+        }
+
+        Component& operator=(Component&& other)
+        {
+            name = std::move(other.name);
+            values = std::move(other.values);
+            return *this;
+        }
+
+        ~Component()
+        {
+            s_Counters.destroyed++;
+        }
+
+        static void init(Component& c)
+        {
+            c.values.push_back(-1);
+            s_Counters.initialized++;
+        }
+
+        std::string name;
+        std::vector<int> values;
+    };
+
+    typedef Memory::SparseComponentSet<Component, Handle, 1024> Set;
+
+    Handle makeHandle(uint32_t index, uint32_t generation = 1)
+    {
+        Handle h;
+        h.index = index;
+        h.generation = generation;
+        return h;
+    }
+
+    /**
+     * Long enough to not fit into the small-string-buffer
+     */
+    std::string makeName(int i)
+    {
+        return "Component number " + std::to_string(i) + ", with a long name to not be stored inline";
+    }
+
+    void testAddAndLookup()
+    {
+        s_Counters = Counters();
+
+        Set set;
+        TEST_CHECK(!set.has(makeHandle(5)));
+        TEST_CHECK(set.tryGet(makeHandle(5)) == nullptr);
+
+        // Far past anything committed yet, must still read as "none"
+        TEST_CHECK(!set.has(makeHandle(1000)));
+
+        Component& c = set.add(makeHandle(5));
+        TEST_CHECK_EQUAL(s_Counters.constructed, 1);
+        TEST_CHECK_EQUAL(s_Counters.initialized, 1);
+        TEST_CHECK_EQUAL(c.values.size(), 1u);
+
+        TEST_CHECK(set.has(makeHandle(5)));
+        TEST_CHECK(set.tryGet(makeHandle(5)) == &c);
+        TEST_CHECK(!set.has(makeHandle(4)));
+        TEST_CHECK_EQUAL(set.getNumElements(), 1u);
+
+        // get() only creates when there is nothing yet
+        TEST_CHECK(&set.get(makeHandle(5)) == &c);
+        set.get(makeHandle(7));
+        TEST_CHECK_EQUAL(s_Counters.constructed, 2);
+        TEST_CHECK_EQUAL(set.getNumElements(), 2u);
+    }
+
+    void testSwapRemove()
+    {
+        s_Counters = Counters();
+
+        {
+            Set set;
+            for(int i = 0; i < 4; i++)
+                set.add(makeHandle(10 * i)).name = makeName(i);
+
+            // Dense order is insertion order until something gets removed
+            TEST_CHECK_EQUAL(set.getOwners()[3].index, 30u);
+
+            set.remove(makeHandle(10));
+
+            // The last one moved into the hole, its sparse-entry follows
+            TEST_CHECK_EQUAL(s_Counters.destroyed, 1);
+            TEST_CHECK_EQUAL(set.getNumElements(), 3u);
+            TEST_CHECK(!set.has(makeHandle(10)));
+            TEST_CHECK_EQUAL(set.getOwners()[1].index, 30u);
+            TEST_CHECK_EQUAL(set.tryGet(makeHandle(30))->name, makeName(3));
+            TEST_CHECK_EQUAL(set.tryGet(makeHandle(0))->name, makeName(0));
+            TEST_CHECK_EQUAL(set.tryGet(makeHandle(20))->name, makeName(2));
+
+            // Removing twice or something never added does nothing
+            set.remove(makeHandle(10));
+            set.remove(makeHandle(11));
+            TEST_CHECK_EQUAL(s_Counters.destroyed, 1);
+
+            // Removing the last one doesn't move anything
+            set.remove(makeHandle(20));
+            TEST_CHECK_EQUAL(set.getNumElements(), 2u);
+            TEST_CHECK_EQUAL(set.tryGet(makeHandle(30))->name, makeName(3));
+
+            // Slots can be used again, with fresh components
+            Component& c = set.add(makeHandle(10, 2));
+            TEST_CHECK(c.name.empty());
+            TEST_CHECK_EQUAL(c.values.size(), 1u);
+        }
+
+        TEST_CHECK_EQUAL(s_Counters.destroyed, s_Counters.constructed);
+    }
+
+    void testClear()
+    {
+        s_Counters = Counters();
+
+        Set set;
+        for(uint32_t i = 0; i < 100; i++)
+            set.add(makeHandle(i));
+
+        set.clear();
+
+        TEST_CHECK_EQUAL(s_Counters.destroyed, 100);
+        TEST_CHECK_EQUAL(set.getNumElements(), 0u);
+        TEST_CHECK(!set.has(makeHandle(50)));
+
+        // High-water stays, so the stats still show the peak
+        TEST_CHECK_EQUAL(set.getStats().highWater, 100u);
+    }
+}
+
+int main()
+{
+    testAddAndLookup();
+    testSwapRemove();
+    testClear();
+
+    return Tests::result();
+}
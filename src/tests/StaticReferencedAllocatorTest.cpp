@@ -0,0 +1,185 @@
+#include "Test.h"
+#include <memory/StaticReferencedAllocator.h>
+#include <string>
+#include <vector>
+
+namespace
+{
+    /**
+     * Counts what happens to the elements, so the allocator can be checked to construct, move and destroy them
+     * exactly once each
+     */
+    struct Counters
+    {
+        int constructed;
+        int destroyed;
+        int moved;
+        int copied;
+    };
+
+    Counters s_Counters;
+
+    struct Element
+    {
+        typedef Memory::GenericHandle<16, 16> HandleType;
+
+        Element() :
+            values(3, 1)
+        {
+            s_Counters.constructed++;
+        }
+
+        Element(const Element& other) :
+            name(other.name),
+            values(other.values)
+        {
+            s_Counters.copied++;
+        }
+
+        Element& operator=(const Element& other)
+        {
+            name = other.name;
+            values = other.values;
+            s_Counters.copied++;
+            return *this;
+        }
+
+        Element& operator=(Element&& other)
+        {
+            name = std::move(other.name);
+            values = std::move(other.values);
+            s_Counters.moved++;
+            return *this;
+        }
+
+        ~Element()
+        {
+            s_Counters.destroyed++;
+        }
+
+        std::string name;
+        std::vector<int> values;
+    };
+
+    typedef Memory::StaticReferencedAllocator<Element, 64> Allocator;
+
+    /**
+     * Long enough to not fit into the small-string-buffer, so moving really hands over the memory
+     */
+    std::string makeName(int i)
+    {
+        return "Element number " + std::to_string(i) + ", with a long name to not be stored inline";
+    }
+
+    void testConstructOnCreate()
+    {
+        s_Counters = Counters();
+
+        Allocator alloc;
+        TEST_CHECK_EQUAL(s_Counters.constructed, 0);
+
+        Element::HandleType h = alloc.createObject();
+        TEST_CHECK_EQUAL(s_Counters.constructed, 1);
+        TEST_CHECK_EQUAL(alloc.getNumObtainedElements(), 1u);
+        TEST_CHECK(alloc.getElement(h).name.empty());
+        TEST_CHECK_EQUAL(alloc.getElement(h).values.size(), 3u);
+    }
+
+    void testSwapRemoveMoves()
+    {
+        s_Counters = Counters();
+
+        {
+            Allocator alloc;
+            std::vector<Element::HandleType> handles;
+
+            for(int i = 0; i < 4; i++)
+            {
+                handles.push_back(alloc.createObject());
+                alloc.getElement(handles.back()).name = makeName(i);
+                alloc.getElement(handles.back()).values.push_back(i);
+            }
+
+            const char* lastData = alloc.getElement(handles[3]).name.data();
+
+            // The last element is moved into the hole and its old slot destroyed
+            alloc.removeObject(handles[1]);
+
+            TEST_CHECK_EQUAL(s_Counters.constructed, 4);
+            TEST_CHECK_EQUAL(s_Counters.moved, 1);
+            TEST_CHECK_EQUAL(s_Counters.copied, 0);
+            TEST_CHECK_EQUAL(s_Counters.destroyed, 1);
+            TEST_CHECK_EQUAL(alloc.getNumObtainedElements(), 3u);
+
+            // Handles of the others still resolve to their data, the moved one kept its memory
+            TEST_CHECK_EQUAL(alloc.getElement(handles[0]).name, makeName(0));
+            TEST_CHECK_EQUAL(alloc.getElement(handles[2]).name, makeName(2));
+            TEST_CHECK_EQUAL(alloc.getElement(handles[3]).name, makeName(3));
+            TEST_CHECK_EQUAL(alloc.getElement(handles[3]).values.back(), 3);
+            TEST_CHECK(alloc.getElement(handles[3]).name.data() == lastData);
+
+            // Removing the last one doesn't need to move anything
+            alloc.removeObject(handles[2]);
+
+            TEST_CHECK_EQUAL(s_Counters.moved, 1);
+            TEST_CHECK_EQUAL(s_Counters.destroyed, 2);
+
+            // Slots are reused
+            Element::HandleType h = alloc.createObject();
+            TEST_CHECK_EQUAL(s_Counters.constructed, 5);
+            TEST_CHECK(alloc.getElement(h).name.empty());
+            TEST_CHECK(!(h == handles[1]) && !(h == handles[2]));
+        }
+
+        // Everything left is destroyed along with the allocator
+        TEST_CHECK_EQUAL(s_Counters.destroyed, s_Counters.constructed);
+    }
+
+    void testRemoveCallback()
+    {
+        s_Counters = Counters();
+
+        Allocator alloc;
+        std::string removedName;
+        alloc.setOnRemoveCallback([&](Element& e){ removedName = e.name; });
+
+        Element::HandleType a = alloc.createObject();
+        Element::HandleType b = alloc.createObject();
+        alloc.getElement(a).name = makeName(0);
+        alloc.getElement(b).name = makeName(1);
+
+        alloc.removeObject(a);
+
+        // Called with the element itself, before it is overwritten
+        TEST_CHECK_EQUAL(removedName, makeName(0));
+        TEST_CHECK_EQUAL(alloc.getElement(b).name, makeName(1));
+    }
+
+    void testKill()
+    {
+        s_Counters = Counters();
+
+        {
+            Allocator alloc;
+            for(int i = 0; i < 10; i++)
+                alloc.createObject();
+
+            alloc.kill();
+
+            TEST_CHECK_EQUAL(s_Counters.destroyed, 10);
+        }
+
+        // The destructor must not destroy them again
+        TEST_CHECK_EQUAL(s_Counters.destroyed, 10);
+    }
+}
+
+int main()
+{
+    testConstructOnCreate();
+    testSwapRemoveMoves();
+    testRemoveCallback();
+    testKill();
+
+    return Tests::result();
+}
@@ -0,0 +1,46 @@
+#pragma once
+#include <iostream>
+
+/**
+ * Minimal checks for the unit-tests. Every test is an executable of its own, which runs its test-functions from main()
+ * and returns Tests::result(). A failed check is reported, but doesn't stop the test.
+ */
+namespace Tests
+{
+    /**
+     * @return Number of checks which failed so far
+     */
+    inline int& numFailed()
+    {
+        static int s_NumFailed = 0;
+        return s_NumFailed;
+    }
+
+    /**
+     * @return Exit-code for main(): 0 if all checks passed
+     */
+    inline int result()
+    {
+        if(numFailed() != 0)
+            std::cerr << numFailed() << " check(s) failed" << std::endl;
+
+        return numFailed() == 0 ? 0 : 1;
+    }
+}
+
+#define TEST_CHECK(expr) \
+    do { \
+        if(!(expr)) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": Check failed: " << #expr << std::endl; \
+            Tests::numFailed()++; \
+        } \
+    } while(0)
+
+#define TEST_CHECK_EQUAL(a, b) \
+    do { \
+        if(!((a) == (b))) { \
+            std::cerr << __FILE__ << ":" << __LINE__ << ": Check failed: " << #a << " == " << #b \
+                      << " (" << (a) << " vs. " << (b) << ")" << std::endl; \
+            Tests::numFailed()++; \
+        } \
+    } while(0)
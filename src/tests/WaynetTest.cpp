@@ -0,0 +1,178 @@
+#include "Test.h"
+#include <engine/Waynet.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+using namespace World;
+
+namespace
+{
+    /**
+     * Grid of waypoints named "WP_<x>_<z>", 1m apart, with edges between horizontal and vertical neighbours
+     */
+    Waynet::WaynetInstance makeGrid(int width, int height)
+    {
+        Waynet::WaynetInstance w;
+
+        for(int z = 0; z < height; z++)
+        {
+            for(int x = 0; x < width; x++)
+            {
+                Waynet::Waypoint wp;
+                wp.name = Utils::Name("WP_" + std::to_string(x) + "_" + std::to_string(z));
+                wp.position = Math::float3(static_cast<float>(x), 0.0f, static_cast<float>(z));
+                wp.direction = Math::float3(0.0f, 0.0f, 1.0f);
+                wp.waterDepth = 0.0f;
+                wp.underWater = false;
+
+                Waynet::addWaypoint(w, wp);
+            }
+        }
+
+        auto connect = [&](size_t a, size_t b){
+            w.waypoints[a].edges.push_back(b);
+            w.waypoints[b].edges.push_back(a);
+        };
+
+        for(int z = 0; z < height; z++)
+        {
+            for(int x = 0; x < width; x++)
+            {
+                size_t i = static_cast<size_t>(z * width + x);
+
+                if(x + 1 < width)
+                    connect(i, i + 1);
+
+                if(z + 1 < height)
+                    connect(i, i + width);
+            }
+        }
+
+        return w;
+    }
+
+    /**
+     * @return Whether every step of the path goes along an edge
+     */
+    bool followsEdges(const Waynet::WaynetInstance& w, const std::vector<size_t>& path)
+    {
+        for(size_t i = 0; i + 1 < path.size(); i++)
+        {
+            const std::vector<Waynet::WaypointIndex>& edges = w.waypoints[path[i]].edges;
+            if(std::find(edges.begin(), edges.end(), path[i + 1]) == edges.end())
+                return false;
+        }
+
+        return true;
+    }
+
+    void testLookup()
+    {
+        Waynet::WaynetInstance w = makeGrid(3, 3);
+
+        TEST_CHECK_EQUAL(Waynet::getWaypointIndex(w, std::string("WP_2_1")), 5u);
+        TEST_CHECK_EQUAL(Waynet::getWaypointIndex(w, std::string("wp_2_1")), 5u);
+        TEST_CHECK(Waynet::waypointExists(w, std::string("WP_0_0")));
+
+        // Unknown names don't get interned and don't match anything
+        TEST_CHECK(!Waynet::waypointExists(w, std::string("WaynetTest_Unknown")));
+        TEST_CHECK(Utils::Name::find("WaynetTest_Unknown").empty());
+        TEST_CHECK(Waynet::getWaypointIndex(w, std::string("")) == Waynet::INVALID_WAYPOINT);
+    }
+
+    void testFindWay()
+    {
+        Waynet::WaynetInstance w = makeGrid(4, 4);
+
+        // Corner to corner takes the manhattan-distance in steps, start and end included
+        std::vector<size_t> path = Waynet::findWay(w, 0, 15);
+        TEST_CHECK_EQUAL(path.size(), 7u);
+        TEST_CHECK_EQUAL(path.front(), 0u);
+        TEST_CHECK_EQUAL(path.back(), 15u);
+        TEST_CHECK(followsEdges(w, path));
+        TEST_CHECK_EQUAL(Waynet::getPathLength(w, path), 6.0f);
+
+        // Neighbours
+        path = Waynet::findWay(w, 5, 6);
+        TEST_CHECK((path == std::vector<size_t>{5, 6}));
+
+        // Nothing to walk, or nothing to walk to
+        TEST_CHECK(Waynet::findWay(w, 3, 3).empty());
+        TEST_CHECK(Waynet::findWay(w, 0, 16).empty());
+        TEST_CHECK(Waynet::findWay(w, Waynet::INVALID_WAYPOINT, 0).empty());
+    }
+
+    void testFindWayAroundGap()
+    {
+        // Cut the middle row of a 3x3 grid apart except for its right end, so the way has to go around
+        Waynet::WaynetInstance w = makeGrid(3, 3);
+
+        auto disconnect = [&](size_t a, size_t b){
+            auto& ea = w.waypoints[a].edges;
+            auto& eb = w.waypoints[b].edges;
+            ea.erase(std::remove(ea.begin(), ea.end(), b), ea.end());
+            eb.erase(std::remove(eb.begin(), eb.end(), a), eb.end());
+        };
+
+        disconnect(0, 3);
+        disconnect(1, 4);
+
+        std::vector<size_t> path = Waynet::findWay(w, 0, 3);
+        TEST_CHECK((path == std::vector<size_t>{0, 1, 2, 5, 4, 3}));
+        TEST_CHECK(followsEdges(w, path));
+
+        // Unreachable
+        disconnect(2, 5);
+        TEST_CHECK(Waynet::findWay(w, 0, 3).empty());
+        TEST_CHECK(Waynet::findWay(w, 0, 8).empty());
+    }
+
+    void testPrefersShorterWay()
+    {
+        // Two ways around an obstacle, one hugging it and one taking a wide berth
+        Waynet::WaynetInstance w;
+        const float positions[][3] = {{0, 0, 0}, {10, 0, 0}, {5, 0, 4}, {5, 0, 1}};
+
+        for(int i = 0; i < 4; i++)
+        {
+            Waynet::Waypoint wp;
+            wp.name = Utils::Name("WaynetTest_Way_" + std::to_string(i));
+            wp.position = Math::float3(positions[i][0], positions[i][1], positions[i][2]);
+            wp.waterDepth = 0.0f;
+            wp.underWater = false;
+            Waynet::addWaypoint(w, wp);
+        }
+
+        // The wide one is found first
+        w.waypoints[0].edges = {2, 3};
+        w.waypoints[1].edges = {2, 3};
+        w.waypoints[2].edges = {0, 1};
+        w.waypoints[3].edges = {0, 1};
+
+        TEST_CHECK((Waynet::findWay(w, 0, 1) == std::vector<size_t>{0, 3, 1}));
+        TEST_CHECK((Waynet::findWay(w, 1, 0) == std::vector<size_t>{1, 3, 0}));
+    }
+
+    void testNearest()
+    {
+        Waynet::WaynetInstance w = makeGrid(3, 3);
+
+        TEST_CHECK_EQUAL(Waynet::findNearestWaypointTo(w, Math::float3(1.9f, 5.0f, 0.2f)), 2u);
+        TEST_CHECK_EQUAL(Waynet::findNearestWaypointTo(w, Math::float3(-4.0f, 0.0f, 10.0f)), 6u);
+
+        TEST_CHECK(Waynet::findNearestWaypointTo(Waynet::WaynetInstance(), Math::float3(0.0f, 0.0f, 0.0f))
+                   == static_cast<size_t>(-1));
+    }
+}
+
+int main()
+{
+    testLookup();
+    testFindWay();
+    testFindWayAroundGap();
+    testPrefersShorterWay();
+    testNearest();
+
+    return Tests::result();
+}
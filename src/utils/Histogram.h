@@ -0,0 +1,85 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+namespace Utils
+{
+    /**
+     * Counts values into power-of-two buckets: [0], [1], [2-3], [4-7], ... The last bucket takes everything above.
+     * Cheap enough to be fed every frame.
+     */
+    class Histogram
+    {
+    public:
+        enum { NUM_BUCKETS = 16 };
+
+        Histogram()
+        {
+            reset();
+        }
+
+        /**
+         * Counts the given value into its bucket
+         */
+        void add(uint64_t value)
+        {
+            size_t b = 0;
+            while(value && b < NUM_BUCKETS - 1)
+            {
+                value >>= 1;
+                b++;
+            }
+
+            m_Buckets[b]++;
+            m_NumSamples++;
+        }
+
+        void reset()
+        {
+            for(size_t& b : m_Buckets)
+                b = 0;
+
+            m_NumSamples = 0;
+        }
+
+        /**
+         * @return Number of values counted into the given bucket
+         */
+        size_t getBucket(size_t b) const { return m_Buckets[b]; }
+
+        /**
+         * @return Smallest value going into the given bucket
+         */
+        static uint64_t getBucketMin(size_t b) { return b == 0 ? 0 : uint64_t(1) << (b - 1); }
+
+        /**
+         * @return Number of values counted so far
+         */
+        size_t getNumSamples() const { return m_NumSamples; }
+
+        /**
+         * @return All non-empty buckets as "min+: count" pairs, separated by commas
+         */
+        std::string toString() const
+        {
+            std::string r;
+            for(size_t b = 0; b < NUM_BUCKETS; b++)
+            {
+                if(!m_Buckets[b])
+                    continue;
+
+                if(!r.empty())
+                    r += ", ";
+
+                r += std::to_string(getBucketMin(b)) + (b == 0 || b == 1 ? "" : "+") + ": " + std::to_string(m_Buckets[b]);
+            }
+
+            return r.empty() ? "empty" : r;
+        }
+
+    private:
+        size_t m_Buckets[NUM_BUCKETS];
+        size_t m_NumSamples;
+    };
+}
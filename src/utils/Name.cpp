@@ -0,0 +1,107 @@
+#include "Name.h"
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+#include <algorithm>
+#include <cctype>
+
+using namespace Utils;
+
+namespace
+{
+    /**
+     * All interned names. Leaked on purpose, names may still be around while static destructors run.
+     */
+    struct NameTable
+    {
+        NameTable()
+        {
+            // Index 0 is the empty name
+            entries.push_back({"", 0});
+            entriesByString[""] = &entries.front();
+        }
+
+        std::deque<Name::Entry> entries;
+        std::unordered_map<std::string, const Name::Entry*> entriesByString;
+        size_t numStringBytes = 0;
+        std::mutex mutex;
+    };
+
+    NameTable& getTable()
+    {
+        static NameTable* table = new NameTable;
+        return *table;
+    }
+
+    std::string normalize(const std::string& str)
+    {
+        std::string n = str;
+        std::transform(n.begin(), n.end(), n.begin(), [](unsigned char c){ return static_cast<char>(::toupper(c)); });
+
+        return n;
+    }
+}
+
+Name::Name() :
+        m_pEntry(&getTable().entries.front())
+{
+}
+
+Name::Name(const std::string& str) :
+        m_pEntry(lookup(str, true))
+{
+}
+
+Name::Name(const char* str) :
+        m_pEntry(lookup(str, true))
+{
+}
+
+Name Name::find(const std::string& str)
+{
+    const Entry* e = lookup(str, false);
+    return e ? Name(e) : Name();
+}
+
+const Name::Entry* Name::lookup(const std::string& str, bool create)
+{
+    NameTable& t = getTable();
+    std::string n = normalize(str);
+
+    std::lock_guard<std::mutex> guard(t.mutex);
+
+    auto it = t.entriesByString.find(n);
+    if(it != t.entriesByString.end())
+        return (*it).second;
+
+    if(!create)
+        return nullptr;
+
+    t.entries.push_back({n, static_cast<uint32_t>(t.entries.size())});
+    t.numStringBytes += n.size() + 1;
+
+    const Entry* e = &t.entries.back();
+    t.entriesByString[n] = e;
+
+    return e;
+}
+
+size_t Name::getNumNames()
+{
+    NameTable& t = getTable();
+    std::lock_guard<std::mutex> guard(t.mutex);
+
+    // Don't count the empty name
+    return t.entries.size() - 1;
+}
+
+size_t Name::getNumBytes()
+{
+    NameTable& t = getTable();
+    std::lock_guard<std::mutex> guard(t.mutex);
+
+    // Strings are stored twice: Inside the entry and as key of the map
+    return t.entries.size() * sizeof(Entry)
+           + t.entriesByString.size() * (sizeof(std::string) + sizeof(void*) * 3)
+           + t.numStringBytes * 2;
+}
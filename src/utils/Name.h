@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <cstddef>
+#include <string>
+#include <functional>
+
+namespace Utils
+{
+    /**
+     * Engine-wide interned name. Every distinct name is normalized to uppercase and stored exactly once,
+     * so comparing and hashing two names only touches an index, no matter how long they are.
+     * Gothic treats all of its names (vobs, waypoints, animations, files, script-symbols) case-insensitive,
+     * which is what this mirrors.
+     * Interning takes a lock, so names can be made from loader-threads. Reading them doesn't.
+     * Note: Names are never freed again.
+     */
+    class Name
+    {
+    public:
+
+        /**
+         * Creates the empty name
+         */
+        Name();
+
+        /**
+         * Interns the given string. Explicit, so strings can't end up in the table by accident.
+         * See find() for lookups.
+         */
+        explicit Name(const std::string& str);
+        explicit Name(const char* str);
+
+        /**
+         * @return The already interned name matching the given string. Empty, if it wasn't interned yet.
+         *         Use this for lookups with strings coming from outside, so misses don't grow the table.
+         */
+        static Name find(const std::string& str);
+
+        /**
+         * @return Normalized (uppercase) string of this name
+         */
+        const std::string& str() const { return m_pEntry->str; }
+        const char* c_str() const { return m_pEntry->str.c_str(); }
+
+        /**
+         * @return Index of this name inside the table. 0 for the empty name.
+         */
+        uint32_t getIndex() const { return m_pEntry->index; }
+
+        bool empty() const { return m_pEntry->index == 0; }
+
+        bool operator==(const Name& o) const { return m_pEntry == o.m_pEntry; }
+        bool operator!=(const Name& o) const { return m_pEntry != o.m_pEntry; }
+
+        /**
+         * Orders by order of interning, NOT alphabetically
+         */
+        bool operator<(const Name& o) const { return m_pEntry->index < o.m_pEntry->index; }
+
+        /**
+         * @return Number of distinct names interned so far
+         */
+        static size_t getNumNames();
+
+        /**
+         * @return Memory used by the name-table
+         */
+        static size_t getNumBytes();
+
+        /**
+         * Interned string. Never moves once created.
+         */
+        struct Entry
+        {
+            std::string str;
+            uint32_t index;
+        };
+
+    private:
+
+        explicit Name(const Entry* e) : m_pEntry(e) {}
+
+        /**
+         * @return Entry of the given string. Created, if it doesn't exist yet and create is true.
+         */
+        static const Entry* lookup(const std::string& str, bool create);
+
+        const Entry* m_pEntry;
+    };
+}
+
+namespace std
+{
+    template<>
+    struct hash<Utils::Name>
+    {
+        size_t operator()(const Utils::Name& n) const
+        {
+            return n.getIndex();
+        }
+    };
+}
@@ -0,0 +1,389 @@
+#include "Profiler.h"
+#include <mutex>
+#include <memory>
+#include <unordered_map>
+#include <fstream>
+#include <algorithm>
+#include <bx/timer.h>
+#include <utils/logger.h>
+
+using namespace Utils;
+
+std::atomic<bool> Profiler::detail::s_Enabled(false);
+
+namespace
+{
+    enum
+    {
+        BUFFER_SIZE = 1 << 14, // Events per thread between two frame-ends, must be a power of two
+        MAX_DEPTH = 64,
+        REPORT_WINDOW = 30, // Frames to average the top-list over
+    };
+
+    /**
+     * A finished zone
+     */
+    struct Event
+    {
+        const char* name;
+        int64_t start;
+        int64_t end;
+        int64_t childTicks;
+        uint16_t depth;
+        bool recursive; // Whether a zone of the same name was already open
+    };
+
+    /**
+     * Events of a single thread. Only the owning thread writes, only the main-thread reads.
+     */
+    struct ThreadBuffer
+    {
+        ThreadBuffer(uint32_t index) :
+                writePos(0),
+                readPos(0),
+                inUse(true),
+                threadIndex(index),
+                depth(0)
+        {
+        }
+
+        Event events[BUFFER_SIZE];
+        std::atomic<uint32_t> writePos;
+        std::atomic<uint32_t> readPos;
+
+        /** Cleared once the thread exits, so an other thread can take over the buffer */
+        std::atomic<bool> inUse;
+
+        uint32_t threadIndex;
+        std::string name; // Guarded by the registry-mutex
+
+        /**
+         * Zones currently open on the owning thread
+         */
+        struct OpenZone
+        {
+            const char* name;
+            int64_t start;
+            int64_t childTicks;
+            bool recursive;
+        };
+
+        OpenZone stack[MAX_DEPTH];
+        uint32_t depth;
+    };
+
+    struct Registry
+    {
+        Registry() :
+                numDropped(0)
+        {
+        }
+
+        std::mutex mutex;
+        std::vector<std::unique_ptr<ThreadBuffer>> buffers;
+        std::atomic<size_t> numDropped;
+    };
+
+    Registry& getRegistry()
+    {
+        static Registry r;
+        return r;
+    }
+
+    /**
+     * Hands the buffer back once the thread exits
+     */
+    struct ThreadBufferOwner
+    {
+        ThreadBuffer* buffer = nullptr;
+
+        ~ThreadBufferOwner()
+        {
+            if(buffer)
+                buffer->inUse.store(false, std::memory_order_release);
+        }
+    };
+
+    thread_local ThreadBufferOwner t_Owner;
+
+    ThreadBuffer& getThreadBuffer()
+    {
+        if(t_Owner.buffer)
+            return *t_Owner.buffer;
+
+        Registry& r = getRegistry();
+        std::lock_guard<std::mutex> guard(r.mutex);
+
+        // Reuse the buffer of a thread which is gone, once everything it recorded was collected
+        for(auto& b : r.buffers)
+        {
+            if(!b->inUse.load(std::memory_order_acquire)
+               && b->readPos.load(std::memory_order_acquire) == b->writePos.load(std::memory_order_acquire))
+            {
+                b->inUse.store(true, std::memory_order_relaxed);
+                b->depth = 0;
+                b->name.clear();
+
+                t_Owner.buffer = b.get();
+                return *t_Owner.buffer;
+            }
+        }
+
+        r.buffers.emplace_back(new ThreadBuffer(static_cast<uint32_t>(r.buffers.size())));
+        t_Owner.buffer = r.buffers.back().get();
+
+        return *t_Owner.buffer;
+    }
+
+    /*
+     * Everything below is only touched by the main-thread
+     */
+
+    struct Accumulator
+    {
+        uint64_t numCalls;
+        int64_t inclusive;
+        int64_t exclusive;
+    };
+
+    std::unordered_map<const char*, Accumulator> s_Window;
+    size_t s_WindowFrames = 0;
+    std::vector<Profiler::ZoneStats> s_Report;
+
+    struct CapturedEvent
+    {
+        Event event;
+        uint32_t thread;
+    };
+
+    std::vector<CapturedEvent> s_Capture;
+    std::string s_CaptureFile;
+    size_t s_CaptureFramesLeft = 0;
+    int64_t s_CaptureStart = 0;
+    bool s_EnabledBeforeCapture = false;
+
+    /**
+     * Sums up the current window into the report, merging zones of the same name from different translation-units
+     */
+    void updateReport()
+    {
+        const double toMs = 1000.0 / double(bx::getHPFrequency());
+        const double frames = double(std::max<size_t>(1, s_WindowFrames));
+
+        std::unordered_map<std::string, Profiler::ZoneStats> byName;
+        for(auto& p : s_Window)
+        {
+            Profiler::ZoneStats& s = byName.emplace(p.first, Profiler::ZoneStats{p.first, 0.0, 0.0, 0.0}).first->second;
+            s.numCalls += p.second.numCalls / frames;
+            s.inclusive += p.second.inclusive * toMs / frames;
+            s.exclusive += p.second.exclusive * toMs / frames;
+        }
+
+        s_Report.clear();
+        for(auto& p : byName)
+            s_Report.push_back(p.second);
+
+        std::sort(s_Report.begin(), s_Report.end(), [](const Profiler::ZoneStats& a, const Profiler::ZoneStats& b){
+            return a.exclusive > b.exclusive;
+        });
+
+        s_Window.clear();
+        s_WindowFrames = 0;
+    }
+
+    void writeJSONString(std::ostream& o, const std::string& s)
+    {
+        o << '"';
+        for(char c : s)
+        {
+            if(c == '"' || c == '\\')
+                o << '\\';
+
+            o << c;
+        }
+        o << '"';
+    }
+
+    bool writeCapture(const std::string& file, const std::vector<std::string>& threadNames)
+    {
+        const double toUs = 1000000.0 / double(bx::getHPFrequency());
+
+        std::ofstream f(file);
+        if(!f.is_open())
+            return false;
+
+        f << "{\"traceEvents\":[\n";
+
+        for(size_t i = 0; i < threadNames.size(); i++)
+        {
+            f << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":" << i << ",\"args\":{\"name\":";
+            writeJSONString(f, threadNames[i].empty() ? "Thread " + std::to_string(i) : threadNames[i]);
+            f << "}},\n";
+        }
+
+        for(size_t i = 0; i < s_Capture.size(); i++)
+        {
+            const Event& e = s_Capture[i].event;
+
+            f << "{\"name\":";
+            writeJSONString(f, e.name);
+            f << ",\"ph\":\"X\",\"pid\":0,\"tid\":" << s_Capture[i].thread
+              << ",\"ts\":" << (e.start - s_CaptureStart) * toUs
+              << ",\"dur\":" << (e.end - e.start) * toUs << "}"
+              << (i + 1 < s_Capture.size() ? ",\n" : "\n");
+        }
+
+        f << "]}\n";
+
+        return f.good();
+    }
+}
+
+void Profiler::setEnabled(bool enabled)
+{
+    detail::s_Enabled.store(enabled, std::memory_order_relaxed);
+}
+
+void Profiler::detail::beginZone(const char* name)
+{
+    ThreadBuffer& b = getThreadBuffer();
+
+    if(b.depth < MAX_DEPTH)
+    {
+        bool recursive = false;
+        for(uint32_t i = 0; i < b.depth; i++)
+            recursive = recursive || b.stack[i].name == name;
+
+        b.stack[b.depth] = {name, 0, 0, recursive};
+
+        // Take the time last, so the bookkeeping above isn't counted
+        b.stack[b.depth].start = bx::getHPCounter();
+    }
+
+    b.depth++;
+}
+
+void Profiler::detail::endZone()
+{
+    int64_t now = bx::getHPCounter();
+    ThreadBuffer& b = getThreadBuffer();
+
+    if(b.depth == 0)
+        return;
+
+    b.depth--;
+
+    // Too deep, wasn't recorded
+    if(b.depth >= MAX_DEPTH)
+        return;
+
+    const ThreadBuffer::OpenZone& z = b.stack[b.depth];
+    int64_t ticks = now - z.start;
+
+    if(b.depth > 0)
+        b.stack[b.depth - 1].childTicks += ticks;
+
+    uint32_t w = b.writePos.load(std::memory_order_relaxed);
+    if(w - b.readPos.load(std::memory_order_acquire) >= BUFFER_SIZE)
+    {
+        getRegistry().numDropped++;
+        return;
+    }
+
+    b.events[w & (BUFFER_SIZE - 1)] = {z.name, z.start, now, z.childTicks, static_cast<uint16_t>(b.depth), z.recursive};
+    b.writePos.store(w + 1, std::memory_order_release);
+}
+
+void Profiler::setThreadName(const char* name)
+{
+    ThreadBuffer& b = getThreadBuffer();
+
+    std::lock_guard<std::mutex> guard(getRegistry().mutex);
+    b.name = name;
+}
+
+void Profiler::onFrameEnd()
+{
+    Registry& r = getRegistry();
+    bool capturing = s_CaptureFramesLeft > 0;
+    std::vector<std::string> threadNames;
+
+    {
+        std::lock_guard<std::mutex> guard(r.mutex);
+
+        for(auto& b : r.buffers)
+        {
+            uint32_t read = b->readPos.load(std::memory_order_relaxed);
+            uint32_t write = b->writePos.load(std::memory_order_acquire);
+
+            for(; read != write; read++)
+            {
+                const Event& e = b->events[read & (BUFFER_SIZE - 1)];
+
+                Accumulator& a = s_Window[e.name];
+                a.numCalls++;
+                a.exclusive += (e.end - e.start) - e.childTicks;
+
+                if(!e.recursive)
+                    a.inclusive += e.end - e.start;
+
+                if(capturing && e.start >= s_CaptureStart)
+                    s_Capture.push_back({e, b->threadIndex});
+            }
+
+            b->readPos.store(read, std::memory_order_release);
+
+            if(capturing)
+                threadNames.push_back(b->name);
+        }
+    }
+
+    if(isEnabled())
+        s_WindowFrames++;
+
+    if(s_WindowFrames >= REPORT_WINDOW)
+        updateReport();
+
+    if(capturing && --s_CaptureFramesLeft == 0)
+    {
+        if(writeCapture(s_CaptureFile, threadNames))
+            LogInfo() << "Profiler: Wrote " << s_Capture.size() << " events to " << s_CaptureFile;
+        else
+            LogError() << "Profiler: Failed to write capture to " << s_CaptureFile;
+
+        s_Capture.clear();
+        s_Capture.shrink_to_fit();
+
+        setEnabled(s_EnabledBeforeCapture);
+    }
+}
+
+std::vector<Profiler::ZoneStats> Profiler::getTopZones(size_t n)
+{
+    return std::vector<ZoneStats>(s_Report.begin(), s_Report.begin() + std::min(n, s_Report.size()));
+}
+
+bool Profiler::startCapture(size_t numFrames, const std::string& file)
+{
+    if(isCapturing() || numFrames == 0)
+        return false;
+
+    s_CaptureFile = file;
+    s_CaptureFramesLeft = numFrames;
+    s_CaptureStart = bx::getHPCounter();
+    s_EnabledBeforeCapture = isEnabled();
+
+    setEnabled(true);
+
+    return true;
+}
+
+bool Profiler::isCapturing()
+{
+    return s_CaptureFramesLeft > 0;
+}
+
+size_t Profiler::getNumDroppedEvents()
+{
+    return getRegistry().numDropped;
+}
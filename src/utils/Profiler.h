@@ -0,0 +1,117 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace Utils
+{
+    /**
+     * Hierarchical CPU-profiler. Code marks zones using PROFILE_SCOPE("Name"), which are recorded into a buffer
+     * owned by the thread running them, so threads never wait on each other. Once per frame, the main-thread collects
+     * all buffers and sums up the time per zone, with and without the zones nested inside.
+     * The collected events can also be written as Chrome-trace (chrome://tracing, Perfetto, speedscope).
+     *
+     * Zone-names must be string-literals or otherwise live forever, only the pointer is stored.
+     */
+    namespace Profiler
+    {
+        /**
+         * Summed up time of one zone, averaged over the frames of the last report-window
+         */
+        struct ZoneStats
+        {
+            const char* name;
+            double numCalls; // Per frame
+            double inclusive; // Milliseconds per frame. Counted once for recursive zones.
+            double exclusive; // Milliseconds per frame, without the zones nested inside
+        };
+
+        /**
+         * Switches recording on or off. While off, a zone costs a single load and branch.
+         */
+        void setEnabled(bool enabled);
+
+        namespace detail
+        {
+            extern std::atomic<bool> s_Enabled;
+
+            void beginZone(const char* name);
+            void endZone();
+        }
+
+        inline bool isEnabled()
+        {
+            return detail::s_Enabled.load(std::memory_order_relaxed);
+        }
+
+        /**
+         * Records the time from construction to destruction as zone with the given name
+         */
+        class Zone
+        {
+        public:
+            explicit Zone(const char* name) :
+                    m_Active(isEnabled())
+            {
+                if(m_Active)
+                    detail::beginZone(name);
+            }
+
+            ~Zone()
+            {
+                if(m_Active)
+                    detail::endZone();
+            }
+
+        private:
+            bool m_Active;
+        };
+
+        /**
+         * Names the calling thread inside captures
+         */
+        void setThreadName(const char* name);
+
+        /**
+         * Collects the events of all threads. To be called by the main-thread once per frame.
+         */
+        void onFrameEnd();
+
+        /**
+         * @param n Maximum number of zones to return
+         * @return The zones with the highest exclusive time, most expensive first
+         */
+        std::vector<ZoneStats> getTopZones(size_t n);
+
+        /**
+         * Records the next numFrames frames and writes them to the given file as Chrome-trace.
+         * Enables the profiler for that time, if it isn't already.
+         * @return False, if there is already a capture running
+         */
+        bool startCapture(size_t numFrames, const std::string& file);
+
+        /**
+         * @return Whether a capture is running
+         */
+        bool isCapturing();
+
+        /**
+         * @return Events lost because a threads buffer was full. Should stay 0.
+         */
+        size_t getNumDroppedEvents();
+    }
+}
+
+#define PROFILE_CONCAT_IMPL(a, b) a##b
+#define PROFILE_CONCAT(a, b) PROFILE_CONCAT_IMPL(a, b)
+
+/**
+ * Records the enclosing scope as zone with the given name
+ */
+#define PROFILE_SCOPE(name) Utils::Profiler::Zone PROFILE_CONCAT(profileZone_, __LINE__)(name)
+
+/**
+ * Records the enclosing function
+ */
+#define PROFILE_FUNCTION() PROFILE_SCOPE(__FUNCTION__)
@@ -0,0 +1,225 @@
+#pragma once
+#include <cstddef>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <assert.h>
+
+namespace Utils
+{
+    template<typename Signature, size_t BUFFER_SIZE = 32>
+    class SmallFunction;
+
+    /**
+     * Replacement for std::function, which stores callables up to BUFFER_SIZE bytes inline instead of
+     * allocating them on the heap. Lambdas capturing a couple of handles and a this-pointer fit in there.
+     * Bigger callables still work, but take a heap-allocation.
+     * @param R Return-type
+     * @param Args Argument-types
+     * @param BUFFER_SIZE Size of the inline storage
+     */
+    template<typename R, typename... Args, size_t BUFFER_SIZE>
+    class SmallFunction<R(Args...), BUFFER_SIZE>
+    {
+    public:
+        SmallFunction() :
+                m_pOps(nullptr)
+        {
+        }
+
+        template<typename F, typename = typename std::enable_if<
+                !std::is_same<typename std::decay<F>::type, SmallFunction>::value>::type>
+        SmallFunction(F&& f) :
+                m_pOps(nullptr)
+        {
+            typedef typename std::decay<F>::type Fn;
+
+            OpsFor<Fn>::create(&m_Storage, std::forward<F>(f));
+            m_pOps = OpsFor<Fn>::get();
+        }
+
+        SmallFunction(const SmallFunction& other) :
+                m_pOps(nullptr)
+        {
+            if(other.m_pOps)
+                other.m_pOps->copy(&m_Storage, &other.m_Storage);
+
+            m_pOps = other.m_pOps;
+        }
+
+        SmallFunction(SmallFunction&& other) noexcept :
+                m_pOps(nullptr)
+        {
+            if(other.m_pOps)
+                other.m_pOps->move(&m_Storage, &other.m_Storage);
+
+            m_pOps = other.m_pOps;
+            other.m_pOps = nullptr;
+        }
+
+        ~SmallFunction()
+        {
+            reset();
+        }
+
+        SmallFunction& operator=(const SmallFunction& other)
+        {
+            if(this != &other)
+            {
+                SmallFunction tmp(other);
+                *this = std::move(tmp);
+            }
+
+            return *this;
+        }
+
+        SmallFunction& operator=(SmallFunction&& other) noexcept
+        {
+            if(this != &other)
+            {
+                reset();
+
+                if(other.m_pOps)
+                    other.m_pOps->move(&m_Storage, &other.m_Storage);
+
+                m_pOps = other.m_pOps;
+                other.m_pOps = nullptr;
+            }
+
+            return *this;
+        }
+
+        R operator()(Args... args) const
+        {
+            assert(m_pOps);
+            return m_pOps->invoke(const_cast<Storage*>(&m_Storage), std::forward<Args>(args)...);
+        }
+
+        explicit operator bool() const
+        {
+            return m_pOps != nullptr;
+        }
+
+        /**
+         * Destroys the stored callable
+         */
+        void reset()
+        {
+            if(m_pOps)
+                m_pOps->destroy(&m_Storage);
+
+            m_pOps = nullptr;
+        }
+
+        /**
+         * @return Whether a callable of the given type is stored without a heap-allocation
+         */
+        template<typename Fn>
+        static constexpr bool fitsInline()
+        {
+            return sizeof(Fn) <= BUFFER_SIZE
+                   && alignof(Fn) <= alignof(std::max_align_t)
+                   && std::is_nothrow_move_constructible<Fn>::value;
+        }
+
+    private:
+
+        typedef typename std::aligned_storage<BUFFER_SIZE, alignof(std::max_align_t)>::type Storage;
+
+        /**
+         * Type-erased operations on the stored callable
+         */
+        struct Ops
+        {
+            R (*invoke)(Storage*, Args&&...);
+            void (*copy)(Storage* dst, const Storage* src);
+            void (*move)(Storage* dst, Storage* src);
+            void (*destroy)(Storage*);
+        };
+
+        template<typename Fn, bool INLINE = fitsInline<Fn>()>
+        struct OpsFor;
+
+        template<typename Fn>
+        struct OpsFor<Fn, true>
+        {
+            template<typename F>
+            static void create(Storage* s, F&& f)
+            {
+                new (s) Fn(std::forward<F>(f));
+            }
+
+            static R invoke(Storage* s, Args&&... args)
+            {
+                return (*reinterpret_cast<Fn*>(s))(std::forward<Args>(args)...);
+            }
+
+            static void copy(Storage* dst, const Storage* src)
+            {
+                new (dst) Fn(*reinterpret_cast<const Fn*>(src));
+            }
+
+            static void move(Storage* dst, Storage* src)
+            {
+                new (dst) Fn(std::move(*reinterpret_cast<Fn*>(src)));
+                reinterpret_cast<Fn*>(src)->~Fn();
+            }
+
+            static void destroy(Storage* s)
+            {
+                reinterpret_cast<Fn*>(s)->~Fn();
+            }
+
+            static const Ops* get()
+            {
+                static const Ops ops = {&invoke, &copy, &move, &destroy};
+                return &ops;
+            }
+        };
+
+        template<typename Fn>
+        struct OpsFor<Fn, false>
+        {
+            static Fn*& ptr(Storage* s)
+            {
+                return *reinterpret_cast<Fn**>(s);
+            }
+
+            template<typename F>
+            static void create(Storage* s, F&& f)
+            {
+                ptr(s) = new Fn(std::forward<F>(f));
+            }
+
+            static R invoke(Storage* s, Args&&... args)
+            {
+                return (*ptr(s))(std::forward<Args>(args)...);
+            }
+
+            static void copy(Storage* dst, const Storage* src)
+            {
+                ptr(dst) = new Fn(**reinterpret_cast<Fn* const*>(src));
+            }
+
+            static void move(Storage* dst, Storage* src)
+            {
+                // Just steal the pointer
+                ptr(dst) = ptr(src);
+            }
+
+            static void destroy(Storage* s)
+            {
+                delete ptr(s);
+            }
+
+            static const Ops* get()
+            {
+                static const Ops ops = {&invoke, &copy, &move, &destroy};
+                return &ops;
+            }
+        };
+
+        Storage m_Storage;
+        const Ops* m_pOps;
+    };
+}
@@ -3,6 +3,10 @@
 #include <utils/logger.h>
 #include <algorithm>
 #include <cctype>
+#include <cerrno>
+#include <cmath>
+#include <cstdlib>
+#include <limits>
 #include <bx/readerwriter.h>
 #include <bx/crtimpl.h>
 #include <utils/split.h>
@@ -90,6 +94,39 @@ bool Utils::fileExists(const std::string& file)
     return true;
 }
 
+bool Utils::parseUnsigned(const std::string& str, size_t& out)
+{
+    // strtoull would happily wrap a leading minus around
+    if(str.empty() || !isdigit(static_cast<unsigned char>(str[0])))
+        return false;
+
+    char* end = nullptr;
+    errno = 0;
+    unsigned long long v = strtoull(str.c_str(), &end, 10);
+
+    if(errno == ERANGE || *end != '\0' || v > std::numeric_limits<size_t>::max())
+        return false;
+
+    out = static_cast<size_t>(v);
+    return true;
+}
+
+bool Utils::parseFloat(const std::string& str, float& out)
+{
+    if(str.empty() || isspace(static_cast<unsigned char>(str[0])))
+        return false;
+
+    char* end = nullptr;
+    errno = 0;
+    float v = strtof(str.c_str(), &end);
+
+    if(errno == ERANGE || *end != '\0' || !std::isfinite(v))
+        return false;
+
+    out = v;
+    return true;
+}
+
 std::string Utils::getCaseSensitivePath(const std::string& caseInsensitivePath, const std::string& prePath)
 {
 #if defined(WIN32) || defined(_WIN32)
@@ -211,6 +248,11 @@ namespace Utils
                 shaderPath = "shaders/gles/";
                 break;
 
+            case bgfx::RendererType::Null:
+                // Doesn't look at the shader-code, but still needs valid shader-files. These are always there.
+                shaderPath = "shaders/glsl/";
+                break;
+
             default:
                 break;
         }
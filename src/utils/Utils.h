@@ -150,6 +150,22 @@ namespace Utils
      * @return True, if the given file can be opened
      */
     bool fileExists(const std::string& file);
+
+    /**
+     * Parses a whole string as unsigned integer. Unlike std::stoul, this doesn't throw and rejects signs and garbage.
+     * @param str String to parse, e.g. user-input
+     * @param out Result. Untouched, if the string is not a valid number.
+     * @return True, if the whole string was a valid number
+     */
+    bool parseUnsigned(const std::string& str, size_t& out);
+
+    /**
+     * Parses a whole string as float. Unlike std::stof, this doesn't throw and rejects garbage.
+     * @param str String to parse, e.g. user-input
+     * @param out Result. Untouched, if the string is not a valid number.
+     * @return True, if the whole string was a valid, finite number
+     */
+    bool parseFloat(const std::string& str, float& out);
     
     
     /**